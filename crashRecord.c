@@ -0,0 +1,105 @@
+/*
+ * crashRecord.c
+ *
+ *  Created on: 18 Oct 2026
+ *
+ *  Crash record writer
+ *  - Begin, add TLVs, commit, the magic is written last so a partial record is never seen as valid
+ *  - Runs in the fault path, so no library calls
+ */
+#include <stdint.h>
+
+#include "crashRecord.h"
+
+/* Start a new record, discarding the previous one
+ * - Register and status fields are left for the caller
+ * - The sequence carries on from the previous record even once crashRecordClear() has
+ *   consumed it or it was never committed; only its header is checked, not the CRC, which
+ *   would cost over 100k cycles on the fault path
+*/
+crashRecordType* crashRecordBegin(uint8_t type)
+{
+    crashRecordType* record = CRASH_RECORD;
+    uint32_t sequence = 0;
+    uint32_t* word = (uint32_t*)record;
+    uint32_t i;
+
+    // Power on leaves the area random, a header of this version and size is a previous record.
+    if((record->m_Version == CRASH_RECORD_VERSION) && (record->m_HeaderSize == sizeof(crashRecordType)))
+        sequence = record->m_Sequence + 1u;
+
+    record->m_Magic = 0;
+    for(i = 1; i < (sizeof(crashRecordType) / sizeof(uint32_t)); i++)
+        word[i] = 0;
+
+    record->m_Version = CRASH_RECORD_VERSION;
+    record->m_HeaderSize = sizeof(crashRecordType);
+    record->m_Size = sizeof(crashRecordType);
+    record->m_Producer = CRASH_RECORD_PRODUCER;
+    record->m_Type = type;
+    record->m_Sequence = sequence;
+
+    return record;
+}
+
+/* Reserve a TLV
+ * - Returns the payload, or NULL and flags the record as truncated if there is no room
+*/
+void* crashRecordAddTlv(uint16_t tag, uint16_t length)
+{
+    crashRecordType* record = CRASH_RECORD;
+    uint32_t needed = sizeof(crashRecordTlvType) + ((length + 3u) & ~3u);
+    crashRecordTlvType* tlv;
+
+    if(needed > (CRASH_RECORD_SIZE - record->m_Size))
+    {
+        record->m_Flags |= CRASH_RECORD_FLAG_TRUNCATED;
+        return 0;
+    }
+
+    tlv = (crashRecordTlvType*)((uint8_t*)record + record->m_Size);
+    tlv->m_Tag = tag;
+    tlv->m_Length = length;
+    record->m_Size += needed;
+
+    // Zero the padding so the CRC doesn't depend on stale RAM.
+    if(length & 3u)
+        ((uint32_t*)(tlv + 1))[length / 4u] = 0;
+
+    return tlv + 1;
+}
+
+/* Shrink the last TLV to the bytes actually written
+ * - 0 removes it, a TLV that isn't the last one or a larger length is left alone
+*/
+void crashRecordEndTlv(void* aPayload, uint16_t length)
+{
+    crashRecordType* record = CRASH_RECORD;
+    crashRecordTlvType* tlv = (crashRecordTlvType*)aPayload - 1;
+    uint32_t reserved = (tlv->m_Length + 3u) & ~3u;
+    uint32_t i;
+
+    if(((uint8_t*)aPayload + reserved != (uint8_t*)record + record->m_Size) || (length >= tlv->m_Length))
+        return;
+
+    if(length == 0)
+    {
+        record->m_Size -= sizeof(crashRecordTlvType) + reserved;
+        return;
+    }
+    record->m_Size -= reserved - ((length + 3u) & ~3u);
+    tlv->m_Length = length;
+
+    // Zero the new padding so the CRC doesn't depend on what was written past the end.
+    for(i = length; i & 3u; i++)
+        ((uint8_t*)aPayload)[i] = 0;
+}
+
+void crashRecordCommit(void)
+{
+    crashRecordType* record = CRASH_RECORD;
+
+    record->m_Crc = crashRecordCrc((const uint8_t*)record + CRASH_RECORD_CRC_OFFSET,
+                                   record->m_Size - CRASH_RECORD_CRC_OFFSET);
+    record->m_Magic = CRASH_RECORD_MAGIC;
+}
@@ -0,0 +1,170 @@
+/*
+ * crashRecord.h
+ *
+ *  Created on: 18 Oct 2026
+ *
+ *  Crash record ABI shared by the bootloader, the application and the host tools
+ *  - Lives at a fixed RAM address reserved by crashRecord.ld, so it survives a reset
+ *  - Fixed header followed by TLVs, fields are only ever appended, readers skip unknown tags
+ *  - Only fixed width types, little endian, no dependency on the CPU headers
+ */
+
+#ifndef CRASH_RECORD_H_
+#define CRASH_RECORD_H_
+
+// Must match crashRecord.ld.
+#define CRASH_RECORD_ADDRESS            0x2004F000u
+#define CRASH_RECORD_SIZE               0x1000u
+
+#define CRASH_RECORD_MAGIC              0x48535243u     // "CRSH"
+#define CRASH_RECORD_VERSION            1u
+
+// Who wrote the record.
+#define CRASH_RECORD_PRODUCER_BOOTLOADER    1u
+#define CRASH_RECORD_PRODUCER_APPLICATION   2u
+
+#ifndef CRASH_RECORD_PRODUCER
+#define CRASH_RECORD_PRODUCER           CRASH_RECORD_PRODUCER_APPLICATION
+#endif
+
+// m_Flags bits.
+#define CRASH_RECORD_FLAG_FPU_FRAME     (1u<<0)     // The faulting context had FP state stacked.
+#define CRASH_RECORD_FLAG_TRUNCATED     (1u<<1)     // At least one TLV didn't fit, or the text it came from was cut short.
+#define CRASH_RECORD_FLAG_FROM_TEXT     (1u<<2)     // Rebuilt from printExtraInfo() output, r4-r11, SP and EXC_RETURN unknown.
+#define CRASH_RECORD_FLAG_PATCH_SITE    (1u<<3)     // The PC was in a word replaced by an FPB patch (exceptionsPatch.h).
+
+// TLV tags.
+#define CRASH_RECORD_TAG_MEMORY         1u      // uint32_t address, then the bytes.
+#define CRASH_RECORD_TAG_BACKTRACE      2u      // uint32_t return addresses, PC first.
+#define CRASH_RECORD_TAG_BUILD_ID       3u      // GNU build-id bytes.
+#define CRASH_RECORD_TAG_CONTEXT_STATUS 4u      // crashRecordContextStatusType per context provider.
+#define CRASH_RECORD_TAG_LOCKUP         5u      // exceptionsLockupStallType, the watch that stalled.
+#define CRASH_RECORD_TAG_TIME           6u      // crashRecordTimeType, when the record was written.
+#define CRASH_RECORD_TAG_DMA            7u      // crashRecordDmaStreamType per active DMA stream.
+#define CRASH_RECORD_TAG_INTEGRITY      8u      // crashRecordIntegrityType, the flash region that failed.
+#define CRASH_RECORD_TAG_REGIONS        9u      // crashRecordRegionStatusType per registered region, in priority order.
+#define CRASH_RECORD_TAG_VARIABLE       10u     // uint32_t address then the bytes, a variable from the capture list.
+#define CRASH_RECORD_TAG_PATCH          11u     // crashRecordPatchType per active FPB patch.
+#define CRASH_RECORD_TAG_CONTEXT        0x100u  // First tag for context providers (exceptionsContext.h).
+
+// crashRecordContextStatusType m_Status values.
+#define CRASH_RECORD_CONTEXT_OK         0u
+#define CRASH_RECORD_CONTEXT_OVERRUN    1u      // Over its cycle budget or byte limit, TLV dropped.
+#define CRASH_RECORD_CONTEXT_FAULTED    2u      // Faulted and was abandoned, TLV dropped.
+#define CRASH_RECORD_CONTEXT_DISABLED   3u      // Overran or faulted earlier this boot, not called.
+#define CRASH_RECORD_CONTEXT_NO_ROOM    4u      // The record was full.
+
+typedef struct
+{
+    uint32_t m_Magic;           // CRASH_RECORD_MAGIC once the record is complete.
+    uint16_t m_Version;         // CRASH_RECORD_VERSION.
+    uint16_t m_HeaderSize;      // sizeof(crashRecordType), TLVs start here.
+    uint32_t m_Size;            // Bytes used, header plus TLVs.
+    uint32_t m_Crc;             // CRC-32 of the bytes after this field up to m_Size.
+    uint8_t  m_Producer;        // CRASH_RECORD_PRODUCER_xxx.
+    uint8_t  m_Type;            // exceptionType.
+    uint16_t m_Flags;           // CRASH_RECORD_FLAG_xxx.
+    uint32_t m_Sequence;        // Incremented for every record written.
+    uint32_t m_R[13];           // r0-r12.
+    uint32_t m_Sp;              // SP of the faulting context, before stacking.
+    uint32_t m_Lr;
+    uint32_t m_Pc;
+    uint32_t m_Psr;
+    uint32_t m_ExcReturn;
+    uint32_t m_Cfsr;
+    uint32_t m_Hfsr;
+    uint32_t m_Mmfar;           // Only meaningful if CFSR.MMARVALID.
+    uint32_t m_Bfar;            // Only meaningful if CFSR.BFARVALID.
+    uint32_t m_AssertToken;     // FAULT_ASSERT token or EXCEPTION_HANDLER_FIELD_IS_INVALID.
+} crashRecordType;
+
+typedef struct
+{
+    uint16_t m_Tag;
+    uint16_t m_Length;          // Payload bytes, the next TLV starts at the following 4 byte boundary.
+} crashRecordTlvType;
+
+typedef struct
+{
+    uint16_t m_Tag;             // The provider's TLV tag.
+    uint8_t  m_Status;          // CRASH_RECORD_CONTEXT_xxx.
+    uint8_t  m_Reserved;
+    uint32_t m_Cycles;          // DWT cycles it ran for.
+} crashRecordContextStatusType;
+
+// Raw register values, the host decodes them (host/crashTime.c).
+typedef struct
+{
+    uint32_t m_CyclesLow;       // DWT CYCCNT extended to 64 bits, cycles since exceptionsTimeInit().
+    uint32_t m_CyclesHigh;
+    uint32_t m_CoreClock;       // SystemCoreClock in Hz, 0 if the cycle count isn't running.
+    uint32_t m_RtcTime;         // RTC_TR, BCD 24 hour time.
+    uint32_t m_RtcDate;         // RTC_DR, BCD date, 0 if the RTC isn't running.
+    uint32_t m_RtcSubSeconds;   // RTC_SSR, counts down from m_RtcPrediv.
+    uint32_t m_RtcPrediv;       // RTC_PRER, the synchronous prescaler is bits 0-14.
+} crashRecordTimeType;
+
+// crashRecordDmaStreamType m_Flags bits.
+#define CRASH_RECORD_DMA_STOPPED        (1u<<0)     // Disabled and confirmed stopped.
+#define CRASH_RECORD_DMA_KEPT           (1u<<1)     // Left running, EXCEPTIONS_DMA_KEEP.
+
+typedef struct
+{
+    uint8_t  m_Controller;      // 1 or 2.
+    uint8_t  m_Stream;          // 0-7.
+    uint8_t  m_Status;          // The stream's 6 LISR/HISR bits, FEIF at bit 0.
+    uint8_t  m_Flags;           // CRASH_RECORD_DMA_xxx.
+    uint32_t m_Cr;              // DMA_SxCR at fault entry.
+    uint32_t m_Ndtr;            // Items left once stopped.
+    uint32_t m_Par;
+    uint32_t m_M0ar;
+    uint32_t m_M1ar;
+    uint32_t m_Fcr;
+} crashRecordDmaStreamType;
+
+typedef struct
+{
+    uint32_t m_Region;          // Index in exceptionsIntegrityTable.
+    uint32_t m_Start;
+    uint32_t m_Words;
+    uint32_t m_Expected;        // CRC written by host/integrityPatch.
+    uint32_t m_Actual;
+} crashRecordIntegrityType;
+
+// crashRecordRegionStatusType m_Status values.
+#define CRASH_RECORD_REGION_COMPLETE    0u
+#define CRASH_RECORD_REGION_TRUNCATED   1u      // Part of it, the budget or the record ran out.
+#define CRASH_RECORD_REGION_SKIPPED     2u      // None of it, the budget or the record ran out.
+#define CRASH_RECORD_REGION_INVALID     3u      // Its length variable said more than the maximum, or isn't in RAM.
+
+typedef struct
+{
+    uint32_t m_Address;
+    uint32_t m_Length;          // Bytes wanted, the maximum or the current length.
+    uint32_t m_Captured;        // Bytes in its CRASH_RECORD_TAG_MEMORY TLV.
+    uint8_t  m_Priority;
+    uint8_t  m_Status;          // CRASH_RECORD_REGION_xxx.
+    uint16_t m_Reserved;
+} crashRecordRegionStatusType;
+
+typedef struct
+{
+    uint32_t m_Address;
+    uint32_t m_Replacement;     // The word executed instead of the ELF's.
+} crashRecordPatchType;
+
+#define CRASH_RECORD                    ((crashRecordType*)CRASH_RECORD_ADDRESS)
+#define CRASH_RECORD_CRC_OFFSET         16u     // First byte covered by m_Crc.
+
+// Reader, small enough for a boot sector (crashRecordReader.c).
+uint32_t crashRecordCrc(const void* aData, uint32_t length);
+const crashRecordType* crashRecordGet(void);
+void crashRecordClear(void);
+
+// Writer (crashRecord.c).
+crashRecordType* crashRecordBegin(uint8_t type);
+void* crashRecordAddTlv(uint16_t tag, uint16_t length);
+void crashRecordEndTlv(void* aPayload, uint16_t length);
+void crashRecordCommit(void);
+
+#endif /* CRASH_RECORD_H_ */
@@ -0,0 +1,57 @@
+/*
+ * crashRecordReader.c
+ *
+ *  Created on: 18 Oct 2026
+ *
+ *  Crash record reader
+ *  - Kept apart from the writer so a bootloader can link just this, it builds to under 300 bytes
+ *  - No CPU headers, no library calls
+ */
+#include <stdint.h>
+
+#include "crashRecord.h"
+
+// CRC-32 (zlib) of each nibble, 64 bytes of flash and a quarter of the bitwise loop's cycles.
+static const uint32_t crcNibbles[16] =
+{
+    0x00000000u, 0x1DB71064u, 0x3B6E20C8u, 0x26D930ACu, 0x76DC4190u, 0x6B6B51F4u, 0x4DB26158u, 0x5005713Cu,
+    0xEDB88320u, 0xF00F9344u, 0xD6D6A3E8u, 0xCB61B38Cu, 0x9B64C2B0u, 0x86D3D2D4u, 0xA00AE278u, 0xBDBDF21Cu
+};
+
+uint32_t crashRecordCrc(const void* aData, uint32_t length)
+{
+    const uint8_t* data = (const uint8_t*)aData;
+    uint32_t crc = 0xFFFFFFFFu;
+
+    while(length--)
+    {
+        crc ^= *data++;
+        crc = (crc >> 4) ^ crcNibbles[crc & 0xFu];
+        crc = (crc >> 4) ^ crcNibbles[crc & 0xFu];
+    }
+    return ~crc;
+}
+
+/* Get the crash record
+ * - Returns NULL if there is no complete record
+*/
+const crashRecordType* crashRecordGet(void)
+{
+    const crashRecordType* record = CRASH_RECORD;
+
+    if((record->m_Magic != CRASH_RECORD_MAGIC) || (record->m_Version != CRASH_RECORD_VERSION) ||
+       (record->m_Size < sizeof(crashRecordType)) || (record->m_Size > CRASH_RECORD_SIZE) ||
+       (record->m_Crc != crashRecordCrc((const uint8_t*)record + CRASH_RECORD_CRC_OFFSET,
+                                        record->m_Size - CRASH_RECORD_CRC_OFFSET)))
+        return 0;
+
+    return record;
+}
+
+/* Mark the record as consumed
+ * - Only the magic is cleared, crashRecordBegin() carries the sequence number on from the header
+*/
+void crashRecordClear(void)
+{
+    CRASH_RECORD->m_Magic = 0;
+}
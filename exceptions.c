@@ -10,7 +10,21 @@
  */
 #include <stdint.h>
 
+#include "crashRecord.h"
 #include "exceptions.h"
+#include "exceptionsCapture.h"
+#include "exceptionsContext.h"
+#include "exceptionsDma.h"
+#include "exceptionsFixup.h"
+#include "exceptionsPatch.h"
+#include "exceptionsRegions.h"
+#include "exceptionsRtos.h"
+#include "exceptionsTime.h"
+#include "exceptionsUnwind.h"
+#include "exceptionsVariables.h"
+#include "exceptionsVectors.h"
+#include "faultAssert.h"
+#include "gdbStub.h"
 #include "kernelPrintf.h"
 
 #if defined(STM32F413xx)
@@ -19,43 +33,103 @@
 #error *** ERROR - Cortex M4 Vectors CPU type not defined.
 #endif
 
-// Usage fault status bits.
-#define SCB_CFSR_DIVBYZERO      (1u<<25)    // Division by zero trapped.
-#define SCB_CFSR_UNALIGNED      (1u<<24)    // Data misalignment detected.
-#define SCB_CFSR_UNDEFINSTR     (1u<<16)    // Executed an undefined instruction.
-
-// Bus fault status bits.
-#define SCB_CFSR_BFARVALID      (1u<<15)    // BusFault Address Register (BFAR) valid flag.
-#define SCB_CFSR_LSPERR         (1u<<13)    // BusFault during floating point lazy state preservation.
-#define SCB_CFSR_STKERR         (1u<<12)    // BusFault on stacking for exception entry.
-#define SCB_CFSR_UNSTKERR       (1u<<11)    // BusFault on unstacking for a return from exception.
-#define SCB_CFSR_IMPRECISERR    (1u<<10)    // Imprecise data bus error.
-#define SCB_CFSR_PRECISERR      (1u<<9)     // Precise data bus error.
-#define SCB_CFSR_IBUSERR        (1u<<8)     // Instruction bus error.
-
-// Memory manager fault status bits.
-#define SCB_CFSR_MMARVALID      (1u<<7)     // Fault Address Register (MMFAR) valid flag.
-#define SCB_CFSR_MLSPERR        (1u<<5)     // Fault during floating point lazy state preservation.
-#define SCB_CFSR_MSTKERR        (1u<<4)     // Fault on stacking for exception entry.
-#define SCB_CFSR_MUNSTKERR      (1u<<3)     // Fault on unstacking for a return from exception.
-#define SCB_CFSR_DACCVIOL       (1u<<1)     // Invalid data address.
-#define SCB_CFSR_IACCVIOL       (1u<<0)     // Invalid execution address.
-
 /* Alignment trapping can be more problematic so option to avoid */
 #define TRAP_DIVIDE_BY_ZERO_ONLY
 
+/* Reset instead of BKPT when no debugger is attached */
+//#define EXCEPTIONS_RESET_ON_FAULT
+
+/* Enter the GDB stub over the UART instead of BKPT, see gdbStub.c */
+//#define EXCEPTIONS_GDB_STUB
+
+/* Add the TLVs of providers registered with exceptionsContextRegister(), see exceptionsContext.c */
+//#define EXCEPTIONS_CONTEXT_PROVIDERS
+
+/* Timestamp crash records, call exceptionsTimeInit() and exceptionsTimeTick(), see exceptionsTime.c */
+//#define EXCEPTIONS_TIMESTAMPS
+
+/* Record and stop the active DMA streams before anything else is captured, see exceptionsDma.c */
+//#define EXCEPTIONS_DMA_QUIESCE
+
+/* Let the accessors in exceptionsFixup.h fault without crashing, see exceptionsFixup.c */
+//#define EXCEPTIONS_FIXUP
+
+/* Add the regions registered with exceptionsRegionRegister(), up to a byte budget, see exceptionsRegions.c */
+//#define EXCEPTIONS_REGIONS
+
+/* Add the variables in the table host/captureList generates, see exceptionsVariables.c */
+//#define EXCEPTIONS_VARIABLES
+
+/* Run from a copy of the vector table in SRAM, handlers can be replaced at run time, see exceptionsVectors.c */
+//#define EXCEPTIONS_RAM_VECTORS
+
+/* Apply the FPB patch table at boot and record active patches in faults, see exceptionsPatch.c
+ * - Tables are rejected until the application provides exceptionsPatchAuthorize()
+ */
+//#define EXCEPTIONS_FPB_PATCHES
+
+/* Crash loop detection
+ * - This many fault resets in a row, within the window, puts the next boot into safe mode
+ * - The window is in RTC seconds, measured from the full date so it holds across month ends
+ * - 0, or an RTC that isn't running or set, just counts consecutive fault resets
+ * - Define EXCEPTIONS_CRASH_LOOP_ROLLBACK to call exceptionsRequestRollback() on entering safe mode
+ */
+#ifndef EXCEPTIONS_CRASH_LOOP_THRESHOLD
+#define EXCEPTIONS_CRASH_LOOP_THRESHOLD 3u
+#endif
+#ifndef EXCEPTIONS_CRASH_LOOP_WINDOW
+#define EXCEPTIONS_CRASH_LOOP_WINDOW    300u
+#endif
+//#define EXCEPTIONS_CRASH_LOOP_ROLLBACK
+
+/* GNU build-id note, define CRASH_RECORD_BUILD_ID if the linker script places it in flash */
+#if defined(CRASH_RECORD_BUILD_ID)
+extern const uint8_t g_note_build_id[];     // Start of .note.gnu.build-id.
+#endif
+
+#define RETAINED_MAGIC                  0x52455441u     // "RETA"
+#define RTC_SYNC_TIMEOUT                100000u
+
+// Boot state kept across resets.
+typedef struct
+{
+    uint32_t m_Magic;
+    uint32_t m_FaultPending;        // Set by the fault path, cleared by the next exceptionsInit().
+    uint32_t m_ConsecutiveFaults;   // Fault resets without a clean boot in between.
+    uint32_t m_FirstFaultTime;      // RTC seconds of the first fault in the window.
+    uint32_t m_Check;               // Inverted sum of the words above.
+} retainedBootStateType;
+
+static retainedBootStateType retainedBootState __attribute__((section(EXCEPTIONS_RETAINED_SECTION)));
+static int safeMode;
+
+static uint32_t retainedCheck(void);
+static void crashLoopUpdate(void);
+static uint32_t assertToken(const CortexExceptionCpuFrameType* aFrame);
 static void printExtraInfo(const CortexExceptionCpuFrameType* aFrame, exceptionType eType);
+#if defined(EXCEPTIONS_GDB_STUB)
+void debugMonitor(CortexExceptionCpuFrameType* aFrame, const CortexExceptionCalleeFrameType* aCallee);
+#endif
+
+#if !defined(EXCEPTIONS_CPP_FRONTEND)
+static void captureRecord(const CortexExceptionCpuFrameType* aFrame, const CortexExceptionCalleeFrameType* aCallee, exceptionType eType);
+static void handleFault(const CortexExceptionCpuFrameType* aFrame, const CortexExceptionCalleeFrameType* aCallee, exceptionType eType);
 
-void hardFault(const CortexExceptionCpuFrameType* aFrame);
-void memMangFault(const CortexExceptionCpuFrameType* aFrame);
-void busFault(const CortexExceptionCpuFrameType* aFrame);
-void usageFault(const CortexExceptionCpuFrameType* aFrame);
+void hardFault(const CortexExceptionCpuFrameType* aFrame, const CortexExceptionCalleeFrameType* aCallee);
+void memMangFault(const CortexExceptionCpuFrameType* aFrame, const CortexExceptionCalleeFrameType* aCallee);
+void busFault(const CortexExceptionCpuFrameType* aFrame, const CortexExceptionCalleeFrameType* aCallee);
+void usageFault(const CortexExceptionCpuFrameType* aFrame, const CortexExceptionCalleeFrameType* aCallee);
+#endif
 
 /* Initialise the exception handlers
  * - If not initialised they will be escalated to a hard fault
  */
 void exceptionsInit()
 {
+#if defined(EXCEPTIONS_RAM_VECTORS)
+    exceptionsVectorsInit();
+#endif
+
 #if !defined(TRAP_DIVIDE_BY_ZERO_ONLY)
     // Enable division by zero and alignment trapping.
     SCB->CCR|=SCB_CCR_UNALIGN_TRP_Msk|SCB_CCR_DIV_0_TRP_Msk;
@@ -67,6 +141,147 @@ void exceptionsInit()
     // Enable other faults of interest,
     // To test HardFault_Handler comment out the line below & call generateHardFault();
     SCB->SHCSR|=SCB_SHCSR_USGFAULTENA_Msk|SCB_SHCSR_BUSFAULTENA_Msk|SCB_SHCSR_MEMFAULTENA_Msk;
+
+#if defined(EXCEPTIONS_GDB_STUB)
+    gdbStubInit();
+#endif
+
+    crashLoopUpdate();
+
+#if defined(EXCEPTIONS_FPB_PATCHES)
+    // A crash loop may be the patch's doing, safe mode runs the build as shipped.
+    if(!safeMode)
+        exceptionsPatchInit();
+#endif
+}
+
+static uint32_t retainedCheck(void)
+{
+    return ~(retainedBootState.m_Magic + retainedBootState.m_FaultPending +
+             retainedBootState.m_ConsecutiveFaults + retainedBootState.m_FirstFaultTime);
+}
+
+/* Count fault resets
+ * - A boot that wasn't preceded by a fault, or is outside the window, restarts the count
+*/
+static void crashLoopUpdate(void)
+{
+    uint32_t now = exceptionsRtcSeconds();
+
+    // Power on, or retained RAM was trashed.
+    if((retainedBootState.m_Magic != RETAINED_MAGIC) || (retainedBootState.m_Check != retainedCheck()))
+    {
+        retainedBootState.m_Magic = RETAINED_MAGIC;
+        retainedBootState.m_FaultPending = 0;
+        retainedBootState.m_ConsecutiveFaults = 0;
+        retainedBootState.m_FirstFaultTime = 0;
+    }
+
+    if(!retainedBootState.m_FaultPending)
+    {
+        retainedBootState.m_ConsecutiveFaults = 0;
+    }
+    else
+    {
+        if((retainedBootState.m_ConsecutiveFaults == 0) ||
+           ((EXCEPTIONS_CRASH_LOOP_WINDOW != 0) && ((now - retainedBootState.m_FirstFaultTime) > EXCEPTIONS_CRASH_LOOP_WINDOW)))
+        {
+            retainedBootState.m_ConsecutiveFaults = 0;
+            retainedBootState.m_FirstFaultTime = now;
+        }
+        retainedBootState.m_ConsecutiveFaults++;
+    }
+    retainedBootState.m_FaultPending = 0;
+
+    safeMode = (retainedBootState.m_ConsecutiveFaults >= EXCEPTIONS_CRASH_LOOP_THRESHOLD);
+
+#if defined(EXCEPTIONS_CRASH_LOOP_ROLLBACK)
+    // Start counting afresh so the other bank doesn't immediately roll back too.
+    if(safeMode)
+        retainedBootState.m_ConsecutiveFaults = 0;
+#endif
+    retainedBootState.m_Check = retainedCheck();
+
+#if defined(EXCEPTIONS_CRASH_LOOP_ROLLBACK)
+    if(safeMode)
+        exceptionsRequestRollback();
+#endif
+}
+
+/* Crash loop status
+ * - Non-zero if this boot follows EXCEPTIONS_CRASH_LOOP_THRESHOLD fault resets, skip non-essential subsystems
+*/
+int exceptionsSafeMode()
+{
+    return safeMode;
+}
+
+uint32_t exceptionsConsecutiveFaults()
+{
+    return retainedBootState.m_ConsecutiveFaults;
+}
+
+/* Call once the application considers itself healthy
+ * - Later faults then start a new count
+*/
+void exceptionsBootStable()
+{
+    retainedBootState.m_ConsecutiveFaults = 0;
+    retainedBootState.m_Check = retainedCheck();
+}
+
+/* Request a switch to the other firmware bank
+ * - The STM32F413xx has a single bank, override this for dual bank parts or a bootloader swap
+*/
+__attribute__((weak)) void exceptionsRequestRollback()
+{
+}
+
+/* RTC time in seconds, used for the crash loop window
+ * - Seconds since 2000-01-01 from the full date, so a window can span a month or year end
+ * - Returns 0 if the RTC isn't running or holds no valid date, the window then only counts
+ *   consecutive fault resets
+*/
+__attribute__((weak)) uint32_t exceptionsRtcSeconds()
+{
+    static const uint16_t daysBeforeMonth[12] = { 0, 31, 59, 90, 120, 151, 181, 212, 243, 273, 304, 334 };
+    uint32_t timeout = RTC_SYNC_TIMEOUT;
+    uint32_t tr;
+    uint32_t dr;
+    uint32_t year;
+    uint32_t month;
+    uint32_t days;
+    uint32_t hours;
+
+    if(!(RCC->BDCR & RCC_BDCR_RTCEN) || !(RTC->ISR & RTC_ISR_INITS))
+        return 0;
+
+    // The shadow registers need to resynchronise after a reset.
+    while(!(RTC->ISR & RTC_ISR_RSF) && --timeout)
+        ;
+    if(timeout == 0)
+        return 0;
+
+    tr = RTC->TR;       // Reading TR locks DR until it is read.
+    dr = RTC->DR;
+
+    year = (((dr >> 20) & 0xFu) * 10u) + ((dr >> 16) & 0xFu);
+    month = (((dr >> 12) & 0x1u) * 10u) + ((dr >> 8) & 0xFu);
+    if((month == 0) || (month > 12))
+        return 0;
+
+    // 2000-2099, every fourth year is a leap year.
+    days = (year * 365u) + ((year + 3u) / 4u) + daysBeforeMonth[month - 1u] +
+           ((((year & 3u) == 0) && (month > 2u)) ? 1u : 0u) +
+           ((((dr >> 4) & 0x3u) * 10u) + (dr & 0xFu)) - 1u;
+
+    hours = (((tr >> 20) & 0x3u) * 10u) + ((tr >> 16) & 0xFu);
+    if(RTC->CR & RTC_CR_FMT)
+        hours = (hours % 12u) + ((tr & RTC_TR_PM) ? 12u : 0u);
+
+    return (days * 86400u) + (hours * 3600u) +
+           ((((tr >> 12) & 0x7u) * 10u) + ((tr >> 8) & 0xFu)) * 60u +
+           ((((tr >> 4) & 0x7u) * 10u) + (tr & 0xFu));
 }
 
 /* Fault generation functions
@@ -116,12 +331,34 @@ int generateUsageFault()
     return (a / b);
 }
 
+/* Decode a FAULT_ASSERT token
+ * - The stacked PC points at the UDF.W that raised the fault
+*/
+static uint32_t assertToken(const CortexExceptionCpuFrameType* aFrame)
+{
+    uint32_t pc = aFrame->m_PC;
+    uint16_t hw1;
+    uint16_t hw2;
+
+    if((pc & 1u) || !unwindIsCodeAddress(pc) || !unwindIsCodeAddress(pc + 3u))
+        return EXCEPTION_HANDLER_FIELD_IS_INVALID;
+
+    hw1 = *(const uint16_t*)pc;
+    hw2 = *(const uint16_t*)(pc + 2u);
+    if(((hw1 & FAULT_ASSERT_UDF_HW1_MASK) != FAULT_ASSERT_UDF_HW1) ||
+       ((hw2 & FAULT_ASSERT_UDF_HW2_MASK) != FAULT_ASSERT_UDF_HW2))
+        return EXCEPTION_HANDLER_FIELD_IS_INVALID;
+
+    return ((hw1 & 0xFu) << 12) | (hw2 & 0xFFFu);
+}
+
 static void printExtraInfo(const CortexExceptionCpuFrameType* aFrame, exceptionType eType)
 {
     uint32_t cfsr  = SCB->CFSR;
 
     uint32_t hfsr = EXCEPTION_HANDLER_FIELD_IS_INVALID;
     uint32_t faultAdd = EXCEPTION_HANDLER_FIELD_IS_INVALID;
+    uint32_t token = EXCEPTION_HANDLER_FIELD_IS_INVALID;
 
     KernelPrintf("**** EXCEPTION OCCURRED ****\r\n");
 
@@ -136,6 +373,8 @@ static void printExtraInfo(const CortexExceptionCpuFrameType* aFrame, exceptionT
                 KernelPrintf("Reason: Division by zero\r\n\n");
             else if(cfsr & SCB_CFSR_UNALIGNED)
                 KernelPrintf("Reason: Misaligned data access\r\n\n");
+            else if((cfsr & SCB_CFSR_UNDEFINSTR) && ((token = assertToken(aFrame)) != EXCEPTION_HANDLER_FIELD_IS_INVALID))
+                KernelPrintf("Reason: Assertion failed\r\n\n");
             else if(cfsr & SCB_CFSR_UNDEFINSTR)
                 KernelPrintf("Reason: Undefined instruction\r\n\n");
             else
@@ -164,8 +403,14 @@ static void printExtraInfo(const CortexExceptionCpuFrameType* aFrame, exceptionT
         case Hard_Fault:
         {
             KernelPrintf("Type: Hard Fault\r\n");
-            KernelPrintf("Reason: Unknown\r\n\n");
             hfsr  = SCB->HFSR;
+
+            // An assert escalates here when the usage fault is disabled.
+            if((hfsr & SCB_HFSR_FORCED_Msk) && (cfsr & SCB_CFSR_UNDEFINSTR) &&
+               ((token = assertToken(aFrame)) != EXCEPTION_HANDLER_FIELD_IS_INVALID))
+                KernelPrintf("Reason: Assertion failed\r\n\n");
+            else
+                KernelPrintf("Reason: Unknown\r\n\n");
         }
         break;
         case MemMang_Fault:
@@ -187,6 +432,24 @@ static void printExtraInfo(const CortexExceptionCpuFrameType* aFrame, exceptionT
                 faultAdd = SCB->MMFAR;
         }
         break;
+        case Lockup:
+        {
+            KernelPrintf("Type: Lockup\r\n");
+            KernelPrintf("Reason: No progress\r\n\n");
+        }
+        break;
+        case Watchdog:
+        {
+            KernelPrintf("Type: Watchdog\r\n");
+            KernelPrintf("Reason: Window watchdog early wakeup\r\n\n");
+        }
+        break;
+        case Integrity:
+        {
+            KernelPrintf("Type: Integrity\r\n");
+            KernelPrintf("Reason: Flash CRC mismatch\r\n\n");
+        }
+        break;
     }
 
     // Print registers
@@ -198,43 +461,244 @@ static void printExtraInfo(const CortexExceptionCpuFrameType* aFrame, exceptionT
     // Print fault info
     KernelPrintf("HFSR=%x CFSR=%x\r\n", hfsr, cfsr);
     KernelPrintf("Fault address=%x\r\n", faultAdd);
+    if(token != EXCEPTION_HANDLER_FIELD_IS_INVALID)
+        KernelPrintf("Assert token=%x\r\n", token);
 }
 
-/* fault handlers
- * - Provide some information on where the fault occurred
+/* Print the fault the way the C handlers do, for the C++ front end's KernelPrintf sink
 */
+void exceptionsPrintFault(const CortexExceptionCpuFrameType* aFrame, exceptionType eType)
+{
+    printExtraInfo(aFrame, eType);
+}
 
-void hardFault(const CortexExceptionCpuFrameType* aFrame)
+/* Let the next boot know this reset was caused by a fault
+*/
+void exceptionsFaultPending(void)
 {
-#ifdef __DEBUG_KERNEL__
-    printExtraInfo(aFrame, Hard_Fault);
+    retainedBootState.m_FaultPending = 1;
+    retainedBootState.m_Check = retainedCheck();
+}
+
+/* Top of the stack the fault was taken on, bounds the backtrace and the stack copy
+*/
+uint32_t exceptionsStackTop(uint32_t excReturn)
+{
+    return (excReturn & EXC_RETURN_PSP) ? EXCEPTIONS_RAM_END : EXCEPTIONS_MAIN_STACK_TOP;
+}
+
+/* Start the crash record
+ * - Registers, fault status and the assert token, the caller adds TLVs and commits
+*/
+crashRecordType* exceptionsRecordBegin(const CortexExceptionCpuFrameType* aFrame, const CortexExceptionCalleeFrameType* aCallee, exceptionType eType)
+{
+    crashRecordType* record = crashRecordBegin((uint8_t)eType);
+
+    record->m_R[0] = aFrame->m_R0;
+    record->m_R[1] = aFrame->m_R1;
+    record->m_R[2] = aFrame->m_R2;
+    record->m_R[3] = aFrame->m_R3;
+    record->m_R[4] = aCallee->m_R4;
+    record->m_R[5] = aCallee->m_R5;
+    record->m_R[6] = aCallee->m_R6;
+    record->m_R[7] = aCallee->m_R7;
+    record->m_R[8] = aCallee->m_R8;
+    record->m_R[9] = aCallee->m_R9;
+    record->m_R[10] = aCallee->m_R10;
+    record->m_R[11] = aCallee->m_R11;
+    record->m_R[12] = aFrame->m_R12;
+    record->m_Sp = unwindFrameSp((uint32_t)aFrame, aCallee->m_ExcReturn, aFrame->m_PSR);
+    record->m_Lr = aFrame->m_LR;
+    record->m_Pc = aFrame->m_PC;
+    record->m_Psr = aFrame->m_PSR;
+    record->m_ExcReturn = aCallee->m_ExcReturn;
+    if(!(aCallee->m_ExcReturn & EXC_RETURN_BASIC_FRAME))
+        record->m_Flags |= CRASH_RECORD_FLAG_FPU_FRAME;
+
+    record->m_Cfsr = SCB->CFSR;
+    record->m_Hfsr = SCB->HFSR;
+    record->m_Mmfar = SCB->MMFAR;
+    record->m_Bfar = SCB->BFAR;
+    record->m_AssertToken = (record->m_Cfsr & SCB_CFSR_UNDEFINSTR) ? assertToken(aFrame) : EXCEPTION_HANDLER_FIELD_IS_INVALID;
+
+    return record;
+}
+
+#if defined(CRASH_RECORD_BUILD_ID)
+void exceptionsRecordBuildId(void)
+{
+    // Note header is namesz, descsz, type then "GNU\0".
+    uint32_t idLength = *(const uint32_t*)(g_note_build_id + 4);
+    uint8_t* id = crashRecordAddTlv(CRASH_RECORD_TAG_BUILD_ID, (uint16_t)idLength);
+    uint32_t i;
+
+    for(i = 0; id && (i < idLength); i++)
+        id[i] = g_note_build_id[16 + i];
+}
 #endif
-    __asm__("BKPT");
+
+void exceptionsRecordBacktrace(const uint32_t* aFrames, uint32_t count)
+{
+    uint32_t* dest = crashRecordAddTlv(CRASH_RECORD_TAG_BACKTRACE, (uint16_t)(count * 4u));
+    uint32_t i;
+
+    for(i = 0; dest && (i < count); i++)
+        dest[i] = aFrames[i];
 }
 
-void memMangFault(const CortexExceptionCpuFrameType* aFrame)
+/* Copy the top of the stack
+ * - Never reads past the stack or RAM
+*/
+void exceptionsRecordStack(uint32_t sp, uint32_t stackTop, uint32_t length)
 {
-#ifdef __DEBUG_KERNEL__
-    printExtraInfo(aFrame, MemMang_Fault);
+    uint32_t* dest;
+    uint32_t i;
+
+    if(!unwindIsRamRange(sp, 0) || (sp & 3u) || (sp >= stackTop))
+        length = 0;
+    else if(length > (stackTop - sp))
+        length = stackTop - sp;
+    dest = length ? crashRecordAddTlv(CRASH_RECORD_TAG_MEMORY, (uint16_t)(length + 4u)) : 0;
+    if(dest)
+    {
+        dest[0] = sp;
+        for(i = 0; i < (length / 4u); i++)
+            dest[i + 1] = ((const uint32_t*)sp)[i];
+    }
+}
+
+/* Start the crash record with the default contents
+ * - Registers, fault status, backtrace and the top of the interrupted context's stack
+ * - Shared by the fault handlers, the lockup monitor and the watchdog, the caller commits
+*/
+crashRecordType* exceptionsRecordCapture(const CortexExceptionCpuFrameType* aFrame, const CortexExceptionCalleeFrameType* aCallee, exceptionType eType)
+{
+    crashRecordType* record = exceptionsRecordBegin(aFrame, aCallee, eType);
+    uint32_t stackTop = exceptionsStackTop(aCallee->m_ExcReturn);
+    uint32_t frames[EXCEPTIONS_RECORD_MAX_FRAMES];
+
+#if defined(EXCEPTIONS_DMA_QUIESCE)
+    exceptionsRecordDma();
 #endif
-    __asm__("BKPT");
+#if defined(EXCEPTIONS_TIMESTAMPS)
+    exceptionsRecordTime();
+#endif
+#if defined(CRASH_RECORD_BUILD_ID)
+    exceptionsRecordBuildId();
+#endif
+#if defined(EXCEPTIONS_FPB_PATCHES)
+    exceptionsRecordPatches(record);
+#endif
+    exceptionsRecordBacktrace(frames, EXCEPTIONS_UNWINDER(record->m_Pc, record->m_Lr, record->m_Sp, stackTop, frames, EXCEPTIONS_RECORD_MAX_FRAMES));
+    exceptionsRecordStack(record->m_Sp, stackTop, EXCEPTIONS_RECORD_STACK_BYTES);
+#if defined(EXCEPTIONS_VARIABLES)
+    exceptionsRecordVariables();
+#endif
+#if defined(EXCEPTIONS_REGIONS)
+    exceptionsRecordRegions();
+#endif
+    return record;
 }
 
-void busFault(const CortexExceptionCpuFrameType* aFrame)
+#if !defined(EXCEPTIONS_CPP_FRONTEND)
+/* Fill in the crash record
+*/
+static void captureRecord(const CortexExceptionCpuFrameType* aFrame, const CortexExceptionCalleeFrameType* aCallee, exceptionType eType)
 {
-#ifdef __DEBUG_KERNEL__
-    printExtraInfo(aFrame, Bus_Fault);
+    exceptionsRecordCapture(aFrame, aCallee, eType);
+#if defined(EXCEPTIONS_CONTEXT_PROVIDERS)
+    exceptionsContextCapture();
 #endif
-    __asm__("BKPT");
+    crashRecordCommit();
 }
 
-void usageFault(const CortexExceptionCpuFrameType* aFrame)
+/* fault handlers
+ * - Provide some information on where the fault occurred
+*/
+
+static void handleFault(const CortexExceptionCpuFrameType* aFrame, const CortexExceptionCalleeFrameType* aCallee, exceptionType eType)
 {
+#if defined(EXCEPTIONS_FIXUP)
+    // An accessor from exceptionsFixup.h faulted, resume at its fixup.
+    if(exceptionsFixupApply((CortexExceptionCpuFrameType*)aFrame, eType))
+        return;
+#endif
+#if defined(EXCEPTIONS_CONTEXT_PROVIDERS)
+    // A context provider faulted, return to the handler that called it.
+    if(exceptionsContextAbandon((CortexExceptionCpuFrameType*)aFrame))
+        return;
+#endif
+    exceptionsFaultPending();
+    captureRecord(aFrame, aCallee, eType);
+#if defined(EXCEPTIONS_RTOS_ADAPTER)
+    // Snapshot every task before printing disturbs anything.
+    exceptionsRtosCapture(aFrame, aCallee->m_ExcReturn);
+#endif
 #ifdef __DEBUG_KERNEL__
-    printExtraInfo(aFrame, Usage_Fault);
+    printExtraInfo(aFrame, eType);
+#if defined(EXCEPTIONS_RTOS_ADAPTER)
+    exceptionsRtosPrint();
+#endif
+#endif
+#if defined(EXCEPTIONS_GDB_STUB)
+    // A halting debugger can use BKPT as normal.
+    if(!(CoreDebug->DHCSR & CoreDebug_DHCSR_C_DEBUGEN_Msk))
+    {
+        gdbStubEnter((CortexExceptionCpuFrameType*)aFrame, aCallee, exceptionsGdbSignal(eType));
+        return;
+    }
+#endif
+#if defined(EXCEPTIONS_RESET_ON_FAULT)
+    if(!(CoreDebug->DHCSR & CoreDebug_DHCSR_C_DEBUGEN_Msk))
+        NVIC_SystemReset();
 #endif
     __asm__("BKPT");
 }
+#endif // !EXCEPTIONS_CPP_FRONTEND
+
+#if defined(EXCEPTIONS_GDB_STUB)
+int exceptionsGdbSignal(exceptionType eType)
+{
+    uint32_t cfsr = SCB->CFSR;
+
+    if(eType != Usage_Fault)
+        return GDB_SIGNAL_SEGV;
+    if(cfsr & SCB_CFSR_DIVBYZERO)
+        return GDB_SIGNAL_FPE;
+    return GDB_SIGNAL_ILL;
+}
+
+/* Debug monitor
+ * - BKPT and single steps arrive here when the GDB stub is in use
+*/
+void debugMonitor(CortexExceptionCpuFrameType* aFrame, const CortexExceptionCalleeFrameType* aCallee)
+{
+    // Clear the debug event status, write one to clear.
+    SCB->DFSR = SCB->DFSR;
+    gdbStubEnter(aFrame, aCallee, GDB_SIGNAL_TRAP);
+}
+#endif
+
+#if !defined(EXCEPTIONS_CPP_FRONTEND)
+void hardFault(const CortexExceptionCpuFrameType* aFrame, const CortexExceptionCalleeFrameType* aCallee)
+{
+    handleFault(aFrame, aCallee, Hard_Fault);
+}
+
+void memMangFault(const CortexExceptionCpuFrameType* aFrame, const CortexExceptionCalleeFrameType* aCallee)
+{
+    handleFault(aFrame, aCallee, MemMang_Fault);
+}
+
+void busFault(const CortexExceptionCpuFrameType* aFrame, const CortexExceptionCalleeFrameType* aCallee)
+{
+    handleFault(aFrame, aCallee, Bus_Fault);
+}
+
+void usageFault(const CortexExceptionCpuFrameType* aFrame, const CortexExceptionCalleeFrameType* aCallee)
+{
+    handleFault(aFrame, aCallee, Usage_Fault);
+}
 
 
 /* Low level fault handlers
@@ -243,60 +707,28 @@ void usageFault(const CortexExceptionCpuFrameType* aFrame)
 */
 __attribute__((naked))  void HardFault_Handler(void)
 {
-    asm volatile("tst lr, #4");                     // Check the exception return behaviour (EXC_RETURN)
-    asm volatile("ite eq");
-    asm volatile("mrseq r0, msp");                  // Bit 2 is low - Return behaviour is F9/E9 or F1/E1 so MSP stack.
-    asm volatile("mrsne r0, psp");                  // Bit 2 is high - Return behaviour is FD/ED, so PSP stack.
-
-    asm volatile("mov r1, #0");
-    asm volatile("msr PRIMASK, r1");                // Disable all interrupts...
-    asm volatile("msr FAULTMASK, r1");              // ... and subsequent faults.
-
-    asm volatile("ldr r1, =hardFault");
-    asm volatile("bx r1");                          // Call the real handler.
+    EXCEPTION_TRAMPOLINE(hardFault);
 }
 
 __attribute__((naked))  void MemManage_Handler(void)
 {
-    asm volatile("tst lr, #4");                     // Check the exception return behaviour (EXC_RETURN)
-    asm volatile("ite eq");
-    asm volatile("mrseq r0, msp");                  // Bit 2 is low - Return behaviour is F9/E9 or F1/E1 so MSP stack.
-    asm volatile("mrsne r0, psp");                  // Bit 2 is high - Return behaviour is FD/ED, so PSP stack.
-
-    asm volatile("mov r1, #0");
-    asm volatile("msr PRIMASK, r1");                // Disable all interrupts...
-    asm volatile("msr FAULTMASK, r1");              // ... and subsequent faults.
-
-    asm volatile("ldr r1, =memMangFault");
-    asm volatile("bx r1");                          // Call the real handler.
+    EXCEPTION_TRAMPOLINE(memMangFault);
 }
 
 __attribute__((naked))  void BusFault_Handler(void)
 {
-    asm volatile("tst lr, #4");                     // Check the exception return behaviour (EXC_RETURN)
-    asm volatile("ite eq");
-    asm volatile("mrseq r0, msp");                  // Bit 2 is low - Return behaviour is F9/E9 or F1/E1 so MSP stack.
-    asm volatile("mrsne r0, psp");                  // Bit 2 is high - Return behaviour is FD/ED, so PSP stack.
-
-    asm volatile("mov r1, #0");
-    asm volatile("msr PRIMASK, r1");                // Disable all interrupts...
-    asm volatile("msr FAULTMASK, r1");              // ... and subsequent faults.
-
-    asm volatile("ldr r1, =busFault");
-    asm volatile("bx r1");                          // Call the real handler.
+    EXCEPTION_TRAMPOLINE(busFault);
 }
 
 __attribute__((naked))  void UsageFault_Handler(void)
 {
-    asm volatile("tst lr, #4");                     // Check the exception return behaviour (EXC_RETURN)
-    asm volatile("ite eq");
-    asm volatile("mrseq r0, msp");                  // Bit 2 is low - Return behaviour is F9/E9 or F1/E1 so MSP stack.
-    asm volatile("mrsne r0, psp");                  // Bit 2 is high - Return behaviour is FD/ED, so PSP stack.
-
-    asm volatile("mov r1, #0");
-    asm volatile("msr PRIMASK, r1");                // Disable all interrupts...
-    asm volatile("msr FAULTMASK, r1");              // ... and subsequent faults.
+    EXCEPTION_TRAMPOLINE(usageFault);
+}
+#endif // !EXCEPTIONS_CPP_FRONTEND
 
-    asm volatile("ldr r1, =usageFault");
-    asm volatile("bx r1");                          // Call the real handler.
+#if defined(EXCEPTIONS_GDB_STUB)
+__attribute__((naked))  void DebugMon_Handler(void)
+{
+    EXCEPTION_TRAMPOLINE(debugMonitor);
 }
+#endif
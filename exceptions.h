@@ -23,16 +23,40 @@ typedef struct
     uint32_t m_PSR;     // Status register.
 }  CortexExceptionCpuFrameType;
 
+// Registers pushed by the exception trampolines, below the CPU frame on the main stack.
+typedef struct
+{
+    uint32_t m_R4;
+    uint32_t m_R5;
+    uint32_t m_R6;
+    uint32_t m_R7;
+    uint32_t m_R8;
+    uint32_t m_R9;
+    uint32_t m_R10;
+    uint32_t m_R11;
+    uint32_t m_ExcReturn;   // EXC_RETURN the exception was entered with.
+    uint32_t m_Pad;         // Keeps the main stack 8 byte aligned.
+}  CortexExceptionCalleeFrameType;
+
 typedef enum
 {
     Hard_Fault,
     MemMang_Fault,
     Bus_Fault,
-    Usage_Fault
+    Usage_Fault,
+    Lockup,             // No fault, the lockup monitor saw a stall (exceptionsLockup.h).
+    Watchdog,           // No fault, the WWDG was about to reset (exceptionsWatchdog.h).
+    Integrity           // No fault, a flash region failed its CRC (exceptionsIntegrity.h).
 } exceptionType;
 
 void exceptionsInit();
 
+int exceptionsSafeMode();
+uint32_t exceptionsConsecutiveFaults();
+void exceptionsBootStable();
+void exceptionsRequestRollback();
+uint32_t exceptionsRtcSeconds();
+
 int generateUsageFault();
 void generateBusFault();
 void generateHardFault();
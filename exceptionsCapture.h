@@ -0,0 +1,95 @@
+/*
+ * exceptionsCapture.h
+ *
+ *  Created on: 18 Oct 2026
+ *
+ *  Fault path building blocks
+ *  - exceptions.c composes them into its handlers, the C++ front end (exceptionsPolicy.hpp)
+ *    picks them per policy instead
+ *  - Each one is a separate function so a build only links the ones it calls
+ */
+
+#ifndef EXCEPTIONS_CAPTURE_H_
+#define EXCEPTIONS_CAPTURE_H_
+
+#include <stdint.h>
+
+#include "crashRecord.h"
+#include "exceptions.h"
+
+#define EXC_RETURN_PSP                  (1u<<2)     // Set if the frame was stacked on the PSP.
+#define EXC_RETURN_BASIC_FRAME          (1u<<4)     // Clear if the frame includes FP state.
+#define PSR_IT_MASK                     0x0600FC00u     // IT/ICI state, cleared when the stacked PC is redirected.
+
+// Usage fault status bits.
+#define SCB_CFSR_DIVBYZERO      (1u<<25)    // Division by zero trapped.
+#define SCB_CFSR_UNALIGNED      (1u<<24)    // Data misalignment detected.
+#define SCB_CFSR_UNDEFINSTR     (1u<<16)    // Executed an undefined instruction.
+
+// Bus fault status bits.
+#define SCB_CFSR_BFARVALID      (1u<<15)    // BusFault Address Register (BFAR) valid flag.
+#define SCB_CFSR_LSPERR         (1u<<13)    // BusFault during floating point lazy state preservation.
+#define SCB_CFSR_STKERR         (1u<<12)    // BusFault on stacking for exception entry.
+#define SCB_CFSR_UNSTKERR       (1u<<11)    // BusFault on unstacking for a return from exception.
+#define SCB_CFSR_IMPRECISERR    (1u<<10)    // Imprecise data bus error.
+#define SCB_CFSR_PRECISERR      (1u<<9)     // Precise data bus error.
+#define SCB_CFSR_IBUSERR        (1u<<8)     // Instruction bus error.
+
+// Memory manager fault status bits.
+#define SCB_CFSR_MMARVALID      (1u<<7)     // Fault Address Register (MMFAR) valid flag.
+#define SCB_CFSR_MLSPERR        (1u<<5)     // Fault during floating point lazy state preservation.
+#define SCB_CFSR_MSTKERR        (1u<<4)     // Fault on stacking for exception entry.
+#define SCB_CFSR_MUNSTKERR      (1u<<3)     // Fault on unstacking for a return from exception.
+#define SCB_CFSR_DACCVIOL       (1u<<1)     // Invalid data address.
+#define SCB_CFSR_IACCVIOL       (1u<<0)     // Invalid execution address.
+
+/* Section that survives a reset, must be NOLOAD so startup code leaves it alone */
+#ifndef EXCEPTIONS_RETAINED_SECTION
+#define EXCEPTIONS_RETAINED_SECTION     ".noinit"
+#endif
+
+/* Bytes of the faulting context's stack copied into the crash record */
+#ifndef EXCEPTIONS_RECORD_STACK_BYTES
+#define EXCEPTIONS_RECORD_STACK_BYTES   512u
+#endif
+#ifndef EXCEPTIONS_RECORD_MAX_FRAMES
+#define EXCEPTIONS_RECORD_MAX_FRAMES    16u
+#endif
+
+/* Low level fault handler trampoline
+ * - Finds the stacked frame, pushes r4-r11 and EXC_RETURN below it and calls handler(aFrame, aCallee)
+ * - The handler may return, the exception then returns normally
+*/
+#define EXCEPTION_TRAMPOLINE(handler)                                                                       \
+    asm volatile("tst lr, #4        \n"    /* Check the exception return behaviour (EXC_RETURN) */         \
+                 "ite eq            \n"                                                                     \
+                 "mrseq r0, msp     \n"    /* Bit 2 is low - Return behaviour is F9/E9 or F1/E1 so MSP stack. */ \
+                 "mrsne r0, psp     \n"    /* Bit 2 is high - Return behaviour is FD/ED, so PSP stack. */  \
+                 "sub sp, sp, #4    \n"    /* Keep the MSP 8 byte aligned... */                            \
+                 "push {r4-r11, lr} \n"    /* ... and pass r4-r11 and EXC_RETURN to the handler. */        \
+                 "mov r1, sp        \n"                                                                     \
+                 "mov r2, #0        \n"                                                                     \
+                 "msr PRIMASK, r2   \n"    /* Disable all interrupts... */                                 \
+                 "msr FAULTMASK, r2 \n"    /* ... and subsequent faults. */                                \
+                 "bl " #handler "   \n"    /* Call the real handler. */                                    \
+                 "pop {r4-r11, lr}  \n"    /* Handler returned, resume the interrupted code. */            \
+                 "add sp, sp, #4    \n"                                                                     \
+                 "bx lr             \n")
+
+void exceptionsFaultPending(void);
+uint32_t exceptionsStackTop(uint32_t excReturn);
+
+crashRecordType* exceptionsRecordBegin(const CortexExceptionCpuFrameType* aFrame, const CortexExceptionCalleeFrameType* aCallee, exceptionType eType);
+#if defined(CRASH_RECORD_BUILD_ID)
+void exceptionsRecordBuildId(void);
+#endif
+void exceptionsRecordBacktrace(const uint32_t* aFrames, uint32_t count);
+void exceptionsRecordStack(uint32_t sp, uint32_t stackTop, uint32_t length);
+crashRecordType* exceptionsRecordCapture(const CortexExceptionCpuFrameType* aFrame, const CortexExceptionCalleeFrameType* aCallee, exceptionType eType);
+
+void exceptionsPrintFault(const CortexExceptionCpuFrameType* aFrame, exceptionType eType);
+#if defined(EXCEPTIONS_GDB_STUB)
+int exceptionsGdbSignal(exceptionType eType);
+#endif
+
+#endif /* EXCEPTIONS_CAPTURE_H_ */
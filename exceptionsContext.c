@@ -0,0 +1,203 @@
+/*
+ * exceptionsContext.c
+ *
+ *  Created on: 18 Oct 2026
+ *
+ *  Context providers for the crash record
+ *  - Each provider is called through contextCall(), which saves the stack pointer first so a
+ *    fault inside it can be unwound: the nested HardFault points its return at contextResume
+ *    and the fault handler carries on with the next provider
+ */
+#include <stdint.h>
+
+#include "crashRecord.h"
+#include "exceptions.h"
+#include "exceptionsCapture.h"
+#include "exceptionsContext.h"
+
+#if defined(STM32F413xx)
+#include "stm32f413xx.h"
+#else
+#error *** ERROR - Cortex M4 Vectors CPU type not defined.
+#endif
+
+#define CONTEXT_FAULTED         0xFFFFFFFFu     // contextCall() result when the provider was abandoned.
+#define IPSR_HARD_FAULT         3u
+
+typedef struct
+{
+    exceptionsContextProviderType m_Provider;
+    uint32_t m_MaxCycles;
+    uint16_t m_Tag;
+    uint16_t m_MaxBytes;
+    uint8_t m_Disabled;         // Overran or faulted, skipped until the next boot.
+} contextProviderType;
+
+static contextProviderType providers[EXCEPTIONS_CONTEXT_MAX_PROVIDERS];
+static uint32_t providerCount;
+
+static volatile uint32_t contextActive;
+static volatile uint32_t contextStart;
+static volatile uint32_t contextBudget;
+static uint32_t contextCfsr;        // Status before the providers ran, bits they add are cleared again.
+static uint32_t contextHfsr;
+static volatile uint32_t contextResumeSp __attribute__((used));
+
+void contextResume(void);
+
+/* Add a provider
+ * - Call before faults can happen, typically straight after exceptionsInit()
+ * - Returns 0, or -1 if the table is full or the arguments are unusable
+*/
+int exceptionsContextRegister(uint16_t tag, uint16_t maxBytes, uint32_t maxCycles, exceptionsContextProviderType aProvider)
+{
+    contextProviderType* entry;
+
+    if((providerCount == EXCEPTIONS_CONTEXT_MAX_PROVIDERS) || (aProvider == 0) || (tag < CRASH_RECORD_TAG_CONTEXT) ||
+       (maxBytes == 0) || (maxBytes > (CRASH_RECORD_SIZE - sizeof(crashRecordType))))
+        return -1;
+
+    // The cycle counter measures the budgets.
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+    entry = &providers[providerCount++];
+    entry->m_Provider = aProvider;
+    entry->m_MaxCycles = maxCycles;
+    entry->m_Tag = tag;
+    entry->m_MaxBytes = maxBytes;
+    entry->m_Disabled = 0;
+    return 0;
+}
+
+/* Non-zero once the running provider has used up its budget
+*/
+int exceptionsContextExpired(void)
+{
+    return contextActive && ((DWT->CYCCNT - contextStart) > contextBudget);
+}
+
+/* Call a provider with a way back out
+ * - Saves r4-r11 and the stack pointer, contextResume restores them and returns CONTEXT_FAULTED
+*/
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wunused-parameter"
+__attribute__((naked, noinline)) static uint32_t contextCall(exceptionsContextProviderType aProvider, uint8_t* aDest, uint32_t maxBytes)
+{
+    asm volatile("push {r3-r11, lr}         \n"    /* Even register count keeps 8 byte alignment. */
+                 "ldr r3, =contextResumeSp  \n"
+                 "mov r12, sp               \n"
+                 "str r12, [r3]             \n"
+                 "mov r3, r0                \n"
+                 "mov r0, r1                \n"
+                 "mov r1, r2                \n"
+                 "blx r3                    \n"
+                 "pop {r3-r11, pc}          \n"
+                 ".thumb_func               \n"
+                 "contextResume:            \n"    /* Entered from exceptionsContextAbandon(). */
+                 "ldr r3, =contextResumeSp  \n"
+                 "ldr r12, [r3]             \n"
+                 "mov sp, r12               \n"
+                 "mvn r0, #0                \n"    /* CONTEXT_FAULTED. */
+                 "pop {r3-r11, pc}          \n"
+                 ".ltorg                    \n");
+}
+#pragma GCC diagnostic pop
+
+/* Run every provider into the crash record
+ * - Between crashRecordBegin() and crashRecordCommit()
+*/
+void exceptionsContextCapture(void)
+{
+    crashRecordContextStatusType* status;
+    uint32_t ccr = SCB->CCR;
+    uint32_t i;
+
+    if(providerCount == 0)
+        return;
+    status = crashRecordAddTlv(CRASH_RECORD_TAG_CONTEXT_STATUS, (uint16_t)(providerCount * sizeof(crashRecordContextStatusType)));
+    contextCfsr = SCB->CFSR;
+    contextHfsr = SCB->HFSR;
+
+    // A fault here would lock up, bad reads are better returning junk.
+    if((__get_IPSR() & SCB_ICSR_VECTACTIVE_Msk) == IPSR_HARD_FAULT)
+    {
+        SCB->CCR = ccr | SCB_CCR_BFHFNMIGN_Msk;
+        __DSB();
+        __ISB();
+    }
+
+    for(i = 0; i < providerCount; i++)
+    {
+        contextProviderType* entry = &providers[i];
+        uint32_t result = CRASH_RECORD_CONTEXT_DISABLED;
+        uint32_t cycles = 0;
+        uint8_t* dest;
+
+        if(!entry->m_Disabled)
+        {
+            uint32_t length;
+            uint32_t added;
+
+            dest = crashRecordAddTlv(entry->m_Tag, entry->m_MaxBytes);
+            if(dest == 0)
+            {
+                result = CRASH_RECORD_CONTEXT_NO_ROOM;
+            }
+            else
+            {
+                contextBudget = entry->m_MaxCycles;
+                contextStart = DWT->CYCCNT;
+                contextActive = 1;
+                length = contextCall(entry->m_Provider, dest, entry->m_MaxBytes);
+                contextActive = 0;
+                cycles = DWT->CYCCNT - contextStart;
+
+                // Any status bits it added mean a fault, even one BFHFNMIGN let through.
+                added = SCB->CFSR & ~contextCfsr;
+                if(added)
+                    SCB->CFSR = added;
+
+                if((length == CONTEXT_FAULTED) || added)
+                    result = CRASH_RECORD_CONTEXT_FAULTED;
+                else if((cycles > entry->m_MaxCycles) || (length > entry->m_MaxBytes))
+                    result = CRASH_RECORD_CONTEXT_OVERRUN;
+                else
+                    result = CRASH_RECORD_CONTEXT_OK;
+
+                crashRecordEndTlv(dest, (result == CRASH_RECORD_CONTEXT_OK) ? (uint16_t)length : 0u);
+                entry->m_Disabled = (result != CRASH_RECORD_CONTEXT_OK);
+            }
+        }
+        if(status)
+        {
+            status[i].m_Tag = entry->m_Tag;
+            status[i].m_Status = (uint8_t)result;
+            status[i].m_Reserved = 0;
+            status[i].m_Cycles = cycles;
+        }
+    }
+
+    SCB->CCR = ccr;
+    __DSB();
+    __ISB();
+}
+
+/* Abandon a provider that faulted
+ * - Called first by the fault handler, returns non-zero if it should just return: the
+ *   stacked PC now points at contextResume, back in the handler that called the provider
+*/
+int exceptionsContextAbandon(CortexExceptionCpuFrameType* aFrame)
+{
+    if(!contextActive)
+        return 0;
+    contextActive = 0;
+
+    // The record already has the original status, drop what the provider's fault added (write one to clear).
+    SCB->CFSR = SCB->CFSR & ~contextCfsr;
+    SCB->HFSR = SCB->HFSR & ~contextHfsr;
+
+    aFrame->m_PC = (uint32_t)contextResume & ~1u;
+    aFrame->m_PSR &= ~PSR_IT_MASK;
+    return 1;
+}
@@ -0,0 +1,39 @@
+/*
+ * exceptionsContext.h
+ *
+ *  Created on: 18 Oct 2026
+ *
+ *  Context providers, application callbacks that add a TLV to the crash record
+ *  - Register at start up with a tag (CRASH_RECORD_TAG_CONTEXT and up), a byte limit and a
+ *    cycle budget, each fault then calls them in order before the record is committed
+ *  - A provider that runs past its budget (DWT CYCCNT) or returns more than its limit has its
+ *    TLV dropped, one that faults is abandoned, both are skipped for the rest of the boot
+ *  - The CRASH_RECORD_TAG_CONTEXT_STATUS TLV has each provider's outcome and cycle count
+ *  - Providers run in the fault handler: copy state out, no blocking, no RTOS or HAL calls.
+ *    Loops should stop once exceptionsContextExpired() is true, the budget can't interrupt them
+ *  - A fault in a provider is only recoverable from a configurable fault (it escalates to
+ *    HardFault), inside HardFault data bus faults are ignored instead and anything else locks up
+ */
+
+#ifndef EXCEPTIONS_CONTEXT_H_
+#define EXCEPTIONS_CONTEXT_H_
+
+#include <stdint.h>
+
+#include "exceptions.h"
+
+#ifndef EXCEPTIONS_CONTEXT_MAX_PROVIDERS
+#define EXCEPTIONS_CONTEXT_MAX_PROVIDERS    8u
+#endif
+
+// Provider, writes at most maxBytes to aDest and returns how many it wrote.
+typedef uint32_t (*exceptionsContextProviderType)(uint8_t* aDest, uint32_t maxBytes);
+
+int exceptionsContextRegister(uint16_t tag, uint16_t maxBytes, uint32_t maxCycles, exceptionsContextProviderType aProvider);
+int exceptionsContextExpired(void);
+
+// Fault path, called by the handlers.
+void exceptionsContextCapture(void);
+int exceptionsContextAbandon(CortexExceptionCpuFrameType* aFrame);
+
+#endif /* EXCEPTIONS_CONTEXT_H_ */
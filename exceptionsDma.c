@@ -0,0 +1,106 @@
+/*
+ * exceptionsDma.c
+ *
+ *  Created on: 18 Oct 2026
+ *
+ *  DMA quiesce on fault entry
+ *  - Runs straight after the record's registers, before the backtrace and stack are copied
+ *  - Clearing EN lets the stream finish its current beat, so the stop is confirmed with a
+ *    bounded wait and the result kept in the entry's m_Flags
+ *  - A controller whose clock is off can't have anything running and isn't read
+ */
+#include <stdint.h>
+
+#include "crashRecord.h"
+#include "exceptionsDma.h"
+
+#if defined(STM32F413xx)
+#include "stm32f413xx.h"
+#else
+#error *** ERROR - Cortex M4 Vectors CPU type not defined.
+#endif
+
+#define DMA_CONTROLLERS         2u
+#define DMA_STREAMS             8u          // Per controller.
+#define DMA_STREAM_STRIDE       0x18u
+#define DMA_STOP_TIMEOUT        1000u
+
+typedef struct
+{
+    DMA_TypeDef* m_Dma;
+    DMA_Stream_TypeDef* m_Stream0;
+    uint32_t m_ClockEnable;
+} dmaControllerType;
+
+static const dmaControllerType controllers[DMA_CONTROLLERS] =
+{
+    {DMA1, DMA1_Stream0, RCC_AHB1ENR_DMA1EN},
+    {DMA2, DMA2_Stream0, RCC_AHB1ENR_DMA2EN}
+};
+
+// Position of each stream's flags in LISR (streams 0-3) and HISR (streams 4-7).
+static const uint8_t statusShift[4] = {0, 6, 16, 22};
+
+/* Record and stop the active DMA streams
+ * - Streams are stopped even if the record has no room for them
+*/
+void exceptionsRecordDma(void)
+{
+    crashRecordDmaStreamType* entries = crashRecordAddTlv(CRASH_RECORD_TAG_DMA, DMA_CONTROLLERS * DMA_STREAMS * sizeof(crashRecordDmaStreamType));
+    uint32_t count = 0;
+    uint32_t c;
+    uint32_t i;
+
+    for(c = 0; c < DMA_CONTROLLERS; c++)
+    {
+        const dmaControllerType* controller = &controllers[c];
+
+        if(!(RCC->AHB1ENR & controller->m_ClockEnable))
+            continue;
+
+        for(i = 0; i < DMA_STREAMS; i++)
+        {
+            DMA_Stream_TypeDef* stream = (DMA_Stream_TypeDef*)((uint32_t)controller->m_Stream0 + (i * DMA_STREAM_STRIDE));
+            uint32_t cr = stream->CR;
+            uint32_t flags = 0;
+
+            if(!(cr & DMA_SxCR_EN))
+                continue;
+
+            if(EXCEPTIONS_DMA_KEEP & (1u << ((c * DMA_STREAMS) + i)))
+            {
+                flags = CRASH_RECORD_DMA_KEPT;
+            }
+            else
+            {
+                uint32_t timeout = DMA_STOP_TIMEOUT;
+
+                stream->CR = cr & ~DMA_SxCR_EN;
+                while((stream->CR & DMA_SxCR_EN) && --timeout)
+                    ;
+                if(timeout != 0)
+                    flags = CRASH_RECORD_DMA_STOPPED;
+            }
+
+            if(entries)
+            {
+                crashRecordDmaStreamType* entry = &entries[count++];
+                uint32_t status = (i < 4u) ? controller->m_Dma->LISR : controller->m_Dma->HISR;
+
+                entry->m_Controller = (uint8_t)(c + 1u);
+                entry->m_Stream = (uint8_t)i;
+                entry->m_Status = (uint8_t)((status >> statusShift[i & 3u]) & 0x3Fu);
+                entry->m_Flags = (uint8_t)flags;
+                entry->m_Cr = cr;
+                entry->m_Ndtr = stream->NDTR;
+                entry->m_Par = stream->PAR;
+                entry->m_M0ar = stream->M0AR;
+                entry->m_M1ar = stream->M1AR;
+                entry->m_Fcr = stream->FCR;
+            }
+        }
+    }
+
+    if(entries)
+        crashRecordEndTlv(entries, (uint16_t)(count * sizeof(crashRecordDmaStreamType)));
+}
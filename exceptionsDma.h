@@ -0,0 +1,24 @@
+/*
+ * exceptionsDma.h
+ *
+ *  Created on: 18 Oct 2026
+ *
+ *  DMA quiesce on fault entry
+ *  - Every enabled DMA1/DMA2 stream is recorded in a CRASH_RECORD_TAG_DMA TLV and disabled,
+ *    so the rest of the record and anything printed describe memory the DMA isn't changing
+ */
+
+#ifndef EXCEPTIONS_DMA_H_
+#define EXCEPTIONS_DMA_H_
+
+#include <stdint.h>
+
+// Streams left running, e.g. a DMA driven console UART: bit n is DMA1 stream n, bit 8 + n DMA2 stream n.
+#ifndef EXCEPTIONS_DMA_KEEP
+#define EXCEPTIONS_DMA_KEEP             0u
+#endif
+
+// Fault path.
+void exceptionsRecordDma(void);
+
+#endif /* EXCEPTIONS_DMA_H_ */
@@ -0,0 +1,118 @@
+/*
+ * exceptionsFixup.c
+ *
+ *  Created on: 18 Oct 2026
+ *
+ *  Fault tolerant accessors, the fault handler side
+ *  - A data access BusFault or MemManage fault, or the HardFault it escalated to, whose PC is
+ *    in an .ex_table range returns to the entry's fixup instead of being a crash
+ *  - Instruction fetch, stacking and lazy FP faults are never fixed up, the frame or the
+ *    code can't be trusted
+ */
+#include <stdint.h>
+
+#include "exceptions.h"
+#include "exceptionsCapture.h"
+#include "exceptionsFixup.h"
+
+#if defined(STM32F413xx)
+#include "stm32f413xx.h"
+#else
+#error *** ERROR - Cortex M4 Vectors CPU type not defined.
+#endif
+
+#define FIXUP_DATA_FAULTS       (SCB_CFSR_DACCVIOL | SCB_CFSR_PRECISERR | SCB_CFSR_IMPRECISERR)
+#define FIXUP_FATAL_FAULTS      (SCB_CFSR_IACCVIOL | SCB_CFSR_MSTKERR | SCB_CFSR_MUNSTKERR | SCB_CFSR_MLSPERR | \
+                                 SCB_CFSR_IBUSERR | SCB_CFSR_STKERR | SCB_CFSR_UNSTKERR | SCB_CFSR_LSPERR)
+#define FIXUP_CFSR_MEM_BUS      0x0000FFFFu     // MMFSR and BFSR.
+
+extern const exceptionsFixupEntryType g_ex_table_start[];     // Start of .ex_table, exceptionsFixup.ld.
+extern const exceptionsFixupEntryType g_ex_table_end[];
+
+static int fixupSorted;
+static uint32_t fixupLastStatus;
+
+static const exceptionsFixupEntryType* fixupFind(uint32_t pc);
+
+/* Check the table is sorted
+ * - Returns 0, or -1 if host/exTableSort wasn't run, lookups are then a linear search
+*/
+int exceptionsFixupInit(void)
+{
+    const exceptionsFixupEntryType* entry;
+
+    fixupSorted = 0;
+    for(entry = g_ex_table_start; (entry + 1) < g_ex_table_end; entry++)
+    {
+        if(entry[0].m_End > entry[1].m_Start)
+            return -1;
+    }
+    fixupSorted = 1;
+    return 0;
+}
+
+/* CFSR of the last fault that was fixed up, 0 if none
+*/
+uint32_t exceptionsFixupLastStatus(void)
+{
+    return fixupLastStatus;
+}
+
+static const exceptionsFixupEntryType* fixupFind(uint32_t pc)
+{
+    uint32_t count = (uint32_t)(g_ex_table_end - g_ex_table_start);
+    uint32_t low = 0;
+    uint32_t high = count;
+
+    if(!fixupSorted)
+    {
+        for(low = 0; low < count; low++)
+        {
+            if((pc >= g_ex_table_start[low].m_Start) && (pc < g_ex_table_start[low].m_End))
+                return &g_ex_table_start[low];
+        }
+        return 0;
+    }
+
+    // Find the last entry starting at or before the PC.
+    while(low < high)
+    {
+        uint32_t middle = (low + high) / 2u;
+
+        if(g_ex_table_start[middle].m_Start <= pc)
+            low = middle + 1u;
+        else
+            high = middle;
+    }
+    if((low != 0) && (pc < g_ex_table_start[low - 1u].m_End))
+        return &g_ex_table_start[low - 1u];
+    return 0;
+}
+
+/* Resume a faulting accessor at its fixup
+ * - Called first by the fault handler, returns non-zero if it should just return
+*/
+int exceptionsFixupApply(CortexExceptionCpuFrameType* aFrame, exceptionType eType)
+{
+    uint32_t cfsr = SCB->CFSR;
+    const exceptionsFixupEntryType* entry;
+
+    if((eType == Usage_Fault) || ((eType == Hard_Fault) && !(SCB->HFSR & SCB_HFSR_FORCED_Msk)))
+        return 0;
+    if(!(cfsr & FIXUP_DATA_FAULTS) || (cfsr & FIXUP_FATAL_FAULTS))
+        return 0;
+
+    entry = fixupFind(aFrame->m_PC);
+    if(entry == 0)
+        return 0;
+
+    // Write one to clear.
+    SCB->CFSR = cfsr & FIXUP_CFSR_MEM_BUS;
+    if(eType == Hard_Fault)
+        SCB->HFSR = SCB_HFSR_FORCED_Msk;
+    fixupLastStatus = cfsr;
+
+    aFrame->m_PC = entry->m_Fixup & ~1u;
+    aFrame->m_PSR &= ~PSR_IT_MASK;
+    return 1;
+}
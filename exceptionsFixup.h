@@ -0,0 +1,135 @@
+/*
+ * exceptionsFixup.h
+ *
+ *  Created on: 18 Oct 2026
+ *
+ *  Fault tolerant accessors, like the Linux __ex_table
+ *  - Each accessor is a plain load or store with a {start, end, fixup} entry in .ex_table,
+ *    a BusFault or MemManage fault inside the range resumes at the fixup, which sets the
+ *    error and carries on after the access: no extra branch when it doesn't fault
+ *  - For external memory and peripherals that may be unplugged or unclocked
+ *  - INCLUDE exceptionsFixup.ld and run host/exTableSort on the ELF so the fault handler
+ *    can binary search the table, exceptionsFixupInit() falls back to a linear search if not
+ *  - Stores are followed by a DSB so a buffered write's imprecise fault arrives while the PC
+ *    is still inside the range, that costs the write buffer for these accesses only
+ */
+
+#ifndef EXCEPTIONS_FIXUP_H_
+#define EXCEPTIONS_FIXUP_H_
+
+#include <stdint.h>
+
+#include "exceptions.h"
+
+typedef struct
+{
+    uint32_t m_Start;           // First instruction allowed to fault.
+    uint32_t m_End;             // Just past the last one.
+    uint32_t m_Fixup;           // Where the fault resumes.
+} exceptionsFixupEntryType;
+
+/* Fixup and table entry for the instructions between labels 1 and 2
+ * - The fixup sets the [error] operand to -1 and branches back to label 2
+*/
+#define EXCEPTIONS_FIXUP_ASM                                                  \
+    ".pushsection .text.exfixup, \"ax\"     \n"                             \
+    ".balign 2                              \n"                             \
+    "3: mvn %[error], #0                    \n"                             \
+    "   b 2b                                \n"                             \
+    ".popsection                            \n"                             \
+    ".pushsection .ex_table, \"a\"          \n"                             \
+    ".balign 4                              \n"                             \
+    ".word 1b, 2b, 3b                       \n"                             \
+    ".popsection                            \n"
+
+/* Loads
+ * - Return 0, or -1 with *aValue 0 if the access faulted
+*/
+static inline int exceptionsFixupRead32(const volatile void* aAddress, uint32_t* aValue)
+{
+    uint32_t value = 0;
+    int error = 0;
+
+    asm volatile("1: ldr %[value], [%[address]]    \n"
+                 "2:                                \n"
+                 EXCEPTIONS_FIXUP_ASM
+                 : [value] "+r"(value), [error] "+r"(error) : [address] "r"(aAddress) : "memory");
+    *aValue = value;
+    return error;
+}
+
+static inline int exceptionsFixupRead16(const volatile void* aAddress, uint16_t* aValue)
+{
+    uint32_t value = 0;
+    int error = 0;
+
+    asm volatile("1: ldrh %[value], [%[address]]   \n"
+                 "2:                                \n"
+                 EXCEPTIONS_FIXUP_ASM
+                 : [value] "+r"(value), [error] "+r"(error) : [address] "r"(aAddress) : "memory");
+    *aValue = (uint16_t)value;
+    return error;
+}
+
+static inline int exceptionsFixupRead8(const volatile void* aAddress, uint8_t* aValue)
+{
+    uint32_t value = 0;
+    int error = 0;
+
+    asm volatile("1: ldrb %[value], [%[address]]   \n"
+                 "2:                                \n"
+                 EXCEPTIONS_FIXUP_ASM
+                 : [value] "+r"(value), [error] "+r"(error) : [address] "r"(aAddress) : "memory");
+    *aValue = (uint8_t)value;
+    return error;
+}
+
+/* Stores
+ * - Return 0, or -1 if the access faulted
+*/
+static inline int exceptionsFixupWrite32(volatile void* aAddress, uint32_t value)
+{
+    int error = 0;
+
+    asm volatile("1: str %[value], [%[address]]    \n"
+                 "   dsb                            \n"
+                 "   nop                            \n"    /* Where an imprecise fault is taken. */
+                 "2:                                \n"
+                 EXCEPTIONS_FIXUP_ASM
+                 : [error] "+r"(error) : [value] "r"(value), [address] "r"(aAddress) : "memory");
+    return error;
+}
+
+static inline int exceptionsFixupWrite16(volatile void* aAddress, uint16_t value)
+{
+    int error = 0;
+
+    asm volatile("1: strh %[value], [%[address]]   \n"
+                 "   dsb                            \n"
+                 "   nop                            \n"
+                 "2:                                \n"
+                 EXCEPTIONS_FIXUP_ASM
+                 : [error] "+r"(error) : [value] "r"((uint32_t)value), [address] "r"(aAddress) : "memory");
+    return error;
+}
+
+static inline int exceptionsFixupWrite8(volatile void* aAddress, uint8_t value)
+{
+    int error = 0;
+
+    asm volatile("1: strb %[value], [%[address]]   \n"
+                 "   dsb                            \n"
+                 "   nop                            \n"
+                 "2:                                \n"
+                 EXCEPTIONS_FIXUP_ASM
+                 : [error] "+r"(error) : [value] "r"((uint32_t)value), [address] "r"(aAddress) : "memory");
+    return error;
+}
+
+int exceptionsFixupInit(void);
+uint32_t exceptionsFixupLastStatus(void);
+
+// Fault path, called by the handlers.
+int exceptionsFixupApply(CortexExceptionCpuFrameType* aFrame, exceptionType eType);
+
+#endif /* EXCEPTIONS_FIXUP_H_ */
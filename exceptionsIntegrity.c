@@ -0,0 +1,148 @@
+/*
+ * exceptionsIntegrity.c
+ *
+ *  Created on: 18 Oct 2026
+ *
+ *  Background flash integrity scanner
+ *  - Call exceptionsIntegrityStep() from a low priority task or the idle hook, it feeds the
+ *    CRC unit in chunks until its cycle budget is spent and carries on next time, cycling
+ *    through the regions forever
+ *  - The scanner owns the CRC unit: the STM32F4 unit can't be reloaded with a partial CRC,
+ *    so nothing else may use it between steps
+ *  - A mismatch writes an Integrity crash record with a CRASH_RECORD_TAG_INTEGRITY TLV, once
+ *    per region per boot, and the step returns -1 so the application can react
+ *  - A record nobody has read yet, such as the fault that caused the last reset, is never
+ *    overwritten: the region is reported on a later pass once crashRecordClear() is called
+ */
+#include <stdint.h>
+
+#include "crashRecord.h"
+#include "exceptions.h"
+#include "exceptionsCapture.h"
+#include "exceptionsIntegrity.h"
+#include "exceptionsTime.h"
+
+#if defined(STM32F413xx)
+#include "stm32f413xx.h"
+#else
+#error *** ERROR - Cortex M4 Vectors CPU type not defined.
+#endif
+
+/* Words fed to the CRC unit between budget checks */
+#ifndef EXCEPTIONS_INTEGRITY_CHUNK_WORDS
+#define EXCEPTIONS_INTEGRITY_CHUNK_WORDS    64u
+#endif
+
+// Patched by host/integrityPatch, volatile so the zeros here are never folded into the code.
+const volatile exceptionsIntegrityTableType exceptionsIntegrityTable __attribute__((section(EXCEPTIONS_INTEGRITY_SECTION), used)) =
+{
+    EXCEPTIONS_INTEGRITY_MAGIC, 0u, {{0u, 0u, 0u}}
+};
+
+static uint32_t scanRegion;
+static uint32_t scanWord;           // Words of scanRegion already in the CRC unit.
+static uint32_t reportedRegions;    // Bit per region with a record this boot.
+
+static int integrityRecord(uint32_t index, uint32_t actual);
+
+/* Clock the CRC unit and the cycle counter
+*/
+void exceptionsIntegrityInit(void)
+{
+    RCC->AHB1ENR |= RCC_AHB1ENR_CRCEN;
+    (void)RCC->AHB1ENR;
+
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+    scanRegion = 0;
+    scanWord = 0;
+}
+
+/* Check the next part of the image
+ * - Runs for about maxCycles, overshooting by at most one chunk
+ * - Returns -1 if a region failed its check during this step, 0 otherwise
+*/
+int exceptionsIntegrityStep(uint32_t maxCycles)
+{
+    const volatile exceptionsIntegrityTableType* table = &exceptionsIntegrityTable;
+    uint32_t count = table->m_Count;
+    uint32_t start = DWT->CYCCNT;
+    int result = 0;
+
+    if((table->m_Magic != EXCEPTIONS_INTEGRITY_MAGIC) || (count == 0) || (count > EXCEPTIONS_INTEGRITY_MAX_REGIONS))
+        return 0;
+
+    do
+    {
+        const volatile exceptionsIntegrityRegionType* region = &table->m_Regions[scanRegion];
+        const volatile uint32_t* words = (const volatile uint32_t*)region->m_Start;
+        uint32_t end = region->m_Words;
+        uint32_t i;
+
+        if(scanWord == 0)
+            CRC->CR = CRC_CR_RESET;
+        if((end - scanWord) > EXCEPTIONS_INTEGRITY_CHUNK_WORDS)
+            end = scanWord + EXCEPTIONS_INTEGRITY_CHUNK_WORDS;
+        for(i = scanWord; i < end; i++)
+            CRC->DR = words[i];
+        scanWord = end;
+
+        if(scanWord >= region->m_Words)
+        {
+            uint32_t actual = CRC->DR;
+
+            if(actual != region->m_Crc)
+            {
+                result = -1;
+                if(!(reportedRegions & (1u << scanRegion)) && (integrityRecord(scanRegion, actual) == 0))
+                    reportedRegions |= 1u << scanRegion;
+            }
+            scanWord = 0;
+            if(++scanRegion >= count)
+                scanRegion = 0;
+        }
+    } while((DWT->CYCCNT - start) < maxCycles);
+
+    return result;
+}
+
+/* Write the Integrity record
+ * - No fault frame, the registers are left zero
+ * - Returns 0, or -1 if the record still holds one that hasn't been read
+*/
+static int integrityRecord(uint32_t index, uint32_t actual)
+{
+    const volatile exceptionsIntegrityRegionType* region = &exceptionsIntegrityTable.m_Regions[index];
+    uint32_t primask = __get_PRIMASK();
+    crashRecordIntegrityType* failure;
+    crashRecordType* record;
+
+    // A fault handler would start its own record part way through this one.
+    __disable_irq();
+    if(crashRecordGet() != 0)
+    {
+        __set_PRIMASK(primask);
+        return -1;
+    }
+    record = crashRecordBegin((uint8_t)Integrity);
+    record->m_AssertToken = EXCEPTION_HANDLER_FIELD_IS_INVALID;
+#if defined(EXCEPTIONS_TIMESTAMPS)
+    exceptionsRecordTime();
+#endif
+#if defined(CRASH_RECORD_BUILD_ID)
+    exceptionsRecordBuildId();
+#endif
+    failure = crashRecordAddTlv(CRASH_RECORD_TAG_INTEGRITY, sizeof(crashRecordIntegrityType));
+    if(failure)
+    {
+        failure->m_Region = index;
+        failure->m_Start = region->m_Start;
+        failure->m_Words = region->m_Words;
+        failure->m_Expected = region->m_Crc;
+        failure->m_Actual = actual;
+    }
+    crashRecordCommit();
+    __set_PRIMASK(primask);
+    return 0;
+}
@@ -0,0 +1,42 @@
+/*
+ * exceptionsIntegrity.h
+ *
+ *  Created on: 18 Oct 2026
+ *
+ *  Background flash integrity scanner
+ *  - Checks the CRC of the vector table, .text and .rodata a few words at a time with the
+ *    hardware CRC unit, so flash bit errors show up as Integrity records instead of as
+ *    unexplained faults
+ *  - The expected CRCs are written into exceptionsIntegrityTable after linking by
+ *    host/integrityPatch, until then the scanner does nothing
+ *  - The table layout is shared with the host, fixed width types only
+ */
+
+#ifndef EXCEPTIONS_INTEGRITY_H_
+#define EXCEPTIONS_INTEGRITY_H_
+
+#include <stdint.h>
+
+#define EXCEPTIONS_INTEGRITY_MAGIC          0x59474E49u     // "INGY"
+#define EXCEPTIONS_INTEGRITY_MAX_REGIONS    4u
+#define EXCEPTIONS_INTEGRITY_SECTION        ".integrity"    // Must be outside every region it checks.
+#define EXCEPTIONS_INTEGRITY_SYMBOL         "exceptionsIntegrityTable"
+
+typedef struct
+{
+    uint32_t m_Start;
+    uint32_t m_Words;           // Whole words only, up to 3 trailing bytes aren't checked.
+    uint32_t m_Crc;             // STM32 CRC: CRC-32 0x04C11DB7, init 0xFFFFFFFF, words MSB first.
+} exceptionsIntegrityRegionType;
+
+typedef struct
+{
+    uint32_t m_Magic;           // EXCEPTIONS_INTEGRITY_MAGIC.
+    uint32_t m_Count;           // Regions filled in, 0 until patched.
+    exceptionsIntegrityRegionType m_Regions[EXCEPTIONS_INTEGRITY_MAX_REGIONS];
+} exceptionsIntegrityTableType;
+
+void exceptionsIntegrityInit(void);
+int exceptionsIntegrityStep(uint32_t maxCycles);
+
+#endif /* EXCEPTIONS_INTEGRITY_H_ */
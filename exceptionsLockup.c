@@ -0,0 +1,212 @@
+/*
+ * exceptionsLockup.c
+ *
+ *  Created on: 18 Oct 2026
+ *
+ *  Soft lockup and task heartbeat monitor
+ *  - The timer handler goes through EXCEPTION_TRAMPOLINE, so the frame it checks from is the
+ *    interrupted context, picked from the MSP or PSP exactly as the fault handlers do
+ *  - A stall is recorded once, the watch is re-armed when its counter moves again, so a later
+ *    stall on it is recorded too
+ *  - A record nothing has read yet, such as the fault from the last boot, is left in place
+ *  - Then the IWDG is left to reset unless EXCEPTIONS_LOCKUP_RESET is defined; only that reset
+ *    counts towards crash loop detection, a stall that clears by itself doesn't
+ */
+#include <stdint.h>
+
+#include "crashRecord.h"
+#include "exceptions.h"
+#include "exceptionsCapture.h"
+#include "exceptionsContext.h"
+#include "exceptionsLockup.h"
+#include "exceptionsRtos.h"
+#include "kernelPrintf.h"
+
+#if defined(STM32F413xx)
+#include "stm32f413xx.h"
+#else
+#error *** ERROR - Cortex M4 Vectors CPU type not defined.
+#endif
+
+/* Reset as soon as the record is written instead of waiting for the IWDG */
+//#define EXCEPTIONS_LOCKUP_RESET
+
+/* The monitor's timer, any APB1 timer with an update interrupt */
+#ifndef EXCEPTIONS_LOCKUP_TIMER
+#define EXCEPTIONS_LOCKUP_TIMER         TIM7
+#define EXCEPTIONS_LOCKUP_TIMER_IRQ     TIM7_IRQn
+#define EXCEPTIONS_LOCKUP_TIMER_EN      RCC_APB1ENR_TIM7EN
+#define EXCEPTIONS_LOCKUP_HANDLER       TIM7_IRQHandler
+#endif
+
+#define LOCKUP_TICK_HZ                  10000u      // Timer count rate, periods up to 6.5s.
+#define LOCKUP_MAX_PERIOD_MS            6553u
+
+typedef struct
+{
+    const volatile uint32_t* m_Counter;     // Progress counter, or m_Beats for a heartbeat.
+    volatile uint32_t m_Beats;
+    uint32_t m_Last;                        // Counter value at the last check.
+    uint32_t m_TimeoutMs;
+    uint32_t m_IdleMs;                      // Time since the counter last moved.
+    uint32_t m_Stalled;                     // Recorded, not checked again until the counter moves.
+} lockupWatchType;
+
+static lockupWatchType watches[EXCEPTIONS_LOCKUP_MAX_WATCHES];
+static volatile uint32_t watchCount;
+static uint32_t lockupPeriodMs;
+
+static void lockupCapture(const CortexExceptionCpuFrameType* aFrame, const CortexExceptionCalleeFrameType* aCallee, uint32_t index);
+void lockupCheck(const CortexExceptionCpuFrameType* aFrame, const CortexExceptionCalleeFrameType* aCallee);
+
+/* Start the monitor
+ * - Checks every periodMs, timeouts are rounded up to a whole number of periods
+ * - Call after the clocks are configured, the timer's prescaler comes from SystemCoreClock
+*/
+void exceptionsLockupInit(uint32_t periodMs)
+{
+    uint32_t ppre1 = (RCC->CFGR & RCC_CFGR_PPRE1_Msk) >> RCC_CFGR_PPRE1_Pos;
+    uint32_t timerClock = SystemCoreClock;
+
+    // APB1 timers run at twice PCLK1 whenever it is divided.
+    if(ppre1 & 4u)
+        timerClock = (SystemCoreClock >> ((ppre1 & 3u) + 1u)) * 2u;
+
+    if(periodMs == 0)
+        periodMs = 1;
+    else if(periodMs > LOCKUP_MAX_PERIOD_MS)
+        periodMs = LOCKUP_MAX_PERIOD_MS;
+    lockupPeriodMs = periodMs;
+
+    RCC->APB1ENR |= EXCEPTIONS_LOCKUP_TIMER_EN;
+    (void)RCC->APB1ENR;
+
+    // URS stops the UG event below raising an interrupt.
+    EXCEPTIONS_LOCKUP_TIMER->CR1 = TIM_CR1_URS;
+    EXCEPTIONS_LOCKUP_TIMER->PSC = (timerClock / LOCKUP_TICK_HZ) - 1u;
+    EXCEPTIONS_LOCKUP_TIMER->ARR = (periodMs * (LOCKUP_TICK_HZ / 1000u)) - 1u;
+    EXCEPTIONS_LOCKUP_TIMER->EGR = TIM_EGR_UG;
+    EXCEPTIONS_LOCKUP_TIMER->SR = 0;
+    EXCEPTIONS_LOCKUP_TIMER->DIER = TIM_DIER_UIE;
+
+    // Above everything else, so a spinning interrupt handler is seen too.
+    NVIC_SetPriority(EXCEPTIONS_LOCKUP_TIMER_IRQ, 0);
+    NVIC_EnableIRQ(EXCEPTIONS_LOCKUP_TIMER_IRQ);
+    EXCEPTIONS_LOCKUP_TIMER->CR1 = TIM_CR1_URS | TIM_CR1_CEN;
+}
+
+/* Watch a counter
+ * - aCounter must change at least every timeoutMs, 0 registers a heartbeat instead
+ * - Returns the watch for exceptionsLockupHeartbeat(), or -1 if the table is full
+ * - Register from start up code, not from several tasks at once
+*/
+int exceptionsLockupWatch(const volatile uint32_t* aCounter, uint32_t timeoutMs)
+{
+    lockupWatchType* watch;
+
+    if((watchCount == EXCEPTIONS_LOCKUP_MAX_WATCHES) || (timeoutMs == 0))
+        return -1;
+
+    watch = &watches[watchCount];
+    watch->m_Beats = 0;
+    watch->m_Counter = aCounter ? aCounter : &watch->m_Beats;
+    watch->m_Last = *watch->m_Counter;
+    watch->m_TimeoutMs = timeoutMs;
+    watch->m_IdleMs = 0;
+    watch->m_Stalled = 0;
+
+    // The timer may already be running, only count the entry once it is filled in.
+    __DMB();
+    return (int)watchCount++;
+}
+
+/* Show progress on a heartbeat watch
+ * - Only ever called by the one task or loop the watch belongs to
+*/
+void exceptionsLockupHeartbeat(int watch)
+{
+    if((watch >= 0) && ((uint32_t)watch < watchCount))
+        watches[watch].m_Beats++;
+}
+
+/* Timer tick, called by the trampoline with the interrupted context
+*/
+void lockupCheck(const CortexExceptionCpuFrameType* aFrame, const CortexExceptionCalleeFrameType* aCallee)
+{
+    uint32_t count = watchCount;
+    uint32_t i;
+
+    // Write zero to clear.
+    EXCEPTIONS_LOCKUP_TIMER->SR = ~TIM_SR_UIF;
+
+    for(i = 0; i < count; i++)
+    {
+        lockupWatchType* watch = &watches[i];
+        uint32_t value = *watch->m_Counter;
+
+        if(value != watch->m_Last)
+        {
+            watch->m_Last = value;
+            watch->m_IdleMs = 0;
+            watch->m_Stalled = 0;
+        }
+        else if(!watch->m_Stalled && ((watch->m_IdleMs += lockupPeriodMs) >= watch->m_TimeoutMs))
+        {
+            watch->m_Stalled = 1;
+            lockupCapture(aFrame, aCallee, i);
+            return;
+        }
+    }
+}
+
+/* Record a stall
+ * - Same contents as a fault record, plus the watch that stalled
+*/
+static void lockupCapture(const CortexExceptionCpuFrameType* aFrame, const CortexExceptionCalleeFrameType* aCallee, uint32_t index)
+{
+    const lockupWatchType* watch = &watches[index];
+    exceptionsLockupStallType* stall;
+
+    // The application may still be running afterwards, an unread record is worth more.
+    if(crashRecordGet() == 0)
+    {
+        exceptionsRecordCapture(aFrame, aCallee, Lockup);
+        stall = crashRecordAddTlv(CRASH_RECORD_TAG_LOCKUP, sizeof(exceptionsLockupStallType));
+        if(stall)
+        {
+            stall->m_Watch = index;
+            stall->m_Count = watch->m_Last;
+            stall->m_IdleMs = watch->m_IdleMs;
+        }
+#if defined(EXCEPTIONS_CONTEXT_PROVIDERS)
+        exceptionsContextCapture();
+#endif
+        crashRecordCommit();
+    }
+#if defined(EXCEPTIONS_RTOS_ADAPTER)
+    exceptionsRtosCapture(aFrame, aCallee->m_ExcReturn);
+#endif
+#ifdef __DEBUG_KERNEL__
+    exceptionsPrintFault(aFrame, Lockup);
+    KernelPrintf("Stalled watch=%x Idle ms=%x\r\n", index, watch->m_IdleMs);
+#if defined(EXCEPTIONS_RTOS_ADAPTER)
+    exceptionsRtosPrint();
+#endif
+#endif
+
+    if(CoreDebug->DHCSR & CoreDebug_DHCSR_C_DEBUGEN_Msk)
+        __asm__("BKPT");
+#if defined(EXCEPTIONS_LOCKUP_RESET)
+    else
+    {
+        // Only a reset made here counts towards crash loop detection.
+        exceptionsFaultPending();
+        NVIC_SystemReset();
+    }
+#endif
+}
+
+__attribute__((naked))  void EXCEPTIONS_LOCKUP_HANDLER(void)
+{
+    EXCEPTION_TRAMPOLINE(lockupCheck);
+}
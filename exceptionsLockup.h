@@ -0,0 +1,36 @@
+/*
+ * exceptionsLockup.h
+ *
+ *  Created on: 18 Oct 2026
+ *
+ *  Soft lockup and task heartbeat monitor
+ *  - A periodic timer interrupt checks every watch, one that hasn't moved within its timeout
+ *    is a stall: the interrupted context goes into a Lockup crash record before the IWDG fires
+ *  - Watch a progress counter the code already keeps, or register a heartbeat and call
+ *    exceptionsLockupHeartbeat() from the task or loop being watched
+ *  - The timer runs at the highest priority, code spinning with interrupts masked can't be
+ *    seen and is still left to the IWDG
+ */
+
+#ifndef EXCEPTIONS_LOCKUP_H_
+#define EXCEPTIONS_LOCKUP_H_
+
+#include <stdint.h>
+
+#ifndef EXCEPTIONS_LOCKUP_MAX_WATCHES
+#define EXCEPTIONS_LOCKUP_MAX_WATCHES   8u
+#endif
+
+// CRASH_RECORD_TAG_LOCKUP payload.
+typedef struct
+{
+    uint32_t m_Watch;           // Index returned by exceptionsLockupWatch().
+    uint32_t m_Count;           // Value the counter was stuck at.
+    uint32_t m_IdleMs;          // Time since it last moved.
+} exceptionsLockupStallType;
+
+void exceptionsLockupInit(uint32_t periodMs);
+int exceptionsLockupWatch(const volatile uint32_t* aCounter, uint32_t timeoutMs);
+void exceptionsLockupHeartbeat(int watch);
+
+#endif /* EXCEPTIONS_LOCKUP_H_ */
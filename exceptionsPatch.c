@@ -0,0 +1,150 @@
+/*
+ * exceptionsPatch.c
+ *
+ *  Created on: 18 Oct 2026
+ *
+ *  Flash Patch and Breakpoint unit hot patches
+ *  - Applied once at boot: the table must have the right magic and CRC, name this build's
+ *    build-id, pass exceptionsPatchAuthorize() and every original word must still match,
+ *    otherwise nothing is patched
+ *  - exceptionsPatchAuthorize() rejects everything unless the application overrides it
+ *  - Remapped words are fetched from a 32 byte aligned SRAM block, one word per comparator
+ *  - Faults record the active patches, a fault inside a patched word sets
+ *    CRASH_RECORD_FLAG_PATCH_SITE
+ */
+#include <stdint.h>
+
+#include "crashRecord.h"
+#include "exceptionsPatch.h"
+
+#if defined(STM32F413xx)
+#include "stm32f413xx.h"
+#else
+#error *** ERROR - Cortex M4 Vectors CPU type not defined.
+#endif
+
+#if !defined(CRASH_RECORD_BUILD_ID)
+#error *** ERROR - FPB patches are matched to the build-id, define CRASH_RECORD_BUILD_ID.
+#endif
+
+// CMSIS has no definitions for the FPB.
+#define FPB_CTRL                        (*(volatile uint32_t*)0xE0002000u)
+#define FPB_REMAP                       (*(volatile uint32_t*)0xE0002004u)
+#define FPB_COMP                        ((volatile uint32_t*)0xE0002008u)
+#define FPB_CTRL_ENABLE                 (1u<<0)
+#define FPB_CTRL_KEY                    (1u<<1)     // Must be set for a write to take effect.
+#define FPB_REMAP_RMPSPT                (1u<<29)    // Remapping supported.
+#define FPB_REMAP_MASK                  0x1FFFFFE0u
+#define FPB_COMP_ENABLE                 (1u<<0)
+#define FPB_COMP_ADDRESS_MASK           0x1FFFFFFCu // REPLACE left 0, remap.
+#define FPB_CODE_REGION_END             0x20000000u
+#define FPB_REMAP_WORDS                 8u
+
+extern const uint8_t g_note_build_id[];     // Start of .note.gnu.build-id.
+
+static uint32_t patchRemap[FPB_REMAP_WORDS] __attribute__((aligned(32)));
+static exceptionsPatchType activePatches[EXCEPTIONS_PATCH_MAX];
+static uint32_t activeCount;
+
+/* Authorize a patch table
+ * - Called once its CRC and build-id have been checked
+ * - The CRC only catches corruption, anyone can build a table with a valid one; override to
+ *   check a signature, e.g. one stored after the table
+ * - The default rejects, so nothing is patched until the application links a verifier
+*/
+__attribute__((weak)) int exceptionsPatchAuthorize(const exceptionsPatchTableType* aTable)
+{
+    (void)aTable;
+    return 0;
+}
+
+static uint32_t codeComparators(void)
+{
+    uint32_t ctrl = FPB_CTRL;
+
+    return ((ctrl >> 4) & 0xFu) | (((ctrl >> 12) & 0x7u) << 4);
+}
+
+static int patchTableValid(const exceptionsPatchTableType* aTable)
+{
+    uint32_t idLength = *(const uint32_t*)(g_note_build_id + 4);
+    uint32_t i;
+
+    if((aTable->m_Magic != EXCEPTIONS_PATCH_MAGIC) || (aTable->m_Count == 0) || (aTable->m_Count > EXCEPTIONS_PATCH_MAX) ||
+       (aTable->m_Crc != crashRecordCrc(aTable, (uint32_t)((const uint8_t*)&aTable->m_Crc - (const uint8_t*)aTable))))
+        return 0;
+
+    if((aTable->m_BuildIdLength != idLength) || (idLength > EXCEPTIONS_PATCH_BUILD_ID_MAX))
+        return 0;
+    for(i = 0; i < idLength; i++)
+    {
+        if(aTable->m_BuildId[i] != g_note_build_id[16 + i])
+            return 0;
+    }
+
+    for(i = 0; i < aTable->m_Count; i++)
+    {
+        const exceptionsPatchType* patch = &aTable->m_Patches[i];
+
+        if((patch->m_Address & 3u) || (patch->m_Address >= FPB_CODE_REGION_END) ||
+           (*(const volatile uint32_t*)patch->m_Address != patch->m_Original))
+            return 0;
+    }
+    return exceptionsPatchAuthorize(aTable);
+}
+
+/* Apply the patch table
+ * - Called by exceptionsInit() with EXCEPTIONS_FPB_PATCHES defined, except in safe mode
+ * - Returns the number of patches applied, 0 without a table, -1 if the table was rejected
+*/
+int exceptionsPatchInit(void)
+{
+    const exceptionsPatchTableType* table = (const exceptionsPatchTableType*)EXCEPTIONS_PATCH_ADDRESS;
+    uint32_t i;
+
+    if(table->m_Magic != EXCEPTIONS_PATCH_MAGIC)
+        return 0;
+    if(!patchTableValid(table) || !(FPB_REMAP & FPB_REMAP_RMPSPT) || (table->m_Count > codeComparators()))
+        return -1;
+
+    // A debugger attached now may be using comparators too, patches take the lowest.
+    FPB_CTRL = FPB_CTRL_KEY;
+    for(i = 0; i < table->m_Count; i++)
+    {
+        activePatches[i] = table->m_Patches[i];
+        patchRemap[i] = table->m_Patches[i].m_Replacement;
+    }
+    __DSB();
+    FPB_REMAP = (uint32_t)patchRemap & FPB_REMAP_MASK;
+    for(i = 0; i < table->m_Count; i++)
+        FPB_COMP[i] = (table->m_Patches[i].m_Address & FPB_COMP_ADDRESS_MASK) | FPB_COMP_ENABLE;
+    activeCount = table->m_Count;
+    FPB_CTRL = FPB_CTRL_KEY | FPB_CTRL_ENABLE;
+    __DSB();
+    __ISB();
+    return (int)activeCount;
+}
+
+/* Record the active patches
+ * - Between crashRecordBegin() and crashRecordCommit()
+*/
+void exceptionsRecordPatches(crashRecordType* aRecord)
+{
+    crashRecordPatchType* dest;
+    uint32_t i;
+
+    if(activeCount == 0)
+        return;
+
+    dest = crashRecordAddTlv(CRASH_RECORD_TAG_PATCH, (uint16_t)(activeCount * sizeof(crashRecordPatchType)));
+    for(i = 0; i < activeCount; i++)
+    {
+        if((aRecord->m_Pc >= activePatches[i].m_Address) && (aRecord->m_Pc < (activePatches[i].m_Address + 4u)))
+            aRecord->m_Flags |= CRASH_RECORD_FLAG_PATCH_SITE;
+        if(dest)
+        {
+            dest[i].m_Address = activePatches[i].m_Address;
+            dest[i].m_Replacement = activePatches[i].m_Replacement;
+        }
+    }
+}
@@ -0,0 +1,53 @@
+/*
+ * exceptionsPatch.h
+ *
+ *  Created on: 18 Oct 2026
+ *
+ *  Flash Patch and Breakpoint unit hot patches
+ *  - A patch replaces one aligned word of code, e.g. with a B.W to a fixed routine, by
+ *    remapping its fetch to SRAM; nothing in flash changes except the patch table
+ *  - The table sits at EXCEPTIONS_PATCH_ADDRESS, outside the application image, so it can be
+ *    written without reflashing; host/fpbPatch builds it from the ELF
+ *  - The table layout is shared with the host, fixed width types only
+ */
+
+#ifndef EXCEPTIONS_PATCH_H_
+#define EXCEPTIONS_PATCH_H_
+
+#include <stdint.h>
+
+#include "crashRecord.h"
+
+#define EXCEPTIONS_PATCH_MAGIC          0x48435450u     // "PTCH"
+#define EXCEPTIONS_PATCH_MAX            6u              // Cortex-M4 instruction comparators.
+#define EXCEPTIONS_PATCH_BUILD_ID_MAX   20u             // SHA-1 build-id.
+
+// Flash sector 1 by default, keep it out of the application's FLASH region.
+#ifndef EXCEPTIONS_PATCH_ADDRESS
+#define EXCEPTIONS_PATCH_ADDRESS        0x08004000u
+#endif
+
+typedef struct
+{
+    uint32_t m_Address;         // Word aligned, in flash.
+    uint32_t m_Original;        // The word the build has there, checked before patching.
+    uint32_t m_Replacement;     // The word fetched instead.
+} exceptionsPatchType;
+
+typedef struct
+{
+    uint32_t m_Magic;           // EXCEPTIONS_PATCH_MAGIC, erased flash means no patches.
+    uint32_t m_Count;
+    uint32_t m_BuildIdLength;
+    uint8_t  m_BuildId[EXCEPTIONS_PATCH_BUILD_ID_MAX];  // The build the patches are for.
+    exceptionsPatchType m_Patches[EXCEPTIONS_PATCH_MAX];
+    uint32_t m_Crc;             // crashRecordCrc() of everything before it.
+} exceptionsPatchTableType;
+
+int exceptionsPatchInit(void);
+int exceptionsPatchAuthorize(const exceptionsPatchTableType* aTable);
+
+// Fault path.
+void exceptionsRecordPatches(crashRecordType* aRecord);
+
+#endif /* EXCEPTIONS_PATCH_H_ */
@@ -0,0 +1,401 @@
+/*
+ * exceptionsPolicy.hpp
+ *
+ *  Created on: 18 Oct 2026
+ *
+ *  C++ front end to the fault handlers, configured at compile time by a policy
+ *  - exceptionsPolicy<> picks capture depth, output sink, persistence backend, unwinder,
+ *    escalation and the optional features (fixups, DMA quiesce, time stamp, build-id, FPB
+ *    patches, variables, regions, context providers), each is a type or constant so disabled
+ *    features generate no code and nothing is decided at run time; exceptions.c's own
+ *    defines only set the defaults
+ *  - Build exceptions.c with EXCEPTIONS_CPP_FRONTEND so it leaves the handlers out, then in
+ *    one C++17 file: EXCEPTIONS_POLICY_HANDLERS(myPolicy)
+ *  - Link with -ffunction-sections -Wl,--gc-sections so building blocks a policy doesn't
+ *    call (exceptionsCapture.h) are dropped as well
+ *  - exceptionsMinimalPolicy is the trampolines, the crash loop flag and a reset, 276 bytes
+ *    of Thumb-2 measured for Cortex-M4: 184 for the four trampolines, 92 for the handlers
+ *    and exceptionsFaultPending(), plus 20 bytes of retained RAM (see the README)
+ *  - exceptionsDiagnosticPolicy does what the C handlers (handleFault() in exceptions.c) do
+ *    with the same defines, step for step
+ */
+
+#ifndef EXCEPTIONS_POLICY_HPP_
+#define EXCEPTIONS_POLICY_HPP_
+
+#include <stdint.h>
+
+extern "C"
+{
+#include "crashRecord.h"
+#include "exceptions.h"
+#include "exceptionsCapture.h"
+#include "exceptionsContext.h"
+#include "exceptionsDma.h"
+#include "exceptionsFixup.h"
+#include "exceptionsPatch.h"
+#include "exceptionsRegions.h"
+#include "exceptionsRtos.h"
+#include "exceptionsTime.h"
+#include "exceptionsUnwind.h"
+#include "exceptionsVariables.h"
+#include "gdbStub.h"
+}
+
+#if defined(STM32F413xx)
+#include "stm32f413xx.h"
+#else
+#error *** ERROR - Cortex M4 Vectors CPU type not defined.
+#endif
+
+// How much goes into the crash record, each level includes the ones before it.
+typedef enum
+{
+    Capture_None,           // No record.
+    Capture_Registers,      // Registers, fault status, assert token and build-id.
+    Capture_Backtrace,      // Plus the unwinder's backtrace.
+    Capture_Stack,          // Plus the top of the faulting stack.
+    Capture_Tasks           // Plus the RTOS task snapshot, needs EXCEPTIONS_RTOS_ADAPTER.
+} exceptionsCaptureType;
+
+// Optional features, or'ed together for the policy, each module must be linked and set up.
+#define EXCEPTIONS_FEATURE_FIXUP        (1u<<0)     // Resume at an exceptionsFixup.h accessor's fixup.
+#define EXCEPTIONS_FEATURE_DMA          (1u<<1)     // Stop DMA and record the streams (exceptionsDma.c).
+#define EXCEPTIONS_FEATURE_TIME         (1u<<2)     // Time stamp (exceptionsTime.c).
+#define EXCEPTIONS_FEATURE_BUILD_ID     (1u<<3)     // GNU build-id, needs CRASH_RECORD_BUILD_ID.
+#define EXCEPTIONS_FEATURE_PATCHES      (1u<<4)     // Active FPB patches (exceptionsPatch.c).
+#define EXCEPTIONS_FEATURE_VARIABLES    (1u<<5)     // Capture list (exceptionsVariables.c).
+#define EXCEPTIONS_FEATURE_REGIONS      (1u<<6)     // Registered regions (exceptionsRegions.c).
+#define EXCEPTIONS_FEATURE_CONTEXT      (1u<<7)     // Context providers (exceptionsContext.c).
+
+// Everything but the fixups goes into the record.
+#define EXCEPTIONS_FEATURES_RECORD      (EXCEPTIONS_FEATURE_DMA | EXCEPTIONS_FEATURE_TIME | EXCEPTIONS_FEATURE_BUILD_ID |    \
+                                         EXCEPTIONS_FEATURE_PATCHES | EXCEPTIONS_FEATURE_VARIABLES |                     \
+                                         EXCEPTIONS_FEATURE_REGIONS | EXCEPTIONS_FEATURE_CONTEXT)
+
+/* The features the C handlers use, from the same defines
+*/
+constexpr uint32_t exceptionsDefaultFeatures()
+{
+    uint32_t features = 0;
+
+#if defined(EXCEPTIONS_FIXUP)
+    features |= EXCEPTIONS_FEATURE_FIXUP;
+#endif
+#if defined(EXCEPTIONS_DMA_QUIESCE)
+    features |= EXCEPTIONS_FEATURE_DMA;
+#endif
+#if defined(EXCEPTIONS_TIMESTAMPS)
+    features |= EXCEPTIONS_FEATURE_TIME;
+#endif
+#if defined(CRASH_RECORD_BUILD_ID)
+    features |= EXCEPTIONS_FEATURE_BUILD_ID;
+#endif
+#if defined(EXCEPTIONS_FPB_PATCHES)
+    features |= EXCEPTIONS_FEATURE_PATCHES;
+#endif
+#if defined(EXCEPTIONS_VARIABLES)
+    features |= EXCEPTIONS_FEATURE_VARIABLES;
+#endif
+#if defined(EXCEPTIONS_REGIONS)
+    features |= EXCEPTIONS_FEATURE_REGIONS;
+#endif
+#if defined(EXCEPTIONS_CONTEXT_PROVIDERS)
+    features |= EXCEPTIONS_FEATURE_CONTEXT;
+#endif
+    return features;
+}
+
+// The C handlers' capture depth.
+#if defined(EXCEPTIONS_RTOS_ADAPTER)
+#define EXCEPTIONS_CAPTURE_DEFAULT      Capture_Tasks
+#else
+#define EXCEPTIONS_CAPTURE_DEFAULT      Capture_Stack
+#endif
+
+/* Output sinks
+ * - print<Policy>(aFrame, eType) runs after the record is committed
+*/
+struct exceptionsSinkNone
+{
+    template<typename Policy>
+    static void print(const CortexExceptionCpuFrameType*, exceptionType)
+    {
+    }
+};
+
+struct exceptionsSinkKernelPrintf
+{
+    template<typename Policy>
+    static void print(const CortexExceptionCpuFrameType* aFrame, exceptionType eType)
+    {
+        exceptionsPrintFault(aFrame, eType);
+#if defined(EXCEPTIONS_RTOS_ADAPTER)
+        if constexpr(Policy::m_Capture >= Capture_Tasks)
+            exceptionsRtosPrint();
+#endif
+    }
+};
+
+// What the C handlers print: everything under __DEBUG_KERNEL__, otherwise nothing.
+#ifdef __DEBUG_KERNEL__
+typedef exceptionsSinkKernelPrintf exceptionsSinkDebugKernel;
+#else
+typedef exceptionsSinkNone exceptionsSinkDebugKernel;
+#endif
+
+/* Persistence backends
+ * - faultPending() runs first, m_CrashRecord says whether records can be written
+*/
+struct exceptionsPersistNone
+{
+    static constexpr bool m_CrashRecord = false;
+
+    static void faultPending()
+    {
+    }
+};
+
+// Crash loop detection only.
+struct exceptionsPersistBootState
+{
+    static constexpr bool m_CrashRecord = false;
+
+    static void faultPending()
+    {
+        exceptionsFaultPending();
+    }
+};
+
+// Crash loop detection and the crash record (crashRecord.h).
+struct exceptionsPersistCrashRecord
+{
+    static constexpr bool m_CrashRecord = true;
+
+    static void faultPending()
+    {
+        exceptionsFaultPending();
+    }
+};
+
+/* Unwinders
+ * - Same contract as exceptionsUnwinderType
+*/
+struct exceptionsUnwindPcOnly
+{
+    static uint32_t unwind(uint32_t pc, uint32_t, uint32_t, uint32_t, uint32_t* aFrames, uint32_t)
+    {
+        aFrames[0] = pc;
+        return 1;
+    }
+};
+
+// Any C unwinder, e.g. exceptionsUnwindWith<unwindStackScan>.
+template<exceptionsUnwinderType unwinder>
+struct exceptionsUnwindWith
+{
+    static uint32_t unwind(uint32_t pc, uint32_t lr, uint32_t sp, uint32_t stackTop, uint32_t* aFrames, uint32_t maxFrames)
+    {
+        return unwinder(pc, lr, sp, stackTop, aFrames, maxFrames);
+    }
+};
+
+typedef exceptionsUnwindWith<unwindStackScan> exceptionsUnwindStackScan;
+typedef exceptionsUnwindWith<EXCEPTIONS_UNWINDER> exceptionsUnwindDefault;
+
+/* Escalation
+ * - escalate(aFrame, aCallee, eType) runs last, returning resumes the interrupted code
+*/
+struct exceptionsEscalateBkpt
+{
+    static void escalate(const CortexExceptionCpuFrameType*, const CortexExceptionCalleeFrameType*, exceptionType)
+    {
+        __asm__("BKPT");
+    }
+};
+
+struct exceptionsEscalateReset
+{
+    static void escalate(const CortexExceptionCpuFrameType*, const CortexExceptionCalleeFrameType*, exceptionType)
+    {
+        NVIC_SystemReset();
+    }
+};
+
+// EXCEPTIONS_RESET_ON_FAULT, a debugger still gets the BKPT.
+struct exceptionsEscalateResetUnlessDebugged
+{
+    static void escalate(const CortexExceptionCpuFrameType*, const CortexExceptionCalleeFrameType*, exceptionType)
+    {
+        if(!(CoreDebug->DHCSR & CoreDebug_DHCSR_C_DEBUGEN_Msk))
+            NVIC_SystemReset();
+        __asm__("BKPT");
+    }
+};
+
+#if defined(EXCEPTIONS_GDB_STUB)
+// EXCEPTIONS_GDB_STUB, a debugger still gets the BKPT.
+struct exceptionsEscalateGdbStub
+{
+    static void escalate(const CortexExceptionCpuFrameType* aFrame, const CortexExceptionCalleeFrameType* aCallee, exceptionType eType)
+    {
+        if(!(CoreDebug->DHCSR & CoreDebug_DHCSR_C_DEBUGEN_Msk))
+        {
+            gdbStubEnter(const_cast<CortexExceptionCpuFrameType*>(aFrame), aCallee, exceptionsGdbSignal(eType));
+            return;
+        }
+        __asm__("BKPT");
+    }
+};
+#endif
+
+// What the C handlers do: the GDB stub, else EXCEPTIONS_RESET_ON_FAULT, else BKPT.
+#if defined(EXCEPTIONS_GDB_STUB)
+typedef exceptionsEscalateGdbStub exceptionsEscalateDefault;
+#elif defined(EXCEPTIONS_RESET_ON_FAULT)
+typedef exceptionsEscalateResetUnlessDebugged exceptionsEscalateDefault;
+#else
+typedef exceptionsEscalateBkpt exceptionsEscalateDefault;
+#endif
+
+/* The policy
+ * - maxFrames and stackBytes only matter at the capture depths that use them
+ * - features are EXCEPTIONS_FEATURE_xxx, the record ones only matter if there is a record
+*/
+template<exceptionsCaptureType capture, typename Sink, typename Persistence, typename Unwinder, typename Escalation,
+         uint32_t maxFrames = EXCEPTIONS_RECORD_MAX_FRAMES, uint32_t stackBytes = EXCEPTIONS_RECORD_STACK_BYTES,
+         uint32_t features = exceptionsDefaultFeatures()>
+struct exceptionsPolicy
+{
+    static constexpr exceptionsCaptureType m_Capture = capture;
+    static constexpr uint32_t m_MaxFrames = maxFrames;
+    static constexpr uint32_t m_StackBytes = stackBytes;
+    static constexpr uint32_t m_Features = features;
+    typedef Sink sinkType;
+    typedef Persistence persistenceType;
+    typedef Unwinder unwinderType;
+    typedef Escalation escalationType;
+
+    static_assert((capture == Capture_None) || Persistence::m_CrashRecord, "capturing needs exceptionsPersistCrashRecord");
+    static_assert((capture < Capture_Backtrace) || (maxFrames != 0), "a backtrace needs at least one frame");
+#if !defined(EXCEPTIONS_RTOS_ADAPTER)
+    static_assert(capture != Capture_Tasks, "Capture_Tasks needs EXCEPTIONS_RTOS_ADAPTER");
+#endif
+#if !defined(CRASH_RECORD_BUILD_ID)
+    static_assert(!(features & EXCEPTIONS_FEATURE_BUILD_ID), "EXCEPTIONS_FEATURE_BUILD_ID needs CRASH_RECORD_BUILD_ID");
+#endif
+    static_assert((capture != Capture_None) || !(features & EXCEPTIONS_FEATURES_RECORD), "record features need a capture depth");
+};
+
+typedef exceptionsPolicy<Capture_None, exceptionsSinkNone, exceptionsPersistBootState, exceptionsUnwindPcOnly,
+                         exceptionsEscalateReset, 1u, 0u, 0u> exceptionsMinimalPolicy;
+
+typedef exceptionsPolicy<EXCEPTIONS_CAPTURE_DEFAULT, exceptionsSinkDebugKernel, exceptionsPersistCrashRecord, exceptionsUnwindDefault,
+                         exceptionsEscalateDefault> exceptionsDiagnosticPolicy;
+
+/* Fault handler for a policy
+ * - Step for step handleFault() in exceptions.c, with captureRecord() and
+ *   exceptionsRecordCapture() inlined: record, task snapshot, print, escalate
+*/
+template<typename Policy>
+struct exceptionsFaultHandler
+{
+    static void handle(const CortexExceptionCpuFrameType* aFrame, const CortexExceptionCalleeFrameType* aCallee, exceptionType eType)
+    {
+        constexpr uint32_t features = Policy::m_Features;
+
+        if constexpr((features & EXCEPTIONS_FEATURE_FIXUP) != 0)
+        {
+            // An accessor from exceptionsFixup.h faulted, resume at its fixup.
+            if(exceptionsFixupApply(const_cast<CortexExceptionCpuFrameType*>(aFrame), eType))
+                return;
+        }
+        if constexpr((features & EXCEPTIONS_FEATURE_CONTEXT) != 0)
+        {
+            // A context provider faulted, return to the handler that called it.
+            if(exceptionsContextAbandon(const_cast<CortexExceptionCpuFrameType*>(aFrame)))
+                return;
+        }
+        Policy::persistenceType::faultPending();
+
+        if constexpr(Policy::m_Capture != Capture_None)
+        {
+            crashRecordType* record = exceptionsRecordBegin(aFrame, aCallee, eType);
+
+            if constexpr((features & EXCEPTIONS_FEATURE_DMA) != 0)
+                exceptionsRecordDma();
+            if constexpr((features & EXCEPTIONS_FEATURE_TIME) != 0)
+                exceptionsRecordTime();
+#if defined(CRASH_RECORD_BUILD_ID)
+            if constexpr((features & EXCEPTIONS_FEATURE_BUILD_ID) != 0)
+                exceptionsRecordBuildId();
+#endif
+            if constexpr((features & EXCEPTIONS_FEATURE_PATCHES) != 0)
+                exceptionsRecordPatches(record);
+            if constexpr(Policy::m_Capture >= Capture_Backtrace)
+            {
+                uint32_t stackTop = exceptionsStackTop(aCallee->m_ExcReturn);
+                uint32_t frames[Policy::m_MaxFrames];
+
+                exceptionsRecordBacktrace(frames, Policy::unwinderType::unwind(record->m_Pc, record->m_Lr, record->m_Sp, stackTop,
+                                                                                frames, Policy::m_MaxFrames));
+                if constexpr(Policy::m_Capture >= Capture_Stack)
+                    exceptionsRecordStack(record->m_Sp, stackTop, Policy::m_StackBytes);
+            }
+            if constexpr((features & EXCEPTIONS_FEATURE_VARIABLES) != 0)
+                exceptionsRecordVariables();
+            if constexpr((features & EXCEPTIONS_FEATURE_REGIONS) != 0)
+                exceptionsRecordRegions();
+            if constexpr((features & EXCEPTIONS_FEATURE_CONTEXT) != 0)
+                exceptionsContextCapture();
+            crashRecordCommit();
+#if defined(EXCEPTIONS_RTOS_ADAPTER)
+            // Snapshot every task before printing disturbs anything.
+            if constexpr(Policy::m_Capture >= Capture_Tasks)
+                exceptionsRtosCapture(aFrame, aCallee->m_ExcReturn);
+#endif
+        }
+
+        Policy::sinkType::template print<Policy>(aFrame, eType);
+        Policy::escalationType::escalate(aFrame, aCallee, eType);
+    }
+};
+
+/* Define the fault handlers for a policy
+ * - Use once, at file scope in a C++ file
+*/
+#define EXCEPTIONS_POLICY_HANDLERS(policy)                                                                          \
+    extern "C" void hardFault(const CortexExceptionCpuFrameType* aFrame, const CortexExceptionCalleeFrameType* aCallee)    \
+    {                                                                                                               \
+        exceptionsFaultHandler<policy>::handle(aFrame, aCallee, Hard_Fault);                                        \
+    }                                                                                                               \
+    extern "C" void memMangFault(const CortexExceptionCpuFrameType* aFrame, const CortexExceptionCalleeFrameType* aCallee) \
+    {                                                                                                               \
+        exceptionsFaultHandler<policy>::handle(aFrame, aCallee, MemMang_Fault);                                     \
+    }                                                                                                               \
+    extern "C" void busFault(const CortexExceptionCpuFrameType* aFrame, const CortexExceptionCalleeFrameType* aCallee)     \
+    {                                                                                                               \
+        exceptionsFaultHandler<policy>::handle(aFrame, aCallee, Bus_Fault);                                         \
+    }                                                                                                               \
+    extern "C" void usageFault(const CortexExceptionCpuFrameType* aFrame, const CortexExceptionCalleeFrameType* aCallee)   \
+    {                                                                                                               \
+        exceptionsFaultHandler<policy>::handle(aFrame, aCallee, Usage_Fault);                                       \
+    }                                                                                                               \
+    extern "C" __attribute__((naked)) void HardFault_Handler(void)                                                 \
+    {                                                                                                               \
+        EXCEPTION_TRAMPOLINE(hardFault);                                                                            \
+    }                                                                                                               \
+    extern "C" __attribute__((naked)) void MemManage_Handler(void)                                                 \
+    {                                                                                                               \
+        EXCEPTION_TRAMPOLINE(memMangFault);                                                                         \
+    }                                                                                                               \
+    extern "C" __attribute__((naked)) void BusFault_Handler(void)                                                  \
+    {                                                                                                               \
+        EXCEPTION_TRAMPOLINE(busFault);                                                                             \
+    }                                                                                                               \
+    extern "C" __attribute__((naked)) void UsageFault_Handler(void)                                                \
+    {                                                                                                               \
+        EXCEPTION_TRAMPOLINE(usageFault);                                                                           \
+    }
+
+#endif /* EXCEPTIONS_POLICY_HPP_ */
@@ -0,0 +1,123 @@
+/*
+ * exceptionsRegions.c
+ *
+ *  Created on: 18 Oct 2026
+ *
+ *  Application memory regions in the crash record
+ *  - The table is kept sorted by priority as regions are registered, equal priorities in
+ *    registration order, so the fault path just walks it
+ *  - A region that doesn't fit in what's left of the budget is truncated, once the budget
+ *    or the record is used up the rest are skipped
+ */
+#include <stdint.h>
+
+#include "crashRecord.h"
+#include "exceptionsRegions.h"
+#include "exceptionsUnwind.h"
+
+typedef struct
+{
+    const volatile uint8_t* m_Start;
+    const volatile uint32_t* m_Length;  // Current length, 0 to always take m_MaxBytes.
+    uint32_t m_MaxBytes;
+    uint8_t m_Priority;
+} regionType;
+
+static regionType regions[EXCEPTIONS_REGIONS_MAX];
+static volatile uint32_t regionCount;
+
+/* Add a region
+ * - priority 0 is captured first
+ * - aLength, if not 0, holds how much of the region is in use and is read at fault time
+ * - Returns 0, or -1 if the table is full or the region isn't in RAM
+ * - Register from start up code, not from several tasks at once
+*/
+int exceptionsRegionRegister(const volatile void* aStart, uint32_t maxBytes, uint8_t priority, const volatile uint32_t* aLength)
+{
+    uint32_t i;
+
+    if((regionCount == EXCEPTIONS_REGIONS_MAX) || (maxBytes == 0) || !unwindIsRamRange((uint32_t)aStart, maxBytes) ||
+       ((aLength != 0) && !unwindIsRamRange((uint32_t)aLength, sizeof(uint32_t))))
+        return -1;
+
+    // Insert after every region of the same or a higher priority.
+    for(i = regionCount; (i > 0) && (regions[i - 1].m_Priority > priority); i--)
+        regions[i] = regions[i - 1];
+    regions[i].m_Start = (const volatile uint8_t*)aStart;
+    regions[i].m_Length = aLength;
+    regions[i].m_MaxBytes = maxBytes;
+    regions[i].m_Priority = priority;
+    regionCount++;
+    return 0;
+}
+
+/* Copy the regions into the crash record
+ * - Between crashRecordBegin() and crashRecordCommit()
+*/
+void exceptionsRecordRegions(void)
+{
+    crashRecordRegionStatusType* status;
+    uint32_t count = regionCount;
+    uint32_t budget = EXCEPTIONS_REGIONS_BUDGET;
+    uint32_t i;
+
+    if(count == 0)
+        return;
+    status = crashRecordAddTlv(CRASH_RECORD_TAG_REGIONS, (uint16_t)(count * sizeof(crashRecordRegionStatusType)));
+
+    for(i = 0; i < count; i++)
+    {
+        const regionType* region = &regions[i];
+        uint32_t length = region->m_MaxBytes;
+        uint32_t captured = 0;
+        uint32_t result = CRASH_RECORD_REGION_COMPLETE;
+
+        if(region->m_Length != 0)
+            length = *region->m_Length;
+
+        if(length > region->m_MaxBytes)
+        {
+            result = CRASH_RECORD_REGION_INVALID;
+        }
+        else if(length != 0)
+        {
+            uint32_t* dest = 0;
+            uint32_t room = CRASH_RECORD_SIZE - CRASH_RECORD->m_Size;
+
+            // What the record still holds after the TLV header and the address, in whole words.
+            room = (room > (sizeof(crashRecordTlvType) + 4u)) ? ((room - sizeof(crashRecordTlvType) - 4u) & ~3u) : 0;
+            captured = (length < budget) ? length : budget;
+            if(captured > room)
+                captured = room;
+            if(captured != 0)
+                dest = crashRecordAddTlv(CRASH_RECORD_TAG_MEMORY, (uint16_t)(captured + 4u));
+            if(dest == 0)
+            {
+                captured = 0;
+                result = CRASH_RECORD_REGION_SKIPPED;
+            }
+            else
+            {
+                uint8_t* bytes = (uint8_t*)(dest + 1);
+                uint32_t j;
+
+                dest[0] = (uint32_t)region->m_Start;
+                for(j = 0; j < captured; j++)
+                    bytes[j] = region->m_Start[j];
+                budget -= captured;
+                if(captured < length)
+                    result = CRASH_RECORD_REGION_TRUNCATED;
+            }
+        }
+
+        if(status)
+        {
+            status[i].m_Address = (uint32_t)region->m_Start;
+            status[i].m_Length = length;
+            status[i].m_Captured = captured;
+            status[i].m_Priority = region->m_Priority;
+            status[i].m_Status = (uint8_t)result;
+            status[i].m_Reserved = 0;
+        }
+    }
+}
@@ -0,0 +1,32 @@
+/*
+ * exceptionsRegions.h
+ *
+ *  Created on: 18 Oct 2026
+ *
+ *  Application memory regions in the crash record
+ *  - Register buffers worth having after a crash (the packet buffer, scheduler state, the
+ *    last command) with a priority and a maximum size
+ *  - The fault path copies them in priority order, 0 first, into CRASH_RECORD_TAG_MEMORY
+ *    TLVs until EXCEPTIONS_REGIONS_BUDGET bytes are used, so the record size and the time
+ *    spent stay bounded; CRASH_RECORD_TAG_REGIONS says what was truncated or skipped
+ */
+
+#ifndef EXCEPTIONS_REGIONS_H_
+#define EXCEPTIONS_REGIONS_H_
+
+#include <stdint.h>
+
+#ifndef EXCEPTIONS_REGIONS_MAX
+#define EXCEPTIONS_REGIONS_MAX          8u
+#endif
+// Bytes of region data per record, TLV headers and addresses not included.
+#ifndef EXCEPTIONS_REGIONS_BUDGET
+#define EXCEPTIONS_REGIONS_BUDGET       1024u
+#endif
+
+int exceptionsRegionRegister(const volatile void* aStart, uint32_t maxBytes, uint8_t priority, const volatile uint32_t* aLength);
+
+// Fault path.
+void exceptionsRecordRegions(void);
+
+#endif /* EXCEPTIONS_REGIONS_H_ */
@@ -0,0 +1,149 @@
+/*
+ * exceptionsRtos.c
+ *
+ *  Created on: 18 Oct 2026
+ *
+ *  RTOS aware all-thread snapshot
+ *  - The adapter walks the kernel's task list, this file adds the watermark and backtraces
+ *  - Deadlocks and priority inversions only show when every thread is seen together
+ */
+#include <stdint.h>
+
+#include "exceptions.h"
+#include "exceptionsRtos.h"
+#include "exceptionsUnwind.h"
+#include "kernelPrintf.h"
+
+#if defined(EXCEPTIONS_RTOS_ADAPTER)
+
+#if defined(STM32F413xx)
+#include "stm32f413xx.h"
+#else
+#error *** ERROR - Cortex M4 Vectors CPU type not defined.
+#endif
+
+#define EXC_RETURN_BASIC_FRAME      (1u<<4)     // Clear if the frame includes FP state.
+
+#define BASIC_FRAME_WORDS           8u          // Size of the hardware stacked frame.
+
+exceptionsRtosSnapshotType exceptionsRtosSnapshot;
+
+static const char* const taskStateNames[] =
+{
+    "Running", "Ready", "Blocked", "Suspended", "Deleted", "Unknown"
+};
+
+void exceptionsRtosCopyName(char* aDest, const char* aName)
+{
+    uint32_t i = 0;
+
+    // Names may live in flash or RAM, anything else is left blank.
+    if(unwindIsCodeAddress((uint32_t)aName) || unwindIsRamRange((uint32_t)aName, EXCEPTIONS_RTOS_NAME_LENGTH))
+    {
+        for(; (i < (EXCEPTIONS_RTOS_NAME_LENGTH - 1)) && aName[i]; i++)
+            aDest[i] = aName[i];
+    }
+    aDest[i] = '\0';
+}
+
+/* Measure the stack watermark
+ * - Counts the fill pattern words up from the bottom of a descending stack
+*/
+uint32_t exceptionsRtosStackUnused(uint32_t low, uint32_t high, uint32_t fill)
+{
+    uint32_t count = 0;
+
+    if((low & 3u) || (high <= low) || !unwindIsRamRange(low, high - low))
+        return EXCEPTION_HANDLER_FIELD_IS_INVALID;
+
+    while((low < high) && (count < EXCEPTIONS_RTOS_MAX_FILL_SCAN) && (*(const uint32_t*)low == fill))
+    {
+        low += 4u;
+        count++;
+    }
+
+    return count * 4u;
+}
+
+/* Locate the hardware frame on a switched out task's stack
+ * - contextWords is the number of words the port saves below it, excluding s16-s31
+*/
+uint32_t exceptionsRtosFrameAddress(uint32_t sp, uint32_t excReturn, uint32_t contextWords)
+{
+    if(!(excReturn & EXC_RETURN_BASIC_FRAME))
+        contextWords += 16u;    // s16-s31.
+
+    sp += contextWords * 4u;
+    if((sp & 3u) || !unwindIsRamRange(sp, BASIC_FRAME_WORDS * 4u))
+        return 0;
+
+    return sp;
+}
+
+/* Take the snapshot
+ * - aFrame is the fault frame, used for the running task when the fault came from thread mode
+*/
+void exceptionsRtosCapture(const CortexExceptionCpuFrameType* aFrame, uint32_t excReturn)
+{
+    uint32_t i;
+    uint32_t found = EXCEPTIONS_RTOS_ADAPTER.m_GetTasks(exceptionsRtosSnapshot.m_Tasks, EXCEPTIONS_RTOS_MAX_TASKS);
+    uint32_t count = (found > EXCEPTIONS_RTOS_MAX_TASKS) ? EXCEPTIONS_RTOS_MAX_TASKS : found;
+
+    exceptionsRtosSnapshot.m_TaskCount = count;
+    exceptionsRtosSnapshot.m_Dropped = found - count;
+
+    for(i = 0; i < count; i++)
+    {
+        exceptionsRtosTaskType* task = &exceptionsRtosSnapshot.m_Tasks[i];
+        const CortexExceptionCpuFrameType* frame = (const CortexExceptionCpuFrameType*)task->m_Frame;
+        uint32_t sp;
+
+        // The running task's saved context is stale, the fault frame is the real one.
+        if(task->m_State == Task_Running)
+        {
+            if((uint32_t)aFrame == __get_PSP())
+            {
+                frame = aFrame;
+                task->m_Frame = (uint32_t)aFrame;
+                task->m_ExcReturn = excReturn;
+            }
+            else
+            {
+                frame = 0;
+                task->m_Frame = 0;
+            }
+            task->m_Psp = __get_PSP();
+        }
+
+        task->m_FrameCount = 0;
+        if(frame == 0)
+            continue;
+
+        sp = unwindFrameSp((uint32_t)frame, task->m_ExcReturn, frame->m_PSR);
+        task->m_FrameCount = EXCEPTIONS_UNWINDER(frame->m_PC, frame->m_LR, sp, task->m_StackHigh,
+                                                 task->m_Frames, EXCEPTIONS_RTOS_MAX_FRAMES);
+    }
+}
+
+void exceptionsRtosPrint(void)
+{
+    uint32_t i;
+    uint32_t j;
+
+    KernelPrintf("**** %s TASKS (%u) ****\r\n", EXCEPTIONS_RTOS_ADAPTER.m_Name, exceptionsRtosSnapshot.m_TaskCount);
+    if(exceptionsRtosSnapshot.m_Dropped != 0)
+        KernelPrintf("%u more tasks not captured, raise EXCEPTIONS_RTOS_MAX_TASKS\r\n", exceptionsRtosSnapshot.m_Dropped);
+
+    for(i = 0; i < exceptionsRtosSnapshot.m_TaskCount; i++)
+    {
+        const exceptionsRtosTaskType* task = &exceptionsRtosSnapshot.m_Tasks[i];
+
+        KernelPrintf("%s: %s PSP=%x Stack=%x-%x Unused=%x\r\n", task->m_Name,
+                     taskStateNames[(task->m_State <= Task_Unknown) ? task->m_State : Task_Unknown],
+                     task->m_Psp, task->m_StackLow, task->m_StackHigh, task->m_Unused);
+        for(j = 0; j < task->m_FrameCount; j++)
+            KernelPrintf("  #%u %x\r\n", j, task->m_Frames[j]);
+    }
+}
+
+#endif // EXCEPTIONS_RTOS_ADAPTER
@@ -0,0 +1,91 @@
+/*
+ * exceptionsRtos.h
+ *
+ *  Created on: 18 Oct 2026
+ *
+ *  RTOS aware all-thread snapshot taken from the fault handlers
+ *  - Define EXCEPTIONS_RTOS_ADAPTER as the adapter to use, e.g. exceptionsRtosFreeRtos
+ *  - Every walk is bounded by EXCEPTIONS_RTOS_MAX_WALK, so corrupt kernel lists can't hang the handler
+ *  - Tasks past EXCEPTIONS_RTOS_MAX_TASKS are counted in m_Dropped, the snapshot is only complete if it is 0
+ */
+
+#ifndef EXCEPTIONS_RTOS_H_
+#define EXCEPTIONS_RTOS_H_
+
+#ifndef EXCEPTIONS_RTOS_MAX_TASKS
+#define EXCEPTIONS_RTOS_MAX_TASKS       16
+#endif
+// Links followed per kernel list, tasks past EXCEPTIONS_RTOS_MAX_TASKS are only counted.
+#ifndef EXCEPTIONS_RTOS_MAX_WALK
+#define EXCEPTIONS_RTOS_MAX_WALK        (4 * EXCEPTIONS_RTOS_MAX_TASKS)
+#endif
+#ifndef EXCEPTIONS_RTOS_MAX_FRAMES
+#define EXCEPTIONS_RTOS_MAX_FRAMES      6
+#endif
+#ifndef EXCEPTIONS_RTOS_NAME_LENGTH
+#define EXCEPTIONS_RTOS_NAME_LENGTH     12
+#endif
+// Maximum number of stack words checked when measuring the watermark.
+#ifndef EXCEPTIONS_RTOS_MAX_FILL_SCAN
+#define EXCEPTIONS_RTOS_MAX_FILL_SCAN   1024
+#endif
+
+typedef enum
+{
+    Task_Running,
+    Task_Ready,
+    Task_Blocked,
+    Task_Suspended,
+    Task_Deleted,
+    Task_Unknown
+} exceptionsTaskStateType;
+
+typedef struct
+{
+    char     m_Name[EXCEPTIONS_RTOS_NAME_LENGTH];   // Task name, truncated and always terminated.
+    uint32_t m_State;                               // exceptionsTaskStateType.
+    uint32_t m_Psp;                                 // Saved process stack pointer.
+    uint32_t m_StackLow;                            // Lowest address of the task stack.
+    uint32_t m_StackHigh;                           // One past the highest address of the task stack.
+    uint32_t m_Unused;                              // Stack bytes never touched (watermark).
+    uint32_t m_Frame;                               // Address of the saved exception frame, 0 if none.
+    uint32_t m_ExcReturn;                           // EXC_RETURN the task will be resumed with.
+    uint32_t m_FrameCount;                          // Number of valid entries in m_Frames.
+    uint32_t m_Frames[EXCEPTIONS_RTOS_MAX_FRAMES];  // Backtrace, m_Frames[0] is the PC.
+} exceptionsRtosTaskType;
+
+typedef struct
+{
+    uint32_t m_TaskCount;
+    uint32_t m_Dropped;                             // Tasks found that didn't fit in m_Tasks.
+    exceptionsRtosTaskType m_Tasks[EXCEPTIONS_RTOS_MAX_TASKS];
+} exceptionsRtosSnapshotType;
+
+// RTOS adapter
+// - m_GetTasks fills in everything but the backtrace for at most maxTasks tasks and returns how many
+//   it found, which is more than maxTasks if some didn't fit.
+// - It must validate each kernel object with unwindIsRamRange() before reading it.
+typedef struct
+{
+    const char* m_Name;
+    uint32_t (*m_GetTasks)(exceptionsRtosTaskType* aTasks, uint32_t maxTasks);
+} exceptionsRtosAdapterType;
+
+extern const exceptionsRtosAdapterType exceptionsRtosFreeRtos;
+extern const exceptionsRtosAdapterType exceptionsRtosCmsis;
+
+extern exceptionsRtosSnapshotType exceptionsRtosSnapshot;
+
+void exceptionsRtosCapture(const CortexExceptionCpuFrameType* aFrame, uint32_t excReturn);
+void exceptionsRtosPrint(void);
+
+// FreeRTOS trace hooks, see exceptionsRtosFreeRtos.c.
+void exceptionsRtosTaskCreated(void* aTcb);
+void exceptionsRtosTaskDeleted(void* aTcb);
+
+// Helpers for adapters.
+void exceptionsRtosCopyName(char* aDest, const char* aName);
+uint32_t exceptionsRtosStackUnused(uint32_t low, uint32_t high, uint32_t fill);
+uint32_t exceptionsRtosFrameAddress(uint32_t sp, uint32_t excReturn, uint32_t contextWords);
+
+#endif /* EXCEPTIONS_RTOS_H_ */
@@ -0,0 +1,93 @@
+/*
+ * exceptionsRtosCmsis.c
+ *
+ *  Created on: 18 Oct 2026
+ *
+ *  CMSIS-RTOS2 adapter for the fault time task snapshot
+ *  - The osThread* API can't be called from handler mode, so this reads the Keil RTX5 kernel directly
+ *  - Every thread is either running, on the ready list, or on the delay or wait list
+ */
+#include <stdint.h>
+
+#include "rtx_os.h"
+
+#include "exceptions.h"
+#include "exceptionsRtos.h"
+#include "exceptionsUnwind.h"
+
+#define RTX_CONTEXT_WORDS           8u      // r4-r11.
+#define RTX_STACK_MAGIC_WORDS       1u      // osRtxStackMagicWord at the bottom of each stack.
+
+static uint32_t rtxState(uint8_t state)
+{
+    switch(state & osRtxThreadStateMask)
+    {
+        case osRtxThreadRunning:    return Task_Running;
+        case osRtxThreadReady:      return Task_Ready;
+        case osRtxThreadBlocked:    return Task_Blocked;
+        case osRtxThreadTerminated: return Task_Deleted;
+        default:                    return Task_Unknown;
+    }
+}
+
+static int rtxIsThread(const osRtxThread_t* aThread)
+{
+    return unwindIsRamRange((uint32_t)aThread, sizeof(osRtxThread_t)) && (aThread->id == osRtxIdThread);
+}
+
+static void rtxFillTask(exceptionsRtosTaskType* aTask, const osRtxThread_t* aThread)
+{
+    exceptionsRtosCopyName(aTask->m_Name, aThread->name);
+    aTask->m_State = rtxState(aThread->state);
+    aTask->m_Psp = aThread->sp;
+    aTask->m_StackLow = (uint32_t)aThread->stack_mem;
+    aTask->m_StackHigh = (uint32_t)aThread->stack_mem + aThread->stack_size;
+    aTask->m_Unused = exceptionsRtosStackUnused(aTask->m_StackLow + (RTX_STACK_MAGIC_WORDS * 4u),
+                                                aThread->sp, osRtxStackFillPattern);
+    aTask->m_ExcReturn = 0xFFFFFF00u | aThread->stack_frame;
+    aTask->m_Frame = exceptionsRtosFrameAddress(aThread->sp, aTask->m_ExcReturn, RTX_CONTEXT_WORDS);
+}
+
+/* Walk one RTX thread list
+ * - Fills in the first threads from aTasks[count] on, up to maxTasks, the rest are only counted
+ * - Follows at most EXCEPTIONS_RTOS_MAX_WALK links, so a corrupt or circular list still terminates
+ * - Returns the new count
+*/
+static uint32_t rtxWalk(const osRtxThread_t* aThread, int useDelayLink, exceptionsRtosTaskType* aTasks, uint32_t count, uint32_t maxTasks)
+{
+    uint32_t links;
+
+    for(links = 0; (links < EXCEPTIONS_RTOS_MAX_WALK) && rtxIsThread(aThread); links++)
+    {
+        if(count < maxTasks)
+            rtxFillTask(&aTasks[count], aThread);
+        count++;
+        aThread = useDelayLink ? aThread->delay_next : aThread->thread_next;
+    }
+
+    return count;
+}
+
+static uint32_t rtxGetTasks(exceptionsRtosTaskType* aTasks, uint32_t maxTasks)
+{
+    uint32_t count = 0;
+
+    if(rtxIsThread(osRtxInfo.thread.run.curr))
+    {
+        if(maxTasks > 0)
+            rtxFillTask(&aTasks[0], osRtxInfo.thread.run.curr);
+        count++;
+    }
+
+    count = rtxWalk(osRtxInfo.thread.ready.thread_list, 0, aTasks, count, maxTasks);
+    count = rtxWalk(osRtxInfo.thread.delay_list, 1, aTasks, count, maxTasks);
+    count = rtxWalk(osRtxInfo.thread.wait_list, 1, aTasks, count, maxTasks);
+
+    return count;
+}
+
+const exceptionsRtosAdapterType exceptionsRtosCmsis =
+{
+    "CMSIS-RTOS2",
+    rtxGetTasks
+};
@@ -0,0 +1,133 @@
+/*
+ * exceptionsRtosFreeRtos.c
+ *
+ *  Created on: 18 Oct 2026
+ *
+ *  FreeRTOS adapter for the fault time task snapshot
+ *  - FreeRTOS keeps its task lists private, so tasks are registered from the trace hooks:
+ *      #define traceTASK_CREATE(pxNewTCB)          exceptionsRtosTaskCreated(pxNewTCB)
+ *      #define traceTASK_DELETE(pxTaskToDelete)    exceptionsRtosTaskDeleted(pxTaskToDelete)
+ *  - TCB fields are read through StaticTask_t, FreeRTOS's public mirror of the TCB layout
+ *  - Task states come from freertos_tasks_c_additions.h, define
+ *    configINCLUDE_FREERTOS_TASK_C_ADDITIONS_H as 1 in FreeRTOSConfig.h; no kernel API is
+ *    called, they all take critical sections that can't be used from a fault handler
+ *  - Define configRECORD_STACK_HIGH_ADDRESS as 1 to get the top of each stack
+ */
+#include <stdint.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+#include "exceptions.h"
+#include "exceptionsRtos.h"
+#include "exceptionsUnwind.h"
+
+#define FREERTOS_STACK_FILL         0xA5A5A5A5u     // tskSTACK_FILL_BYTE repeated.
+
+// Words saved by the port below the hardware frame, excluding s16-s31.
+#if !defined(EXCEPTIONS_RTOS_FREERTOS_CM4F)
+#if (__FPU_PRESENT == 1) && (__FPU_USED == 1)
+#define EXCEPTIONS_RTOS_FREERTOS_CM4F   1
+#else
+#define EXCEPTIONS_RTOS_FREERTOS_CM4F   0
+#endif
+#endif
+#if EXCEPTIONS_RTOS_FREERTOS_CM4F
+#define FREERTOS_CONTEXT_WORDS      9u      // r4-r11, EXC_RETURN.
+#else
+#define FREERTOS_CONTEXT_WORDS      8u      // r4-r11.
+#endif
+
+static TaskHandle_t registeredTasks[EXCEPTIONS_RTOS_MAX_TASKS];
+static uint32_t unregisteredTasks;      // Created while the table was full.
+
+// In freertos_tasks_c_additions.h, compiled as part of tasks.c.
+uint32_t exceptionsRtosFreeRtosState(const void* aTcb);
+
+void exceptionsRtosTaskCreated(void* aTcb)
+{
+    uint32_t i;
+
+    for(i = 0; i < EXCEPTIONS_RTOS_MAX_TASKS; i++)
+    {
+        if(registeredTasks[i] == NULL)
+        {
+            registeredTasks[i] = (TaskHandle_t)aTcb;
+            return;
+        }
+    }
+    unregisteredTasks++;
+}
+
+void exceptionsRtosTaskDeleted(void* aTcb)
+{
+    uint32_t i;
+
+    for(i = 0; i < EXCEPTIONS_RTOS_MAX_TASKS; i++)
+    {
+        if(registeredTasks[i] == (TaskHandle_t)aTcb)
+        {
+            registeredTasks[i] = NULL;
+            return;
+        }
+    }
+    // Not in the table, so it was one of those that didn't fit.
+    if(unregisteredTasks != 0)
+        unregisteredTasks--;
+}
+
+/* Fill in the task details
+ * - The state compares the TCB's list pointers with the kernel's lists, nothing is walked
+ * - Tasks created while the table was full count towards the total, with no details
+*/
+static uint32_t freeRtosGetTasks(exceptionsRtosTaskType* aTasks, uint32_t maxTasks)
+{
+    uint32_t i;
+    uint32_t count = 0;
+
+    for(i = 0; i < EXCEPTIONS_RTOS_MAX_TASKS; i++)
+    {
+        const StaticTask_t* tcb = (const StaticTask_t*)registeredTasks[i];
+        exceptionsRtosTaskType* task = &aTasks[count];
+
+        if((tcb == NULL) || !unwindIsRamRange((uint32_t)tcb, sizeof(StaticTask_t)))
+            continue;
+        if(count >= maxTasks)
+        {
+            count++;
+            continue;
+        }
+
+        exceptionsRtosCopyName(task->m_Name, (const char*)tcb->ucDummy7);
+        task->m_State = exceptionsRtosFreeRtosState(tcb);
+        task->m_Psp = (uint32_t)tcb->pxDummy1;
+        task->m_StackLow = (uint32_t)tcb->pxDummy6;
+#if (configRECORD_STACK_HIGH_ADDRESS == 1)
+        task->m_StackHigh = (uint32_t)tcb->pxDummy8 + sizeof(StackType_t);
+#else
+        task->m_StackHigh = EXCEPTIONS_RAM_END;
+#endif
+        task->m_Unused = exceptionsRtosStackUnused(task->m_StackLow, task->m_Psp, FREERTOS_STACK_FILL);
+
+        task->m_Frame = 0;
+        task->m_ExcReturn = EXCEPTION_HANDLER_FIELD_IS_INVALID;
+        if(unwindIsRamRange(task->m_Psp, FREERTOS_CONTEXT_WORDS * 4u))
+        {
+#if EXCEPTIONS_RTOS_FREERTOS_CM4F
+            task->m_ExcReturn = ((const uint32_t*)task->m_Psp)[8];
+#else
+            task->m_ExcReturn = 0xFFFFFFFDu;
+#endif
+            task->m_Frame = exceptionsRtosFrameAddress(task->m_Psp, task->m_ExcReturn, FREERTOS_CONTEXT_WORDS);
+        }
+        count++;
+    }
+
+    return count + unregisteredTasks;
+}
+
+const exceptionsRtosAdapterType exceptionsRtosFreeRtos =
+{
+    "FreeRTOS",
+    freeRtosGetTasks
+};
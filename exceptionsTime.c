@@ -0,0 +1,96 @@
+/*
+ * exceptionsTime.c
+ *
+ *  Created on: 18 Oct 2026
+ *
+ *  Crash record timestamps
+ *  - Uptime is the extended cycle count over SystemCoreClock, right as long as the core clock
+ *    isn't changed after exceptionsTimeInit(); CYCCNT doesn't count while the core is halted
+ *    by a debugger
+ *  - The RTC shadow registers are read as they are, SSR then TR then DR so they're consistent,
+ *    exceptionsRtcSeconds() has already waited for them to synchronise after reset
+ *  - host/crashTime.c turns the TLV into wall clock time
+ */
+#include <stdint.h>
+
+#include "crashRecord.h"
+#include "exceptions.h"
+#include "exceptionsTime.h"
+
+#if defined(STM32F413xx)
+#include "stm32f413xx.h"
+#else
+#error *** ERROR - Cortex M4 Vectors CPU type not defined.
+#endif
+
+static uint32_t cyclesHigh;
+static uint32_t cyclesLast;     // CYCCNT at the last read, a smaller value means it wrapped.
+
+/* Start the cycle count from zero
+ * - Call at the start of main, before anything else uses the DWT cycle counter
+*/
+void exceptionsTimeInit(void)
+{
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CYCCNT = 0;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+    cyclesHigh = 0;
+    cyclesLast = 0;
+}
+
+/* Keep the overflow count up to date
+ * - Call periodically, e.g. from SysTick_Handler
+*/
+void exceptionsTimeTick(void)
+{
+    (void)exceptionsTimeCycles();
+}
+
+/* Cycles since exceptionsTimeInit()
+*/
+uint64_t exceptionsTimeCycles(void)
+{
+    uint32_t primask = __get_PRIMASK();
+    uint32_t low;
+    uint32_t high;
+
+    __disable_irq();
+    low = DWT->CYCCNT;
+    if(low < cyclesLast)
+        cyclesHigh++;
+    cyclesLast = low;
+    high = cyclesHigh;
+    __set_PRIMASK(primask);
+
+    return ((uint64_t)high << 32) | low;
+}
+
+/* Add the time TLV
+ * - Between crashRecordBegin() and crashRecordCommit()
+*/
+void exceptionsRecordTime(void)
+{
+    uint64_t cycles = exceptionsTimeCycles();
+    crashRecordTimeType* time = crashRecordAddTlv(CRASH_RECORD_TAG_TIME, sizeof(crashRecordTimeType));
+
+    if(time == 0)
+        return;
+
+    time->m_CyclesLow = (uint32_t)cycles;
+    time->m_CyclesHigh = (uint32_t)(cycles >> 32);
+    time->m_CoreClock = (DWT->CTRL & DWT_CTRL_CYCCNTENA_Msk) ? SystemCoreClock : 0u;
+    if((RCC->BDCR & RCC_BDCR_RTCEN) && (RTC->ISR & RTC_ISR_INITS))
+    {
+        time->m_RtcSubSeconds = RTC->SSR;   // Locks TR and DR until DR is read.
+        time->m_RtcTime = RTC->TR;
+        time->m_RtcDate = RTC->DR;
+        time->m_RtcPrediv = RTC->PRER;
+    }
+    else
+    {
+        time->m_RtcSubSeconds = 0;
+        time->m_RtcTime = 0;
+        time->m_RtcDate = 0;
+        time->m_RtcPrediv = 0;
+    }
+}
@@ -0,0 +1,25 @@
+/*
+ * exceptionsTime.h
+ *
+ *  Created on: 18 Oct 2026
+ *
+ *  Crash record timestamps
+ *  - Each record gets a CRASH_RECORD_TAG_TIME TLV: the RTC date and time registers and a
+ *    64 bit cycle count since boot, raw so the handler only spends a few loads on it
+ *  - The cycle count extends DWT CYCCNT by counting its overflows, exceptionsTimeTick()
+ *    has to run at least once per wrap (2^32 / SystemCoreClock, 42s at 100MHz)
+ */
+
+#ifndef EXCEPTIONS_TIME_H_
+#define EXCEPTIONS_TIME_H_
+
+#include <stdint.h>
+
+void exceptionsTimeInit(void);
+void exceptionsTimeTick(void);
+uint64_t exceptionsTimeCycles(void);
+
+// Fault path.
+void exceptionsRecordTime(void);
+
+#endif /* EXCEPTIONS_TIME_H_ */
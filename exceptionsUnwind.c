@@ -0,0 +1,110 @@
+/*
+ * exceptionsUnwind.c
+ *
+ *  Created on: 18 Oct 2026
+ *
+ *  Heuristic stack scanning unwinder
+ *  - Works without unwind tables or frame pointers, so suits optimised builds
+ *  - A stack word is taken as a return address if it points into code just after a BL or BLX
+ *  - Only memory inside the configured code and RAM regions is ever read
+ */
+#include <stdint.h>
+
+#include "exceptionsUnwind.h"
+
+// Thumb call instruction encodings.
+#define THUMB_BL_HW1_MASK       0xF800u     // BL, first halfword.
+#define THUMB_BL_HW1            0xF000u
+#define THUMB_BL_HW2_MASK       0xD000u     // BL, second halfword.
+#define THUMB_BL_HW2            0xD000u
+#define THUMB_BLX_REG_MASK      0xFF87u     // BLX <Rm>.
+#define THUMB_BLX_REG           0x4780u
+
+#define EXC_RETURN_BASIC_FRAME  (1u<<4)     // Clear if the frame includes FP state.
+#define PSR_STACK_ALIGNED       (1u<<9)     // Set if a padding word was inserted on stacking.
+
+// Size of the hardware stacked frame.
+#define BASIC_FRAME_BYTES       0x20u
+#define EXTENDED_FRAME_BYTES    0x68u
+
+int unwindIsCodeAddress(uint32_t address)
+{
+    return (address >= EXCEPTIONS_CODE_START) && (address < EXCEPTIONS_CODE_END);
+}
+
+int unwindIsRamRange(uint32_t address, uint32_t length)
+{
+    return (address >= EXCEPTIONS_RAM_START) && (address <= EXCEPTIONS_RAM_END) &&
+           (length <= (EXCEPTIONS_RAM_END - address));
+}
+
+/* Check for a plausible return address
+ * - Must have the Thumb bit set and follow a BL or BLX instruction in code
+*/
+int unwindIsReturnAddress(uint32_t address)
+{
+    uint32_t next = address & ~1u;
+
+    if(!(address & 1u) || (next < (EXCEPTIONS_CODE_START + 4u)) || !unwindIsCodeAddress(next - 1u))
+        return 0;
+
+    // BLX <Rm> is a 16 bit instruction.
+    if((*(const uint16_t*)(next - 2u) & THUMB_BLX_REG_MASK) == THUMB_BLX_REG)
+        return 1;
+
+    // BL is a 32 bit instruction.
+    return ((*(const uint16_t*)(next - 4u) & THUMB_BL_HW1_MASK) == THUMB_BL_HW1) &&
+           ((*(const uint16_t*)(next - 2u) & THUMB_BL_HW2_MASK) == THUMB_BL_HW2);
+}
+
+/* SP of the interrupted context
+ * - Undoes the hardware stacking, including FP state and alignment padding
+*/
+uint32_t unwindFrameSp(uint32_t frameAddress, uint32_t excReturn, uint32_t psr)
+{
+    uint32_t sp = frameAddress + ((excReturn & EXC_RETURN_BASIC_FRAME) ? BASIC_FRAME_BYTES : EXTENDED_FRAME_BYTES);
+
+    if(psr & PSR_STACK_ALIGNED)
+        sp += 4u;
+    return sp;
+}
+
+/* Stack scanning unwinder
+ * - aFrames[0] is always the PC, even if invalid, as that is often the clue
+ * - Scans at most EXCEPTIONS_UNWIND_MAX_SCAN words upward from sp, stopping at stackTop
+*/
+uint32_t unwindStackScan(uint32_t pc, uint32_t lr, uint32_t sp, uint32_t stackTop,
+                         uint32_t* aFrames, uint32_t maxFrames)
+{
+    uint32_t count = 0;
+    uint32_t scanEnd;
+
+    if(maxFrames == 0)
+        return 0;
+
+    aFrames[count++] = pc;
+
+    // LR holds the caller when the fault is in a leaf function.
+    if((count < maxFrames) && unwindIsReturnAddress(lr))
+        aFrames[count++] = lr & ~1u;
+
+    if((sp & 3u) || !unwindIsRamRange(sp, 0))
+        return count;
+
+    scanEnd = sp + (EXCEPTIONS_UNWIND_MAX_SCAN * 4u);
+    if(scanEnd > EXCEPTIONS_RAM_END)
+        scanEnd = EXCEPTIONS_RAM_END;
+    if(scanEnd > stackTop)
+        scanEnd = stackTop;
+
+    for(; (sp < scanEnd) && (count < maxFrames); sp += 4u)
+    {
+        uint32_t candidate = *(const uint32_t*)sp;
+
+        // Skip the saved copy of a return address we already have.
+        if(unwindIsReturnAddress(candidate) && ((candidate & ~1u) != aFrames[count - 1]))
+            aFrames[count++] = candidate & ~1u;
+    }
+
+    return count;
+}
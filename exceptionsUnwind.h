@@ -0,0 +1,59 @@
+/*
+ * exceptionsUnwind.h
+ *
+ *  Created on: 18 Oct 2026
+ *
+ *  Bounded backtrace support for the exception handlers
+ *  - The fault path and the RTOS snapshot both go through EXCEPTIONS_UNWINDER
+ */
+
+#ifndef EXCEPTIONS_UNWIND_H_
+#define EXCEPTIONS_UNWIND_H_
+
+// Code region, return addresses must fall inside this to be accepted.
+#ifndef EXCEPTIONS_CODE_START
+#define EXCEPTIONS_CODE_START       0x08000000u
+#endif
+#ifndef EXCEPTIONS_CODE_END
+extern uint32_t _etext;             // End of .text, provided by the linker script.
+#define EXCEPTIONS_CODE_END         ((uint32_t)&_etext)
+#endif
+
+// RAM region, stacks and RTOS structures must fall inside this to be read.
+#ifndef EXCEPTIONS_RAM_START
+#define EXCEPTIONS_RAM_START        0x20000000u
+#endif
+#ifndef EXCEPTIONS_RAM_END
+#define EXCEPTIONS_RAM_END          0x20050000u     // SRAM1 + SRAM2 on the STM32F413xx.
+#endif
+
+// Top of the main stack, bounds the backtrace of faults taken on the MSP.
+#ifndef EXCEPTIONS_MAIN_STACK_TOP
+extern uint32_t _estack;            // Initial MSP, provided by the linker script.
+#define EXCEPTIONS_MAIN_STACK_TOP   ((uint32_t)&_estack)
+#endif
+
+// Maximum number of stack words inspected per backtrace, keeps the walk bounded in time.
+#ifndef EXCEPTIONS_UNWIND_MAX_SCAN
+#define EXCEPTIONS_UNWIND_MAX_SCAN  256
+#endif
+
+// Unwinder signature
+// - Writes the PC followed by the return addresses found, returns the number of frames written.
+typedef uint32_t (*exceptionsUnwinderType)(uint32_t pc, uint32_t lr, uint32_t sp, uint32_t stackTop,
+                                          uint32_t* aFrames, uint32_t maxFrames);
+
+// The unwinder used by the exception handlers, override to plug in a table based one.
+#ifndef EXCEPTIONS_UNWINDER
+#define EXCEPTIONS_UNWINDER         unwindStackScan
+#endif
+
+int unwindIsCodeAddress(uint32_t address);
+int unwindIsRamRange(uint32_t address, uint32_t length);
+int unwindIsReturnAddress(uint32_t address);
+uint32_t unwindFrameSp(uint32_t frameAddress, uint32_t excReturn, uint32_t psr);
+
+uint32_t unwindStackScan(uint32_t pc, uint32_t lr, uint32_t sp, uint32_t stackTop,
+                         uint32_t* aFrames, uint32_t maxFrames);
+
+#endif /* EXCEPTIONS_UNWIND_H_ */
@@ -0,0 +1,46 @@
+/*
+ * exceptionsVariables.c
+ *
+ *  Created on: 18 Oct 2026
+ *
+ *  Named global variables in the crash record
+ *  - Entries outside RAM, from a table generated for another build, are skipped
+ *  - Stops at the first variable the record has no room for, the list is in the order given
+ *    to captureList so put the important ones first
+ */
+#include <stdint.h>
+
+#include "crashRecord.h"
+#include "exceptionsUnwind.h"
+#include "exceptionsVariables.h"
+
+/* Copy the capture list into the crash record
+ * - Between crashRecordBegin() and crashRecordCommit()
+*/
+void exceptionsRecordVariables(void)
+{
+    uint32_t i;
+
+    for(i = 0; i < exceptionsVariableCount; i++)
+    {
+        const exceptionsVariableType* variable = &exceptionsVariables[i];
+        const volatile uint8_t* source = (const volatile uint8_t*)variable->m_Address;
+        uint32_t length = variable->m_Size;
+        uint32_t* dest;
+        uint8_t* bytes;
+        uint32_t j;
+
+        if(length > EXCEPTIONS_VARIABLE_MAX_BYTES)
+            length = EXCEPTIONS_VARIABLE_MAX_BYTES;
+        if((length == 0) || !unwindIsRamRange(variable->m_Address, length))
+            continue;
+
+        dest = crashRecordAddTlv(CRASH_RECORD_TAG_VARIABLE, (uint16_t)(length + 4u));
+        if(dest == 0)
+            return;
+        dest[0] = variable->m_Address;
+        bytes = (uint8_t*)(dest + 1);
+        for(j = 0; j < length; j++)
+            bytes[j] = source[j];
+    }
+}
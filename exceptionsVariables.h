@@ -0,0 +1,39 @@
+/*
+ * exceptionsVariables.h
+ *
+ *  Created on: 18 Oct 2026
+ *
+ *  Named global variables in the crash record
+ *  - exceptionsVariables is generated from the linked ELF by host/captureList, from a list of
+ *    symbol names, so the addresses and sizes are never kept by hand
+ *  - Each variable goes into a CRASH_RECORD_TAG_VARIABLE TLV, captureList -d prints them by name
+ *  - The table is const, it sits in flash and regenerating it doesn't move anything in RAM;
+ *    captureList -c checks a linked ELF still matches its table
+ *  - The table layout is shared with the host, fixed width types only
+ */
+
+#ifndef EXCEPTIONS_VARIABLES_H_
+#define EXCEPTIONS_VARIABLES_H_
+
+#include <stdint.h>
+
+#define EXCEPTIONS_VARIABLES_SYMBOL         "exceptionsVariables"
+
+// Larger variables are truncated, a record holds only a few KB.
+#ifndef EXCEPTIONS_VARIABLE_MAX_BYTES
+#define EXCEPTIONS_VARIABLE_MAX_BYTES       256u
+#endif
+
+typedef struct
+{
+    uint32_t m_Address;
+    uint32_t m_Size;
+} exceptionsVariableType;
+
+extern const exceptionsVariableType exceptionsVariables[];
+extern const uint32_t exceptionsVariableCount;
+
+// Fault path.
+void exceptionsRecordVariables(void);
+
+#endif /* EXCEPTIONS_VARIABLES_H_ */
@@ -0,0 +1,89 @@
+/*
+ * exceptionsVectors.c
+ *
+ *  Created on: 18 Oct 2026
+ *
+ *  Vector table in SRAM
+ *  - The table copied is whatever VTOR points at, so it also works behind a bootloader
+ *  - Handlers are single word stores followed by a DSB, an exception taken straight after
+ *    exceptionsVectorInstall() returns already uses the new handler
+ *  - Fault handlers installed here are entered like any exception handler, without the
+ *    EXCEPTION_TRAMPOLINE frame, a naked handler can use EXCEPTION_TRAMPOLINE itself
+ */
+#include <stdint.h>
+
+#include "exceptionsVectors.h"
+
+#if defined(STM32F413xx)
+#include "stm32f413xx.h"
+#else
+#error *** ERROR - Cortex M4 Vectors CPU type not defined.
+#endif
+
+#define VECTOR_FIRST_HANDLER            2u          // Below are the initial SP and Reset_Handler.
+
+static uint32_t ramVectors[EXCEPTIONS_VECTOR_COUNT] __attribute__((aligned(EXCEPTIONS_VECTOR_ALIGN)));
+static const uint32_t* originalVectors;
+
+/* Copy the vector table to SRAM and switch to it
+ * - Called by exceptionsInit() with EXCEPTIONS_RAM_VECTORS defined, again does nothing
+*/
+void exceptionsVectorsInit(void)
+{
+    const uint32_t* source = (const uint32_t*)SCB->VTOR;
+    uint32_t primask;
+    uint32_t i;
+
+    if(source == ramVectors)
+        return;
+
+    for(i = 0; i < EXCEPTIONS_VECTOR_COUNT; i++)
+        ramVectors[i] = source[i];
+    originalVectors = source;
+
+    primask = __get_PRIMASK();
+    __disable_irq();
+    SCB->VTOR = (uint32_t)ramVectors;
+    __DSB();
+    __ISB();
+    __set_PRIMASK(primask);
+}
+
+static uint32_t vectorIndex(int32_t irq)
+{
+    int32_t index = irq + 16;
+
+    if((index < (int32_t)VECTOR_FIRST_HANDLER) || (index >= (int32_t)EXCEPTIONS_VECTOR_COUNT))
+        return 0;
+    return (uint32_t)index;
+}
+
+/* Replace a handler
+ * - irq is a CMSIS IRQn, or EXCEPTIONS_VECTOR_xxx for the fault handlers
+ * - aHandler 0 puts back the handler from the table that was copied
+ * - Returns the previous handler, or 0 if the SRAM table isn't in use or irq is out of range
+*/
+exceptionsHandlerType exceptionsVectorInstall(int32_t irq, exceptionsHandlerType aHandler)
+{
+    uint32_t index = vectorIndex(irq);
+    uint32_t previous;
+
+    if((index == 0) || (SCB->VTOR != (uint32_t)ramVectors))
+        return 0;
+
+    previous = ramVectors[index];
+    ramVectors[index] = aHandler ? (uint32_t)aHandler : originalVectors[index];
+    __DSB();
+    return (exceptionsHandlerType)previous;
+}
+
+/* The handler an exception runs now
+*/
+exceptionsHandlerType exceptionsVectorGet(int32_t irq)
+{
+    uint32_t index = vectorIndex(irq);
+
+    if(index == 0)
+        return 0;
+    return (exceptionsHandlerType)((const uint32_t*)SCB->VTOR)[index];
+}
@@ -0,0 +1,40 @@
+/*
+ * exceptionsVectors.h
+ *
+ *  Created on: 18 Oct 2026
+ *
+ *  Vector table in SRAM
+ *  - exceptionsInit() copies the active vector table to SRAM and points VTOR at it, handlers
+ *    can then be replaced at run time, e.g. a profiling or recovery variant of a fault handler
+ *  - Vector fetches on exception entry no longer wait on flash
+ */
+
+#ifndef EXCEPTIONS_VECTORS_H_
+#define EXCEPTIONS_VECTORS_H_
+
+#include <stdint.h>
+
+// Entries copied: 16 system vectors and the STM32F413's 102 interrupts.
+#ifndef EXCEPTIONS_VECTOR_COUNT
+#define EXCEPTIONS_VECTOR_COUNT         118u
+#endif
+// VTOR needs the table aligned to its size rounded up to a power of two.
+#ifndef EXCEPTIONS_VECTOR_ALIGN
+#define EXCEPTIONS_VECTOR_ALIGN         512u
+#endif
+
+// CMSIS IRQn numbers, the device headers have no HardFault_IRQn.
+#define EXCEPTIONS_VECTOR_NMI           (-14)
+#define EXCEPTIONS_VECTOR_HARD_FAULT    (-13)
+#define EXCEPTIONS_VECTOR_MEM_MANAGE    (-12)
+#define EXCEPTIONS_VECTOR_BUS_FAULT     (-11)
+#define EXCEPTIONS_VECTOR_USAGE_FAULT   (-10)
+#define EXCEPTIONS_VECTOR_DEBUG_MONITOR (-4)
+
+typedef void (*exceptionsHandlerType)(void);
+
+void exceptionsVectorsInit(void);
+exceptionsHandlerType exceptionsVectorInstall(int32_t irq, exceptionsHandlerType aHandler);
+exceptionsHandlerType exceptionsVectorGet(int32_t irq);
+
+#endif /* EXCEPTIONS_VECTORS_H_ */
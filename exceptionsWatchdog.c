@@ -0,0 +1,115 @@
+/*
+ * exceptionsWatchdog.c
+ *
+ *  Created on: 18 Oct 2026
+ *
+ *  Window watchdog early wakeup capture
+ *  - WWDG_IRQHandler goes through EXCEPTION_TRAMPOLINE, so the record has the registers,
+ *    backtrace and stack of the context the watchdog caught, from the MSP or PSP
+ *  - The early wakeup comes one WWDG tick before the reset, 4096 * prescaler PCLK1 cycles,
+ *    and the magic is written last, so the record is cut down to fit: registers, a PC and LR
+ *    backtrace, the build-id and EXCEPTIONS_WATCHDOG_STACK_BYTES of stack, no unwinding,
+ *    context providers, regions or printing
+ *  - About 4,000 cycles with the defaults, counted from the code, mostly the CRC of the
+ *    ~210 bytes written; one tick is 4096 * 2^WDGTB * HCLK/PCLK1 CPU cycles, so with PCLK1 at
+ *    HCLK/2 any prescaler fits and with PCLK1 at HCLK it needs WDGTB of 1 (divide by 2) or more
+ *  - exceptionsWatchdogCaptureCycles() gives the CYCCNT measurement of the last capture after
+ *    the reset, check it on the target with the clocks it really runs
+ *  - Nothing runs until the early wakeup, normal operation costs nothing
+ *  - The reset counts towards crash loop detection like a fault: firmware that hangs on every
+ *    boot needs safe mode as much as firmware that faults
+ */
+#include <stdint.h>
+
+#include "crashRecord.h"
+#include "exceptions.h"
+#include "exceptionsCapture.h"
+#include "exceptionsWatchdog.h"
+
+#if defined(STM32F413xx)
+#include "stm32f413xx.h"
+#else
+#error *** ERROR - Cortex M4 Vectors CPU type not defined.
+#endif
+
+// Bytes of the interrupted stack in the record, each word adds to the CRC.
+#ifndef EXCEPTIONS_WATCHDOG_STACK_BYTES
+#define EXCEPTIONS_WATCHDOG_STACK_BYTES 64u
+#endif
+
+// Capture time, kept across the reset with the sequence number of the record it belongs to.
+typedef struct
+{
+    uint32_t m_Sequence;
+    uint32_t m_Cycles;
+} watchdogTimingType;
+
+static watchdogTimingType watchdogTiming __attribute__((section(EXCEPTIONS_RETAINED_SECTION)));
+
+void watchdogEarlyWakeup(const CortexExceptionCpuFrameType* aFrame, const CortexExceptionCalleeFrameType* aCallee);
+
+/* Enable the early wakeup interrupt
+ * - Call once the WWDG is configured, the interrupt can't be disabled again until reset
+*/
+void exceptionsWatchdogInit(void)
+{
+    WWDG->SR = 0;
+    WWDG->CFR |= WWDG_CFR_EWI;
+
+    // Above everything else, the reset is only one WWDG tick away.
+    NVIC_SetPriority(WWDG_IRQn, 0);
+    NVIC_ClearPendingIRQ(WWDG_IRQn);
+    NVIC_EnableIRQ(WWDG_IRQn);
+
+    // For exceptionsWatchdogCaptureCycles(), the count itself is left alone.
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+}
+
+/* Cycles the last Watchdog record took to write
+ * - Call after the reset, returns 0 if the crash record isn't that Watchdog record
+*/
+uint32_t exceptionsWatchdogCaptureCycles(void)
+{
+    const crashRecordType* record = crashRecordGet();
+
+    if((record == 0) || (record->m_Type != Watchdog) || (record->m_Sequence != watchdogTiming.m_Sequence))
+        return 0;
+    return watchdogTiming.m_Cycles;
+}
+
+/* Early wakeup, called by the trampoline with the interrupted context
+ * - Never returns, so nothing can refresh the watchdog after the record says it fired
+*/
+void watchdogEarlyWakeup(const CortexExceptionCpuFrameType* aFrame, const CortexExceptionCalleeFrameType* aCallee)
+{
+    uint32_t start = DWT->CYCCNT;
+    crashRecordType* record;
+    uint32_t frames[2];
+
+    // Write zero to clear.
+    WWDG->SR = 0;
+
+    // A hang is a crash, flag it before anything that could run out the tick.
+    exceptionsFaultPending();
+    record = exceptionsRecordBegin(aFrame, aCallee, Watchdog);
+#if defined(CRASH_RECORD_BUILD_ID)
+    exceptionsRecordBuildId();
+#endif
+    frames[0] = record->m_Pc;
+    frames[1] = record->m_Lr;
+    exceptionsRecordBacktrace(frames, 2);
+    exceptionsRecordStack(record->m_Sp, exceptionsStackTop(aCallee->m_ExcReturn), EXCEPTIONS_WATCHDOG_STACK_BYTES);
+    crashRecordCommit();
+
+    watchdogTiming.m_Sequence = record->m_Sequence;
+    watchdogTiming.m_Cycles = DWT->CYCCNT - start;
+
+    for(;;)
+        ;
+}
+
+__attribute__((naked))  void WWDG_IRQHandler(void)
+{
+    EXCEPTION_TRAMPOLINE(watchdogEarlyWakeup);
+}
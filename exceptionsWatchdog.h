@@ -0,0 +1,19 @@
+/*
+ * exceptionsWatchdog.h
+ *
+ *  Created on: 18 Oct 2026
+ *
+ *  Window watchdog early wakeup capture
+ *  - The WWDG interrupts one tick before it resets, the handler writes a reduced Watchdog
+ *    crash record from whatever was running and then waits for the reset
+ */
+
+#ifndef EXCEPTIONS_WATCHDOG_H_
+#define EXCEPTIONS_WATCHDOG_H_
+
+#include <stdint.h>
+
+void exceptionsWatchdogInit(void);
+uint32_t exceptionsWatchdogCaptureCycles(void);
+
+#endif /* EXCEPTIONS_WATCHDOG_H_ */
@@ -0,0 +1,56 @@
+/*
+ * faultAssert.h
+ *
+ *  Created on: 18 Oct 2026
+ *
+ *  Tokenized assert
+ *  - FAULT_ASSERT(cond) compiles to a compare and a UDF.W carrying a 16 bit token
+ *  - No strings go into flash, file/line/expression are kept in the non-allocated .fault_assert
+ *    section (see faultAssert.ld) and mapped back on the host with host/faultAssertMap
+ *  - The UsageFault/HardFault handler decodes the token from the faulting instruction
+ *  - Each UDF's address goes into .fault_assert_sites next to its entry, the linker fills it
+ *    in, so the faulting PC names exactly one assert with no ids to hand out; the token, the
+ *    line in 12 bits and an optional FAULT_ASSERT_FILE_ID (0-15), is a hint for logs without it
+ */
+
+#ifndef FAULT_ASSERT_H_
+#define FAULT_ASSERT_H_
+
+#ifndef FAULT_ASSERT_FILE_ID
+#define FAULT_ASSERT_FILE_ID    0
+#endif
+
+#define FAULT_ASSERT_TOKEN      ((((FAULT_ASSERT_FILE_ID) & 0xF) << 12) | (__LINE__ & 0xFFF))
+
+// UDF.W #imm16 encoding, imm16 = imm4:imm12.
+#define FAULT_ASSERT_UDF_HW1_MASK   0xFFF0u
+#define FAULT_ASSERT_UDF_HW1        0xF7F0u
+#define FAULT_ASSERT_UDF_HW2_MASK   0xF000u
+#define FAULT_ASSERT_UDF_HW2        0xA000u
+
+#define FAULT_ASSERT(cond)                                                          \
+    do                                                                              \
+    {                                                                               \
+        if(__builtin_expect(!(cond), 0))                                            \
+        {                                                                           \
+            __attribute__((section(".fault_assert"), used, aligned(4)))             \
+            static const struct                                                     \
+            {                                                                       \
+                uint16_t m_Token;                                                   \
+                uint16_t m_Size;                                                    \
+                uint32_t m_Line;                                                    \
+                char m_File[sizeof(__FILE__)];                                      \
+                char m_Expr[sizeof(#cond)];                                         \
+            } faultAssertEntry = { FAULT_ASSERT_TOKEN, sizeof(faultAssertEntry),    \
+                                   __LINE__, __FILE__, #cond };                     \
+            __asm__ volatile("1: udf.w %0\n"                                        \
+                             ".pushsection .fault_assert_sites, \"\", %%progbits\n" \
+                             ".balign 4\n"                                          \
+                             ".word 1b, %c1\n"                                      \
+                             ".popsection"                                          \
+                             :: "n"(FAULT_ASSERT_TOKEN), "i"(&faultAssertEntry));   \
+            __builtin_unreachable();                                                \
+        }                                                                           \
+    } while(0)
+
+#endif /* FAULT_ASSERT_H_ */
@@ -0,0 +1,44 @@
+/*
+ * freertos_tasks_c_additions.h
+ *
+ *  Created on: 18 Oct 2026
+ *
+ *  Task state for the FreeRTOS adapter of the fault time task snapshot
+ *  - tasks.c includes this at its end when FreeRTOSConfig.h defines
+ *    configINCLUDE_FREERTOS_TASK_C_ADDITIONS_H as 1, which gives it the private task lists;
+ *    an application with its own additions file includes this one from it
+ *  - Works the state out the way eTaskGetState() does, but without its critical section:
+ *    the port asserts that isn't entered from an interrupt, and leaving it would drop
+ *    BASEPRI to 0 inside the fault handler
+ */
+#include "exceptions.h"
+#include "exceptionsRtos.h"
+
+uint32_t exceptionsRtosFreeRtosState(const void* aTcb);
+
+/* State of a task from the list its state item is on
+ * - Only reads list pointers, nothing is walked, so it is safe on corrupt lists
+*/
+uint32_t exceptionsRtosFreeRtosState(const void* aTcb)
+{
+    const TCB_t* tcb = (const TCB_t*)aTcb;
+    const List_t* container = (const List_t*)listLIST_ITEM_CONTAINER(&tcb->xStateListItem);
+
+    if(tcb == pxCurrentTCB)
+        return Task_Running;
+    if((container == pxDelayedTaskList) || (container == pxOverflowDelayedTaskList))
+        return Task_Blocked;
+    if(((container >= &pxReadyTasksLists[0]) && (container < &pxReadyTasksLists[configMAX_PRIORITIES])) ||
+       (container == &xPendingReadyList))
+        return Task_Ready;
+#if (INCLUDE_vTaskSuspend == 1)
+    // Blocked with no timeout also puts a task on the suspended list, but it waits on an event.
+    if(container == &xSuspendedTaskList)
+        return (listLIST_ITEM_CONTAINER(&tcb->xEventListItem) == NULL) ? Task_Suspended : Task_Blocked;
+#endif
+#if (INCLUDE_vTaskDelete == 1)
+    if(container == &xTasksWaitingTermination)
+        return Task_Deleted;
+#endif
+    return (container == NULL) ? Task_Deleted : Task_Unknown;
+}
@@ -0,0 +1,394 @@
+/*
+ * gdbStub.c
+ *
+ *  Created on: 18 Oct 2026
+ *
+ *  Minimal GDB remote serial protocol stub
+ *  - Lets a faulted unit be inspected over its serial console, no SWD probe, no power cycle
+ *  - Runs with interrupts off and polls the UART, so works from any fault handler
+ *  - Continue and step return from the exception, stepping uses DEMCR.MON_STEP so the
+ *    DebugMonitor exception brings us back after one instruction
+ */
+#include <stdint.h>
+
+#include "exceptions.h"
+#include "exceptionsCapture.h"
+#include "exceptionsUnwind.h"
+#include "gdbStub.h"
+
+#if defined(STM32F413xx)
+#include "stm32f413xx.h"
+#else
+#error *** ERROR - Cortex M4 Vectors CPU type not defined.
+#endif
+
+#define GDB_PACKET_SIZE     512u
+#define GDB_REGISTER_COUNT  17u     // r0-r12, sp, lr, pc, xpsr.
+
+#define BUS_READ_ERRORS     (SCB_CFSR_PRECISERR | SCB_CFSR_IMPRECISERR | SCB_CFSR_BFARVALID)
+
+#define THUMB_BKPT_MASK     0xFF00u
+#define THUMB_BKPT          0xBE00u
+
+// Lowest priority, so stepping works in any code that is not itself an exception handler.
+#define DEBUG_MONITOR_PRIORITY  0xFFu
+
+static const char targetXml[] =
+    "<?xml version=\"1.0\"?><target><architecture>arm</architecture>"
+    "<feature name=\"org.gnu.gdb.arm.m-profile\">"
+    "<reg name=\"r0\" bitsize=\"32\"/><reg name=\"r1\" bitsize=\"32\"/><reg name=\"r2\" bitsize=\"32\"/>"
+    "<reg name=\"r3\" bitsize=\"32\"/><reg name=\"r4\" bitsize=\"32\"/><reg name=\"r5\" bitsize=\"32\"/>"
+    "<reg name=\"r6\" bitsize=\"32\"/><reg name=\"r7\" bitsize=\"32\"/><reg name=\"r8\" bitsize=\"32\"/>"
+    "<reg name=\"r9\" bitsize=\"32\"/><reg name=\"r10\" bitsize=\"32\"/><reg name=\"r11\" bitsize=\"32\"/>"
+    "<reg name=\"r12\" bitsize=\"32\"/><reg name=\"sp\" bitsize=\"32\" type=\"data_ptr\"/>"
+    "<reg name=\"lr\" bitsize=\"32\"/><reg name=\"pc\" bitsize=\"32\" type=\"code_ptr\"/>"
+    "<reg name=\"xpsr\" bitsize=\"32\" regnum=\"16\"/></feature></target>";
+
+static const char hexDigits[] = "0123456789abcdef";
+static char packet[GDB_PACKET_SIZE];
+
+/* Only read memory that is there
+ * - Code, RAM, peripherals and the system control space
+ * - The last two have reserved holes, readMemory() reads them with BusFaults ignored
+*/
+static int readable(uint32_t address, uint32_t length)
+{
+    uint32_t end = address + length - 1u;
+
+    if((length == 0) || (end < address))
+        return 0;
+    return (unwindIsCodeAddress(address) && unwindIsCodeAddress(end)) ||
+           unwindIsRamRange(address, length) ||
+           ((address >= PERIPH_BASE) && (end < 0x60000000u)) ||
+           ((address >= 0xE0000000u) && (end < 0xE0100000u));
+}
+
+static int startsWith(const char* aText, const char* aPrefix)
+{
+    while(*aPrefix)
+    {
+        if(*aText++ != *aPrefix++)
+            return 0;
+    }
+    return 1;
+}
+
+static int hexValue(char c)
+{
+    if((c >= '0') && (c <= '9'))
+        return c - '0';
+    if((c >= 'a') && (c <= 'f'))
+        return c - 'a' + 10;
+    if((c >= 'A') && (c <= 'F'))
+        return c - 'A' + 10;
+    return -1;
+}
+
+static const char* parseHex(const char* aText, uint32_t* aValue)
+{
+    int digit;
+
+    *aValue = 0;
+    while((digit = hexValue(*aText)) >= 0)
+    {
+        *aValue = (*aValue << 4) | (uint32_t)digit;
+        aText++;
+    }
+    return aText;
+}
+
+static char* putHex8(char* aOut, uint8_t value)
+{
+    *aOut++ = hexDigits[value >> 4];
+    *aOut++ = hexDigits[value & 0xFu];
+    return aOut;
+}
+
+// Registers go out in target byte order, little endian.
+static char* putHex32(char* aOut, uint32_t value)
+{
+    uint32_t i;
+
+    for(i = 0; i < 4; i++)
+        aOut = putHex8(aOut, (uint8_t)(value >> (i * 8)));
+    return aOut;
+}
+
+/* Receive a packet
+ * - Returns its length, acking good packets and nacking bad ones
+*/
+static uint32_t getPacket(void)
+{
+    for(;;)
+    {
+        uint32_t length = 0;
+        uint8_t checksum = 0;
+        int c;
+
+        while((c = gdbStubGetChar()) != '$')
+        {
+            // Ctrl-C just asks where we are.
+            if(c == 0x03)
+            {
+                packet[0] = '?';
+                return 1;
+            }
+        }
+
+        while(((c = gdbStubGetChar()) != '#') && (length < (GDB_PACKET_SIZE - 1)))
+        {
+            if(c == '$')
+            {
+                length = 0;
+                checksum = 0;
+                continue;
+            }
+            packet[length++] = (char)c;
+            checksum += (uint8_t)c;
+        }
+        packet[length] = '\0';
+
+        c = hexValue((char)gdbStubGetChar()) << 4;
+        c |= hexValue((char)gdbStubGetChar());
+        if(c == checksum)
+        {
+            gdbStubPutChar('+');
+            return length;
+        }
+        gdbStubPutChar('-');
+    }
+}
+
+/* Send a packet and wait for the ack
+ * - Resent on a nack, gives up on anything else
+*/
+static void putPacket(const char* aData)
+{
+    int c;
+
+    do
+    {
+        const char* data = aData;
+        uint8_t checksum = 0;
+        char trailer[2];
+
+        gdbStubPutChar('$');
+        while(*data)
+        {
+            checksum += (uint8_t)*data;
+            gdbStubPutChar(*data++);
+        }
+        gdbStubPutChar('#');
+        putHex8(trailer, checksum);
+        gdbStubPutChar(trailer[0]);
+        gdbStubPutChar(trailer[1]);
+
+        c = gdbStubGetChar();
+    } while(c == '-');
+}
+
+static void putStopReply(int signal)
+{
+    char reply[4];
+
+    reply[0] = 'S';
+    putHex8(&reply[1], (uint8_t)signal);
+    reply[3] = '\0';
+    putPacket(reply);
+}
+
+static uint32_t registerValue(const CortexExceptionCpuFrameType* aFrame, const CortexExceptionCalleeFrameType* aCallee, uint32_t index)
+{
+    switch(index)
+    {
+        case 0:     return aFrame->m_R0;
+        case 1:     return aFrame->m_R1;
+        case 2:     return aFrame->m_R2;
+        case 3:     return aFrame->m_R3;
+        case 4:     return aCallee->m_R4;
+        case 5:     return aCallee->m_R5;
+        case 6:     return aCallee->m_R6;
+        case 7:     return aCallee->m_R7;
+        case 8:     return aCallee->m_R8;
+        case 9:     return aCallee->m_R9;
+        case 10:    return aCallee->m_R10;
+        case 11:    return aCallee->m_R11;
+        case 12:    return aFrame->m_R12;
+        case 13:    return unwindFrameSp((uint32_t)aFrame, aCallee->m_ExcReturn, aFrame->m_PSR);
+        case 14:    return aFrame->m_LR;
+        case 15:    return aFrame->m_PC;
+        default:    return aFrame->m_PSR;
+    }
+}
+
+static void readMemory(const char* aArgs)
+{
+    uint32_t address;
+    uint32_t length;
+    uint32_t ccr;
+    uint32_t faultMask;
+    uint32_t busStatus;
+    uint32_t added;
+    char* out = packet;
+
+    aArgs = parseHex(aArgs, &address);
+    if(*aArgs++ != ',')
+    {
+        putPacket("E01");
+        return;
+    }
+    parseHex(aArgs, &length);
+    if(length > ((GDB_PACKET_SIZE - 1) / 2))
+        length = (GDB_PACKET_SIZE - 1) / 2;
+    if(!readable(address, length))
+    {
+        putPacket("E14");
+        return;
+    }
+
+    // A BusFault here would re-enter the fault handler or lock up. At priority -1 BFHFNMIGN
+    // makes a read of a hole return junk instead, BFSR says whether that happened. The MPU
+    // is off at -1 unless MPU_CTRL.HFNMIENA is set, leave it clear.
+    ccr = SCB->CCR;
+    faultMask = __get_FAULTMASK();
+    busStatus = SCB->CFSR & BUS_READ_ERRORS;
+    __set_FAULTMASK(1);
+    SCB->CCR = ccr | SCB_CCR_BFHFNMIGN_Msk;
+    __DSB();
+    __ISB();
+
+    while(length--)
+        out = putHex8(out, *(const volatile uint8_t*)address++);
+    *out = '\0';
+
+    __DSB();
+    added = (SCB->CFSR & BUS_READ_ERRORS) & ~busStatus;
+    SCB->CCR = ccr;
+    __DSB();
+    __ISB();
+    __set_FAULTMASK(faultMask);
+
+    if(added)
+    {
+        // Write one to clear, only what the read set.
+        SCB->CFSR = added;
+        putPacket("E14");
+        return;
+    }
+    putPacket(packet);
+}
+
+/* Target description
+ * - Sent in the chunks GDB asks for, qXfer:features:read:target.xml:offset,length
+*/
+static void readFeatures(const char* aArgs)
+{
+    uint32_t offset;
+    uint32_t length;
+    uint32_t i;
+
+    aArgs = parseHex(aArgs, &offset);
+    if(*aArgs++ != ',')
+    {
+        putPacket("E01");
+        return;
+    }
+    parseHex(aArgs, &length);
+    if(length > (GDB_PACKET_SIZE - 2))
+        length = GDB_PACKET_SIZE - 2;
+    if(offset > (sizeof(targetXml) - 1))
+        offset = sizeof(targetXml) - 1;
+    if(length > (sizeof(targetXml) - 1 - offset))
+        length = sizeof(targetXml) - 1 - offset;
+
+    packet[0] = ((offset + length) < (sizeof(targetXml) - 1)) ? 'm' : 'l';
+    for(i = 0; i < length; i++)
+        packet[i + 1] = targetXml[offset + i];
+    packet[length + 1] = '\0';
+    putPacket(packet);
+}
+
+/* Resuming at a BKPT would just trap again, so step over it */
+static void skipBreakpoint(CortexExceptionCpuFrameType* aFrame)
+{
+    if(!(aFrame->m_PC & 1u) && readable(aFrame->m_PC, 2) &&
+       ((*(const uint16_t*)aFrame->m_PC & THUMB_BKPT_MASK) == THUMB_BKPT))
+        aFrame->m_PC += 2u;
+}
+
+void gdbStubInit(void)
+{
+    // A halting debugger takes priority, the monitor is only used without one.
+    NVIC_SetPriority(DebugMonitor_IRQn, DEBUG_MONITOR_PRIORITY);
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_MON_EN_Msk;
+}
+
+/* Talk to GDB until it continues, steps or detaches
+ * - Returning resumes the interrupted code when the caller returns from the exception
+*/
+void gdbStubEnter(CortexExceptionCpuFrameType* aFrame, const CortexExceptionCalleeFrameType* aCallee, int signal)
+{
+    uint32_t i;
+
+    CoreDebug->DEMCR &= ~CoreDebug_DEMCR_MON_STEP_Msk;
+    putStopReply(signal);
+
+    for(;;)
+    {
+        char* out = packet;
+
+        getPacket();
+        switch(packet[0])
+        {
+            case '?':
+                putStopReply(signal);
+                break;
+            case 'g':
+                for(i = 0; i < GDB_REGISTER_COUNT; i++)
+                    out = putHex32(out, registerValue(aFrame, aCallee, i));
+                *out = '\0';
+                putPacket(packet);
+                break;
+            case 'p':
+                parseHex(&packet[1], &i);
+                if(i >= GDB_REGISTER_COUNT)
+                {
+                    putPacket("E00");
+                    break;
+                }
+                *putHex32(out, registerValue(aFrame, aCallee, i)) = '\0';
+                putPacket(packet);
+                break;
+            case 'm':
+                readMemory(&packet[1]);
+                break;
+            case 's':
+                CoreDebug->DEMCR |= CoreDebug_DEMCR_MON_STEP_Msk;
+                skipBreakpoint(aFrame);
+                return;
+            case 'c':
+                skipBreakpoint(aFrame);
+                return;
+            case 'D':
+                putPacket("OK");
+                skipBreakpoint(aFrame);
+                return;
+            case 'k':
+                NVIC_SystemReset();
+                break;
+            case 'q':
+                if(startsWith(packet, "qSupported"))
+                    putPacket("PacketSize=200;qXfer:features:read+");
+                else if(startsWith(packet, "qXfer:features:read:target.xml:"))
+                    readFeatures(&packet[31]);
+                else if(startsWith(packet, "qAttached"))
+                    putPacket("1");
+                else
+                    putPacket("");
+                break;
+            default:
+                putPacket("");
+                break;
+        }
+    }
+}
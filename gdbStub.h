@@ -0,0 +1,27 @@
+/*
+ * gdbStub.h
+ *
+ *  Created on: 18 Oct 2026
+ *
+ *  Minimal GDB remote serial protocol stub over a UART
+ *  - Define EXCEPTIONS_GDB_STUB to enter it from the fault path instead of BKPT
+ *  - Register and memory reads, continue and single step through the DebugMonitor exception
+ *  - Provide gdbStubGetChar() and gdbStubPutChar() for your UART, polled, no interrupts
+ */
+
+#ifndef GDB_STUB_H_
+#define GDB_STUB_H_
+
+#define GDB_SIGNAL_ILL      4
+#define GDB_SIGNAL_TRAP     5
+#define GDB_SIGNAL_FPE      8
+#define GDB_SIGNAL_SEGV     11
+
+// UART access, to be provided by the application.
+int gdbStubGetChar(void);
+void gdbStubPutChar(char c);
+
+void gdbStubInit(void);
+void gdbStubEnter(CortexExceptionCpuFrameType* aFrame, const CortexExceptionCalleeFrameType* aCallee, int signal);
+
+#endif /* GDB_STUB_H_ */
@@ -0,0 +1,359 @@
+/*
+ * captureList.c
+ *
+ *  Created on: 18 Oct 2026
+ *
+ *  Capture list of named global variables (exceptionsVariables.h)
+ *  - Generates the exceptionsVariables table from a list of symbol names: the address and
+ *    size of each come from the ELF's symbol table, so nothing is kept by hand
+ *  - Names come from the command line or a file, one per line, # starts a comment; each must
+ *    be a single data object in RAM, a static name used in several files is an error
+ *  - The table is const, so regenerating it after linking doesn't move any RAM variable;
+ *    -c checks the table linked into an ELF matches its names, run it as a build step
+ *  - -d prints the CRASH_RECORD_TAG_VARIABLE TLVs of crash records by name
+ *  - Build: gcc -O2 -o captureList captureList.c elf32.c crashArchive.c
+ *  - Usage: captureList [-o captureTable.c] [-f names.txt] app.elf [symbol ...]
+ *           captureList -c [-f names.txt] app.elf [symbol ...]
+ *           captureList -d app.elf record.bin [record.bin ...]
+ */
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "crashArchive.h"
+#include "elf32.h"
+#include "../exceptionsVariables.h"
+
+#define LINE_LENGTH         256u
+#define DUMP_WIDTH          16u
+
+typedef struct
+{
+    const char* m_Name;
+    uint32_t m_Address;
+    uint32_t m_Size;
+} variableType;
+
+static const char** names;
+static uint32_t nameCount;
+static uint32_t nameAllocated;
+
+static int addName(const char* aName)
+{
+    if(nameCount == nameAllocated)
+    {
+        nameAllocated = nameAllocated ? (nameAllocated * 2u) : 64u;
+        names = realloc(names, nameAllocated * sizeof(const char*));
+        if(names == NULL)
+            return -1;
+    }
+    names[nameCount++] = aName;
+    return 0;
+}
+
+static int loadNames(const char* aPath)
+{
+    FILE* file = fopen(aPath, "r");
+    char line[LINE_LENGTH];
+
+    if(file == NULL)
+    {
+        perror(aPath);
+        return -1;
+    }
+    while(fgets(line, sizeof(line), file) != NULL)
+    {
+        char* name = line + strspn(line, " \t");
+        char* copy;
+
+        name[strcspn(name, " \t\r\n#")] = '\0';
+        if(*name == '\0')
+            continue;
+        if(((copy = strdup(name)) == NULL) || (addName(copy) != 0))
+        {
+            fclose(file);
+            return -1;
+        }
+    }
+    fclose(file);
+    return 0;
+}
+
+/* Look up a variable by name
+ * - Returns 0, or -1 after saying why it can't be captured
+*/
+static int resolve(const elf32FileType* aElf, const char* aPath, const char* aName, variableType* aVariable)
+{
+    const Elf32_Sym* found = NULL;
+    const Elf32_Shdr* section;
+    uint32_t i;
+
+    for(i = 0; i < aElf->m_SymbolCount; i++)
+    {
+        const Elf32_Sym* symbol = &aElf->m_Symbols[i];
+
+        if((ELF32_ST_TYPE(symbol->st_info) != STT_OBJECT) || (symbol->st_shndx == SHN_UNDEF) ||
+           (strcmp(elf32SymbolName(aElf, symbol), aName) != 0))
+            continue;
+        if(found != NULL)
+        {
+            fprintf(stderr, "%s: %s is defined more than once\n", aPath, aName);
+            return -1;
+        }
+        found = symbol;
+    }
+    if(found == NULL)
+    {
+        fprintf(stderr, "%s: no variable %s\n", aPath, aName);
+        return -1;
+    }
+    if((found->st_size == 0) || (found->st_shndx >= aElf->m_SectionCount))
+    {
+        fprintf(stderr, "%s: %s has no size\n", aPath, aName);
+        return -1;
+    }
+    section = &aElf->m_Sections[found->st_shndx];
+    if(!(section->sh_flags & SHF_ALLOC) || !(section->sh_flags & SHF_WRITE))
+    {
+        fprintf(stderr, "%s: %s is in %s, not RAM\n", aPath, aName, elf32SectionName(aElf, section));
+        return -1;
+    }
+    aVariable->m_Name = aName;
+    aVariable->m_Address = found->st_value;
+    aVariable->m_Size = found->st_size;
+    return 0;
+}
+
+static int generate(const char* aElfPath, const variableType* aVariables, const char* aOutPath)
+{
+    FILE* file = aOutPath ? fopen(aOutPath, "w") : stdout;
+    const char* base = strrchr(aElfPath, '/');
+    char entry[32];
+    uint32_t i;
+
+    if(file == NULL)
+    {
+        perror(aOutPath);
+        return 1;
+    }
+    fprintf(file, "/*\n * Generated by host/captureList from %s, do not edit\n */\n", base ? (base + 1) : aElfPath);
+    fprintf(file, "#include <stdint.h>\n\n#include \"exceptionsVariables.h\"\n\n");
+    fprintf(file, "const exceptionsVariableType exceptionsVariables[] =\n{\n");
+    for(i = 0; i < nameCount; i++)
+    {
+        if(aVariables[i].m_Size > EXCEPTIONS_VARIABLE_MAX_BYTES)
+            fprintf(stderr, "%s: %s is %u bytes, only the first %u are captured\n", aElfPath, aVariables[i].m_Name,
+                    aVariables[i].m_Size, EXCEPTIONS_VARIABLE_MAX_BYTES);
+        snprintf(entry, sizeof(entry), "{0x%08Xu, %uu},", aVariables[i].m_Address, aVariables[i].m_Size);
+        fprintf(file, "    %-28s// %s\n", entry, aVariables[i].m_Name);
+    }
+    fprintf(file, "};\nconst uint32_t exceptionsVariableCount = %uu;\n", nameCount);
+
+    if((aOutPath != NULL) && (fclose(file) != 0))
+    {
+        perror(aOutPath);
+        return 1;
+    }
+    return 0;
+}
+
+/* Compare the table linked into the ELF with the names
+*/
+static int check(const elf32FileType* aElf, const char* aPath, const variableType* aVariables)
+{
+    const Elf32_Sym* symbol = elf32FindSymbol(aElf, EXCEPTIONS_VARIABLES_SYMBOL);
+    exceptionsVariableType entry;
+    uint32_t count;
+    uint32_t i;
+    int result = 0;
+
+    if(symbol == NULL)
+    {
+        fprintf(stderr, "%s: no %s, is the generated table linked?\n", aPath, EXCEPTIONS_VARIABLES_SYMBOL);
+        return 1;
+    }
+    count = symbol->st_size / sizeof(exceptionsVariableType);
+    if(count != nameCount)
+    {
+        fprintf(stderr, "%s: table has %u entries, %u names given\n", aPath, count, nameCount);
+        return 1;
+    }
+    for(i = 0; i < count; i++)
+    {
+        if(elf32ReadMemory(aElf, symbol->st_value + (i * sizeof(entry)), &entry, sizeof(entry), 1) != sizeof(entry))
+        {
+            fprintf(stderr, "%s: %s has no file contents\n", aPath, EXCEPTIONS_VARIABLES_SYMBOL);
+            return 1;
+        }
+        if((entry.m_Address != aVariables[i].m_Address) || (entry.m_Size != aVariables[i].m_Size))
+        {
+            fprintf(stderr, "%s: %s is %08x size %u, the table says %08x size %u\n", aPath, aVariables[i].m_Name,
+                    aVariables[i].m_Address, aVariables[i].m_Size, entry.m_Address, entry.m_Size);
+            result = 1;
+        }
+    }
+    if(result == 0)
+        printf("%u variables, table is current\n", count);
+    else
+        fprintf(stderr, "%s: regenerate the table and relink\n", aPath);
+    return result;
+}
+
+static const char* variableName(const elf32FileType* aElf, uint32_t address)
+{
+    uint32_t i;
+
+    for(i = 0; i < aElf->m_SymbolCount; i++)
+    {
+        const Elf32_Sym* symbol = &aElf->m_Symbols[i];
+
+        if((ELF32_ST_TYPE(symbol->st_info) == STT_OBJECT) && (symbol->st_shndx != SHN_UNDEF) && (symbol->st_value == address))
+            return elf32SymbolName(aElf, symbol);
+    }
+    return NULL;
+}
+
+static void printValue(const uint8_t* aData, uint32_t length)
+{
+    uint32_t value = 0;
+    uint32_t i;
+
+    if((length == 1) || (length == 2) || (length == 4))
+    {
+        for(i = 0; i < length; i++)
+            value |= (uint32_t)aData[i] << (i * 8u);
+        printf("0x%0*x (%u)\n", (int)(length * 2u), value, value);
+        return;
+    }
+    for(i = 0; i < length; i++)
+        printf("%s%02x", (i % DUMP_WIDTH) ? " " : ((i != 0) ? "\n        " : ""), aData[i]);
+    printf("\n");
+}
+
+static int decode(const elf32FileType* aElf, const char* aPath, int count, char** aRecords)
+{
+    const uint8_t* elfId = NULL;
+    uint32_t elfIdLength = 0;
+    int i;
+
+    elf32BuildId(aElf, &elfId, &elfIdLength);
+    for(i = 0; i < count; i++)
+    {
+        crashArchiveType archive;
+        const crashRecordType* record;
+        size_t offset = 0;
+
+        if(crashArchiveOpen(&archive, aRecords[i]) != 0)
+            continue;
+        while((record = crashArchiveNext(&archive, &offset)) != NULL)
+        {
+            const crashRecordTlvType* tlv = NULL;
+            const uint8_t* id;
+            uint32_t idLength = crashArchiveBuildId(record, &id);
+
+            printf("record %u\n", record->m_Sequence);
+            if((idLength != 0) && (elfIdLength != 0) && ((idLength != elfIdLength) || (memcmp(id, elfId, idLength) != 0)))
+                printf("    build-id doesn't match %s, names may be wrong\n", aPath);
+            while((tlv = crashArchiveNextTlv(record, tlv)) != NULL)
+            {
+                const uint8_t* payload = (const uint8_t*)(tlv + 1);
+                const char* name;
+                uint32_t address;
+
+                if((tlv->m_Tag != CRASH_RECORD_TAG_VARIABLE) || (tlv->m_Length < 4u))
+                    continue;
+                memcpy(&address, payload, sizeof(address));
+                name = variableName(aElf, address);
+                if(name != NULL)
+                    printf("    %s:\n        ", name);
+                else
+                    printf("    %08x:\n        ", address);
+                printValue(payload + 4u, tlv->m_Length - 4u);
+            }
+        }
+        crashArchiveClose(&archive);
+    }
+    return 0;
+}
+
+static void usage(const char* aName)
+{
+    fprintf(stderr, "usage: %s [-o captureTable.c] [-f names.txt] app.elf [symbol ...]\n"
+                    "       %s -c [-f names.txt] app.elf [symbol ...]\n"
+                    "       %s -d app.elf record.bin [record.bin ...]\n", aName, aName, aName);
+}
+
+int main(int argc, char** argv)
+{
+    const char* outPath = NULL;
+    const char* elfPath;
+    variableType* variables;
+    elf32FileType elf;
+    int checkOnly = 0;
+    int decodeOnly = 0;
+    int result = 0;
+    uint32_t i;
+    int option;
+
+    while((option = getopt(argc, argv, "cdf:o:")) != -1)
+    {
+        switch(option)
+        {
+            case 'c':   checkOnly = 1; break;
+            case 'd':   decodeOnly = 1; break;
+            case 'o':   outPath = optarg; break;
+            case 'f':
+                if(loadNames(optarg) != 0)
+                    return 1;
+                break;
+            default:
+                usage(argv[0]);
+                return 2;
+        }
+    }
+    if((optind >= argc) || (checkOnly && decodeOnly) || (decodeOnly && ((optind + 1) >= argc)))
+    {
+        usage(argv[0]);
+        return 2;
+    }
+    elfPath = argv[optind++];
+    if(elf32Open(&elf, elfPath) != 0)
+        return 1;
+    if(decodeOnly)
+    {
+        result = decode(&elf, elfPath, argc - optind, argv + optind);
+        elf32Close(&elf);
+        return result;
+    }
+
+    for(; optind < argc; optind++)
+    {
+        if(addName(argv[optind]) != 0)
+            return 1;
+    }
+    if(nameCount == 0)
+    {
+        fprintf(stderr, "no variables given\n");
+        elf32Close(&elf);
+        return 2;
+    }
+    variables = calloc(nameCount, sizeof(variableType));
+    if(variables == NULL)
+    {
+        elf32Close(&elf);
+        return 1;
+    }
+    for(i = 0; i < nameCount; i++)
+    {
+        if(resolve(&elf, elfPath, names[i], &variables[i]) != 0)
+            result = 1;
+    }
+    if(result == 0)
+        result = checkOnly ? check(&elf, elfPath, variables) : generate(elfPath, variables, outPath);
+
+    elf32Close(&elf);
+    free(variables);
+    return result;
+}
@@ -0,0 +1,243 @@
+/*
+ * crashArchive.c
+ *
+ *  Created on: 18 Oct 2026
+ *
+ *  Host side access to crash records
+ */
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "crashArchive.h"
+
+#define CRC32_POLYNOMIAL    0xEDB88320u     // Same CRC-32 as crashRecordReader.c.
+
+static uint32_t crcTable[256];
+
+int crashArchiveOpen(crashArchiveType* aArchive, const char* aPath)
+{
+    struct stat info;
+    int fd;
+
+    memset(aArchive, 0, sizeof(*aArchive));
+
+    fd = open(aPath, O_RDONLY);
+    if(fd < 0)
+    {
+        perror(aPath);
+        return -1;
+    }
+    if(fstat(fd, &info) != 0)
+    {
+        perror(aPath);
+        close(fd);
+        return -1;
+    }
+    if(info.st_size == 0)
+    {
+        close(fd);
+        return 0;
+    }
+
+    aArchive->m_Size = (size_t)info.st_size;
+    aArchive->m_Data = mmap(NULL, aArchive->m_Size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if(aArchive->m_Data == MAP_FAILED)
+    {
+        perror(aPath);
+        memset(aArchive, 0, sizeof(*aArchive));
+        return -1;
+    }
+    madvise((void*)aArchive->m_Data, aArchive->m_Size, MADV_SEQUENTIAL);
+    return 0;
+}
+
+void crashArchiveClose(crashArchiveType* aArchive)
+{
+    if(aArchive->m_Data != NULL)
+        munmap((void*)aArchive->m_Data, aArchive->m_Size);
+    memset(aArchive, 0, sizeof(*aArchive));
+}
+
+uint32_t crashArchiveCrc(const void* aData, size_t length)
+{
+    const uint8_t* data = (const uint8_t*)aData;
+    uint32_t crc = 0xFFFFFFFFu;
+
+    if(crcTable[1] == 0)
+    {
+        uint32_t i;
+        uint32_t bit;
+
+        for(i = 0; i < 256; i++)
+        {
+            uint32_t value = i;
+
+            for(bit = 0; bit < 8; bit++)
+                value = (value >> 1) ^ (CRC32_POLYNOMIAL & (0u - (value & 1u)));
+            crcTable[i] = value;
+        }
+    }
+
+    while(length--)
+        crc = (crc >> 8) ^ crcTable[(crc ^ *data++) & 0xFFu];
+    return ~crc;
+}
+
+/* Check for a complete record
+ * - Returns its size, or 0 if there isn't a valid record at aData
+*/
+uint32_t crashArchiveValidate(const uint8_t* aData, size_t available)
+{
+    crashRecordType header;
+
+    if(available < sizeof(crashRecordType))
+        return 0;
+
+    memcpy(&header, aData, sizeof(header));
+    if((header.m_Magic != CRASH_RECORD_MAGIC) || (header.m_Version != CRASH_RECORD_VERSION) ||
+       (header.m_HeaderSize < sizeof(crashRecordType)) || (header.m_Size < header.m_HeaderSize) ||
+       (header.m_Size > CRASH_RECORD_SIZE) || (header.m_Size > available) ||
+       (header.m_Crc != crashArchiveCrc(aData + CRASH_RECORD_CRC_OFFSET, header.m_Size - CRASH_RECORD_CRC_OFFSET)))
+        return 0;
+
+    return header.m_Size;
+}
+
+/* Next valid record at or after *aOffset
+ * - Skips anything that isn't a record 4 bytes at a time, so a damaged record costs only itself
+*/
+const crashRecordType* crashArchiveNext(const crashArchiveType* aArchive, size_t* aOffset)
+{
+    size_t offset = (*aOffset + 3u) & ~(size_t)3u;
+
+    while((offset + sizeof(crashRecordType)) <= aArchive->m_Size)
+    {
+        const uint8_t* data = aArchive->m_Data + offset;
+        uint32_t size;
+
+        if(((const uint32_t*)data)[0] == CRASH_RECORD_MAGIC)
+        {
+            size = crashArchiveValidate(data, aArchive->m_Size - offset);
+            if(size != 0)
+            {
+                *aOffset = offset + ((size + 3u) & ~3u);
+                return (const crashRecordType*)data;
+            }
+        }
+        offset += 4u;
+    }
+
+    *aOffset = aArchive->m_Size;
+    return NULL;
+}
+
+/* Iterate over the TLVs
+ * - Pass NULL to get the first, returns NULL at the end or on a malformed TLV
+*/
+const crashRecordTlvType* crashArchiveNextTlv(const crashRecordType* aRecord, const crashRecordTlvType* aTlv)
+{
+    const uint8_t* base = (const uint8_t*)aRecord;
+    uint32_t offset;
+
+    if(aTlv == NULL)
+        offset = aRecord->m_HeaderSize;
+    else
+        offset = (uint32_t)((const uint8_t*)aTlv - base) + sizeof(crashRecordTlvType) + ((aTlv->m_Length + 3u) & ~3u);
+
+    if(((offset + sizeof(crashRecordTlvType)) > aRecord->m_Size))
+        return NULL;
+
+    aTlv = (const crashRecordTlvType*)(base + offset);
+    if((aTlv->m_Length > (aRecord->m_Size - offset - sizeof(crashRecordTlvType))))
+        return NULL;
+    return aTlv;
+}
+
+const crashRecordTlvType* crashArchiveFindTlv(const crashRecordType* aRecord, uint16_t tag)
+{
+    const crashRecordTlvType* tlv = NULL;
+
+    while((tlv = crashArchiveNextTlv(aRecord, tlv)) != NULL)
+    {
+        if(tlv->m_Tag == tag)
+            return tlv;
+    }
+    return NULL;
+}
+
+/* Read target memory captured in the record
+ * - Returns the number of bytes read, stopping at the first byte not captured
+*/
+uint32_t crashArchiveReadMemory(const crashRecordType* aRecord, uint32_t address, void* aDest, uint32_t length)
+{
+    uint32_t done = 0;
+
+    while(done < length)
+    {
+        const crashRecordTlvType* tlv = NULL;
+        uint32_t current = address + done;
+        int found = 0;
+
+        while((tlv = crashArchiveNextTlv(aRecord, tlv)) != NULL)
+        {
+            const uint8_t* payload = (const uint8_t*)(tlv + 1);
+            uint32_t base;
+            uint32_t size;
+            uint32_t chunk;
+
+            if(((tlv->m_Tag != CRASH_RECORD_TAG_MEMORY) && (tlv->m_Tag != CRASH_RECORD_TAG_VARIABLE)) || (tlv->m_Length < 4u))
+                continue;
+            memcpy(&base, payload, sizeof(base));
+            size = tlv->m_Length - 4u;
+            if((current < base) || ((current - base) >= size))
+                continue;
+
+            chunk = size - (current - base);
+            if(chunk > (length - done))
+                chunk = length - done;
+            memcpy((uint8_t*)aDest + done, payload + 4u + (current - base), chunk);
+            done += chunk;
+            found = 1;
+            break;
+        }
+        if(!found)
+            break;
+    }
+    return done;
+}
+
+uint32_t crashArchiveBacktrace(const crashRecordType* aRecord, uint32_t* aFrames, uint32_t maxFrames)
+{
+    const crashRecordTlvType* tlv = crashArchiveFindTlv(aRecord, CRASH_RECORD_TAG_BACKTRACE);
+    uint32_t count;
+
+    if(tlv == NULL)
+    {
+        // Older records, fall back to the registers.
+        count = 0;
+        if(maxFrames > 0)
+            aFrames[count++] = aRecord->m_Pc;
+        return count;
+    }
+
+    count = tlv->m_Length / 4u;
+    if(count > maxFrames)
+        count = maxFrames;
+    memcpy(aFrames, tlv + 1, count * 4u);
+    return count;
+}
+
+uint32_t crashArchiveBuildId(const crashRecordType* aRecord, const uint8_t** aId)
+{
+    const crashRecordTlvType* tlv = crashArchiveFindTlv(aRecord, CRASH_RECORD_TAG_BUILD_ID);
+
+    if(tlv == NULL)
+        return 0;
+    *aId = (const uint8_t*)(tlv + 1);
+    return tlv->m_Length;
+}
@@ -0,0 +1,39 @@
+/*
+ * crashArchive.h
+ *
+ *  Created on: 18 Oct 2026
+ *
+ *  Host side access to crash records
+ *  - An archive is any file holding crash records: a raw dump of the record area,
+ *    or many records concatenated, each padded to 4 bytes
+ *  - Files are memory mapped and records are used in place
+ */
+
+#ifndef CRASH_ARCHIVE_H_
+#define CRASH_ARCHIVE_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "../crashRecord.h"
+
+typedef struct
+{
+    const uint8_t* m_Data;
+    size_t m_Size;
+} crashArchiveType;
+
+int crashArchiveOpen(crashArchiveType* aArchive, const char* aPath);
+void crashArchiveClose(crashArchiveType* aArchive);
+
+uint32_t crashArchiveCrc(const void* aData, size_t length);
+uint32_t crashArchiveValidate(const uint8_t* aData, size_t available);
+const crashRecordType* crashArchiveNext(const crashArchiveType* aArchive, size_t* aOffset);
+
+const crashRecordTlvType* crashArchiveNextTlv(const crashRecordType* aRecord, const crashRecordTlvType* aTlv);
+const crashRecordTlvType* crashArchiveFindTlv(const crashRecordType* aRecord, uint16_t tag);
+uint32_t crashArchiveReadMemory(const crashRecordType* aRecord, uint32_t address, void* aDest, uint32_t length);
+uint32_t crashArchiveBacktrace(const crashRecordType* aRecord, uint32_t* aFrames, uint32_t maxFrames);
+uint32_t crashArchiveBuildId(const crashRecordType* aRecord, const uint8_t** aId);
+
+#endif /* CRASH_ARCHIVE_H_ */
@@ -0,0 +1,549 @@
+/*
+ * crashCluster.c
+ *
+ *  Created on: 18 Oct 2026
+ *
+ *  Crash record clustering
+ *  - Each record's backtrace is normalised to function+offset using the ELF whose build-id
+ *    matches, so the same crash from different builds gets the same frames
+ *  - Records with identical fault type and frames share a signature (one 64 bit hash), then
+ *    signatures are merged into clusters when the MinHash estimate of the Jaccard similarity
+ *    of their function sets is above the threshold, found through LSH banding so the cost is
+ *    linear in the number of distinct signatures
+ *  - Clusters are ranked by how many records they hold
+ *  - With -c the signatures are kept in a decode cache (decodeCache.h), a rerun over a grown
+ *    archive only symbolizes the new records
+ *  - Build: gcc -O2 -o crashCluster crashCluster.c crashArchive.c decodeCache.c elf32.c
+ *  - Usage: crashCluster [-c cache.bin] [-e firmware.elf]... [-k frames] [-j similarity] [-n clusters] record.bin [record.bin ...]
+ */
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "../exceptions.h"
+#include "crashArchive.h"
+#include "decodeCache.h"
+#include "elf32.h"
+
+#define MAX_ELFS            63u         // Build bit 63 is records no ELF matched.
+#define MAX_FRAMES          32u
+#define DEFAULT_FRAMES      8u
+#define DEFAULT_SIMILARITY  0.5
+#define DEFAULT_CLUSTERS    20u
+#define MINHASH_COUNT       32u
+#define MINHASH_BANDS       8u          // Of MINHASH_COUNT / MINHASH_BANDS rows each.
+#define MINHASH_ROWS        (MINHASH_COUNT / MINHASH_BANDS)
+#define FNV_OFFSET          0xCBF29CE484222325ull
+#define FNV_PRIME           0x100000001B3ull
+#define DECODER_VERSION     1u          // Bump when signRecord() changes.
+
+typedef struct
+{
+    uint64_t m_Hash;            // Exact signature, 0 marks a free table slot.
+    uint64_t m_Builds;          // Bit per ELF the records came from.
+    uint32_t m_Count;
+    uint32_t m_Parent;          // Union-find over signatures.
+    uint32_t m_MinHash[MINHASH_COUNT];
+    const crashRecordType* m_Example;
+    uint32_t m_Elf;             // Index of the example's ELF, MAX_ELFS if none.
+} signatureType;
+
+typedef struct
+{
+    uint64_t m_Key;
+    uint32_t m_Signature;
+} bandEntryType;
+
+typedef struct
+{
+    uint32_t m_Root;
+    uint32_t m_Signatures;
+    uint64_t m_Count;
+    uint64_t m_Builds;
+} clusterType;
+
+static elf32FileType elfs[MAX_ELFS];
+static const uint8_t* buildIds[MAX_ELFS];
+static uint32_t buildIdLengths[MAX_ELFS];
+static uint64_t buildHashes[MAX_ELFS + 1];      // For the decode cache, 0 for no ELF.
+static uint32_t elfCount;
+static decodeCacheType cache;
+static int cacheEnabled;
+static uint32_t maxFrames = DEFAULT_FRAMES;
+
+static signatureType* table;        // Open addressing on the exact hash.
+static uint32_t tableSize;
+static uint32_t signatureCount;
+
+static const char* const typeNames[] =
+{
+    "Hard_Fault", "MemMang_Fault", "Bus_Fault", "Usage_Fault", "Lockup", "Watchdog", "Integrity"
+};
+
+static uint64_t fnv(uint64_t hash, const void* aData, size_t length)
+{
+    const uint8_t* data = (const uint8_t*)aData;
+
+    while(length--)
+        hash = (hash ^ *data++) * FNV_PRIME;
+    return hash;
+}
+
+static uint64_t fnvString(uint64_t hash, const char* aString)
+{
+    while(*aString != '\0')
+        hash = (hash ^ (uint8_t)*aString++) * FNV_PRIME;
+    return hash;
+}
+
+static uint64_t mix(uint64_t value)
+{
+    value = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9ull;
+    value = (value ^ (value >> 27)) * 0x94D049BB133111EBull;
+    return value ^ (value >> 31);
+}
+
+/* ELF the record was built from
+ * - Matched on build-id, a record without one uses the only ELF if there is just one
+*/
+static uint32_t findElf(const crashRecordType* aRecord)
+{
+    const uint8_t* id;
+    uint32_t length = crashArchiveBuildId(aRecord, &id);
+    uint32_t i;
+
+    if(length == 0)
+        return (elfCount == 1) ? 0 : MAX_ELFS;
+    for(i = 0; i < elfCount; i++)
+    {
+        if((buildIdLengths[i] == length) && (memcmp(buildIds[i], id, length) == 0))
+            return i;
+    }
+    return MAX_ELFS;
+}
+
+/* Name and offset of a frame
+ * - Unresolved frames keep their address, with no name
+*/
+static const char* frameName(uint32_t elf, uint32_t address, uint32_t* aOffset)
+{
+    const elf32FunctionType* function = (elf < elfCount) ? elf32FindFunction(&elfs[elf], address) : NULL;
+
+    if(function == NULL)
+    {
+        *aOffset = address & ~1u;
+        return NULL;
+    }
+    *aOffset = (address & ~1u) - function->m_Address;
+    return function->m_Name;
+}
+
+/* Exact signature of one record
+ * - The fault type and every frame's function+offset
+*/
+static uint64_t signRecord(const crashRecordType* aRecord, uint32_t elf)
+{
+    uint32_t frames[MAX_FRAMES];
+    uint32_t count = crashArchiveBacktrace(aRecord, frames, maxFrames);
+    uint64_t exact = fnv(FNV_OFFSET, &aRecord->m_Type, 1);
+    uint32_t i;
+
+    for(i = 0; i < count; i++)
+    {
+        uint32_t offset;
+        const char* name = frameName(elf, frames[i], &offset);
+
+        if(name != NULL)
+            exact = fnvString(exact, name);
+        exact = fnv(exact, &offset, sizeof(offset));
+    }
+    return (exact != 0) ? exact : 1;
+}
+
+static void minHashAdd(uint32_t* aMinHash, uint64_t shingle)
+{
+    uint32_t j;
+
+    for(j = 0; j < MINHASH_COUNT; j++)
+    {
+        uint32_t value = (uint32_t)(mix(shingle + ((uint64_t)j * 0x9E3779B97F4A7C15ull)) >> 32);
+
+        if(value < aMinHash[j])
+            aMinHash[j] = value;
+    }
+}
+
+/* MinHash of one record
+ * - The set is the fault type, each function and each caller/callee pair, without offsets,
+ *   so a crash moved by a rebuild or reached through one more caller still lands close
+ * - Only computed once per signature
+*/
+static void minHashRecord(const crashRecordType* aRecord, uint32_t elf, uint32_t* aMinHash)
+{
+    uint32_t frames[MAX_FRAMES];
+    uint32_t count = crashArchiveBacktrace(aRecord, frames, maxFrames);
+    uint64_t previous = 0;
+    uint32_t i;
+
+    for(i = 0; i < MINHASH_COUNT; i++)
+        aMinHash[i] = UINT32_MAX;
+    minHashAdd(aMinHash, mix(aRecord->m_Type + 1u));
+    for(i = 0; i < count; i++)
+    {
+        uint32_t offset;
+        const char* name = frameName(elf, frames[i], &offset);
+        uint64_t nameHash = (name != NULL) ? fnvString(FNV_OFFSET, name) : fnv(FNV_OFFSET, &offset, sizeof(offset));
+
+        minHashAdd(aMinHash, mix(nameHash));
+        if(previous != 0)
+            minHashAdd(aMinHash, mix(nameHash ^ (previous * FNV_PRIME)));
+        previous = nameHash;
+    }
+}
+
+static int growTable(void)
+{
+    signatureType* old = table;
+    uint32_t oldSize = tableSize;
+    uint32_t i;
+
+    tableSize = (tableSize != 0) ? (tableSize * 2) : 4096u;
+    table = calloc(tableSize, sizeof(signatureType));
+    if(table == NULL)
+        return -1;
+    for(i = 0; i < oldSize; i++)
+    {
+        uint32_t slot;
+
+        if(old[i].m_Hash == 0)
+            continue;
+        for(slot = (uint32_t)old[i].m_Hash & (tableSize - 1); table[slot].m_Hash != 0; slot = (slot + 1) & (tableSize - 1))
+            ;
+        table[slot] = old[i];
+    }
+    free(old);
+    return 0;
+}
+
+/* Signature of a record, through the decode cache if there is one
+*/
+static int cachedSignature(const crashRecordType* aRecord, uint32_t elf, uint64_t* aHash)
+{
+    uint64_t recordHash;
+    const void* value;
+    uint32_t length;
+
+    if(!cacheEnabled)
+    {
+        *aHash = signRecord(aRecord, elf);
+        return 0;
+    }
+    recordHash = decodeCacheRecordHash(aRecord);
+    value = decodeCacheFind(&cache, recordHash, buildHashes[elf], &length);
+    if((value != NULL) && (length == sizeof(*aHash)))
+    {
+        memcpy(aHash, value, sizeof(*aHash));
+        return 0;
+    }
+    *aHash = signRecord(aRecord, elf);
+    return decodeCacheStore(&cache, recordHash, buildHashes[elf], aHash, sizeof(*aHash));
+}
+
+static int addRecord(const crashRecordType* aRecord)
+{
+    uint32_t elf = findElf(aRecord);
+    uint64_t hash;
+    uint32_t slot;
+
+    if(cachedSignature(aRecord, elf, &hash) != 0)
+        return -1;
+
+    if(((signatureCount + 1) * 2) > tableSize)
+    {
+        if(growTable() != 0)
+            return -1;
+    }
+    for(slot = (uint32_t)hash & (tableSize - 1); table[slot].m_Hash != 0; slot = (slot + 1) & (tableSize - 1))
+    {
+        if(table[slot].m_Hash == hash)
+            break;
+    }
+    if(table[slot].m_Hash == 0)
+    {
+        table[slot].m_Hash = hash;
+        table[slot].m_Example = aRecord;
+        table[slot].m_Elf = elf;
+        minHashRecord(aRecord, elf, table[slot].m_MinHash);
+        signatureCount++;
+    }
+    table[slot].m_Count++;
+    table[slot].m_Builds |= 1ull << ((elf < elfCount) ? elf : MAX_ELFS);
+    return 0;
+}
+
+static uint32_t findRoot(signatureType* aSignatures, uint32_t index)
+{
+    while(aSignatures[index].m_Parent != index)
+    {
+        aSignatures[index].m_Parent = aSignatures[aSignatures[index].m_Parent].m_Parent;
+        index = aSignatures[index].m_Parent;
+    }
+    return index;
+}
+
+static double similarity(const signatureType* aLeft, const signatureType* aRight)
+{
+    uint32_t same = 0;
+    uint32_t j;
+
+    for(j = 0; j < MINHASH_COUNT; j++)
+        same += (aLeft->m_MinHash[j] == aRight->m_MinHash[j]);
+    return (double)same / MINHASH_COUNT;
+}
+
+static int compareBand(const void* aLeft, const void* aRight)
+{
+    const bandEntryType* left = (const bandEntryType*)aLeft;
+    const bandEntryType* right = (const bandEntryType*)aRight;
+
+    return (left->m_Key > right->m_Key) - (left->m_Key < right->m_Key);
+}
+
+/* Near-duplicate merging
+ * - Signatures that agree on every row of any band land next to each other after sorting,
+ *   each is compared with the first of its run
+*/
+static int mergeSimilar(signatureType* aSignatures, uint32_t count, double threshold)
+{
+    bandEntryType* band = malloc((size_t)count * sizeof(bandEntryType));
+    uint32_t b;
+    uint32_t i;
+
+    if(band == NULL)
+        return -1;
+    for(b = 0; b < MINHASH_BANDS; b++)
+    {
+        uint32_t first = 0;
+
+        for(i = 0; i < count; i++)
+        {
+            band[i].m_Key = fnv(FNV_OFFSET + b, &aSignatures[i].m_MinHash[b * MINHASH_ROWS], MINHASH_ROWS * sizeof(uint32_t));
+            band[i].m_Signature = i;
+        }
+        qsort(band, count, sizeof(bandEntryType), compareBand);
+        for(i = 1; i < count; i++)
+        {
+            if(band[i].m_Key != band[first].m_Key)
+            {
+                first = i;
+                continue;
+            }
+            if(similarity(&aSignatures[band[i].m_Signature], &aSignatures[band[first].m_Signature]) >= threshold)
+            {
+                uint32_t left = findRoot(aSignatures, band[i].m_Signature);
+                uint32_t right = findRoot(aSignatures, band[first].m_Signature);
+
+                if(left != right)
+                    aSignatures[left].m_Parent = right;
+            }
+        }
+    }
+    free(band);
+    return 0;
+}
+
+static int compareClusters(const void* aLeft, const void* aRight)
+{
+    const clusterType* left = (const clusterType*)aLeft;
+    const clusterType* right = (const clusterType*)aRight;
+
+    return (left->m_Count < right->m_Count) - (left->m_Count > right->m_Count);
+}
+
+static uint32_t countBuilds(uint64_t builds)
+{
+    uint32_t count = 0;
+
+    for(; builds != 0; builds &= builds - 1)
+        count++;
+    return count;
+}
+
+static void printCluster(const clusterType* aCluster, uint32_t rank, uint64_t total, const signatureType* aExample)
+{
+    const crashRecordType* record = aExample->m_Example;
+    uint32_t frames[MAX_FRAMES];
+    uint32_t count = crashArchiveBacktrace(record, frames, maxFrames);
+    uint32_t i;
+
+    printf("%-8u%10llu%8.2f%%%8u%12u  %s\n", rank, (unsigned long long)aCluster->m_Count, 100.0 * (double)aCluster->m_Count / (double)total,
+           countBuilds(aCluster->m_Builds), aCluster->m_Signatures, (record->m_Type < (sizeof(typeNames) / sizeof(typeNames[0]))) ? typeNames[record->m_Type] : "?");
+    for(i = 0; i < count; i++)
+    {
+        uint32_t offset;
+        const char* name = frameName(aExample->m_Elf, frames[i], &offset);
+
+        if(name != NULL)
+            printf("        %s+0x%x\n", name, offset);
+        else
+            printf("        %08x\n", offset);
+    }
+}
+
+static void usage(const char* aName)
+{
+    fprintf(stderr, "usage: %s [-c cache.bin] [-e firmware.elf]... [-k frames] [-j similarity] [-n clusters] record.bin [record.bin ...]\n", aName);
+}
+
+int main(int argc, char** argv)
+{
+    crashArchiveType* archives;
+    signatureType* signatures;
+    clusterType* clusters;
+    uint32_t* clusterOf;
+    const char* cachePath = NULL;
+    double threshold = DEFAULT_SIMILARITY;
+    uint32_t shown = DEFAULT_CLUSTERS;
+    uint32_t archiveCount;
+    uint32_t clusterCount = 0;
+    uint64_t total = 0;
+    struct timespec start;
+    struct timespec finish;
+    uint32_t i;
+    int option;
+
+    while((option = getopt(argc, argv, "c:e:j:k:n:")) != -1)
+    {
+        switch(option)
+        {
+            case 'c':   cachePath = optarg; break;
+            case 'e':
+                if((elfCount == MAX_ELFS) || (elf32Open(&elfs[elfCount], optarg) != 0))
+                    return 1;
+                if(elf32BuildId(&elfs[elfCount], &buildIds[elfCount], &buildIdLengths[elfCount]) != 0)
+                    buildIdLengths[elfCount] = 0;
+                buildHashes[elfCount] = decodeCacheBuildHash(buildIds[elfCount], buildIdLengths[elfCount]);
+                elfCount++;
+                break;
+            case 'j':   threshold = strtod(optarg, NULL); break;
+            case 'k':   maxFrames = (uint32_t)strtoul(optarg, NULL, 0); break;
+            case 'n':   shown = (uint32_t)strtoul(optarg, NULL, 0); break;
+            default:
+                usage(argv[0]);
+                return 2;
+        }
+    }
+    if((optind >= argc) || (maxFrames == 0) || (maxFrames > MAX_FRAMES))
+    {
+        usage(argv[0]);
+        return 2;
+    }
+
+    // The frame count changes the signature, so it is part of the decoder version.
+    if(cachePath != NULL)
+    {
+        if(decodeCacheOpen(&cache, cachePath, (DECODER_VERSION << 8) | maxFrames) != 0)
+            return 1;
+        cacheEnabled = 1;
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    archiveCount = (uint32_t)(argc - optind);
+    archives = calloc(archiveCount, sizeof(crashArchiveType));
+    if((archives == NULL) || (growTable() != 0))
+    {
+        fprintf(stderr, "out of memory\n");
+        return 1;
+    }
+    for(i = 0; i < archiveCount; i++)
+    {
+        const crashRecordType* record;
+        size_t offset = 0;
+
+        if(crashArchiveOpen(&archives[i], argv[optind + i]) != 0)
+            continue;
+        while((record = crashArchiveNext(&archives[i], &offset)) != NULL)
+        {
+            if(addRecord(record) != 0)
+            {
+                fprintf(stderr, "out of memory\n");
+                return 1;
+            }
+            total++;
+        }
+    }
+
+    // Compact the table, then merge near duplicates.
+    signatures = malloc(((size_t)signatureCount + 1) * sizeof(signatureType));
+    clusters = calloc((size_t)signatureCount + 1, sizeof(clusterType));
+    clusterOf = malloc(((size_t)signatureCount + 1) * sizeof(uint32_t));
+    if((signatures == NULL) || (clusters == NULL) || (clusterOf == NULL))
+    {
+        fprintf(stderr, "out of memory\n");
+        return 1;
+    }
+    signatureCount = 0;
+    for(i = 0; i < tableSize; i++)
+    {
+        if(table[i].m_Hash == 0)
+            continue;
+        signatures[signatureCount] = table[i];
+        signatures[signatureCount].m_Parent = signatureCount;
+        signatureCount++;
+    }
+    free(table);
+    if(mergeSimilar(signatures, signatureCount, threshold) != 0)
+    {
+        fprintf(stderr, "out of memory\n");
+        return 1;
+    }
+
+    // Root signatures become clusters, each cluster's example is its most common signature.
+    for(i = 0; i < signatureCount; i++)
+        signatures[i].m_Parent = findRoot(signatures, i);
+    for(i = 0; i < signatureCount; i++)
+    {
+        if(signatures[i].m_Parent == i)
+        {
+            clusters[clusterCount].m_Root = i;
+            clusterOf[i] = clusterCount++;
+        }
+    }
+    for(i = 0; i < signatureCount; i++)
+    {
+        clusterType* cluster = &clusters[clusterOf[signatures[i].m_Parent]];
+
+        cluster->m_Count += signatures[i].m_Count;
+        cluster->m_Builds |= signatures[i].m_Builds;
+        cluster->m_Signatures++;
+        if(signatures[i].m_Count > signatures[cluster->m_Root].m_Count)
+            cluster->m_Root = i;
+    }
+    qsort(clusters, clusterCount, sizeof(clusterType), compareClusters);
+    clock_gettime(CLOCK_MONOTONIC, &finish);
+
+    printf("%llu records, %u signatures, %u clusters, %.3f s\n", (unsigned long long)total, signatureCount, clusterCount,
+           (double)(finish.tv_sec - start.tv_sec) + ((double)(finish.tv_nsec - start.tv_nsec) / 1e9));
+    if(cacheEnabled)
+        printf("decode cache: %llu hits, %llu decoded\n", (unsigned long long)cache.m_Hits, (unsigned long long)cache.m_Misses);
+    printf("\n");
+    if(clusterCount != 0)
+        printf("%-8s%10s%9s%8s%12s  %s\n", "cluster", "records", "rate", "builds", "signatures", "type");
+    for(i = 0; (i < clusterCount) && (i < shown); i++)
+        printCluster(&clusters[i], i + 1, total, &signatures[clusters[i].m_Root]);
+
+    for(i = 0; i < archiveCount; i++)
+        crashArchiveClose(&archives[i]);
+    for(i = 0; i < elfCount; i++)
+        elf32Close(&elfs[i]);
+    if(cacheEnabled)
+        decodeCacheClose(&cache);
+    free(archives);
+    free(signatures);
+    free(clusters);
+    free(clusterOf);
+    return 0;
+}
@@ -0,0 +1,625 @@
+/*
+ * crashGdbServer.c
+ *
+ *  Created on: 18 Oct 2026
+ *
+ *  Post-mortem GDB remote serial protocol server
+ *  - Serves a crash record's registers and captured memory, anything else comes from the
+ *    ELF's read-only sections, so arm-none-eabi-gdb or an IDE can attach to a dead device
+ *  - Every record found in the given files gets its own port, counting up from -p and
+ *    skipping ports already in use, all served at once
+ *  - Build: gcc -O2 -o crashGdbServer crashGdbServer.c crashArchive.c elf32.c
+ *  - Usage: crashGdbServer [-p port] firmware.elf record.bin [record.bin ...]
+ *      then (gdb) target remote :port
+ */
+#include <errno.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "../exceptions.h"
+#include "crashArchive.h"
+#include "elf32.h"
+
+#define DEFAULT_PORT        3333
+#define MAX_RECORDS         64
+#define MAX_CLIENTS         64
+#define PACKET_SIZE         4096
+#define REGISTER_COUNT      17      // r0-r12, sp, lr, pc, xpsr.
+
+// CFSR bits used to pick a signal.
+#define CFSR_DIVBYZERO      (1u<<25)
+#define CFSR_UNDEFINSTR     (1u<<16)
+
+#define GDB_SIGILL          4
+#define GDB_SIGTRAP         5
+#define GDB_SIGFPE          8
+#define GDB_SIGSEGV         11
+#define GDB_SIGALRM         14
+
+static const char targetXml[] =
+    "<?xml version=\"1.0\"?>"
+    "<!DOCTYPE target SYSTEM \"gdb-target.dtd\">"
+    "<target version=\"1.0\">"
+    "<architecture>arm</architecture>"
+    "<feature name=\"org.gnu.gdb.arm.m-profile\">"
+    "<reg name=\"r0\" bitsize=\"32\"/><reg name=\"r1\" bitsize=\"32\"/>"
+    "<reg name=\"r2\" bitsize=\"32\"/><reg name=\"r3\" bitsize=\"32\"/>"
+    "<reg name=\"r4\" bitsize=\"32\"/><reg name=\"r5\" bitsize=\"32\"/>"
+    "<reg name=\"r6\" bitsize=\"32\"/><reg name=\"r7\" bitsize=\"32\"/>"
+    "<reg name=\"r8\" bitsize=\"32\"/><reg name=\"r9\" bitsize=\"32\"/>"
+    "<reg name=\"r10\" bitsize=\"32\"/><reg name=\"r11\" bitsize=\"32\"/>"
+    "<reg name=\"r12\" bitsize=\"32\"/>"
+    "<reg name=\"sp\" bitsize=\"32\" type=\"data_ptr\"/>"
+    "<reg name=\"lr\" bitsize=\"32\"/>"
+    "<reg name=\"pc\" bitsize=\"32\" type=\"code_ptr\"/>"
+    "<reg name=\"xpsr\" bitsize=\"32\" regnum=\"16\"/>"
+    "</feature>"
+    "</target>";
+
+typedef struct
+{
+    const crashRecordType* m_Record;
+    const char* m_Source;
+    int m_Listener;
+    int m_Port;
+} servedRecordType;
+
+typedef struct
+{
+    int m_Socket;
+    const servedRecordType* m_Served;
+    int m_NoAck;
+    char m_In[PACKET_SIZE];
+    size_t m_InLength;
+    char m_LastReply[PACKET_SIZE + 4];
+    size_t m_LastReplyLength;
+} clientType;
+
+static elf32FileType elf;
+static servedRecordType served[MAX_RECORDS];
+static uint32_t servedCount;
+static clientType clients[MAX_CLIENTS];
+static const char hexDigits[] = "0123456789abcdef";
+
+static int gdbSignal(const crashRecordType* aRecord)
+{
+    switch(aRecord->m_Type)
+    {
+        case MemMang_Fault:
+        case Bus_Fault:
+            return GDB_SIGSEGV;
+        case Usage_Fault:
+            if(aRecord->m_Cfsr & CFSR_DIVBYZERO)
+                return GDB_SIGFPE;
+            if(aRecord->m_Cfsr & CFSR_UNDEFINSTR)
+                return GDB_SIGILL;
+            return GDB_SIGSEGV;
+        case Lockup:
+        case Watchdog:
+            return GDB_SIGALRM;
+        default:
+            return GDB_SIGTRAP;
+    }
+}
+
+static uint32_t registerValue(const crashRecordType* aRecord, uint32_t index)
+{
+    if(index < 13)
+        return aRecord->m_R[index];
+    switch(index)
+    {
+        case 13:    return aRecord->m_Sp;
+        case 14:    return aRecord->m_Lr;
+        case 15:    return aRecord->m_Pc;
+        default:    return aRecord->m_Psr;
+    }
+}
+
+static char* appendHex32(char* aOut, uint32_t value)
+{
+    uint32_t i;
+
+    // Target byte order, little endian.
+    for(i = 0; i < 4; i++)
+    {
+        *aOut++ = hexDigits[(value >> ((i * 8) + 4)) & 0xFu];
+        *aOut++ = hexDigits[(value >> (i * 8)) & 0xFu];
+    }
+    *aOut = '\0';
+    return aOut;
+}
+
+static void sendRaw(clientType* aClient, const char* aData, size_t length)
+{
+    while(length > 0)
+    {
+        ssize_t sent = send(aClient->m_Socket, aData, length, MSG_NOSIGNAL);
+
+        if(sent < 0)
+        {
+            if(errno == EINTR)
+                continue;
+            return;
+        }
+        aData += sent;
+        length -= (size_t)sent;
+    }
+}
+
+static void sendPacket(clientType* aClient, const char* aPayload)
+{
+    size_t length = strlen(aPayload);
+    uint8_t checksum = 0;
+    size_t i;
+
+    if(length > PACKET_SIZE - 1)
+        length = PACKET_SIZE - 1;
+    for(i = 0; i < length; i++)
+        checksum += (uint8_t)aPayload[i];
+
+    aClient->m_LastReply[0] = '$';
+    memcpy(aClient->m_LastReply + 1, aPayload, length);
+    aClient->m_LastReply[length + 1] = '#';
+    aClient->m_LastReply[length + 2] = hexDigits[checksum >> 4];
+    aClient->m_LastReply[length + 3] = hexDigits[checksum & 0xFu];
+    aClient->m_LastReplyLength = length + 4;
+    sendRaw(aClient, aClient->m_LastReply, aClient->m_LastReplyLength);
+}
+
+static void sendStopReply(clientType* aClient)
+{
+    char reply[8];
+
+    snprintf(reply, sizeof(reply), "S%02x", gdbSignal(aClient->m_Served->m_Record));
+    sendPacket(aClient, reply);
+}
+
+/* Memory read
+ * - Captured RAM first, then the ELF's read-only sections, stopping at the first gap
+*/
+static void readMemory(clientType* aClient, const char* aArgs)
+{
+    static char reply[PACKET_SIZE];
+    uint8_t buffer[(PACKET_SIZE - 1) / 2];
+    char* end;
+    uint32_t address = (uint32_t)strtoul(aArgs, &end, 16);
+    uint32_t length;
+    uint32_t done = 0;
+    uint32_t i;
+
+    if(*end != ',')
+    {
+        sendPacket(aClient, "E01");
+        return;
+    }
+    length = (uint32_t)strtoul(end + 1, NULL, 16);
+    if(length > sizeof(buffer))
+        length = sizeof(buffer);
+
+    while(done < length)
+    {
+        uint32_t chunk = crashArchiveReadMemory(aClient->m_Served->m_Record, address + done, buffer + done, length - done);
+
+        if(chunk == 0)
+            chunk = elf32ReadMemory(&elf, address + done, buffer + done, length - done, 1);
+        if(chunk == 0)
+            break;
+        done += chunk;
+    }
+
+    if(done == 0)
+    {
+        sendPacket(aClient, "E14");
+        return;
+    }
+    for(i = 0; i < done; i++)
+    {
+        reply[i * 2] = hexDigits[buffer[i] >> 4];
+        reply[(i * 2) + 1] = hexDigits[buffer[i] & 0xFu];
+    }
+    reply[done * 2] = '\0';
+    sendPacket(aClient, reply);
+}
+
+static void readFeatures(clientType* aClient, const char* aArgs)
+{
+    static char reply[PACKET_SIZE];
+    char* end;
+    size_t offset;
+    size_t length;
+    size_t total = sizeof(targetXml) - 1;
+
+    if(strncmp(aArgs, "target.xml:", 11) != 0)
+    {
+        sendPacket(aClient, "E00");
+        return;
+    }
+    offset = strtoul(aArgs + 11, &end, 16);
+    length = (*end == ',') ? strtoul(end + 1, NULL, 16) : 0;
+    if(length > PACKET_SIZE - 2)
+        length = PACKET_SIZE - 2;
+    if(offset >= total)
+    {
+        sendPacket(aClient, "l");
+        return;
+    }
+    if(length > (total - offset))
+        length = total - offset;
+
+    reply[0] = ((offset + length) < total) ? 'm' : 'l';
+    memcpy(reply + 1, targetXml + offset, length);
+    reply[length + 1] = '\0';
+    sendPacket(aClient, reply);
+}
+
+static void handlePacket(clientType* aClient, char* aPacket)
+{
+    const crashRecordType* record = aClient->m_Served->m_Record;
+    char reply[(REGISTER_COUNT * 8) + 1];
+    char* out = reply;
+    uint32_t i;
+
+    switch(aPacket[0])
+    {
+        case '?':
+            sendStopReply(aClient);
+            break;
+        case 'g':
+            for(i = 0; i < REGISTER_COUNT; i++)
+                out = appendHex32(out, registerValue(record, i));
+            sendPacket(aClient, reply);
+            break;
+        case 'p':
+            i = (uint32_t)strtoul(aPacket + 1, NULL, 16);
+            if(i >= REGISTER_COUNT)
+                sendPacket(aClient, "E00");
+            else
+            {
+                appendHex32(out, registerValue(record, i));
+                sendPacket(aClient, reply);
+            }
+            break;
+        case 'm':
+            readMemory(aClient, aPacket + 1);
+            break;
+        case 'c':
+        case 's':
+            // Nothing can run, report the same stop again.
+            sendStopReply(aClient);
+            break;
+        case 'H':
+            sendPacket(aClient, "OK");
+            break;
+        case 'D':
+            sendPacket(aClient, "OK");
+            break;
+        case 'G':
+        case 'M':
+        case 'P':
+        case 'X':
+            sendPacket(aClient, "E01");    // The record is read-only.
+            break;
+        case 'q':
+            if(strncmp(aPacket, "qSupported", 10) == 0)
+                sendPacket(aClient, "PacketSize=fff;qXfer:features:read+;QStartNoAckMode+");
+            else if(strncmp(aPacket, "qXfer:features:read:", 20) == 0)
+                readFeatures(aClient, aPacket + 20);
+            else if(strcmp(aPacket, "qAttached") == 0)
+                sendPacket(aClient, "1");
+            else if(strcmp(aPacket, "qC") == 0)
+                sendPacket(aClient, "QC1");
+            else if(strcmp(aPacket, "qfThreadInfo") == 0)
+                sendPacket(aClient, "m1");
+            else if(strcmp(aPacket, "qsThreadInfo") == 0)
+                sendPacket(aClient, "l");
+            else if(strncmp(aPacket, "qSymbol", 7) == 0)
+                sendPacket(aClient, "OK");
+            else
+                sendPacket(aClient, "");
+            break;
+        case 'Q':
+            if(strcmp(aPacket, "QStartNoAckMode") == 0)
+            {
+                sendPacket(aClient, "OK");
+                aClient->m_NoAck = 1;
+            }
+            else
+                sendPacket(aClient, "");
+            break;
+        case 'v':
+            if(strncmp(aPacket, "vCont?", 6) == 0)
+                sendPacket(aClient, "vCont;c;s");
+            else if(strncmp(aPacket, "vCont;", 6) == 0)
+                sendStopReply(aClient);
+            else
+                sendPacket(aClient, "");
+            break;
+        default:
+            sendPacket(aClient, "");
+            break;
+    }
+}
+
+static void closeClient(clientType* aClient)
+{
+    close(aClient->m_Socket);
+    aClient->m_Socket = -1;
+}
+
+/* Check a packet's checksum
+ * - aPayload runs from after the '$' to the '#', which is followed by two hex digits
+*/
+static int checksumValid(const char* aPayload, const char* aHash)
+{
+    char digits[3] = { aHash[1], aHash[2], '\0' };
+    char* end;
+    uint8_t checksum = 0;
+    unsigned long expected = strtoul(digits, &end, 16);
+
+    if(end != digits + 2)
+        return 0;
+    for(; aPayload < aHash; aPayload++)
+        checksum += (uint8_t)*aPayload;
+    return checksum == expected;
+}
+
+/* Pull complete packets out of the input buffer
+ * - Handles acks, retransmit requests and the Ctrl-C interrupt byte
+ * - A packet with a bad checksum is dropped and answered with '-' so GDB resends it
+*/
+static void processInput(clientType* aClient)
+{
+    size_t start = 0;
+
+    while(start < aClient->m_InLength)
+    {
+        char c = aClient->m_In[start];
+        char* hash;
+        size_t end;
+
+        if(c == '+')
+        {
+            start++;
+            continue;
+        }
+        if(c == '-')
+        {
+            sendRaw(aClient, aClient->m_LastReply, aClient->m_LastReplyLength);
+            start++;
+            continue;
+        }
+        if(c == 0x03)
+        {
+            sendStopReply(aClient);
+            start++;
+            continue;
+        }
+        if(c != '$')
+        {
+            start++;
+            continue;
+        }
+
+        hash = memchr(aClient->m_In + start, '#', aClient->m_InLength - start);
+        if((hash == NULL) || ((size_t)(hash - aClient->m_In) + 3u > aClient->m_InLength))
+            break;  // Incomplete.
+
+        end = (size_t)(hash - aClient->m_In);
+        if(!checksumValid(aClient->m_In + start + 1, hash))
+        {
+            // With no-ack mode on GDB won't resend, the packet is just lost.
+            if(!aClient->m_NoAck)
+                sendRaw(aClient, "-", 1);
+            start = end + 3u;
+            continue;
+        }
+        *hash = '\0';
+        if(!aClient->m_NoAck)
+            sendRaw(aClient, "+", 1);
+        if(aClient->m_In[start + 1] == 'k')
+        {
+            closeClient(aClient);
+            return;
+        }
+        handlePacket(aClient, aClient->m_In + start + 1);
+        if(aClient->m_In[start + 1] == 'D')
+        {
+            closeClient(aClient);
+            return;
+        }
+        start = end + 3u;
+    }
+
+    memmove(aClient->m_In, aClient->m_In + start, aClient->m_InLength - start);
+    aClient->m_InLength -= start;
+    if(aClient->m_InLength == sizeof(aClient->m_In))
+        aClient->m_InLength = 0;    // Oversized packet, drop it.
+}
+
+static int openListener(int port)
+{
+    struct sockaddr_in address;
+    int one = 1;
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+
+    if(fd < 0)
+        return -1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+
+    memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    address.sin_port = htons((uint16_t)port);
+    if((bind(fd, (struct sockaddr*)&address, sizeof(address)) != 0) || (listen(fd, 4) != 0))
+    {
+        int error = errno;
+
+        close(fd);
+        errno = error;
+        return -1;
+    }
+    return fd;
+}
+
+static void acceptClient(const servedRecordType* aServed)
+{
+    int one = 1;
+    int fd = accept(aServed->m_Listener, NULL, NULL);
+    uint32_t i;
+
+    if(fd < 0)
+        return;
+    for(i = 0; i < MAX_CLIENTS; i++)
+    {
+        if(clients[i].m_Socket < 0)
+        {
+            memset(&clients[i], 0, sizeof(clients[i]));
+            clients[i].m_Socket = fd;
+            clients[i].m_Served = aServed;
+            setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+            printf("port %d: client connected\n", aServed->m_Port);
+            return;
+        }
+    }
+    close(fd);
+}
+
+/* Poll the listeners and clients
+ * - New connections are accepted once every client has been read, a slot freed by a client
+ *   closing is only reused after the pass over fds[] that saw it close
+*/
+static void serve(void)
+{
+    struct pollfd fds[MAX_RECORDS + MAX_CLIENTS];
+    clientType* owners[MAX_RECORDS + MAX_CLIENTS];
+
+    for(;;)
+    {
+        nfds_t count = 0;
+        nfds_t i;
+
+        for(i = 0; i < servedCount; i++)
+        {
+            fds[count].fd = served[i].m_Listener;
+            fds[count].events = POLLIN;
+            owners[count++] = NULL;
+        }
+        for(i = 0; i < MAX_CLIENTS; i++)
+        {
+            if(clients[i].m_Socket < 0)
+                continue;
+            fds[count].fd = clients[i].m_Socket;
+            fds[count].events = POLLIN;
+            owners[count++] = &clients[i];
+        }
+
+        if(poll(fds, count, -1) < 0)
+        {
+            if(errno == EINTR)
+                continue;
+            perror("poll");
+            return;
+        }
+
+        for(i = 0; i < count; i++)
+        {
+            clientType* client = owners[i];
+            ssize_t received;
+
+            if((client == NULL) || !(fds[i].revents & (POLLIN | POLLHUP | POLLERR)))
+                continue;
+
+            received = recv(client->m_Socket, client->m_In + client->m_InLength, sizeof(client->m_In) - client->m_InLength, 0);
+            if(received <= 0)
+            {
+                closeClient(client);
+                continue;
+            }
+            client->m_InLength += (size_t)received;
+            processInput(client);
+        }
+
+        // Listeners come first in fds[].
+        for(i = 0; i < servedCount; i++)
+        {
+            if(fds[i].revents & POLLIN)
+                acceptClient(&served[i]);
+        }
+    }
+}
+
+int main(int argc, char** argv)
+{
+    static crashArchiveType archives[MAX_RECORDS];
+    int port = DEFAULT_PORT;
+    int argument = 1;
+    uint32_t archiveCount = 0;
+    uint32_t i;
+
+    if((argc > 2) && (strcmp(argv[1], "-p") == 0))
+    {
+        port = atoi(argv[2]);
+        argument = 3;
+    }
+    if((argc - argument) < 2)
+    {
+        fprintf(stderr, "usage: %s [-p port] firmware.elf record.bin [record.bin ...]\n", argv[0]);
+        return 2;
+    }
+    if(elf32Open(&elf, argv[argument++]) != 0)
+        return 1;
+
+    for(i = 0; i < MAX_CLIENTS; i++)
+        clients[i].m_Socket = -1;
+
+    for(; (argument < argc) && (archiveCount < MAX_RECORDS); argument++)
+    {
+        crashArchiveType* archive = &archives[archiveCount];
+        const crashRecordType* record;
+        size_t offset = 0;
+
+        if(crashArchiveOpen(archive, argv[argument]) != 0)
+            continue;
+        archiveCount++;
+
+        while(((record = crashArchiveNext(archive, &offset)) != NULL) && (servedCount < MAX_RECORDS))
+        {
+            servedRecordType* entry = &served[servedCount];
+
+            entry->m_Record = record;
+            entry->m_Source = argv[argument];
+            // A port already in use is skipped, the record gets the next free one.
+            do
+            {
+                entry->m_Port = port++;
+                entry->m_Listener = openListener(entry->m_Port);
+            } while((entry->m_Listener < 0) && (errno == EADDRINUSE) && (port <= 65535));
+            if(entry->m_Listener < 0)
+            {
+                fprintf(stderr, "port %d: %s\n", entry->m_Port, strerror(errno));
+                continue;
+            }
+            printf("port %d: %s record %u, type %u, PC=%08x\n", entry->m_Port, entry->m_Source,
+                   record->m_Sequence, record->m_Type, record->m_Pc);
+            servedCount++;
+        }
+    }
+    if(servedCount == 0)
+    {
+        fprintf(stderr, "no valid crash records found\n");
+        return 1;
+    }
+    fflush(stdout);
+
+    signal(SIGPIPE, SIG_IGN);
+    serve();
+    return 0;
+}
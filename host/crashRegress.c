@@ -0,0 +1,606 @@
+/*
+ * crashRegress.c
+ *
+ *  Created on: 18 Oct 2026
+ *
+ *  Crash rate regressions between firmware releases
+ *  - Counts records per (build-id, fingerprint), the fingerprint being the fault type and
+ *    the function names of the top frames, so it is the same in every build given its ELF
+ *  - Every build counted needs its ELF with -e, reading an archive stops at a record from
+ *    any other build until a run is given it, so the state file only holds name fingerprints
+ *  - Counts are kept in a state file along with how far each archive has been read, a run
+ *    only reads records appended since the last one
+ *  - Rates are per unit-hour from an exposure file, one "build-id unit-hours" line per
+ *    release (a leading part of the build-id is enough), the last two being the candidate
+ *    and the baseline unless -b and -c say otherwise
+ *  - An increase is flagged when the exact conditional test for two Poisson rates (the
+ *    candidate's share of the combined count against its share of the exposure) gives a
+ *    p-value below alpha divided by the number of fingerprints tested
+ *  - Build: gcc -O2 -o crashRegress crashRegress.c crashArchive.c elf32.c -lm
+ *  - Usage: crashRegress -s state.txt -u exposure.txt [-e firmware.elf]... [-k frames] [-a alpha]
+ *           [-b build-id] [-c build-id] [archive.bin ...]
+ */
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "../exceptions.h"
+#include "crashArchive.h"
+#include "elf32.h"
+
+#define MAX_ELFS            64u
+#define MAX_VERSIONS        256u
+#define MAX_ARCHIVES        1024u
+#define MAX_FRAMES          8u
+#define DEFAULT_FRAMES      3u
+#define DEFAULT_ALPHA       0.001
+#define ID_LENGTH           41u         // 20 byte build-id in hex.
+#define DESCRIPTION_LENGTH  160u
+#define LINE_LENGTH         2048u
+#define FNV_OFFSET          0xCBF29CE484222325ull
+#define FNV_PRIME           0x100000001B3ull
+
+typedef struct
+{
+    uint64_t m_Fingerprint;     // 0 marks a free slot.
+    uint32_t m_Version;
+    uint64_t m_Count;
+    char m_Description[DESCRIPTION_LENGTH];
+} countType;
+
+typedef struct
+{
+    char m_Path[LINE_LENGTH];
+    uint64_t m_Offset;          // Bytes already counted.
+} archiveStateType;
+
+typedef struct
+{
+    char m_Id[ID_LENGTH];
+    double m_UnitHours;
+} exposureType;
+
+static elf32FileType elfs[MAX_ELFS];
+static const uint8_t* elfIds[MAX_ELFS];
+static uint32_t elfIdLengths[MAX_ELFS];
+static uint32_t elfCount;
+static uint32_t maxFrames = DEFAULT_FRAMES;
+
+static char versions[MAX_VERSIONS][ID_LENGTH];     // Build-ids seen, in hex.
+static uint32_t versionCount;
+static archiveStateType archives[MAX_ARCHIVES];
+static uint32_t archiveCount;
+static exposureType exposures[MAX_VERSIONS];
+static uint32_t exposureCount;
+
+static countType* counts;           // Open addressing on fingerprint and version.
+static uint32_t countSize;
+static uint32_t countUsed;
+
+static const char* const typeNames[] =
+{
+    "Hard_Fault", "MemMang_Fault", "Bus_Fault", "Usage_Fault", "Lockup", "Watchdog", "Integrity"
+};
+
+static uint64_t fnvString(uint64_t hash, const char* aString)
+{
+    while(*aString != '\0')
+        hash = (hash ^ (uint8_t)*aString++) * FNV_PRIME;
+    return hash;
+}
+
+static uint32_t slotOf(uint64_t fingerprint, uint32_t version)
+{
+    uint64_t key = fingerprint ^ ((uint64_t)(version + 1u) * 0x9E3779B97F4A7C15ull);
+
+    return (uint32_t)(key ^ (key >> 32)) & (countSize - 1u);
+}
+
+static int growCounts(void)
+{
+    countType* old = counts;
+    uint32_t oldSize = countSize;
+    uint32_t i;
+
+    countSize = (countSize != 0) ? (countSize * 2u) : 1024u;
+    counts = calloc(countSize, sizeof(countType));
+    if(counts == NULL)
+        return -1;
+    for(i = 0; i < oldSize; i++)
+    {
+        uint32_t slot;
+
+        if(old[i].m_Fingerprint == 0)
+            continue;
+        for(slot = slotOf(old[i].m_Fingerprint, old[i].m_Version); counts[slot].m_Fingerprint != 0; slot = (slot + 1u) & (countSize - 1u))
+            ;
+        counts[slot] = old[i];
+    }
+    free(old);
+    return 0;
+}
+
+static countType* findCount(uint64_t fingerprint, uint32_t version, const char* aDescription)
+{
+    uint32_t slot;
+
+    for(slot = slotOf(fingerprint, version); counts[slot].m_Fingerprint != 0; slot = (slot + 1u) & (countSize - 1u))
+    {
+        if((counts[slot].m_Fingerprint == fingerprint) && (counts[slot].m_Version == version))
+            return &counts[slot];
+    }
+    if(aDescription == NULL)
+        return NULL;
+
+    // Only inserting grows the table, so lookups keep earlier pointers valid.
+    if(((countUsed + 1u) * 2u) > countSize)
+    {
+        if(growCounts() != 0)
+            return NULL;
+        for(slot = slotOf(fingerprint, version); counts[slot].m_Fingerprint != 0; slot = (slot + 1u) & (countSize - 1u))
+            ;
+    }
+    counts[slot].m_Fingerprint = fingerprint;
+    counts[slot].m_Version = version;
+    snprintf(counts[slot].m_Description, DESCRIPTION_LENGTH, "%s", aDescription);
+    countUsed++;
+    return &counts[slot];
+}
+
+static int findVersion(const char* aId)
+{
+    uint32_t i;
+
+    for(i = 0; i < versionCount; i++)
+    {
+        if(strcmp(versions[i], aId) == 0)
+            return (int)i;
+    }
+    if(versionCount == MAX_VERSIONS)
+        return -1;
+    snprintf(versions[versionCount], ID_LENGTH, "%s", aId);
+    return (int)versionCount++;
+}
+
+/* Build-id as hex, "unknown" if the record has none
+ * - Returns the matching ELF, or elfCount
+*/
+static uint32_t recordVersion(const crashRecordType* aRecord, char* aId)
+{
+    const uint8_t* id;
+    uint32_t length = crashArchiveBuildId(aRecord, &id);
+    uint32_t i;
+
+    if(length == 0)
+    {
+        strcpy(aId, "unknown");
+        return (elfCount == 1) ? 0 : elfCount;
+    }
+    if(length > ((ID_LENGTH - 1u) / 2u))
+        length = (ID_LENGTH - 1u) / 2u;
+    for(i = 0; i < length; i++)
+        sprintf(aId + (i * 2u), "%02x", id[i]);
+    for(i = 0; i < elfCount; i++)
+    {
+        if((elfIdLengths[i] >= length) && (memcmp(elfIds[i], id, length) == 0))
+            return i;
+    }
+    return elfCount;
+}
+
+/* Fingerprint of a record
+ * - Type and function names, no offsets, so it survives a rebuild
+ * - Frames outside the ELF's functions are hashed as addresses
+*/
+static uint64_t fingerprint(const crashRecordType* aRecord, uint32_t elf, char* aDescription)
+{
+    uint32_t frames[MAX_FRAMES];
+    uint32_t count = crashArchiveBacktrace(aRecord, frames, maxFrames);
+    const char* type = (aRecord->m_Type < (sizeof(typeNames) / sizeof(typeNames[0]))) ? typeNames[aRecord->m_Type] : "?";
+    uint64_t hash = fnvString(FNV_OFFSET, type);
+    size_t used = (size_t)snprintf(aDescription, DESCRIPTION_LENGTH, "%s", type);
+    uint32_t i;
+
+    for(i = 0; i < count; i++)
+    {
+        const elf32FunctionType* function = (elf < elfCount) ? elf32FindFunction(&elfs[elf], frames[i]) : NULL;
+        char address[12];
+        const char* name = function ? function->m_Name : address;
+
+        if(function == NULL)
+            snprintf(address, sizeof(address), "%08x", frames[i] & ~1u);
+        hash = fnvString(hash * FNV_PRIME, name);
+        if(used < DESCRIPTION_LENGTH)
+            used += (size_t)snprintf(aDescription + used, DESCRIPTION_LENGTH - used, "%s%s", (i == 0) ? " " : "<", name);
+    }
+    return (hash != 0) ? hash : 1;
+}
+
+/* State file
+ * - "archive offset path" and "count build-id fingerprint count description" lines
+*/
+static int loadState(const char* aPath)
+{
+    char line[LINE_LENGTH];
+    FILE* file = fopen(aPath, "r");
+
+    if(file == NULL)
+        return 0;
+    while(fgets(line, sizeof(line), file) != NULL)
+    {
+        unsigned long long offset;
+        unsigned long long number;
+        unsigned long long value;
+        char id[ID_LENGTH];
+        int consumed = 0;
+
+        line[strcspn(line, "\r\n")] = '\0';
+        if((sscanf(line, "archive %llu %n", &offset, &consumed) == 1) && (consumed != 0) && (archiveCount < MAX_ARCHIVES))
+        {
+            snprintf(archives[archiveCount].m_Path, LINE_LENGTH, "%s", line + consumed);
+            archives[archiveCount++].m_Offset = offset;
+        }
+        else if((sscanf(line, "count %40s %llx %llu %n", id, &value, &number, &consumed) == 3) && (consumed != 0))
+        {
+            int version = findVersion(id);
+            countType* entry = (version >= 0) ? findCount(value, (uint32_t)version, line + consumed) : NULL;
+
+            if(entry == NULL)
+            {
+                fclose(file);
+                return -1;
+            }
+            entry->m_Count += number;
+        }
+    }
+    fclose(file);
+    return 0;
+}
+
+static int saveState(const char* aPath)
+{
+    char temporary[LINE_LENGTH + 8];
+    FILE* file;
+    uint32_t i;
+
+    snprintf(temporary, sizeof(temporary), "%s.tmp", aPath);
+    file = fopen(temporary, "w");
+    if(file == NULL)
+    {
+        perror(temporary);
+        return -1;
+    }
+    for(i = 0; i < archiveCount; i++)
+        fprintf(file, "archive %llu %s\n", (unsigned long long)archives[i].m_Offset, archives[i].m_Path);
+    for(i = 0; i < countSize; i++)
+    {
+        if(counts[i].m_Fingerprint != 0)
+            fprintf(file, "count %s %016llx %llu %s\n", versions[counts[i].m_Version], (unsigned long long)counts[i].m_Fingerprint,
+                    (unsigned long long)counts[i].m_Count, counts[i].m_Description);
+    }
+    if((fclose(file) != 0) || (rename(temporary, aPath) != 0))
+    {
+        perror(aPath);
+        return -1;
+    }
+    return 0;
+}
+
+static int loadExposure(const char* aPath)
+{
+    char line[LINE_LENGTH];
+    FILE* file = fopen(aPath, "r");
+
+    if(file == NULL)
+    {
+        perror(aPath);
+        return -1;
+    }
+    while((fgets(line, sizeof(line), file) != NULL) && (exposureCount < MAX_VERSIONS))
+    {
+        exposureType* exposure = &exposures[exposureCount];
+
+        if((line[0] != '#') && (sscanf(line, "%40s %lf", exposure->m_Id, &exposure->m_UnitHours) == 2) && (exposure->m_UnitHours > 0))
+            exposureCount++;
+    }
+    fclose(file);
+    return 0;
+}
+
+/* Read the records appended to an archive since the last run
+ * - An archive that shrank was replaced, it is read from the start
+ * - Stops at a record whose build has no ELF, its fingerprint would be addresses rather than
+ *   function names and never match the same crash counted with the ELF; the state file keeps
+ *   the offset before it, so a run given the ELF carries on from there
+ * - Returns 0, 1 if it stopped at such a record, or -1
+*/
+static int scanArchive(const char* aPath, uint64_t* aNew)
+{
+    archiveStateType* state = NULL;
+    crashArchiveType archive;
+    const crashRecordType* record;
+    size_t offset;
+    uint32_t i;
+
+    for(i = 0; i < archiveCount; i++)
+    {
+        if(strcmp(archives[i].m_Path, aPath) == 0)
+            state = &archives[i];
+    }
+    if(state == NULL)
+    {
+        if(archiveCount == MAX_ARCHIVES)
+            return -1;
+        state = &archives[archiveCount++];
+        snprintf(state->m_Path, LINE_LENGTH, "%s", aPath);
+        state->m_Offset = 0;
+    }
+
+    if(crashArchiveOpen(&archive, aPath) != 0)
+        return -1;
+    if(archive.m_Size < state->m_Offset)
+        state->m_Offset = 0;
+    offset = (size_t)state->m_Offset;
+    while((record = crashArchiveNext(&archive, &offset)) != NULL)
+    {
+        char id[ID_LENGTH];
+        char description[DESCRIPTION_LENGTH];
+        uint32_t elf = recordVersion(record, id);
+        uint64_t value;
+        int version;
+        countType* entry;
+
+        if(elf == elfCount)
+        {
+            fprintf(stderr, "%s: record %u is from build %s, stopped until its ELF is given with -e\n", aPath, record->m_Sequence, id);
+            crashArchiveClose(&archive);
+            return 1;
+        }
+        value = fingerprint(record, elf, description);
+        version = findVersion(id);
+        entry = (version >= 0) ? findCount(value, (uint32_t)version, description) : NULL;
+        if(entry == NULL)
+        {
+            crashArchiveClose(&archive);
+            return -1;
+        }
+        entry->m_Count++;
+        state->m_Offset = offset;
+        (*aNew)++;
+    }
+    // Resuming after the last whole record picks up one still being appended.
+    crashArchiveClose(&archive);
+    return 0;
+}
+
+/* Records and unit-hours for a release
+ * - Every build-id starting with the exposure's id counts
+*/
+static uint64_t releaseCount(const exposureType* aRelease, uint64_t fingerprint)
+{
+    uint64_t total = 0;
+    size_t length = strlen(aRelease->m_Id);
+    uint32_t i;
+
+    for(i = 0; i < versionCount; i++)
+    {
+        const countType* entry;
+
+        if(strncmp(versions[i], aRelease->m_Id, length) != 0)
+            continue;
+        entry = findCount(fingerprint, i, NULL);
+        if(entry != NULL)
+            total += entry->m_Count;
+    }
+    return total;
+}
+
+/* P(X >= k) for X ~ Binomial(n, p)
+ * - Summed in log space from k, terms fall off quickly once past the mean
+*/
+static double binomialTail(uint64_t k, uint64_t n, double p)
+{
+    double sum = 0.0;
+    uint64_t i;
+
+    if(k == 0)
+        return 1.0;
+    if(p >= 1.0)
+        return 1.0;
+    for(i = k; i <= n; i++)
+    {
+        double term = exp(lgamma((double)n + 1.0) - lgamma((double)i + 1.0) - lgamma((double)(n - i) + 1.0) +
+                          ((double)i * log(p)) + ((double)(n - i) * log1p(-p)));
+
+        sum += term;
+        if((term < (sum * 1e-12)) && ((double)i > ((double)n * p)))
+            break;
+    }
+    return (sum < 1.0) ? sum : 1.0;
+}
+
+static const exposureType* findRelease(const char* aId)
+{
+    uint32_t i;
+
+    for(i = 0; i < exposureCount; i++)
+    {
+        if(strcmp(exposures[i].m_Id, aId) == 0)
+            return &exposures[i];
+    }
+    fprintf(stderr, "%s: not in the exposure file\n", aId);
+    return NULL;
+}
+
+typedef struct
+{
+    const countType* m_Entry;
+    uint64_t m_Baseline;
+    uint64_t m_Candidate;
+    double m_P;
+} resultType;
+
+static int compareEntries(const void* aLeft, const void* aRight)
+{
+    uint64_t left = (*(const countType* const*)aLeft)->m_Fingerprint;
+    uint64_t right = (*(const countType* const*)aRight)->m_Fingerprint;
+
+    return (left > right) - (left < right);
+}
+
+static int compareResults(const void* aLeft, const void* aRight)
+{
+    const resultType* left = (const resultType*)aLeft;
+    const resultType* right = (const resultType*)aRight;
+
+    return (left->m_P > right->m_P) - (left->m_P < right->m_P);
+}
+
+/* Compare the candidate release with the baseline
+ * - Returns the number of fingerprints flagged
+*/
+static int report(const exposureType* aBaseline, const exposureType* aCandidate, double alpha)
+{
+    resultType* results = calloc(countUsed + 1u, sizeof(resultType));
+    const countType** entries = calloc(countUsed + 1u, sizeof(const countType*));
+    double share = aCandidate->m_UnitHours / (aCandidate->m_UnitHours + aBaseline->m_UnitHours);
+    uint32_t entryCount = 0;
+    uint32_t resultCount = 0;
+    uint32_t flagged = 0;
+    uint32_t i;
+
+    if((results == NULL) || (entries == NULL))
+    {
+        free(results);
+        free(entries);
+        return -1;
+    }
+
+    // One result per fingerprint, the versions it was counted in sit next to each other once sorted.
+    for(i = 0; i < countSize; i++)
+    {
+        if(counts[i].m_Fingerprint != 0)
+            entries[entryCount++] = &counts[i];
+    }
+    qsort(entries, entryCount, sizeof(const countType*), compareEntries);
+    for(i = 0; i < entryCount; i++)
+    {
+        resultType* result = &results[resultCount];
+
+        if((i != 0) && (entries[i]->m_Fingerprint == entries[i - 1u]->m_Fingerprint))
+            continue;
+        result->m_Entry = entries[i];
+        result->m_Baseline = releaseCount(aBaseline, entries[i]->m_Fingerprint);
+        result->m_Candidate = releaseCount(aCandidate, entries[i]->m_Fingerprint);
+        if((result->m_Baseline + result->m_Candidate) == 0)
+            continue;
+        result->m_P = binomialTail(result->m_Candidate, result->m_Baseline + result->m_Candidate, share);
+        resultCount++;
+    }
+    free(entries);
+    qsort(results, resultCount, sizeof(resultType), compareResults);
+
+    printf("baseline %s, %.0f unit-hours\ncandidate %s, %.0f unit-hours\n\n", aBaseline->m_Id, aBaseline->m_UnitHours,
+           aCandidate->m_Id, aCandidate->m_UnitHours);
+    printf("%10s %10s %12s %12s %10s  %s\n", "baseline", "candidate", "base/1k h", "cand/1k h", "p", "fingerprint");
+    for(i = 0; i < resultCount; i++)
+    {
+        const resultType* result = &results[i];
+        int significant = (result->m_P < (alpha / resultCount)) &&
+                          (((double)result->m_Candidate / aCandidate->m_UnitHours) > ((double)result->m_Baseline / aBaseline->m_UnitHours));
+
+        flagged += significant;
+        printf("%10llu %10llu %12.4f %12.4f %10.2e  %s%s\n", (unsigned long long)result->m_Baseline, (unsigned long long)result->m_Candidate,
+               1000.0 * (double)result->m_Baseline / aBaseline->m_UnitHours, 1000.0 * (double)result->m_Candidate / aCandidate->m_UnitHours,
+               result->m_P, result->m_Entry->m_Description, significant ? (result->m_Baseline ? "  INCREASED" : "  NEW") : "");
+    }
+    printf("\n%u of %u fingerprints increased significantly (alpha %g)\n", flagged, resultCount, alpha);
+    free(results);
+    return (int)flagged;
+}
+
+static void usage(const char* aName)
+{
+    fprintf(stderr, "usage: %s -s state.txt -u exposure.txt [-e firmware.elf]... [-k frames] [-a alpha] [-b build-id] [-c build-id] [archive.bin ...]\n", aName);
+}
+
+int main(int argc, char** argv)
+{
+    const char* statePath = NULL;
+    const char* exposurePath = NULL;
+    const char* baselineId = NULL;
+    const char* candidateId = NULL;
+    const exposureType* baseline;
+    const exposureType* candidate;
+    double alpha = DEFAULT_ALPHA;
+    uint64_t added = 0;
+    uint32_t stopped = 0;
+    int flagged;
+    int scanned;
+    int option;
+
+    while((option = getopt(argc, argv, "a:b:c:e:k:s:u:")) != -1)
+    {
+        switch(option)
+        {
+            case 'a':   alpha = strtod(optarg, NULL); break;
+            case 'b':   baselineId = optarg; break;
+            case 'c':   candidateId = optarg; break;
+            case 'e':
+                if((elfCount == MAX_ELFS) || (elf32Open(&elfs[elfCount], optarg) != 0))
+                    return 1;
+                if(elf32BuildId(&elfs[elfCount], &elfIds[elfCount], &elfIdLengths[elfCount]) != 0)
+                    elfIdLengths[elfCount] = 0;
+                elfCount++;
+                break;
+            case 'k':   maxFrames = (uint32_t)strtoul(optarg, NULL, 0); break;
+            case 's':   statePath = optarg; break;
+            case 'u':   exposurePath = optarg; break;
+            default:
+                usage(argv[0]);
+                return 2;
+        }
+    }
+    if((statePath == NULL) || (exposurePath == NULL) || (maxFrames == 0) || (maxFrames > MAX_FRAMES))
+    {
+        usage(argv[0]);
+        return 2;
+    }
+
+    if((growCounts() != 0) || (loadState(statePath) != 0) || (loadExposure(exposurePath) != 0))
+    {
+        fprintf(stderr, "%s: can't load\n", statePath);
+        return 1;
+    }
+    for(; optind < argc; optind++)
+    {
+        scanned = scanArchive(argv[optind], &added);
+        if(scanned < 0)
+        {
+            fprintf(stderr, "%s: can't read\n", argv[optind]);
+            return 1;
+        }
+        stopped += (uint32_t)scanned;
+    }
+    if(saveState(statePath) != 0)
+        return 1;
+    printf("%llu new records\n", (unsigned long long)added);
+    if(stopped != 0)
+        printf("%u archives not read to the end, counts are incomplete\n", stopped);
+
+    if(exposureCount < 2)
+    {
+        fprintf(stderr, "%s: need two releases to compare\n", exposurePath);
+        return 1;
+    }
+    baseline = baselineId ? findRelease(baselineId) : &exposures[exposureCount - 2];
+    candidate = candidateId ? findRelease(candidateId) : &exposures[exposureCount - 1];
+    if((baseline == NULL) || (candidate == NULL))
+        return 1;
+    flagged = report(baseline, candidate, alpha);
+    return ((flagged != 0) || (stopped != 0)) ? 1 : 0;
+}
@@ -0,0 +1,242 @@
+/*
+ * crashReplay.c
+ *
+ *  Created on: 18 Oct 2026
+ *
+ *  Crash record replay on the Thumb-2 emulator
+ *  - Default: restart at the faulting PC with the record's registers and memory, and
+ *    report whether the same fault comes back
+ *  - -s: enter the firmware's own fault handler with the record's fault status, run it to
+ *    its BKPT or reset, and check the crash record it writes
+ *  - -p starts somewhere else (the top of the faulting function, say) with the same state,
+ *    -t traces each instruction with its function and offset
+ *  - Build: gcc -O2 -o crashReplay crashReplay.c thumbEmuTarget.c thumbEmu.c crashArchive.c elf32.c -lm
+ *  - Usage: crashReplay [-n count] [-s] [-t] [-v] [-p address] firmware.elf record.bin [record.bin ...]
+ */
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "../exceptions.h"
+#include "crashArchive.h"
+#include "elf32.h"
+#include "thumbEmuTarget.h"
+
+#define DEFAULT_COUNT       1000u
+
+// Fault status that says the same thing happened.
+#define CFSR_BFARVALID      (1u<<15)
+#define CFSR_MMARVALID      (1u<<7)
+
+typedef struct
+{
+    uint64_t m_Count;
+    uint32_t m_StartPc;
+    int m_HasStartPc;
+    int m_Synthetic;
+    int m_Trace;
+} replayOptionsType;
+
+static const char* const stopNames[] =
+{
+    "instruction limit",
+    "breakpoint",
+    "lockup",
+    "reset requested",
+    "sleeping",
+    "watch"
+};
+
+static elf32FileType elf;
+static thumbEmuTargetType target;
+
+static void printLocation(uint32_t address)
+{
+    const elf32FunctionType* function = elf32FindFunction(&elf, address);
+
+    if(function != NULL)
+        printf("%08x %s+0x%x", address, function->m_Name, address - function->m_Address);
+    else
+        printf("%08x", address);
+}
+
+static void printTrace(const thumbEmuType* aEmu, uint32_t pc)
+{
+    uint32_t hw1 = 0;
+    uint32_t hw2 = 0;
+
+    thumbEmuRead((thumbEmuType*)aEmu, pc, 2, &hw1);
+    printf("  ");
+    printLocation(pc);
+    if(hw1 >= 0xE800u)
+    {
+        thumbEmuRead((thumbEmuType*)aEmu, pc + 2, 2, &hw2);
+        printf("  %04x %04x\n", hw1, hw2);
+    }
+    else
+        printf("  %04x\n", hw1);
+}
+
+/* Step until a fault handler is entered
+ * - Returns the exception number, or 0 when the budget ran out or the core stopped
+*/
+static uint32_t runToFault(thumbEmuType* aEmu, const replayOptionsType* aOptions, thumbEmuStopType* aStop)
+{
+    uint64_t i;
+
+    *aStop = ThumbEmu_Limit;
+    for(i = 0; i < aOptions->m_Count; i++)
+    {
+        uint32_t pc = aEmu->m_R[15];
+        uint32_t before = aEmu->m_Ipsr;
+
+        if(aOptions->m_Trace)
+            printTrace(aEmu, pc);
+        *aStop = thumbEmuRun(aEmu, 1);
+        if((aEmu->m_Ipsr != before) && (aEmu->m_Ipsr >= THUMB_EMU_HARD_FAULT) && (aEmu->m_Ipsr <= THUMB_EMU_USAGE_FAULT) &&
+           aEmu->m_Active[aEmu->m_Ipsr])
+            return aEmu->m_Ipsr;
+        if(*aStop != ThumbEmu_Limit)
+            return 0;
+    }
+    return 0;
+}
+
+static int reproduce(const crashRecordType* aRecord, const replayOptionsType* aOptions)
+{
+    thumbEmuType* emu = &target.m_Emu;
+    uint32_t expected = thumbEmuTargetException(aRecord->m_Type);
+    thumbEmuStopType stop;
+    uint32_t exception;
+    int same;
+
+    exception = runToFault(emu, aOptions, &stop);
+    if(exception == 0)
+    {
+        printf("  no fault after %llu instructions, stopped on %s at ", (unsigned long long)emu->m_Instructions, stopNames[stop]);
+        printLocation(emu->m_R[15]);
+        printf("\n");
+        return 1;
+    }
+
+    same = (exception == expected) && ((emu->m_Cfsr & aRecord->m_Cfsr) != 0);
+    if(same && (aRecord->m_Cfsr & CFSR_BFARVALID))
+        same = (emu->m_Bfar == aRecord->m_Bfar);
+    if(same && (aRecord->m_Cfsr & CFSR_MMARVALID))
+        same = (emu->m_Mmfar == aRecord->m_Mmfar);
+
+    printf("  exception %u after %llu instructions, CFSR=%08x HFSR=%08x BFAR=%08x MMFAR=%08x\n", exception,
+           (unsigned long long)emu->m_Instructions, emu->m_Cfsr, emu->m_Hfsr, emu->m_Bfar, emu->m_Mmfar);
+    printf("  %s\n", same ? "reproduced" : "different fault");
+    if(target.m_IoReads != 0)
+        printf("  %llu peripheral reads returned 0, replay may have diverged\n", (unsigned long long)target.m_IoReads);
+    return same ? 0 : 1;
+}
+
+/* Synthetic fault
+ * - The handler runs from the fault status in the record, with the faulting context as
+ *   the exception frame, and should end writing a crash record of its own
+*/
+static int synthetic(const crashRecordType* aRecord, const replayOptionsType* aOptions)
+{
+    thumbEmuType* emu = &target.m_Emu;
+    const crashRecordType* written = (const crashRecordType*)(target.m_Ram + (CRASH_RECORD_ADDRESS - THUMB_EMU_TARGET_RAM_BASE));
+    thumbEmuStopType stop = ThumbEmu_Limit;
+    uint32_t address = (aRecord->m_Cfsr & CFSR_BFARVALID) ? aRecord->m_Bfar : aRecord->m_Mmfar;
+    uint64_t i;
+
+    emu->m_Hfsr = aRecord->m_Hfsr;
+    thumbEmuFault(emu, thumbEmuTargetException(aRecord->m_Type), aRecord->m_Cfsr, address);
+    for(i = 0; (i < aOptions->m_Count) && (stop == ThumbEmu_Limit); i++)
+    {
+        if(aOptions->m_Trace)
+            printTrace(emu, emu->m_R[15]);
+        stop = thumbEmuRun(emu, 1);
+    }
+
+    printf("  handler stopped on %s after %llu instructions at ", stopNames[stop], (unsigned long long)emu->m_Instructions);
+    printLocation(emu->m_R[15]);
+    printf("\n");
+
+    if(crashArchiveValidate((const uint8_t*)written, CRASH_RECORD_SIZE) == 0)
+    {
+        printf("  no crash record written\n");
+        return 1;
+    }
+    printf("  record written: type %u, PC=%08x, CFSR=%08x, %u bytes\n", written->m_Type, written->m_Pc, written->m_Cfsr, written->m_Size);
+    if((written->m_Type != aRecord->m_Type) || (written->m_Pc != aRecord->m_Pc) || (written->m_Cfsr != aRecord->m_Cfsr))
+    {
+        printf("  record differs from the original\n");
+        return 1;
+    }
+    return 0;
+}
+
+int main(int argc, char** argv)
+{
+    replayOptionsType options;
+    int failures = 0;
+    int option;
+
+    memset(&options, 0, sizeof(options));
+    options.m_Count = DEFAULT_COUNT;
+    while((option = getopt(argc, argv, "n:p:stv")) != -1)
+    {
+        switch(option)
+        {
+            case 'n':   options.m_Count = strtoull(optarg, NULL, 0); break;
+            case 'p':   options.m_StartPc = (uint32_t)strtoul(optarg, NULL, 16); options.m_HasStartPc = 1; break;
+            case 's':   options.m_Synthetic = 1; break;
+            case 't':   options.m_Trace = 1; break;
+            case 'v':   target.m_Verbose = 1; break;
+            default:
+                fprintf(stderr, "usage: %s [-n count] [-s] [-t] [-v] [-p address] firmware.elf record.bin [record.bin ...]\n", argv[0]);
+                return 2;
+        }
+    }
+    if((argc - optind) < 2)
+    {
+        fprintf(stderr, "usage: %s [-n count] [-s] [-t] [-v] [-p address] firmware.elf record.bin [record.bin ...]\n", argv[0]);
+        return 2;
+    }
+    if(elf32Open(&elf, argv[optind++]) != 0)
+        return 1;
+    {
+        int verbose = target.m_Verbose;
+
+        if(thumbEmuTargetOpen(&target, &elf) != 0)
+        {
+            fprintf(stderr, "out of memory\n");
+            return 1;
+        }
+        target.m_Verbose = verbose;
+    }
+
+    for(; optind < argc; optind++)
+    {
+        crashArchiveType archive;
+        const crashRecordType* record;
+        size_t offset = 0;
+
+        if(crashArchiveOpen(&archive, argv[optind]) != 0)
+            continue;
+        while((record = crashArchiveNext(&archive, &offset)) != NULL)
+        {
+            printf("%s record %u, type %u, PC=", argv[optind], record->m_Sequence, record->m_Type);
+            printLocation(record->m_Pc);
+            printf("\n");
+
+            thumbEmuTargetSeed(&target, record);
+            if(options.m_HasStartPc)
+                target.m_Emu.m_R[15] = options.m_StartPc & ~1u;
+            failures += options.m_Synthetic ? synthetic(record, &options) : reproduce(record, &options);
+        }
+        crashArchiveClose(&archive);
+    }
+
+    thumbEmuTargetClose(&target);
+    elf32Close(&elf);
+    return (failures != 0) ? 1 : 0;
+}
@@ -0,0 +1,319 @@
+/*
+ * crashTime.c
+ *
+ *  Created on: 18 Oct 2026
+ *
+ *  Wall clock time of crash records
+ *  - Decodes each record's CRASH_RECORD_TAG_TIME TLV: the RTC date and time, taken as UTC,
+ *    and the uptime from the extended cycle count
+ *  - The RTC drifts, an anchors file of "device-time true-time" pairs, e.g. from time syncs
+ *    or server receive logs, corrects it: a least squares line through the offsets gives the
+ *    offset at each record, one anchor is a plain offset
+ *  - Times are ISO 8601 (2026-10-18T09:30:00.250) or Unix seconds
+ *  - Boot is the corrected time less the uptime, records from one boot share it
+ *  - Build: gcc -O2 -o crashTime crashTime.c crashArchive.c
+ *  - Usage: crashTime [-a anchors.txt] record.bin [record.bin ...]
+ */
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "crashArchive.h"
+
+#define LINE_LENGTH         256u
+#define SECONDS_PER_DAY     86400
+
+typedef struct
+{
+    double m_Device;            // What the device's RTC said.
+    double m_True;
+} anchorType;
+
+static anchorType* anchors;
+static uint32_t anchorCount;
+static double driftMean;        // Mean device time of the anchors.
+static double offsetMean;       // Mean offset, true less device.
+static double driftRate;        // Change in offset per device second.
+
+static const char* const typeNames[] =
+{
+    "Hard_Fault", "MemMang_Fault", "Bus_Fault", "Usage_Fault", "Lockup", "Watchdog", "Integrity"
+};
+
+static uint32_t bcd(uint32_t value, uint32_t shift, uint32_t tensMask)
+{
+    return (((value >> (shift + 4)) & tensMask) * 10u) + ((value >> shift) & 0xFu);
+}
+
+/* Days since 1970-01-01 of a civil date
+*/
+static int64_t daysFromCivil(int64_t year, uint32_t month, uint32_t day)
+{
+    int64_t era;
+    uint32_t yearOfEra;
+    uint32_t dayOfYear;
+
+    year -= (month <= 2);
+    era = ((year >= 0) ? year : (year - 399)) / 400;
+    yearOfEra = (uint32_t)(year - (era * 400));
+    dayOfYear = ((153u * ((month > 2) ? (month - 3) : (month + 9))) + 2u) / 5u + day - 1u;
+    return (era * 146097) + ((int64_t)yearOfEra * 365) + (yearOfEra / 4) - (yearOfEra / 100) + dayOfYear - 719468;
+}
+
+static void civilFromDays(int64_t days, int64_t* aYear, uint32_t* aMonth, uint32_t* aDay)
+{
+    int64_t era;
+    uint32_t dayOfEra;
+    uint32_t yearOfEra;
+    uint32_t dayOfYear;
+    uint32_t monthIndex;
+
+    days += 719468;
+    era = ((days >= 0) ? days : (days - 146096)) / 146097;
+    dayOfEra = (uint32_t)(days - (era * 146097));
+    yearOfEra = (dayOfEra - (dayOfEra / 1460) + (dayOfEra / 36524) - (dayOfEra / 146096)) / 365;
+    dayOfYear = dayOfEra - ((365 * yearOfEra) + (yearOfEra / 4) - (yearOfEra / 100));
+    monthIndex = ((5 * dayOfYear) + 2) / 153;
+    *aDay = dayOfYear - (((153 * monthIndex) + 2) / 5) + 1;
+    *aMonth = (monthIndex < 10) ? (monthIndex + 3) : (monthIndex - 9);
+    *aYear = (int64_t)yearOfEra + (era * 400) + (*aMonth <= 2);
+}
+
+static void formatTime(double seconds, char* aText, size_t size)
+{
+    int64_t millis = (int64_t)((seconds * 1000.0) + ((seconds < 0) ? -0.5 : 0.5));
+    int64_t days = millis / (SECONDS_PER_DAY * 1000);
+    int64_t rest = millis % (SECONDS_PER_DAY * 1000);
+    int64_t year;
+    uint32_t month;
+    uint32_t day;
+
+    if(rest < 0)
+    {
+        rest += SECONDS_PER_DAY * 1000;
+        days--;
+    }
+    civilFromDays(days, &year, &month, &day);
+    snprintf(aText, size, "%04lld-%02u-%02uT%02u:%02u:%02u.%03u", (long long)year, month, day, (uint32_t)(rest / 3600000),
+             (uint32_t)((rest / 60000) % 60), (uint32_t)((rest / 1000) % 60), (uint32_t)(rest % 1000));
+}
+
+/* Parse ISO 8601 or Unix seconds
+ * - Returns a pointer past the time, or NULL
+*/
+static const char* parseTime(const char* aText, double* aSeconds)
+{
+    unsigned year;
+    unsigned month;
+    unsigned day;
+    unsigned hour;
+    unsigned minute;
+    double second;
+    char* end;
+    int used = 0;
+
+    while((*aText == ' ') || (*aText == '\t'))
+        aText++;
+    if((sscanf(aText, "%4u-%2u-%2u%*1[T ]%2u:%2u:%lf%n", &year, &month, &day, &hour, &minute, &second, &used) == 6) && (used > 0))
+    {
+        if((month < 1) || (month > 12) || (day < 1) || (day > 31))
+            return NULL;
+        *aSeconds = ((double)daysFromCivil(year, month, day) * SECONDS_PER_DAY) + (hour * 3600.0) + (minute * 60.0) + second;
+        aText += used;
+        return (*aText == 'Z') ? (aText + 1) : aText;
+    }
+    *aSeconds = strtod(aText, &end);
+    return (end == aText) ? NULL : end;
+}
+
+static int loadAnchors(const char* aPath)
+{
+    FILE* file = fopen(aPath, "r");
+    char line[LINE_LENGTH];
+    uint32_t lineNumber = 0;
+    uint32_t allocated = 0;
+
+    if(file == NULL)
+    {
+        perror(aPath);
+        return -1;
+    }
+    while(fgets(line, sizeof(line), file) != NULL)
+    {
+        const char* next;
+        anchorType anchor;
+
+        lineNumber++;
+        next = line + strspn(line, " \t");
+        if((*next == '#') || (*next == '\n') || (*next == '\0'))
+            continue;
+        if(((next = parseTime(next, &anchor.m_Device)) == NULL) || (parseTime(next, &anchor.m_True) == NULL))
+        {
+            fprintf(stderr, "%s:%u: expected \"device-time true-time\"\n", aPath, lineNumber);
+            fclose(file);
+            return -1;
+        }
+        if(anchorCount == allocated)
+        {
+            allocated = allocated ? (allocated * 2u) : 64u;
+            anchors = realloc(anchors, allocated * sizeof(anchorType));
+            if(anchors == NULL)
+            {
+                fclose(file);
+                return -1;
+            }
+        }
+        anchors[anchorCount++] = anchor;
+    }
+    fclose(file);
+    return 0;
+}
+
+/* Fit offset = offsetMean + driftRate * (device - driftMean)
+*/
+static void fitDrift(void)
+{
+    double spread = 0.0;
+    double covariance = 0.0;
+    uint32_t i;
+
+    for(i = 0; i < anchorCount; i++)
+    {
+        driftMean += anchors[i].m_Device;
+        offsetMean += anchors[i].m_True - anchors[i].m_Device;
+    }
+    driftMean /= anchorCount;
+    offsetMean /= anchorCount;
+    for(i = 0; i < anchorCount; i++)
+    {
+        double dx = anchors[i].m_Device - driftMean;
+
+        spread += dx * dx;
+        covariance += dx * ((anchors[i].m_True - anchors[i].m_Device) - offsetMean);
+    }
+    driftRate = (spread > 0.0) ? (covariance / spread) : 0.0;
+}
+
+static double correct(double device)
+{
+    if(anchorCount == 0)
+        return device;
+    return device + offsetMean + (driftRate * (device - driftMean));
+}
+
+/* RTC time of a record as Unix seconds
+ * - Returns 0 if the RTC wasn't running
+*/
+static int rtcSeconds(const crashRecordTimeType* aTime, double* aSeconds)
+{
+    uint32_t prediv = aTime->m_RtcPrediv & 0x7FFFu;
+    uint32_t subSeconds = aTime->m_RtcSubSeconds & 0xFFFFu;
+    uint32_t month = bcd(aTime->m_RtcDate, 8, 0x1u);
+    uint32_t day = bcd(aTime->m_RtcDate, 0, 0x3u);
+
+    if((aTime->m_RtcDate == 0) || (month < 1) || (month > 12) || (day < 1) || (day > 31))
+        return 0;
+
+    *aSeconds = ((double)daysFromCivil(2000 + bcd(aTime->m_RtcDate, 16, 0xFu), month, day) * SECONDS_PER_DAY) +
+                (bcd(aTime->m_RtcTime, 16, 0x3u) * 3600.0) + (bcd(aTime->m_RtcTime, 8, 0x7u) * 60.0) + bcd(aTime->m_RtcTime, 0, 0x7u);
+
+    // SSR counts down, above PREDIV_S only straight after a shift.
+    if(subSeconds <= prediv)
+        *aSeconds += (double)(prediv - subSeconds) / (double)(prediv + 1u);
+    return 1;
+}
+
+static void usage(const char* aName)
+{
+    fprintf(stderr, "usage: %s [-a anchors.txt] record.bin [record.bin ...]\n", aName);
+}
+
+int main(int argc, char** argv)
+{
+    uint64_t total = 0;
+    uint64_t untimed = 0;
+    int option;
+
+    while((option = getopt(argc, argv, "a:")) != -1)
+    {
+        switch(option)
+        {
+            case 'a':
+                if(loadAnchors(optarg) != 0)
+                    return 1;
+                break;
+            default:
+                usage(argv[0]);
+                return 2;
+        }
+    }
+    if(optind >= argc)
+    {
+        usage(argv[0]);
+        return 2;
+    }
+
+    if(anchorCount != 0)
+    {
+        char text[48];
+
+        fitDrift();
+        formatTime(driftMean, text, sizeof(text));
+        printf("%u anchors, offset %+.3fs at %s, drift %+.2f ppm\n\n", anchorCount, offsetMean, text, driftRate * 1e6);
+    }
+    printf("%-10s %-14s%-25s%-25s%14s  %s\n", "sequence", "type", "rtc", "utc", "uptime", "boot");
+
+    for(; optind < argc; optind++)
+    {
+        crashArchiveType archive;
+        const crashRecordType* record;
+        size_t offset = 0;
+
+        if(crashArchiveOpen(&archive, argv[optind]) != 0)
+            continue;
+        while((record = crashArchiveNext(&archive, &offset)) != NULL)
+        {
+            const crashRecordTlvType* tlv = crashArchiveFindTlv(record, CRASH_RECORD_TAG_TIME);
+            const char* type = (record->m_Type < (sizeof(typeNames) / sizeof(typeNames[0]))) ? typeNames[record->m_Type] : "?";
+            crashRecordTimeType time;
+            char rtcText[48] = "-";
+            char utcText[48] = "-";
+            char bootText[48] = "-";
+            char uptimeText[24] = "-";
+            double uptime = 0.0;
+            double device;
+
+            total++;
+            if((tlv == NULL) || (tlv->m_Length < sizeof(crashRecordTimeType)))
+            {
+                untimed++;
+                continue;
+            }
+            memcpy(&time, tlv + 1, sizeof(time));
+
+            if(time.m_CoreClock != 0)
+            {
+                uptime = (double)(((uint64_t)time.m_CyclesHigh << 32) | time.m_CyclesLow) / time.m_CoreClock;
+                snprintf(uptimeText, sizeof(uptimeText), "%.6f", uptime);
+            }
+            if(rtcSeconds(&time, &device))
+            {
+                double utc = correct(device);
+
+                formatTime(device, rtcText, sizeof(rtcText));
+                formatTime(utc, utcText, sizeof(utcText));
+                if(time.m_CoreClock != 0)
+                    formatTime(utc - uptime, bootText, sizeof(bootText));
+            }
+            printf("%-10u %-14s%-25s%-25s%14s  %s\n", record->m_Sequence, type, rtcText, utcText, uptimeText, bootText);
+        }
+        crashArchiveClose(&archive);
+    }
+
+    if(untimed != 0)
+        printf("\n%llu of %llu records have no time, define EXCEPTIONS_TIMESTAMPS\n", (unsigned long long)untimed, (unsigned long long)total);
+    free(anchors);
+    return 0;
+}
@@ -0,0 +1,293 @@
+/*
+ * decodeCache.c
+ *
+ *  Created on: 18 Oct 2026
+ *
+ *  Persistent cache of decoded crash records
+ */
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "decodeCache.h"
+
+#define DECODE_CACHE_MAGIC  0x48434344u     // "DCCH".
+#define DECODE_CACHE_LAYOUT 1u
+#define INITIAL_SLOTS       4096u
+#define INITIAL_HEAP        65536u
+#define INLINE_LENGTH       8u
+
+typedef struct
+{
+    uint32_t m_Magic;
+    uint32_t m_Layout;
+    uint32_t m_SlotCount;       // Power of 2.
+    uint32_t m_Used;
+    uint64_t m_HeapUsed;
+    uint64_t m_HeapSize;
+} cacheHeaderType;
+
+typedef struct
+{
+    uint64_t m_Record;          // 0 marks a free slot.
+    uint64_t m_Build;
+    uint32_t m_Decoder;
+    uint32_t m_Length;
+    uint64_t m_Value;           // The value itself up to INLINE_LENGTH bytes, else its heap offset.
+} cacheSlotType;
+
+static uint64_t mix(uint64_t value)
+{
+    value = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9ull;
+    value = (value ^ (value >> 27)) * 0x94D049BB133111EBull;
+    return value ^ (value >> 31);
+}
+
+static cacheHeaderType* header(const decodeCacheType* aCache)
+{
+    return (cacheHeaderType*)aCache->m_Data;
+}
+
+static cacheSlotType* slots(const decodeCacheType* aCache)
+{
+    return (cacheSlotType*)(aCache->m_Data + sizeof(cacheHeaderType));
+}
+
+static uint8_t* heap(const decodeCacheType* aCache)
+{
+    return aCache->m_Data + sizeof(cacheHeaderType) + ((size_t)header(aCache)->m_SlotCount * sizeof(cacheSlotType));
+}
+
+static size_t fileSize(uint32_t slotCount, uint64_t heapSize)
+{
+    return sizeof(cacheHeaderType) + ((size_t)slotCount * sizeof(cacheSlotType)) + (size_t)heapSize;
+}
+
+static uint32_t firstSlot(uint64_t recordHash, uint64_t buildHash, uint32_t decoder, uint32_t slotCount)
+{
+    return (uint32_t)mix(recordHash ^ (buildHash * 0x9E3779B97F4A7C15ull) ^ decoder) & (slotCount - 1u);
+}
+
+static int mapFile(decodeCacheType* aCache, const char* aPath, size_t size, int create)
+{
+    int fd = open(aPath, O_RDWR | (create ? (O_CREAT | O_TRUNC) : 0), 0644);
+    void* data;
+
+    if(fd < 0)
+    {
+        perror(aPath);
+        return -1;
+    }
+    if(create && (ftruncate(fd, (off_t)size) != 0))
+    {
+        perror(aPath);
+        close(fd);
+        return -1;
+    }
+    data = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, 0);
+    close(fd);
+    if(data == MAP_FAILED)
+    {
+        perror(aPath);
+        return -1;
+    }
+    aCache->m_Data = data;
+    aCache->m_Size = size;
+    return 0;
+}
+
+/* Write a new cache file of the given size and swap it in
+ * - Carries over the current decoder's entries, others are stale and dropped
+ * - Built beside the old file and renamed over it, a crash midway leaves the old one
+*/
+static int rebuild(decodeCacheType* aCache, uint32_t slotCount, uint64_t heapSize)
+{
+    decodeCacheType fresh;
+    char temporary[sizeof(aCache->m_Path) + 8];
+    uint32_t i;
+
+    memset(&fresh, 0, sizeof(fresh));
+    snprintf(temporary, sizeof(temporary), "%s.tmp", aCache->m_Path);
+    if(mapFile(&fresh, temporary, fileSize(slotCount, heapSize), 1) != 0)
+        return -1;
+    header(&fresh)->m_Magic = DECODE_CACHE_MAGIC;
+    header(&fresh)->m_Layout = DECODE_CACHE_LAYOUT;
+    header(&fresh)->m_SlotCount = slotCount;
+    header(&fresh)->m_HeapSize = heapSize;
+
+    for(i = 0; (aCache->m_Data != NULL) && (i < header(aCache)->m_SlotCount); i++)
+    {
+        const cacheSlotType* old = &slots(aCache)[i];
+        cacheSlotType* slot;
+        uint32_t index;
+
+        if((old->m_Record == 0) || (old->m_Decoder != aCache->m_Decoder) ||
+           ((old->m_Length > INLINE_LENGTH) && ((old->m_Value + old->m_Length) > header(aCache)->m_HeapUsed)))
+            continue;
+        for(index = firstSlot(old->m_Record, old->m_Build, old->m_Decoder, slotCount); slots(&fresh)[index].m_Record != 0;
+            index = (index + 1u) & (slotCount - 1u))
+            ;
+        slot = &slots(&fresh)[index];
+        *slot = *old;
+        if(old->m_Length > INLINE_LENGTH)
+        {
+            slot->m_Value = header(&fresh)->m_HeapUsed;
+            memcpy(heap(&fresh) + slot->m_Value, heap(aCache) + old->m_Value, old->m_Length);
+            header(&fresh)->m_HeapUsed += (old->m_Length + 7u) & ~7u;
+        }
+        header(&fresh)->m_Used++;
+    }
+
+    if(rename(temporary, aCache->m_Path) != 0)
+    {
+        perror(aCache->m_Path);
+        munmap(fresh.m_Data, fresh.m_Size);
+        unlink(temporary);
+        return -1;
+    }
+    if(aCache->m_Data != NULL)
+        munmap(aCache->m_Data, aCache->m_Size);
+    aCache->m_Data = fresh.m_Data;
+    aCache->m_Size = fresh.m_Size;
+    return 0;
+}
+
+/* Open or create a cache
+ * - A file that isn't a cache of this layout, or whose sizes don't add up, is started over
+*/
+int decodeCacheOpen(decodeCacheType* aCache, const char* aPath, uint32_t decoder)
+{
+    struct stat info;
+
+    memset(aCache, 0, sizeof(*aCache));
+    snprintf(aCache->m_Path, sizeof(aCache->m_Path), "%s", aPath);
+    aCache->m_Decoder = decoder;
+
+    if((stat(aPath, &info) == 0) && ((size_t)info.st_size >= sizeof(cacheHeaderType)))
+    {
+        const cacheHeaderType* existing;
+
+        if(mapFile(aCache, aPath, (size_t)info.st_size, 0) != 0)
+            return -1;
+        existing = header(aCache);
+        if((existing->m_Magic == DECODE_CACHE_MAGIC) && (existing->m_Layout == DECODE_CACHE_LAYOUT) &&
+           (existing->m_SlotCount != 0) && ((existing->m_SlotCount & (existing->m_SlotCount - 1u)) == 0) &&
+           (existing->m_Used < existing->m_SlotCount) &&
+           (existing->m_HeapUsed <= existing->m_HeapSize) && (fileSize(existing->m_SlotCount, existing->m_HeapSize) == aCache->m_Size))
+            return 0;
+        munmap(aCache->m_Data, aCache->m_Size);
+        aCache->m_Data = NULL;
+    }
+    return rebuild(aCache, INITIAL_SLOTS, INITIAL_HEAP);
+}
+
+void decodeCacheClose(decodeCacheType* aCache)
+{
+    if(aCache->m_Data != NULL)
+        munmap(aCache->m_Data, aCache->m_Size);
+    aCache->m_Data = NULL;
+}
+
+/* Hash identifying a record
+ * - Built from the stored CRC and header fields rather than the bytes, the archive reader has
+ *   already checked the CRC so nothing is read twice
+*/
+uint64_t decodeCacheRecordHash(const crashRecordType* aRecord)
+{
+    uint64_t hash = mix(((uint64_t)aRecord->m_Crc << 32) | aRecord->m_Size);
+
+    hash = mix(hash ^ (((uint64_t)aRecord->m_Pc << 32) | aRecord->m_Lr));
+    hash = mix(hash ^ (((uint64_t)aRecord->m_Sp << 32) | aRecord->m_Sequence));
+    hash = mix(hash ^ (((uint64_t)aRecord->m_Cfsr << 32) | aRecord->m_Type));
+    return (hash != 0) ? hash : 1;
+}
+
+uint64_t decodeCacheBuildHash(const uint8_t* aId, uint32_t length)
+{
+    uint64_t hash = 0;
+    uint32_t i;
+
+    if(length == 0)
+        return 0;
+    for(i = 0; i < length; i++)
+        hash = mix(hash ^ aId[i]);
+    return hash;
+}
+
+static cacheSlotType* findSlot(const decodeCacheType* aCache, uint64_t recordHash, uint64_t buildHash)
+{
+    uint32_t slotCount = header(aCache)->m_SlotCount;
+    uint32_t index;
+
+    for(index = firstSlot(recordHash, buildHash, aCache->m_Decoder, slotCount); slots(aCache)[index].m_Record != 0;
+        index = (index + 1u) & (slotCount - 1u))
+    {
+        cacheSlotType* slot = &slots(aCache)[index];
+
+        if((slot->m_Record == recordHash) && (slot->m_Build == buildHash) && (slot->m_Decoder == aCache->m_Decoder))
+            return slot;
+    }
+    return &slots(aCache)[index];
+}
+
+/* Look up a decoded record
+ * - Returns the value, valid until the next store, or NULL on a miss
+*/
+const void* decodeCacheFind(decodeCacheType* aCache, uint64_t recordHash, uint64_t buildHash, uint32_t* aLength)
+{
+    const cacheSlotType* slot = findSlot(aCache, recordHash, buildHash);
+
+    if((slot->m_Record == 0) || ((slot->m_Length > INLINE_LENGTH) && ((slot->m_Value + slot->m_Length) > header(aCache)->m_HeapUsed)))
+    {
+        aCache->m_Misses++;
+        return NULL;
+    }
+    aCache->m_Hits++;
+    *aLength = slot->m_Length;
+    return (slot->m_Length > INLINE_LENGTH) ? (const void*)(heap(aCache) + slot->m_Value) : (const void*)&slot->m_Value;
+}
+
+int decodeCacheStore(decodeCacheType* aCache, uint64_t recordHash, uint64_t buildHash, const void* aValue, uint32_t length)
+{
+    uint64_t padded = (length > INLINE_LENGTH) ? ((length + 7u) & ~7u) : 0;
+    cacheSlotType* slot;
+
+    if(recordHash == 0)
+        return -1;
+    if(((header(aCache)->m_Used + 1u) * 2u) > header(aCache)->m_SlotCount)
+    {
+        if(rebuild(aCache, header(aCache)->m_SlotCount * 2u, header(aCache)->m_HeapSize) != 0)
+            return -1;
+    }
+    if((header(aCache)->m_HeapUsed + padded) > header(aCache)->m_HeapSize)
+    {
+        uint64_t heapSize = header(aCache)->m_HeapSize * 2u;
+
+        while(heapSize < (header(aCache)->m_HeapUsed + padded))
+            heapSize *= 2u;
+        if(rebuild(aCache, header(aCache)->m_SlotCount, heapSize) != 0)
+            return -1;
+    }
+
+    slot = findSlot(aCache, recordHash, buildHash);
+    if(slot->m_Record == 0)
+        header(aCache)->m_Used++;
+    slot->m_Record = recordHash;
+    slot->m_Build = buildHash;
+    slot->m_Decoder = aCache->m_Decoder;
+    slot->m_Length = length;
+    slot->m_Value = 0;
+    if(padded != 0)
+    {
+        // A replaced value's old heap bytes stay until the next rebuild.
+        slot->m_Value = header(aCache)->m_HeapUsed;
+        memcpy(heap(aCache) + slot->m_Value, aValue, length);
+        header(aCache)->m_HeapUsed += padded;
+    }
+    else
+        memcpy(&slot->m_Value, aValue, length);
+    return 0;
+}
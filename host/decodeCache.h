@@ -0,0 +1,42 @@
+/*
+ * decodeCache.h
+ *
+ *  Created on: 18 Oct 2026
+ *
+ *  Persistent cache of decoded crash records
+ *  - Keyed by (record hash, build-id hash, decoder version), the value is whatever the tool
+ *    derived from the record, so a rerun over a grown archive only decodes new records
+ *  - The build-id hash is of the ELF the record was decoded against (0 for none), adding the
+ *    matching ELF later misses the cache; bump the decoder version when decoding changes
+ *  - One file, memory mapped: a header, an open addressing slot table and a value heap.
+ *    Values of up to 8 bytes live in the slot itself
+ *  - One writer at a time
+ */
+
+#ifndef DECODE_CACHE_H_
+#define DECODE_CACHE_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "../crashRecord.h"
+
+typedef struct
+{
+    char m_Path[1024];
+    uint8_t* m_Data;
+    size_t m_Size;
+    uint32_t m_Decoder;
+    uint64_t m_Hits;
+    uint64_t m_Misses;
+} decodeCacheType;
+
+int decodeCacheOpen(decodeCacheType* aCache, const char* aPath, uint32_t decoder);
+void decodeCacheClose(decodeCacheType* aCache);
+
+uint64_t decodeCacheRecordHash(const crashRecordType* aRecord);
+uint64_t decodeCacheBuildHash(const uint8_t* aId, uint32_t length);
+const void* decodeCacheFind(decodeCacheType* aCache, uint64_t recordHash, uint64_t buildHash, uint32_t* aLength);
+int decodeCacheStore(decodeCacheType* aCache, uint64_t recordHash, uint64_t buildHash, const void* aValue, uint32_t length);
+
+#endif /* DECODE_CACHE_H_ */
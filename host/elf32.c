@@ -0,0 +1,285 @@
+/*
+ * elf32.c
+ *
+ *  Created on: 18 Oct 2026
+ *
+ *  Minimal read-only ELF32 reader for the host tools
+ */
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "elf32.h"
+
+static int functionCompare(const void* aLeft, const void* aRight)
+{
+    const elf32FunctionType* left = (const elf32FunctionType*)aLeft;
+    const elf32FunctionType* right = (const elf32FunctionType*)aRight;
+
+    return (left->m_Address > right->m_Address) - (left->m_Address < right->m_Address);
+}
+
+static int inFile(const elf32FileType* aElf, uint32_t offset, uint32_t length)
+{
+    return (offset <= aElf->m_Size) && (length <= (aElf->m_Size - offset));
+}
+
+/* Build the sorted function table used by elf32FindFunction()
+ * - Thumb bit is stripped from the symbol values
+*/
+static int loadFunctions(elf32FileType* aElf)
+{
+    uint32_t i;
+
+    aElf->m_Functions = calloc(aElf->m_SymbolCount + 1, sizeof(elf32FunctionType));
+    if(aElf->m_Functions == NULL)
+        return -1;
+
+    for(i = 0; i < aElf->m_SymbolCount; i++)
+    {
+        const Elf32_Sym* symbol = &aElf->m_Symbols[i];
+
+        if((ELF32_ST_TYPE(symbol->st_info) != STT_FUNC) || (symbol->st_shndx == SHN_UNDEF))
+            continue;
+        aElf->m_Functions[aElf->m_FunctionCount].m_Address = symbol->st_value & ~1u;
+        aElf->m_Functions[aElf->m_FunctionCount].m_Size = symbol->st_size;
+        aElf->m_Functions[aElf->m_FunctionCount].m_Name = elf32SymbolName(aElf, symbol);
+        aElf->m_FunctionCount++;
+    }
+    qsort(aElf->m_Functions, aElf->m_FunctionCount, sizeof(elf32FunctionType), functionCompare);
+    return 0;
+}
+
+int elf32Open(elf32FileType* aElf, const char* aPath)
+{
+    struct stat info;
+    const Elf32_Shdr* symtab;
+    uint32_t i;
+    int fd;
+
+    memset(aElf, 0, sizeof(*aElf));
+
+    fd = open(aPath, O_RDONLY);
+    if(fd < 0)
+    {
+        perror(aPath);
+        return -1;
+    }
+    if((fstat(fd, &info) != 0) || (info.st_size < (off_t)sizeof(Elf32_Ehdr)))
+    {
+        fprintf(stderr, "%s: not an ELF file\n", aPath);
+        close(fd);
+        return -1;
+    }
+
+    aElf->m_Size = (size_t)info.st_size;
+    aElf->m_Data = mmap(NULL, aElf->m_Size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if(aElf->m_Data == MAP_FAILED)
+    {
+        perror(aPath);
+        aElf->m_Data = NULL;
+        return -1;
+    }
+
+    aElf->m_Header = (const Elf32_Ehdr*)aElf->m_Data;
+    if((memcmp(aElf->m_Header->e_ident, ELFMAG, SELFMAG) != 0) ||
+       (aElf->m_Header->e_ident[EI_CLASS] != ELFCLASS32) ||
+       (aElf->m_Header->e_ident[EI_DATA] != ELFDATA2LSB) ||
+       !inFile(aElf, aElf->m_Header->e_shoff, aElf->m_Header->e_shnum * sizeof(Elf32_Shdr)) ||
+       (aElf->m_Header->e_shstrndx >= aElf->m_Header->e_shnum))
+    {
+        fprintf(stderr, "%s: not a little endian ELF32 file\n", aPath);
+        elf32Close(aElf);
+        return -1;
+    }
+
+    aElf->m_Sections = (const Elf32_Shdr*)(aElf->m_Data + aElf->m_Header->e_shoff);
+    aElf->m_SectionCount = aElf->m_Header->e_shnum;
+    aElf->m_SectionNames = (const char*)elf32SectionData(aElf, &aElf->m_Sections[aElf->m_Header->e_shstrndx]);
+
+    symtab = NULL;
+    for(i = 0; i < aElf->m_SectionCount; i++)
+    {
+        if(aElf->m_Sections[i].sh_type == SHT_SYMTAB)
+            symtab = &aElf->m_Sections[i];
+    }
+    if((symtab != NULL) && (symtab->sh_link < aElf->m_SectionCount))
+    {
+        aElf->m_Symbols = (const Elf32_Sym*)elf32SectionData(aElf, symtab);
+        aElf->m_SymbolCount = aElf->m_Symbols ? symtab->sh_size / sizeof(Elf32_Sym) : 0;
+        aElf->m_SymbolNames = (const char*)elf32SectionData(aElf, &aElf->m_Sections[symtab->sh_link]);
+    }
+
+    if(loadFunctions(aElf) != 0)
+    {
+        elf32Close(aElf);
+        return -1;
+    }
+    return 0;
+}
+
+void elf32Close(elf32FileType* aElf)
+{
+    if(aElf->m_Data != NULL)
+        munmap((void*)aElf->m_Data, aElf->m_Size);
+    free(aElf->m_Functions);
+    memset(aElf, 0, sizeof(*aElf));
+}
+
+const uint8_t* elf32SectionData(const elf32FileType* aElf, const Elf32_Shdr* aSection)
+{
+    if((aSection->sh_type == SHT_NOBITS) || !inFile(aElf, aSection->sh_offset, aSection->sh_size))
+        return NULL;
+    return aElf->m_Data + aSection->sh_offset;
+}
+
+const char* elf32SectionName(const elf32FileType* aElf, const Elf32_Shdr* aSection)
+{
+    if(aElf->m_SectionNames == NULL)
+        return "";
+    return aElf->m_SectionNames + aSection->sh_name;
+}
+
+const Elf32_Shdr* elf32FindSection(const elf32FileType* aElf, const char* aName)
+{
+    uint32_t i;
+
+    for(i = 0; i < aElf->m_SectionCount; i++)
+    {
+        if(strcmp(elf32SectionName(aElf, &aElf->m_Sections[i]), aName) == 0)
+            return &aElf->m_Sections[i];
+    }
+    return NULL;
+}
+
+const char* elf32SymbolName(const elf32FileType* aElf, const Elf32_Sym* aSymbol)
+{
+    if(aElf->m_SymbolNames == NULL)
+        return "";
+    return aElf->m_SymbolNames + aSymbol->st_name;
+}
+
+const Elf32_Sym* elf32FindSymbol(const elf32FileType* aElf, const char* aName)
+{
+    uint32_t i;
+
+    for(i = 0; i < aElf->m_SymbolCount; i++)
+    {
+        if((aElf->m_Symbols[i].st_shndx != SHN_UNDEF) && (strcmp(elf32SymbolName(aElf, &aElf->m_Symbols[i]), aName) == 0))
+            return &aElf->m_Symbols[i];
+    }
+    return NULL;
+}
+
+/* Find the function containing an address
+ * - Returns NULL if the address is past the end of the nearest function
+*/
+const elf32FunctionType* elf32FindFunction(const elf32FileType* aElf, uint32_t address)
+{
+    uint32_t low = 0;
+    uint32_t high = aElf->m_FunctionCount;
+    const elf32FunctionType* function;
+
+    address &= ~1u;
+    while(low < high)
+    {
+        uint32_t middle = low + ((high - low) / 2);
+
+        if(aElf->m_Functions[middle].m_Address <= address)
+            low = middle + 1;
+        else
+            high = middle;
+    }
+    if(low == 0)
+        return NULL;
+
+    function = &aElf->m_Functions[low - 1];
+    if((function->m_Size != 0) && ((address - function->m_Address) >= function->m_Size))
+        return NULL;
+    return function;
+}
+
+/* Read target memory from the loadable sections
+ * - readOnly limits it to sections that can't change at run time (code and constants)
+ * - Returns the number of bytes read, stopping at the first byte not covered
+*/
+uint32_t elf32ReadMemory(const elf32FileType* aElf, uint32_t address, void* aDest, uint32_t length, int readOnly)
+{
+    uint32_t done = 0;
+
+    while(done < length)
+    {
+        uint32_t i;
+        uint32_t current = address + done;
+        int found = 0;
+
+        for(i = 0; i < aElf->m_SectionCount; i++)
+        {
+            const Elf32_Shdr* section = &aElf->m_Sections[i];
+            const uint8_t* data;
+            uint32_t chunk;
+
+            if(!(section->sh_flags & SHF_ALLOC) || (section->sh_type != SHT_PROGBITS) ||
+               (readOnly && (section->sh_flags & SHF_WRITE)) ||
+               (current < section->sh_addr) || ((current - section->sh_addr) >= section->sh_size))
+                continue;
+
+            data = elf32SectionData(aElf, section);
+            if(data == NULL)
+                continue;
+            chunk = section->sh_size - (current - section->sh_addr);
+            if(chunk > (length - done))
+                chunk = length - done;
+            memcpy((uint8_t*)aDest + done, data + (current - section->sh_addr), chunk);
+            done += chunk;
+            found = 1;
+            break;
+        }
+        if(!found)
+            break;
+    }
+    return done;
+}
+
+/* Find the GNU build-id note
+ * - Returns 0 and the descriptor if present
+*/
+int elf32BuildId(const elf32FileType* aElf, const uint8_t** aId, uint32_t* aLength)
+{
+    uint32_t i;
+
+    for(i = 0; i < aElf->m_SectionCount; i++)
+    {
+        const Elf32_Shdr* section = &aElf->m_Sections[i];
+        const uint8_t* data;
+        uint32_t offset = 0;
+
+        if(section->sh_type != SHT_NOTE)
+            continue;
+        data = elf32SectionData(aElf, section);
+        while((data != NULL) && ((offset + sizeof(Elf32_Nhdr)) <= section->sh_size))
+        {
+            const Elf32_Nhdr* note = (const Elf32_Nhdr*)(data + offset);
+            uint32_t nameSize = (note->n_namesz + 3u) & ~3u;
+            uint32_t descSize = (note->n_descsz + 3u) & ~3u;
+            uint32_t descOffset = offset + sizeof(Elf32_Nhdr) + nameSize;
+
+            if((descOffset > section->sh_size) || (note->n_descsz > (section->sh_size - descOffset)))
+                break;
+            if((note->n_type == NT_GNU_BUILD_ID) && (note->n_namesz == 4) &&
+               (memcmp(data + offset + sizeof(Elf32_Nhdr), "GNU", 4) == 0))
+            {
+                *aId = data + descOffset;
+                *aLength = note->n_descsz;
+                return 0;
+            }
+            offset = descOffset + descSize;
+        }
+    }
+    return -1;
+}
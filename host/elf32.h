@@ -0,0 +1,53 @@
+/*
+ * elf32.h
+ *
+ *  Created on: 18 Oct 2026
+ *
+ *  Minimal read-only ELF32 (little endian ARM) reader for the host tools
+ *  - The file is memory mapped, nothing is copied
+ */
+
+#ifndef ELF32_H_
+#define ELF32_H_
+
+#include <elf.h>
+#include <stddef.h>
+#include <stdint.h>
+
+typedef struct
+{
+    uint32_t m_Address;
+    uint32_t m_Size;
+    const char* m_Name;
+} elf32FunctionType;
+
+typedef struct
+{
+    const uint8_t* m_Data;
+    size_t m_Size;
+    const Elf32_Ehdr* m_Header;
+    const Elf32_Shdr* m_Sections;
+    uint32_t m_SectionCount;
+    const char* m_SectionNames;
+    const Elf32_Sym* m_Symbols;
+    uint32_t m_SymbolCount;
+    const char* m_SymbolNames;
+    elf32FunctionType* m_Functions;     // Function symbols sorted by address.
+    uint32_t m_FunctionCount;
+} elf32FileType;
+
+int elf32Open(elf32FileType* aElf, const char* aPath);
+void elf32Close(elf32FileType* aElf);
+
+const Elf32_Shdr* elf32FindSection(const elf32FileType* aElf, const char* aName);
+const uint8_t* elf32SectionData(const elf32FileType* aElf, const Elf32_Shdr* aSection);
+const char* elf32SectionName(const elf32FileType* aElf, const Elf32_Shdr* aSection);
+
+const Elf32_Sym* elf32FindSymbol(const elf32FileType* aElf, const char* aName);
+const char* elf32SymbolName(const elf32FileType* aElf, const Elf32_Sym* aSymbol);
+const elf32FunctionType* elf32FindFunction(const elf32FileType* aElf, uint32_t address);
+
+uint32_t elf32ReadMemory(const elf32FileType* aElf, uint32_t address, void* aDest, uint32_t length, int readOnly);
+int elf32BuildId(const elf32FileType* aElf, const uint8_t** aId, uint32_t* aLength);
+
+#endif /* ELF32_H_ */
@@ -0,0 +1,149 @@
+/*
+ * exTableSort.c
+ *
+ *  Created on: 18 Oct 2026
+ *
+ *  Sorts the .ex_table of the fault tolerant accessors (exceptionsFixup.h) in the firmware ELF
+ *  - The linker keeps entries in input order, the fault handler binary searches them by start
+ *  - Sorted in place, run it after linking and before objcopy
+ *  - Entries are three little endian words: start, end, fixup; an empty or overlapping
+ *    range is an error
+ *  - Build: gcc -O2 -o exTableSort exTableSort.c elf32.c
+ *  - Usage: exTableSort [-l] firmware.elf
+ *      -l lists the sorted entries
+ */
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "elf32.h"
+
+#define ENTRY_SIZE          12u     // Must match exceptionsFixupEntryType.
+
+typedef struct
+{
+    uint32_t m_Start;
+    uint32_t m_End;
+    uint32_t m_Fixup;
+} entryType;
+
+static int compareEntries(const void* aLeft, const void* aRight)
+{
+    const entryType* left = (const entryType*)aLeft;
+    const entryType* right = (const entryType*)aRight;
+
+    if(left->m_Start != right->m_Start)
+        return (left->m_Start < right->m_Start) ? -1 : 1;
+    return 0;
+}
+
+static void usage(const char* aName)
+{
+    fprintf(stderr, "usage: %s [-l] firmware.elf\n", aName);
+}
+
+int main(int argc, char** argv)
+{
+    const Elf32_Shdr* section;
+    const uint8_t* data;
+    elf32FileType elf;
+    entryType* entries;
+    uint32_t count;
+    uint32_t offset;
+    uint32_t i;
+    int sorted = 1;
+    int list = 0;
+    int result = 0;
+    FILE* file;
+    int option;
+
+    while((option = getopt(argc, argv, "l")) != -1)
+    {
+        switch(option)
+        {
+            case 'l':   list = 1; break;
+            default:
+                usage(argv[0]);
+                return 2;
+        }
+    }
+    if(optind != (argc - 1))
+    {
+        usage(argv[0]);
+        return 2;
+    }
+
+    if(elf32Open(&elf, argv[optind]) != 0)
+        return 1;
+    section = elf32FindSection(&elf, ".ex_table");
+    if((section == NULL) || ((data = elf32SectionData(&elf, section)) == NULL) || (section->sh_size % ENTRY_SIZE))
+    {
+        fprintf(stderr, "%s: no usable .ex_table, is exceptionsFixup.ld included?\n", argv[optind]);
+        elf32Close(&elf);
+        return 1;
+    }
+    count = section->sh_size / ENTRY_SIZE;
+    offset = section->sh_offset;
+    entries = malloc((count ? count : 1u) * sizeof(entryType));
+    if(entries == NULL)
+    {
+        elf32Close(&elf);
+        return 1;
+    }
+    for(i = 0; i < count; i++)
+    {
+        const uint8_t* entry = data + (i * ENTRY_SIZE);
+
+        memcpy(&entries[i].m_Start, entry, 4);
+        memcpy(&entries[i].m_End, entry + 4, 4);
+        memcpy(&entries[i].m_Fixup, entry + 8, 4);
+        if((i != 0) && (entries[i].m_Start < entries[i - 1].m_Start))
+            sorted = 0;
+    }
+    elf32Close(&elf);
+
+    qsort(entries, count, sizeof(entryType), compareEntries);
+    for(i = 0; i < count; i++)
+    {
+        if(entries[i].m_Start >= entries[i].m_End)
+        {
+            fprintf(stderr, "%s: empty range at %08x\n", argv[optind], entries[i].m_Start);
+            result = 1;
+        }
+        else if((i != 0) && (entries[i].m_Start < entries[i - 1].m_End))
+        {
+            fprintf(stderr, "%s: ranges at %08x and %08x overlap\n", argv[optind], entries[i - 1].m_Start, entries[i].m_Start);
+            result = 1;
+        }
+        if(list)
+            printf("%08x-%08x  fixup %08x\n", entries[i].m_Start, entries[i].m_End, entries[i].m_Fixup);
+    }
+    if(result != 0)
+    {
+        free(entries);
+        return result;
+    }
+
+    if(!sorted)
+    {
+        file = fopen(argv[optind], "r+b");
+        if((file == NULL) || (fseek(file, (long)offset, SEEK_SET) != 0))
+            result = 1;
+        for(i = 0; (result == 0) && (i < count); i++)
+        {
+            if((fwrite(&entries[i].m_Start, 4, 1, file) != 1) || (fwrite(&entries[i].m_End, 4, 1, file) != 1) ||
+               (fwrite(&entries[i].m_Fixup, 4, 1, file) != 1))
+                result = 1;
+        }
+        if((file != NULL) && (fclose(file) != 0))
+            result = 1;
+        if(result != 0)
+            perror(argv[optind]);
+    }
+    if(result == 0)
+        printf("%u entries, %s\n", count, sorted ? "already sorted" : "sorted");
+    free(entries);
+    return result;
+}
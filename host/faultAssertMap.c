@@ -0,0 +1,252 @@
+/*
+ * faultAssertMap.c
+ *
+ *  Created on: 18 Oct 2026
+ *
+ *  Maps FAULT_ASSERT tokens and PCs back to file, line and expression
+ *  - Reads the .fault_assert side section from the firmware ELF, and .fault_assert_sites,
+ *    which gives the address of every assert's UDF
+ *  - The PC of an assert fault is unique to its site, so a lookup by PC never clashes; the
+ *    16 bit token is only the fallback for logs that lost the PC
+ *  - Build: gcc -O2 -o faultAssertMap faultAssertMap.c elf32.c
+ *  - Usage: faultAssertMap firmware.elf [token|PC ...]
+ *      With no arguments every entry is listed, arguments above ffff are PCs
+ *  - Tokens that are shared, or wrapped past line 4095, are listed as notes; an ELF with no
+ *    sites section, built before they existed, can only be looked up by token and exits
+ *    non-zero on a clash
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "elf32.h"
+
+#define ENTRY_HEADER_SIZE   8u      // m_Token, m_Size, m_Line.
+#define SITE_SIZE           8u      // UDF address, entry offset in .fault_assert.
+#define MAX_TOKEN           0xFFFFu
+
+typedef struct
+{
+    uint16_t m_Token;
+    uint32_t m_Line;
+    uint32_t m_Offset;              // In .fault_assert, what a site refers to.
+    const char* m_File;
+    const char* m_Expr;
+} assertEntryType;
+
+typedef struct
+{
+    uint32_t m_Pc;
+    const assertEntryType* m_Entry;
+} assertSiteType;
+
+/* Parse the side section
+ * - Entries are variable length and 4 byte aligned, each carries its own size
+*/
+static uint32_t parseEntries(const uint8_t* aData, uint32_t size, assertEntryType* aEntries)
+{
+    uint32_t offset = 0;
+    uint32_t count = 0;
+
+    while((offset + ENTRY_HEADER_SIZE) <= size)
+    {
+        const uint8_t* entry = aData + offset;
+        uint16_t entrySize;
+        size_t fileLength;
+
+        memcpy(&entrySize, entry + 2, sizeof(entrySize));
+        if((entrySize < ENTRY_HEADER_SIZE) || (entrySize > (size - offset)))
+        {
+            fprintf(stderr, "warning: corrupt entry at offset %u\n", offset);
+            break;
+        }
+
+        fileLength = strnlen((const char*)entry + ENTRY_HEADER_SIZE, entrySize - ENTRY_HEADER_SIZE);
+        if((ENTRY_HEADER_SIZE + fileLength + 1) < entrySize)
+        {
+            memcpy(&aEntries[count].m_Token, entry, sizeof(aEntries[count].m_Token));
+            memcpy(&aEntries[count].m_Line, entry + 4, sizeof(aEntries[count].m_Line));
+            aEntries[count].m_Offset = offset;
+            aEntries[count].m_File = (const char*)entry + ENTRY_HEADER_SIZE;
+            aEntries[count].m_Expr = aEntries[count].m_File + fileLength + 1;
+            count++;
+        }
+
+        offset += (entrySize + 3u) & ~3u;
+    }
+    return count;
+}
+
+/* Parse the sites section
+ * - One per UDF, an assert inlined in several places has several
+ * - Returns the number found, sites naming no entry are dropped
+*/
+static uint32_t parseSites(const uint8_t* aData, uint32_t size, const assertEntryType* aEntries, uint32_t entryCount, assertSiteType* aSites)
+{
+    uint32_t offset;
+    uint32_t count = 0;
+    uint32_t i;
+
+    for(offset = 0; (offset + SITE_SIZE) <= size; offset += SITE_SIZE)
+    {
+        uint32_t words[2];
+
+        memcpy(words, aData + offset, sizeof(words));
+        for(i = 0; (i < entryCount) && (aEntries[i].m_Offset != words[1]); i++)
+            ;
+        if(i == entryCount)
+        {
+            fprintf(stderr, "warning: site %08x names no entry\n", words[0]);
+            continue;
+        }
+        aSites[count].m_Pc = words[0] & ~1u;
+        aSites[count].m_Entry = &aEntries[i];
+        count++;
+    }
+    return count;
+}
+
+static void printEntry(const assertEntryType* aEntry, uint32_t pc)
+{
+    if(pc != 0)
+        printf("%08x ", pc);
+    printf("%04x %s:%u: FAULT_ASSERT(%s)\n", aEntry->m_Token, aEntry->m_File, aEntry->m_Line, aEntry->m_Expr);
+}
+
+/* Tokens that don't map back to a single assert
+ * - Errors when they are all there is to go on, otherwise notes
+ * - Returns the number found
+*/
+static uint32_t checkTokens(const assertEntryType* aEntries, uint32_t count, int fatal)
+{
+    const char* level = fatal ? "error" : "note";
+    uint32_t problems = 0;
+    uint32_t i;
+    uint32_t j;
+
+    for(i = 0; i < count; i++)
+    {
+        const assertEntryType* entry = &aEntries[i];
+
+        if(entry->m_Line > 0xFFFu)
+        {
+            fprintf(stderr, "%s: %s:%u: past line 4095, the token wraps%s\n", level,
+                    entry->m_File, entry->m_Line, fatal ? ", move the assert or split the file" : "");
+            problems++;
+        }
+        for(j = 0; j < i; j++)
+        {
+            const assertEntryType* other = &aEntries[j];
+
+            if((other->m_Token != entry->m_Token) ||
+               ((other->m_Line == entry->m_Line) && (strcmp(other->m_File, entry->m_File) == 0) && (strcmp(other->m_Expr, entry->m_Expr) == 0)))
+                continue;
+            fprintf(stderr, "%s: %s:%u: token %04x is shared with %s:%u, %s\n", level,
+                    entry->m_File, entry->m_Line, entry->m_Token, other->m_File, other->m_Line,
+                    fatal ? "set FAULT_ASSERT_FILE_ID" : "look it up by PC");
+            problems++;
+            break;
+        }
+    }
+    return problems;
+}
+
+int main(int argc, char** argv)
+{
+    elf32FileType elf;
+    const Elf32_Shdr* section;
+    const Elf32_Shdr* siteSection;
+    const uint8_t* data;
+    const uint8_t* siteData;
+    assertEntryType* entries;
+    assertSiteType* sites;
+    uint32_t count;
+    uint32_t siteCount = 0;
+    uint32_t i;
+    uint32_t j;
+    int result = 0;
+
+    if(argc < 2)
+    {
+        fprintf(stderr, "usage: %s firmware.elf [token|PC ...]\n", argv[0]);
+        return 2;
+    }
+    if(elf32Open(&elf, argv[1]) != 0)
+        return 1;
+
+    section = elf32FindSection(&elf, ".fault_assert");
+    data = section ? elf32SectionData(&elf, section) : NULL;
+    if(data == NULL)
+    {
+        fprintf(stderr, "%s: no .fault_assert section, is faultAssert.ld included?\n", argv[1]);
+        elf32Close(&elf);
+        return 1;
+    }
+    siteSection = elf32FindSection(&elf, ".fault_assert_sites");
+    siteData = siteSection ? elf32SectionData(&elf, siteSection) : NULL;
+
+    entries = calloc((section->sh_size / ENTRY_HEADER_SIZE) + 1, sizeof(assertEntryType));
+    sites = calloc((siteData ? (siteSection->sh_size / SITE_SIZE) : 0) + 1, sizeof(assertSiteType));
+    if((entries == NULL) || (sites == NULL))
+    {
+        free(entries);
+        free(sites);
+        elf32Close(&elf);
+        return 1;
+    }
+    count = parseEntries(data, section->sh_size, entries);
+    if(siteData != NULL)
+        siteCount = parseSites(siteData, siteSection->sh_size, entries, count, sites);
+    if((checkTokens(entries, count, siteData == NULL) != 0) && (siteData == NULL))
+        result = 1;
+
+    if(argc == 2)
+    {
+        if(siteData == NULL)
+        {
+            for(i = 0; i < count; i++)
+                printEntry(&entries[i], 0);
+        }
+        for(i = 0; i < siteCount; i++)
+            printEntry(sites[i].m_Entry, sites[i].m_Pc);
+    }
+
+    for(i = 2; i < (uint32_t)argc; i++)
+    {
+        uint32_t value = (uint32_t)strtoul(argv[i], NULL, 16);
+        int found = 0;
+
+        if(value > MAX_TOKEN)
+        {
+            for(j = 0; j < siteCount; j++)
+            {
+                if(sites[j].m_Pc == (value & ~1u))
+                {
+                    printEntry(sites[j].m_Entry, sites[j].m_Pc);
+                    found = 1;
+                }
+            }
+        }
+        else
+        {
+            for(j = 0; j < count; j++)
+            {
+                if(entries[j].m_Token == value)
+                {
+                    printEntry(&entries[j], 0);
+                    found = 1;
+                }
+            }
+        }
+        if(!found)
+        {
+            printf("%04x unknown %s\n", value, (value > MAX_TOKEN) ? "PC" : "token");
+            result = 1;
+        }
+    }
+
+    free(entries);
+    free(sites);
+    elf32Close(&elf);
+    return result;
+}
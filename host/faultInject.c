@@ -0,0 +1,699 @@
+/*
+ * faultInject.c
+ *
+ *  Created on: 18 Oct 2026
+ *
+ *  Fault injection campaign on the Thumb-2 emulator
+ *  - Each run boots the firmware from reset, runs a random number of instructions, injects
+ *    one fault and checks that the handlers in exceptions.c commit a valid crash record
+ *    that matches the fault the core took
+ *  - Injections: register bit flips, RAM bit flips (half of them in the live stack), bad
+ *    pointers, corrupted return addresses, and faults raised directly with a chosen CFSR
+ *    bit so the rarer reasons (stacking, lazy FP) are covered too
+ *  - Runs are spread over worker threads, each owning a range of run numbers that idle
+ *    workers steal half of, and every run is seeded from its number so -r repeats it alone
+ *  - Peripherals read as zero, so -b should stay inside code the firmware reaches without them
+ *  - Build: gcc -O2 -pthread -o faultInject faultInject.c thumbEmuTarget.c thumbEmu.c crashArchive.c elf32.c -lm
+ *  - Usage: faultInject [-j threads] [-n runs] [-b instructions] [-l instructions] [-s seed] [-r run] firmware.elf
+ */
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "../exceptions.h"
+#include "crashArchive.h"
+#include "elf32.h"
+#include "thumbEmuTarget.h"
+
+#define DEFAULT_RUNS            1000u
+#define DEFAULT_BOOT            100000u     // Most instructions run before injecting.
+#define DEFAULT_LIMIT           2000000u    // Instructions allowed after injecting.
+#define MAX_FAILURES            32u         // Failing runs kept per worker for the report.
+#define CHUNK                   4096u       // Instructions between record checks in the handler.
+#define STACK_WORDS             64u         // Stack searched for a return address to corrupt.
+
+#define EXC_RETURN_PSP          (1u<<2)
+#define CFSR_MMARVALID          (1u<<7)
+#define CFSR_BFARVALID          (1u<<15)
+#define HFSR_VECTTBL            (1u<<1)
+#define HFSR_FORCED             (1u<<30)
+
+typedef enum
+{
+    Inject_Register,
+    Inject_Memory,
+    Inject_Pointer,
+    Inject_Return,
+    Inject_Direct,
+    Inject_Count
+} injectType;
+
+typedef enum
+{
+    Outcome_Masked,         // No fault within the limit, the injection did no visible harm.
+    Outcome_Captured,       // Valid record matching the fault taken.
+    Outcome_Mismatch,       // Valid record, but for something else (a fault inside the handler, say).
+    Outcome_NoRecord,       // Handler finished without committing a record.
+    Outcome_Lockup,         // Fault while the core could not take one.
+    Outcome_Hang,           // Handler entered, limit reached without a record.
+    Outcome_Count
+} outcomeType;
+
+typedef struct
+{
+    uint64_t m_Run;
+    injectType m_Inject;
+    outcomeType m_Outcome;
+    uint32_t m_Exception;       // Fault handler entered first, 0 if none.
+    uint32_t m_Cfsr;            // Fault status on entry.
+    uint32_t m_Hfsr;
+    uint32_t m_Pc;              // Stacked PC on entry.
+    char m_Description[80];
+} runResultType;
+
+typedef struct
+{
+    uint64_t m_Outcomes[Inject_Count][Outcome_Count];
+    uint64_t m_Entered[THUMB_EMU_USAGE_FAULT + 1];
+    uint64_t m_EnteredCaptured[THUMB_EMU_USAGE_FAULT + 1];
+    uint64_t m_CfsrBits[32];
+    uint64_t m_CfsrCaptured[32];
+    uint64_t m_HfsrBits[32];
+    uint64_t m_Instructions;
+    runResultType m_Failures[MAX_FAILURES];
+    uint32_t m_FailureCount;
+} statsType;
+
+typedef struct
+{
+    pthread_mutex_t m_Lock;
+    uint64_t m_Next;            // The owner takes runs from here up.
+    uint64_t m_End;             // Thieves take the top half below here.
+} runQueueType;
+
+typedef struct
+{
+    pthread_t m_Thread;
+    uint32_t m_Index;
+    runQueueType m_Queue;
+    thumbEmuTargetType m_Target;
+    statsType m_Stats;
+} workerType;
+
+typedef struct
+{
+    uint64_t m_Runs;
+    uint64_t m_Boot;
+    uint64_t m_Limit;
+    uint64_t m_Seed;
+    uint64_t m_OnlyRun;
+    int m_HasOnlyRun;
+    uint32_t m_Workers;
+} injectOptionsType;
+
+static const char* const injectNames[Inject_Count] =
+{
+    "register",
+    "memory",
+    "pointer",
+    "return",
+    "direct"
+};
+
+static const char* const outcomeNames[Outcome_Count] =
+{
+    "masked",
+    "captured",
+    "mismatch",
+    "no record",
+    "lockup",
+    "hang"
+};
+
+static const char* const exceptionNames[THUMB_EMU_USAGE_FAULT + 1] =
+{
+    "", "", "", "HardFault", "MemManage", "BusFault", "UsageFault"
+};
+
+static const char* const cfsrNames[32] =
+{
+    "IACCVIOL", "DACCVIOL", "", "MUNSTKERR", "MSTKERR", "MLSPERR", "", "MMARVALID",
+    "IBUSERR", "PRECISERR", "IMPRECISERR", "UNSTKERR", "STKERR", "LSPERR", "", "BFARVALID",
+    "UNDEFINSTR", "INVSTATE", "INVPC", "NOCP", "", "", "", "",
+    "UNALIGNED", "DIVBYZERO", "", "", "", "", "", ""
+};
+
+// Every fault reason, for faults raised directly.
+static const struct
+{
+    uint32_t m_Exception;
+    uint32_t m_Cfsr;
+    uint32_t m_Hfsr;
+} directReasons[] =
+{
+    {THUMB_EMU_HARD_FAULT,  0,                          HFSR_VECTTBL},
+    {THUMB_EMU_MEM_MANAGE,  (1u<<0),                    0},
+    {THUMB_EMU_MEM_MANAGE,  (1u<<1)|CFSR_MMARVALID,     0},
+    {THUMB_EMU_MEM_MANAGE,  (1u<<3),                    0},
+    {THUMB_EMU_MEM_MANAGE,  (1u<<4),                    0},
+    {THUMB_EMU_MEM_MANAGE,  (1u<<5),                    0},
+    {THUMB_EMU_BUS_FAULT,   (1u<<8),                    0},
+    {THUMB_EMU_BUS_FAULT,   (1u<<9)|CFSR_BFARVALID,     0},
+    {THUMB_EMU_BUS_FAULT,   (1u<<10),                   0},
+    {THUMB_EMU_BUS_FAULT,   (1u<<11),                   0},
+    {THUMB_EMU_BUS_FAULT,   (1u<<12),                   0},
+    {THUMB_EMU_BUS_FAULT,   (1u<<13),                   0},
+    {THUMB_EMU_USAGE_FAULT, (1u<<16),                   0},
+    {THUMB_EMU_USAGE_FAULT, (1u<<17),                   0},
+    {THUMB_EMU_USAGE_FAULT, (1u<<18),                   0},
+    {THUMB_EMU_USAGE_FAULT, (1u<<19),                   0},
+    {THUMB_EMU_USAGE_FAULT, (1u<<24),                   0},
+    {THUMB_EMU_USAGE_FAULT, (1u<<25),                   0}
+};
+
+// Addresses a corrupted pointer is likely to hold.
+static const uint32_t badPointers[] =
+{
+    0x30000000u,    // Nothing mapped.
+    0xA0001000u,    // External memory controller space, unpopulated.
+    0xE0100000u,    // Vendor system space.
+    0xFFFFFFF0u,    // Top of memory.
+    0x20050000u,    // Just past the end of RAM.
+    0x08180000u     // Just past the end of flash.
+};
+
+static elf32FileType elf;
+static injectOptionsType options;
+static workerType* workers;
+
+/* Random numbers
+ * - splitmix64 turns the run number into a seed, xorshift64* runs from it
+*/
+static uint64_t splitMix(uint64_t value)
+{
+    value += 0x9E3779B97F4A7C15ull;
+    value = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9ull;
+    value = (value ^ (value >> 27)) * 0x94D049BB133111EBull;
+    return value ^ (value >> 31);
+}
+
+static uint32_t randomNext(uint64_t* aState)
+{
+    *aState ^= *aState >> 12;
+    *aState ^= *aState << 25;
+    *aState ^= *aState >> 27;
+    return (uint32_t)((*aState * 0x2545F4914F6CDD1Dull) >> 32);
+}
+
+static uint32_t randomBelow(uint64_t* aState, uint32_t limit)
+{
+    return (uint32_t)(((uint64_t)randomNext(aState) * limit) >> 32);
+}
+
+static uint32_t stackedPc(thumbEmuType* aEmu)
+{
+    uint32_t frame = (aEmu->m_R[14] & EXC_RETURN_PSP) ? aEmu->m_Psp : aEmu->m_Msp;
+    uint32_t pc = 0;
+
+    thumbEmuRead(aEmu, frame + 24, 4, &pc);
+    return pc;
+}
+
+static void injectRegister(thumbEmuType* aEmu, uint64_t* aRandom, runResultType* aResult)
+{
+    uint32_t reg = randomBelow(aRandom, 16);
+    uint32_t bit = randomBelow(aRandom, 32);
+
+    // PC bit 0 isn't stored, flip a bit that is.
+    if((reg == 15) && (bit == 0))
+        bit = 1;
+    aEmu->m_R[reg] ^= 1u << bit;
+    snprintf(aResult->m_Description, sizeof(aResult->m_Description), "r%u bit %u", reg, bit);
+}
+
+static void injectMemory(thumbEmuType* aEmu, uint64_t* aRandom, runResultType* aResult)
+{
+    uint32_t sp = aEmu->m_R[13];
+    uint32_t bit = randomBelow(aRandom, 32);
+    uint32_t address;
+    uint32_t value = 0;
+
+    if(randomBelow(aRandom, 2) && (sp >= THUMB_EMU_TARGET_RAM_BASE) && (sp < CRASH_RECORD_ADDRESS))
+        address = sp + (randomBelow(aRandom, STACK_WORDS) * 4);
+    else
+        address = THUMB_EMU_TARGET_RAM_BASE + (randomBelow(aRandom, (CRASH_RECORD_ADDRESS - THUMB_EMU_TARGET_RAM_BASE) / 4) * 4);
+    thumbEmuRead(aEmu, address, 4, &value);
+    thumbEmuWrite(aEmu, address, 4, value ^ (1u << bit));
+    snprintf(aResult->m_Description, sizeof(aResult->m_Description), "[%08x] bit %u", address, bit);
+}
+
+static void injectPointer(thumbEmuType* aEmu, uint64_t* aRandom, runResultType* aResult)
+{
+    uint32_t reg = randomBelow(aRandom, 8);
+    uint32_t choice = randomBelow(aRandom, (sizeof(badPointers) / sizeof(badPointers[0])) + 2);
+    uint32_t value;
+
+    if(choice < (sizeof(badPointers) / sizeof(badPointers[0])))
+        value = badPointers[choice];
+    else if(choice == (sizeof(badPointers) / sizeof(badPointers[0])))
+        value = aEmu->m_R[reg] | 1u;    // Misaligned.
+    else
+        value = randomNext(aRandom);
+    aEmu->m_R[reg] = value;
+    snprintf(aResult->m_Description, sizeof(aResult->m_Description), "r%u = %08x", reg, value);
+}
+
+/* Corrupt a return address
+ * - The first stacked word that looks like a Thumb code address, or LR if there is none
+*/
+static void injectReturn(thumbEmuType* aEmu, uint64_t* aRandom, runResultType* aResult)
+{
+    static const uint32_t targets[] = {0x30000001u, 0x08000000u, 0x20000001u, 0xFFFFFFFFu};
+    uint32_t value = (randomBelow(aRandom, 2) != 0) ? targets[randomBelow(aRandom, 4)] : randomNext(aRandom);
+    uint32_t sp = aEmu->m_R[13];
+    uint32_t i;
+
+    for(i = 0; i < STACK_WORDS; i++)
+    {
+        uint32_t word = 0;
+
+        if(thumbEmuRead(aEmu, sp + (i * 4), 4, &word) != 0)
+            break;
+        if((word & 1u) && (word >= THUMB_EMU_TARGET_FLASH_BASE) && (word < (THUMB_EMU_TARGET_FLASH_BASE + THUMB_EMU_TARGET_FLASH_SIZE)))
+        {
+            thumbEmuWrite(aEmu, sp + (i * 4), 4, value);
+            snprintf(aResult->m_Description, sizeof(aResult->m_Description), "[%08x] %08x -> %08x", sp + (i * 4), word, value);
+            return;
+        }
+    }
+    snprintf(aResult->m_Description, sizeof(aResult->m_Description), "lr %08x -> %08x", aEmu->m_R[14], value);
+    aEmu->m_R[14] = value;
+}
+
+static void injectDirect(thumbEmuType* aEmu, uint64_t* aRandom, runResultType* aResult)
+{
+    uint32_t reason = randomBelow(aRandom, sizeof(directReasons) / sizeof(directReasons[0]));
+    uint32_t address = badPointers[randomBelow(aRandom, sizeof(badPointers) / sizeof(badPointers[0]))];
+
+    snprintf(aResult->m_Description, sizeof(aResult->m_Description), "%s CFSR=%08x HFSR=%08x at %08x", exceptionNames[directReasons[reason].m_Exception],
+             directReasons[reason].m_Cfsr, directReasons[reason].m_Hfsr, aEmu->m_R[15]);
+    aEmu->m_Hfsr |= directReasons[reason].m_Hfsr;
+    thumbEmuFault(aEmu, directReasons[reason].m_Exception, directReasons[reason].m_Cfsr, address);
+}
+
+/* Run until a fault handler is entered
+ * - Stepped one instruction at a time so the entry state can be read before the handler
+ *   changes anything
+*/
+static uint32_t runToFault(thumbEmuType* aEmu, uint64_t limit, thumbEmuStopType* aStop)
+{
+    uint64_t end = aEmu->m_Instructions + limit;
+
+    *aStop = ThumbEmu_Limit;
+    while(aEmu->m_Instructions < end)
+    {
+        uint32_t before = aEmu->m_Ipsr;
+
+        *aStop = thumbEmuRun(aEmu, 1);
+        if((aEmu->m_Ipsr != before) && (aEmu->m_Ipsr >= THUMB_EMU_HARD_FAULT) && (aEmu->m_Ipsr <= THUMB_EMU_USAGE_FAULT))
+            return aEmu->m_Ipsr;
+        if((*aStop != ThumbEmu_Limit) && (*aStop != ThumbEmu_Sleep))
+            return 0;
+    }
+    return 0;
+}
+
+/* Run the handler until it commits a record, stops or runs out of instructions
+*/
+static const crashRecordType* runHandler(thumbEmuTargetType* aTarget, uint64_t limit, thumbEmuStopType* aStop)
+{
+    thumbEmuType* emu = &aTarget->m_Emu;
+    const uint8_t* record = aTarget->m_Ram + (CRASH_RECORD_ADDRESS - THUMB_EMU_TARGET_RAM_BASE);
+    uint64_t end = emu->m_Instructions + limit;
+
+    *aStop = ThumbEmu_Limit;
+    while(emu->m_Instructions < end)
+    {
+        uint64_t chunk = end - emu->m_Instructions;
+
+        *aStop = thumbEmuRun(emu, (chunk < CHUNK) ? chunk : CHUNK);
+        if(crashArchiveValidate(record, CRASH_RECORD_SIZE) != 0)
+            return (const crashRecordType*)record;
+        if((*aStop != ThumbEmu_Limit) && (*aStop != ThumbEmu_Sleep))
+            break;
+    }
+    return NULL;
+}
+
+static void runOne(thumbEmuTargetType* aTarget, uint64_t run, runResultType* aResult)
+{
+    thumbEmuType* emu = &aTarget->m_Emu;
+    uint64_t random = splitMix(options.m_Seed ^ splitMix(run)) | 1u;
+    const crashRecordType* record;
+    thumbEmuStopType stop;
+
+    memset(aResult, 0, sizeof(*aResult));
+    aResult->m_Run = run;
+    aResult->m_Inject = (injectType)randomBelow(&random, Inject_Count);
+
+    thumbEmuTargetReset(aTarget);
+    memset(aTarget->m_Ram + (CRASH_RECORD_ADDRESS - THUMB_EMU_TARGET_RAM_BASE), 0, CRASH_RECORD_SIZE);
+
+    // Boot, a fault here is the firmware's own and is checked like any other.
+    aResult->m_Exception = runToFault(emu, 1 + randomBelow(&random, (uint32_t)options.m_Boot), &stop);
+    if(aResult->m_Exception == 0)
+    {
+        switch(aResult->m_Inject)
+        {
+            case Inject_Register:   injectRegister(emu, &random, aResult); break;
+            case Inject_Memory:     injectMemory(emu, &random, aResult); break;
+            case Inject_Pointer:    injectPointer(emu, &random, aResult); break;
+            case Inject_Return:     injectReturn(emu, &random, aResult); break;
+            default:                injectDirect(emu, &random, aResult); break;
+        }
+        if(emu->m_Stop == ThumbEmu_Lockup)
+        {
+            aResult->m_Outcome = Outcome_Lockup;
+            return;
+        }
+        if((emu->m_Ipsr >= THUMB_EMU_HARD_FAULT) && (emu->m_Ipsr <= THUMB_EMU_USAGE_FAULT) && emu->m_Active[emu->m_Ipsr])
+            aResult->m_Exception = emu->m_Ipsr;
+        else
+            aResult->m_Exception = runToFault(emu, options.m_Limit, &stop);
+    }
+    else
+        snprintf(aResult->m_Description, sizeof(aResult->m_Description), "faulted before injection");
+
+    if(aResult->m_Exception == 0)
+    {
+        aResult->m_Outcome = (stop == ThumbEmu_Lockup) ? Outcome_Lockup : Outcome_Masked;
+        return;
+    }
+    aResult->m_Cfsr = emu->m_Cfsr;
+    aResult->m_Hfsr = emu->m_Hfsr;
+    aResult->m_Pc = stackedPc(emu);
+
+    record = runHandler(aTarget, options.m_Limit, &stop);
+    if(record == NULL)
+    {
+        if(stop == ThumbEmu_Lockup)
+            aResult->m_Outcome = Outcome_Lockup;
+        else
+            aResult->m_Outcome = (stop == ThumbEmu_Limit) ? Outcome_Hang : Outcome_NoRecord;
+        return;
+    }
+    if((thumbEmuTargetException(record->m_Type) == aResult->m_Exception) && (record->m_Pc == aResult->m_Pc) &&
+       ((record->m_Cfsr & aResult->m_Cfsr) == aResult->m_Cfsr))
+        aResult->m_Outcome = Outcome_Captured;
+    else
+        aResult->m_Outcome = Outcome_Mismatch;
+}
+
+static void account(statsType* aStats, const runResultType* aResult)
+{
+    uint32_t bit;
+
+    aStats->m_Outcomes[aResult->m_Inject][aResult->m_Outcome]++;
+    if(aResult->m_Exception != 0)
+    {
+        aStats->m_Entered[aResult->m_Exception]++;
+        if(aResult->m_Outcome == Outcome_Captured)
+            aStats->m_EnteredCaptured[aResult->m_Exception]++;
+        for(bit = 0; bit < 32; bit++)
+        {
+            if(aResult->m_Cfsr & (1u << bit))
+            {
+                aStats->m_CfsrBits[bit]++;
+                if(aResult->m_Outcome == Outcome_Captured)
+                    aStats->m_CfsrCaptured[bit]++;
+            }
+            if(aResult->m_Hfsr & (1u << bit))
+                aStats->m_HfsrBits[bit]++;
+        }
+    }
+    if((aResult->m_Outcome != Outcome_Masked) && (aResult->m_Outcome != Outcome_Captured) && (aStats->m_FailureCount < MAX_FAILURES))
+        aStats->m_Failures[aStats->m_FailureCount++] = *aResult;
+}
+
+/* Work stealing
+ * - A thief takes the top half of a victim's remaining runs, the owner keeps the rest
+*/
+static int takeRun(workerType* aWorker, uint64_t* aRun)
+{
+    uint32_t i;
+
+    pthread_mutex_lock(&aWorker->m_Queue.m_Lock);
+    if(aWorker->m_Queue.m_Next < aWorker->m_Queue.m_End)
+    {
+        *aRun = aWorker->m_Queue.m_Next++;
+        pthread_mutex_unlock(&aWorker->m_Queue.m_Lock);
+        return 1;
+    }
+    pthread_mutex_unlock(&aWorker->m_Queue.m_Lock);
+
+    for(i = 1; i < options.m_Workers; i++)
+    {
+        runQueueType* victim = &workers[(aWorker->m_Index + i) % options.m_Workers].m_Queue;
+        uint64_t begin;
+        uint64_t end;
+
+        pthread_mutex_lock(&victim->m_Lock);
+        end = victim->m_End;
+        begin = victim->m_Next + ((victim->m_End - victim->m_Next) / 2);
+        victim->m_End = begin;
+        pthread_mutex_unlock(&victim->m_Lock);
+        if(begin == end)
+            continue;
+
+        // Keep the first stolen run, queue the rest for others to steal back.
+        pthread_mutex_lock(&aWorker->m_Queue.m_Lock);
+        aWorker->m_Queue.m_Next = begin + 1;
+        aWorker->m_Queue.m_End = end;
+        pthread_mutex_unlock(&aWorker->m_Queue.m_Lock);
+        *aRun = begin;
+        return 1;
+    }
+    return 0;
+}
+
+static void* workerMain(void* aArgument)
+{
+    workerType* worker = (workerType*)aArgument;
+    runResultType result;
+    uint64_t run;
+
+    while(takeRun(worker, &run))
+    {
+        runOne(&worker->m_Target, run, &result);
+        account(&worker->m_Stats, &result);
+        worker->m_Stats.m_Instructions += worker->m_Target.m_Emu.m_Instructions;
+    }
+    return NULL;
+}
+
+static void printResult(const runResultType* aResult)
+{
+    const elf32FunctionType* function = elf32FindFunction(&elf, aResult->m_Pc);
+
+    printf("run %llu: %s %s, %s", (unsigned long long)aResult->m_Run, injectNames[aResult->m_Inject], aResult->m_Description,
+           outcomeNames[aResult->m_Outcome]);
+    if(aResult->m_Exception != 0)
+    {
+        printf(" in %s, CFSR=%08x HFSR=%08x PC=%08x", exceptionNames[aResult->m_Exception], aResult->m_Cfsr, aResult->m_Hfsr, aResult->m_Pc);
+        if(function != NULL)
+            printf(" %s+0x%x", function->m_Name, aResult->m_Pc - function->m_Address);
+    }
+    printf("\n");
+}
+
+static int compareFailures(const void* aLeft, const void* aRight)
+{
+    const runResultType* left = (const runResultType*)aLeft;
+    const runResultType* right = (const runResultType*)aRight;
+
+    return (left->m_Run > right->m_Run) - (left->m_Run < right->m_Run);
+}
+
+static int report(statsType* aTotal, double seconds)
+{
+    uint64_t failures = 0;
+    uint32_t i;
+    uint32_t j;
+
+    printf("%llu runs, %.1f s, %.1f M instructions/s\n\n", (unsigned long long)options.m_Runs, seconds,
+           (seconds > 0) ? ((double)aTotal->m_Instructions / seconds / 1e6) : 0.0);
+
+    printf("%-10s", "inject");
+    for(j = 0; j < Outcome_Count; j++)
+        printf("%11s", outcomeNames[j]);
+    printf("\n");
+    for(i = 0; i < Inject_Count; i++)
+    {
+        printf("%-10s", injectNames[i]);
+        for(j = 0; j < Outcome_Count; j++)
+        {
+            printf("%11llu", (unsigned long long)aTotal->m_Outcomes[i][j]);
+            if((j != Outcome_Masked) && (j != Outcome_Captured))
+                failures += aTotal->m_Outcomes[i][j];
+        }
+        printf("\n");
+    }
+
+    printf("\n%-12s%10s%10s\n", "exception", "entered", "captured");
+    for(i = THUMB_EMU_HARD_FAULT; i <= THUMB_EMU_USAGE_FAULT; i++)
+        printf("%-12s%10llu%10llu\n", exceptionNames[i], (unsigned long long)aTotal->m_Entered[i], (unsigned long long)aTotal->m_EnteredCaptured[i]);
+    printf("%-12s%10llu\n", "FORCED", (unsigned long long)aTotal->m_HfsrBits[30]);
+    printf("%-12s%10llu\n", "VECTTBL", (unsigned long long)aTotal->m_HfsrBits[1]);
+
+    printf("\n%-12s%10s%10s\n", "CFSR bit", "entered", "captured");
+    for(i = 0; i < 32; i++)
+    {
+        if(cfsrNames[i][0] != '\0')
+            printf("%-12s%10llu%10llu%s\n", cfsrNames[i], (unsigned long long)aTotal->m_CfsrBits[i],
+                   (unsigned long long)aTotal->m_CfsrCaptured[i], (aTotal->m_CfsrBits[i] == 0) ? "  not covered" : "");
+    }
+
+    if(aTotal->m_FailureCount != 0)
+    {
+        printf("\n");
+        qsort(aTotal->m_Failures, aTotal->m_FailureCount, sizeof(runResultType), compareFailures);
+        for(i = 0; i < aTotal->m_FailureCount; i++)
+            printResult(&aTotal->m_Failures[i]);
+    }
+    printf("\n%llu of %llu runs failed to capture a record\n", (unsigned long long)failures, (unsigned long long)options.m_Runs);
+    return (failures != 0) ? 1 : 0;
+}
+
+static void merge(statsType* aTotal, const statsType* aStats)
+{
+    uint32_t i;
+    uint32_t j;
+
+    for(i = 0; i < Inject_Count; i++)
+    {
+        for(j = 0; j < Outcome_Count; j++)
+            aTotal->m_Outcomes[i][j] += aStats->m_Outcomes[i][j];
+    }
+    for(i = 0; i <= THUMB_EMU_USAGE_FAULT; i++)
+    {
+        aTotal->m_Entered[i] += aStats->m_Entered[i];
+        aTotal->m_EnteredCaptured[i] += aStats->m_EnteredCaptured[i];
+    }
+    for(i = 0; i < 32; i++)
+    {
+        aTotal->m_CfsrBits[i] += aStats->m_CfsrBits[i];
+        aTotal->m_CfsrCaptured[i] += aStats->m_CfsrCaptured[i];
+        aTotal->m_HfsrBits[i] += aStats->m_HfsrBits[i];
+    }
+    aTotal->m_Instructions += aStats->m_Instructions;
+    for(i = 0; (i < aStats->m_FailureCount) && (aTotal->m_FailureCount < MAX_FAILURES); i++)
+        aTotal->m_Failures[aTotal->m_FailureCount++] = aStats->m_Failures[i];
+}
+
+static void usage(const char* aName)
+{
+    fprintf(stderr, "usage: %s [-j threads] [-n runs] [-b instructions] [-l instructions] [-s seed] [-r run] firmware.elf\n", aName);
+}
+
+int main(int argc, char** argv)
+{
+    static statsType total;
+    struct timespec start;
+    struct timespec finish;
+    uint64_t perWorker;
+    uint32_t i;
+    int option;
+
+    options.m_Runs = DEFAULT_RUNS;
+    options.m_Boot = DEFAULT_BOOT;
+    options.m_Limit = DEFAULT_LIMIT;
+    options.m_Seed = (uint64_t)time(NULL);
+    options.m_Workers = (uint32_t)sysconf(_SC_NPROCESSORS_ONLN);
+    while((option = getopt(argc, argv, "b:j:l:n:r:s:")) != -1)
+    {
+        switch(option)
+        {
+            case 'b':   options.m_Boot = strtoull(optarg, NULL, 0); break;
+            case 'j':   options.m_Workers = (uint32_t)strtoul(optarg, NULL, 0); break;
+            case 'l':   options.m_Limit = strtoull(optarg, NULL, 0); break;
+            case 'n':   options.m_Runs = strtoull(optarg, NULL, 0); break;
+            case 'r':   options.m_OnlyRun = strtoull(optarg, NULL, 0); options.m_HasOnlyRun = 1; break;
+            case 's':   options.m_Seed = strtoull(optarg, NULL, 0); break;
+            default:
+                usage(argv[0]);
+                return 2;
+        }
+    }
+    if(((argc - optind) != 1) || (options.m_Boot == 0) || (options.m_Boot > UINT32_MAX))
+    {
+        usage(argv[0]);
+        return 2;
+    }
+    if(options.m_Workers == 0)
+        options.m_Workers = 1;
+    if(elf32Open(&elf, argv[optind]) != 0)
+        return 1;
+
+    if(options.m_HasOnlyRun)
+    {
+        static thumbEmuTargetType target;
+        runResultType result;
+
+        if(thumbEmuTargetOpen(&target, &elf) != 0)
+        {
+            fprintf(stderr, "out of memory\n");
+            return 1;
+        }
+        runOne(&target, options.m_OnlyRun, &result);
+        printResult(&result);
+        thumbEmuTargetClose(&target);
+        elf32Close(&elf);
+        return ((result.m_Outcome == Outcome_Masked) || (result.m_Outcome == Outcome_Captured)) ? 0 : 1;
+    }
+
+    if((uint64_t)options.m_Workers > options.m_Runs)
+        options.m_Workers = (options.m_Runs != 0) ? (uint32_t)options.m_Runs : 1;
+    workers = calloc(options.m_Workers, sizeof(workerType));
+    if(workers == NULL)
+    {
+        fprintf(stderr, "out of memory\n");
+        return 1;
+    }
+    printf("seed %llu, %u workers\n", (unsigned long long)options.m_Seed, options.m_Workers);
+
+    // Each worker starts with an equal share.
+    perWorker = options.m_Runs / options.m_Workers;
+    for(i = 0; i < options.m_Workers; i++)
+    {
+        workers[i].m_Index = i;
+        pthread_mutex_init(&workers[i].m_Queue.m_Lock, NULL);
+        workers[i].m_Queue.m_Next = i * perWorker;
+        workers[i].m_Queue.m_End = (i == (options.m_Workers - 1)) ? options.m_Runs : ((i + 1) * perWorker);
+        if(thumbEmuTargetOpen(&workers[i].m_Target, &elf) != 0)
+        {
+            fprintf(stderr, "out of memory\n");
+            return 1;
+        }
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for(i = 0; i < options.m_Workers; i++)
+        pthread_create(&workers[i].m_Thread, NULL, workerMain, &workers[i]);
+    for(i = 0; i < options.m_Workers; i++)
+    {
+        pthread_join(workers[i].m_Thread, NULL);
+        merge(&total, &workers[i].m_Stats);
+        thumbEmuTargetClose(&workers[i].m_Target);
+        pthread_mutex_destroy(&workers[i].m_Queue.m_Lock);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &finish);
+
+    i = (uint32_t)report(&total, (double)(finish.tv_sec - start.tv_sec) + ((double)(finish.tv_nsec - start.tv_nsec) / 1e9));
+    free(workers);
+    elf32Close(&elf);
+    return (int)i;
+}
@@ -0,0 +1,225 @@
+/*
+ * fpbPatch.c
+ *
+ *  Created on: 18 Oct 2026
+ *
+ *  Builds the FPB patch table (exceptionsPatch.h) for a firmware ELF
+ *  - Each patch replaces the aligned code word at an address, given as a symbol, symbol+offset
+ *    or hex address, with a hex word or b:target, a B.W to a symbol or address
+ *  - The original word and the build-id come from the ELF, the firmware refuses the table on
+ *    any other build
+ *  - Writes the raw table, program it at EXCEPTIONS_PATCH_ADDRESS along with whatever the
+ *    application's exceptionsPatchAuthorize() checks, the firmware rejects it otherwise
+ *  - Build: gcc -O2 -o fpbPatch fpbPatch.c elf32.c crashArchive.c
+ *  - Usage: fpbPatch -o patch.bin app.elf address=word|address=b:target ...
+ *      e.g. fpbPatch -o patch.bin app.elf motorStep+0x24=b:motorStepFixed
+ */
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "crashArchive.h"
+#include "elf32.h"
+#include "../exceptionsPatch.h"
+
+#define BRANCH_RANGE        (1 << 24)       // B.W reaches +-16 MB.
+
+/* Symbol, symbol+offset or a number
+ * - Returns 0, or -1 if it isn't any of them
+*/
+static int parseAddress(const elf32FileType* aElf, const char* aText, uint32_t* aAddress)
+{
+    const Elf32_Sym* symbol;
+    const char* plus = strchr(aText, '+');
+    char name[128];
+    char* end;
+    uint32_t offset = 0;
+    size_t length = plus ? (size_t)(plus - aText) : strlen(aText);
+
+    *aAddress = (uint32_t)strtoul(aText, &end, 0);
+    if((end != aText) && (*end == '\0'))
+        return 0;
+
+    if((length == 0) || (length >= sizeof(name)))
+        return -1;
+    memcpy(name, aText, length);
+    name[length] = '\0';
+    if(plus != NULL)
+    {
+        offset = (uint32_t)strtoul(plus + 1, &end, 0);
+        if((end == (plus + 1)) || (*end != '\0'))
+            return -1;
+    }
+    symbol = elf32FindSymbol(aElf, name);
+    if(symbol == NULL)
+        return -1;
+    // Function symbols carry the Thumb bit.
+    *aAddress = (symbol->st_value & ((ELF32_ST_TYPE(symbol->st_info) == STT_FUNC) ? ~1u : ~0u)) + offset;
+    return 0;
+}
+
+/* Thumb-2 B.W (T4) at address, as the word that holds both halfwords
+*/
+static int encodeBranch(uint32_t address, uint32_t target, uint32_t* aWord)
+{
+    int32_t offset = (int32_t)((target & ~1u) - (address + 4u));
+    uint32_t s;
+    uint32_t j1;
+    uint32_t j2;
+    uint32_t imm;
+
+    if((offset < -BRANCH_RANGE) || (offset >= BRANCH_RANGE))
+        return -1;
+    imm = (uint32_t)offset;
+    s = (imm >> 24) & 1u;
+    j1 = (~((imm >> 23) & 1u) ^ s) & 1u;
+    j2 = (~((imm >> 22) & 1u) ^ s) & 1u;
+    *aWord = (0xF000u | (s << 10) | ((imm >> 12) & 0x3FFu)) |
+             ((0x9000u | (j1 << 13) | (j2 << 11) | ((imm >> 1) & 0x7FFu)) << 16);
+    return 0;
+}
+
+static int parsePatch(const elf32FileType* aElf, const char* aText, exceptionsPatchType* aPatch)
+{
+    const char* equals = strchr(aText, '=');
+    char site[160];
+    char* end;
+    uint32_t target;
+
+    if((equals == NULL) || ((size_t)(equals - aText) >= sizeof(site)))
+        return -1;
+    memcpy(site, aText, (size_t)(equals - aText));
+    site[equals - aText] = '\0';
+    if(parseAddress(aElf, site, &aPatch->m_Address) != 0)
+    {
+        fprintf(stderr, "%s: no address %s\n", aText, site);
+        return -1;
+    }
+    if(aPatch->m_Address & 3u)
+    {
+        fprintf(stderr, "%s: %08x isn't word aligned, the FPB replaces whole words\n", aText, aPatch->m_Address);
+        return -1;
+    }
+    if(elf32ReadMemory(aElf, aPatch->m_Address, &aPatch->m_Original, 4, 1) != 4)
+    {
+        fprintf(stderr, "%s: %08x isn't in the ELF's code\n", aText, aPatch->m_Address);
+        return -1;
+    }
+
+    if(strncmp(equals + 1, "b:", 2) == 0)
+    {
+        if(parseAddress(aElf, equals + 3, &target) != 0)
+        {
+            fprintf(stderr, "%s: no target %s\n", aText, equals + 3);
+            return -1;
+        }
+        if(encodeBranch(aPatch->m_Address, target, &aPatch->m_Replacement) != 0)
+        {
+            fprintf(stderr, "%s: %08x is out of branch range\n", aText, target);
+            return -1;
+        }
+        return 0;
+    }
+    aPatch->m_Replacement = (uint32_t)strtoul(equals + 1, &end, 16);
+    if((end == (equals + 1)) || (*end != '\0'))
+    {
+        fprintf(stderr, "%s: expected a hex word or b:target\n", aText);
+        return -1;
+    }
+    return 0;
+}
+
+static void usage(const char* aName)
+{
+    fprintf(stderr, "usage: %s -o patch.bin app.elf address=word|address=b:target ...\n", aName);
+}
+
+int main(int argc, char** argv)
+{
+    exceptionsPatchTableType table;
+    const char* outPath = NULL;
+    const uint8_t* id;
+    uint32_t idLength;
+    elf32FileType elf;
+    FILE* file;
+    int option;
+    int i;
+
+    while((option = getopt(argc, argv, "o:")) != -1)
+    {
+        switch(option)
+        {
+            case 'o':   outPath = optarg; break;
+            default:
+                usage(argv[0]);
+                return 2;
+        }
+    }
+    if((outPath == NULL) || ((optind + 2) > argc))
+    {
+        usage(argv[0]);
+        return 2;
+    }
+    if((argc - optind - 1) > (int)EXCEPTIONS_PATCH_MAX)
+    {
+        fprintf(stderr, "at most %u patches\n", EXCEPTIONS_PATCH_MAX);
+        return 2;
+    }
+
+    if(elf32Open(&elf, argv[optind]) != 0)
+        return 1;
+    memset(&table, 0, sizeof(table));
+    if((elf32BuildId(&elf, &id, &idLength) != 0) || (idLength > EXCEPTIONS_PATCH_BUILD_ID_MAX))
+    {
+        fprintf(stderr, "%s: no build-id, link with --build-id\n", argv[optind]);
+        elf32Close(&elf);
+        return 1;
+    }
+    table.m_Magic = EXCEPTIONS_PATCH_MAGIC;
+    table.m_BuildIdLength = idLength;
+    memcpy(table.m_BuildId, id, idLength);
+
+    for(i = optind + 1; i < argc; i++)
+    {
+        exceptionsPatchType* patch = &table.m_Patches[table.m_Count];
+        uint32_t j;
+
+        if(parsePatch(&elf, argv[i], patch) != 0)
+        {
+            elf32Close(&elf);
+            return 1;
+        }
+        for(j = 0; j < table.m_Count; j++)
+        {
+            if(table.m_Patches[j].m_Address == patch->m_Address)
+            {
+                fprintf(stderr, "%s: %08x is patched twice\n", argv[i], patch->m_Address);
+                elf32Close(&elf);
+                return 1;
+            }
+        }
+        printf("%08x  %08x -> %08x\n", patch->m_Address, patch->m_Original, patch->m_Replacement);
+        table.m_Count++;
+    }
+    elf32Close(&elf);
+    table.m_Crc = crashArchiveCrc(&table, offsetof(exceptionsPatchTableType, m_Crc));
+
+    file = fopen(outPath, "wb");
+    if((file == NULL) || (fwrite(&table, sizeof(table), 1, file) != 1))
+    {
+        perror(outPath);
+        if(file != NULL)
+            fclose(file);
+        return 1;
+    }
+    if(fclose(file) != 0)
+    {
+        perror(outPath);
+        return 1;
+    }
+    printf("%u patches, program %s at %08x\n", table.m_Count, outPath, EXCEPTIONS_PATCH_ADDRESS);
+    return 0;
+}
@@ -0,0 +1,165 @@
+/*
+ * integrityPatch.c
+ *
+ *  Created on: 18 Oct 2026
+ *
+ *  Writes the expected CRCs for the background integrity scanner into the firmware ELF
+ *  - Fills exceptionsIntegrityTable (exceptionsIntegrity.h) with the address, length and
+ *    STM32 CRC of each section, in place, run it after linking and before objcopy
+ *  - Sections default to .isr_vector, .text and .rodata, missing ones are skipped
+ *  - Refuses if the table itself is inside a section it would check
+ *  - Build: gcc -O2 -o integrityPatch integrityPatch.c elf32.c
+ *  - Usage: integrityPatch [-s section]... firmware.elf
+ */
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "elf32.h"
+#include "../exceptionsIntegrity.h"
+
+#define CRC_POLY            0x04C11DB7u
+
+static const char* defaultSections[] = {".isr_vector", ".text", ".rodata"};
+
+/* CRC as the STM32 CRC unit computes it
+ * - Each little endian word is shifted in MSB first, no reflection, no final XOR
+*/
+static uint32_t stm32Crc(const uint8_t* aData, uint32_t words)
+{
+    uint32_t crc = 0xFFFFFFFFu;
+    uint32_t i;
+    uint32_t bit;
+
+    for(i = 0; i < words; i++)
+    {
+        crc ^= (uint32_t)aData[0] | ((uint32_t)aData[1] << 8) | ((uint32_t)aData[2] << 16) | ((uint32_t)aData[3] << 24);
+        aData += 4;
+        for(bit = 0; bit < 32; bit++)
+            crc = (crc & 0x80000000u) ? ((crc << 1) ^ CRC_POLY) : (crc << 1);
+    }
+    return crc;
+}
+
+static void usage(const char* aName)
+{
+    fprintf(stderr, "usage: %s [-s section]... firmware.elf\n", aName);
+}
+
+int main(int argc, char** argv)
+{
+    const char* sections[EXCEPTIONS_INTEGRITY_MAX_REGIONS];
+    uint32_t sectionCount = 0;
+    exceptionsIntegrityTableType table;
+    const Elf32_Shdr* tableSection;
+    const Elf32_Sym* symbol;
+    elf32FileType elf;
+    long tableOffset;
+    FILE* file;
+    uint32_t i;
+    int option;
+
+    while((option = getopt(argc, argv, "s:")) != -1)
+    {
+        switch(option)
+        {
+            case 's':
+                if(sectionCount == EXCEPTIONS_INTEGRITY_MAX_REGIONS)
+                {
+                    fprintf(stderr, "at most %u sections\n", EXCEPTIONS_INTEGRITY_MAX_REGIONS);
+                    return 2;
+                }
+                sections[sectionCount++] = optarg;
+                break;
+            default:
+                usage(argv[0]);
+                return 2;
+        }
+    }
+    if(optind != (argc - 1))
+    {
+        usage(argv[0]);
+        return 2;
+    }
+    if(sectionCount == 0)
+    {
+        for(i = 0; i < (sizeof(defaultSections) / sizeof(defaultSections[0])); i++)
+            sections[sectionCount++] = defaultSections[i];
+    }
+
+    if(elf32Open(&elf, argv[optind]) != 0)
+        return 1;
+    symbol = elf32FindSymbol(&elf, EXCEPTIONS_INTEGRITY_SYMBOL);
+    if((symbol == NULL) || (symbol->st_size < sizeof(table)) || (symbol->st_shndx == SHN_UNDEF) || (symbol->st_shndx >= elf.m_SectionCount))
+    {
+        fprintf(stderr, "%s: no %s, is exceptionsIntegrity.c linked?\n", argv[optind], EXCEPTIONS_INTEGRITY_SYMBOL);
+        elf32Close(&elf);
+        return 1;
+    }
+    tableSection = &elf.m_Sections[symbol->st_shndx];
+    tableOffset = (long)(tableSection->sh_offset + (symbol->st_value - tableSection->sh_addr));
+    if((elf32SectionData(&elf, tableSection) == NULL) || ((size_t)tableOffset + sizeof(table) > elf.m_Size))
+    {
+        fprintf(stderr, "%s: %s has no file contents\n", argv[optind], EXCEPTIONS_INTEGRITY_SYMBOL);
+        elf32Close(&elf);
+        return 1;
+    }
+    memcpy(&table, elf.m_Data + tableOffset, sizeof(table));
+    if(table.m_Magic != EXCEPTIONS_INTEGRITY_MAGIC)
+    {
+        fprintf(stderr, "%s: %s has the wrong magic\n", argv[optind], EXCEPTIONS_INTEGRITY_SYMBOL);
+        elf32Close(&elf);
+        return 1;
+    }
+
+    memset(table.m_Regions, 0, sizeof(table.m_Regions));
+    table.m_Count = 0;
+    for(i = 0; i < sectionCount; i++)
+    {
+        const Elf32_Shdr* section = elf32FindSection(&elf, sections[i]);
+        const uint8_t* data;
+        exceptionsIntegrityRegionType* region;
+
+        if((section == NULL) || !(section->sh_flags & SHF_ALLOC) || ((data = elf32SectionData(&elf, section)) == NULL) || (section->sh_size < 4))
+        {
+            fprintf(stderr, "%s: no %s contents, skipped\n", argv[optind], sections[i]);
+            continue;
+        }
+        if((symbol->st_value + sizeof(table) > section->sh_addr) && (symbol->st_value < (section->sh_addr + section->sh_size)))
+        {
+            fprintf(stderr, "%s: %s is inside %s, put %s in its own output section\n", argv[optind], EXCEPTIONS_INTEGRITY_SYMBOL,
+                    sections[i], EXCEPTIONS_INTEGRITY_SECTION);
+            elf32Close(&elf);
+            return 1;
+        }
+
+        region = &table.m_Regions[table.m_Count++];
+        region->m_Start = section->sh_addr;
+        region->m_Words = section->sh_size / 4u;
+        region->m_Crc = stm32Crc(data, region->m_Words);
+        printf("%-16s %08x %8u words  crc %08x\n", sections[i], region->m_Start, region->m_Words, region->m_Crc);
+    }
+    elf32Close(&elf);
+    if(table.m_Count == 0)
+    {
+        fprintf(stderr, "%s: nothing to check\n", argv[optind]);
+        return 1;
+    }
+
+    file = fopen(argv[optind], "r+b");
+    if((file == NULL) || (fseek(file, tableOffset, SEEK_SET) != 0) || (fwrite(&table, sizeof(table), 1, file) != 1))
+    {
+        perror(argv[optind]);
+        if(file != NULL)
+            fclose(file);
+        return 1;
+    }
+    if(fclose(file) != 0)
+    {
+        perror(argv[optind]);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,491 @@
+/*
+ * legacyLogParse.c
+ *
+ *  Created on: 18 Oct 2026
+ *
+ *  Crash records from the text older firmware prints
+ *  - Finds the printExtraInfo() blocks ("**** EXCEPTION OCCURRED ****", "Type: ...",
+ *    "R0=%x R1=%x", ...) in serial logs where other output is interleaved, line prefixes
+ *    such as timestamps included, and writes each as a binary crash record
+ *  - Files are memory mapped and parsed in place, "-" reads standard input in chunks
+ *  - Outside a block only the marker is searched for, 16 bytes at a time with SSE2
+ *  - A block cut short by a reset or a new marker is kept if its type and PC made it, and
+ *    flagged as truncated, parsing resumes at the next marker either way
+ *  - The records carry CRASH_RECORD_FLAG_FROM_TEXT, r4-r11, SP and EXC_RETURN weren't printed
+ *  - Build: gcc -O2 -o legacyLogParse legacyLogParse.c crashArchive.c
+ *  - Usage: legacyLogParse -o records.bin log.txt [log.txt ...]
+ */
+#include <fcntl.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "../exceptions.h"
+#include "crashArchive.h"
+
+#define MARKER              "**** EXCEPTION OCCURRED ****"
+#define MARKER_LENGTH       (sizeof(MARKER) - 1u)
+#define MARKER_SECOND       5u          // Offset of the 'E', checked with the first '*'.
+#define MAX_GAP             32u         // Unrelated lines allowed inside a block.
+#define READ_SIZE           (1u<<20)
+
+#define CFSR_UNDEFINSTR     (1u<<16)
+
+typedef enum
+{
+    Field_R0,
+    Field_R1,
+    Field_R2,
+    Field_R3,
+    Field_R12,
+    Field_Lr,
+    Field_Pc,
+    Field_Psr,
+    Field_Hfsr,
+    Field_Cfsr,
+    Field_Address,
+    Field_Token,
+    Field_Count
+} fieldType;
+
+// Fields every complete block has.
+#define REQUIRED_FIELDS     ((1u << Field_Token) - 1u)
+
+typedef struct
+{
+    const char* m_Key;
+    uint32_t m_Length;
+} fieldKeyType;
+
+typedef struct
+{
+    FILE* m_Out;
+    int m_InBlock;
+    int m_Type;                 // exceptionType, -1 until the Type line.
+    uint32_t m_Seen;            // Bit per fieldType.
+    uint32_t m_Values[Field_Count];
+    uint32_t m_Gap;             // Lines since the last one that belonged to the block.
+    uint32_t m_Sequence;
+    uint64_t m_Blocks;
+    uint64_t m_Records;
+    uint64_t m_Truncated;
+    uint64_t m_Dropped;
+} parserType;
+
+static const fieldKeyType fieldKeys[Field_Count] =
+{
+    {"R0", 2},
+    {"R1", 2},
+    {"R2", 2},
+    {"R3", 2},
+    {"R12", 3},
+    {"LR", 2},
+    {"PC", 2},
+    {"PSR", 3},
+    {"HFSR", 4},
+    {"CFSR", 4},
+    {"Fault address", 13},
+    {"Assert token", 12}
+};
+
+// "Type: " lines, by exceptionType.
+static const fieldKeyType typeNames[] =
+{
+    {"Hard Fault", 10},
+    {"Memory Fault", 12},
+    {"Bus Fault", 9},
+    {"Usage Fault", 11},
+    {"Lockup", 6},
+    {"Watchdog", 8},
+    {"Integrity", 9}
+};
+
+static const char* findByte(const char* aData, const char* aEnd, char value)
+{
+#if defined(__SSE2__)
+    const __m128i pattern = _mm_set1_epi8(value);
+
+    while((aEnd - aData) >= 16)
+    {
+        uint32_t mask = (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)aData), pattern));
+
+        if(mask != 0)
+            return aData + __builtin_ctz(mask);
+        aData += 16;
+    }
+#endif
+    while((aData < aEnd) && (*aData != value))
+        aData++;
+    return aData;
+}
+
+/* Find the block marker
+ * - Candidates need the first '*' and the 'E' five bytes on, which plain log text rarely
+ *   has, only those are compared in full
+ * - Returns aEnd if there is none
+*/
+static const char* findMarker(const char* aData, const char* aEnd)
+{
+#if defined(__SSE2__)
+    const __m128i first = _mm_set1_epi8(MARKER[0]);
+    const __m128i second = _mm_set1_epi8(MARKER[MARKER_SECOND]);
+
+    while((size_t)(aEnd - aData) >= (16u + MARKER_LENGTH))
+    {
+        __m128i atFirst = _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)aData), first);
+        __m128i atSecond = _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)(aData + MARKER_SECOND)), second);
+        uint32_t mask = (uint32_t)_mm_movemask_epi8(_mm_and_si128(atFirst, atSecond));
+
+        while(mask != 0)
+        {
+            const char* candidate = aData + __builtin_ctz(mask);
+
+            if(memcmp(candidate, MARKER, MARKER_LENGTH) == 0)
+                return candidate;
+            mask &= mask - 1;
+        }
+        aData += 16;
+    }
+#endif
+    for(; (size_t)(aEnd - aData) >= MARKER_LENGTH; aData++)
+    {
+        if((*aData == MARKER[0]) && (memcmp(aData, MARKER, MARKER_LENGTH) == 0))
+            return aData;
+    }
+    return aEnd;
+}
+
+static int isWordCharacter(char value)
+{
+    return ((value >= '0') && (value <= '9')) || ((value >= 'A') && (value <= 'Z')) || ((value >= 'a') && (value <= 'z'));
+}
+
+static uint32_t parseHex(const char* aData, const char* aEnd, int* aValid)
+{
+    uint32_t value = 0;
+    const char* start = aData;
+
+    for(; aData < aEnd; aData++)
+    {
+        char digit = *aData;
+
+        if((digit >= '0') && (digit <= '9'))
+            value = (value << 4) | (uint32_t)(digit - '0');
+        else if((digit >= 'a') && (digit <= 'f'))
+            value = (value << 4) | (uint32_t)(digit - 'a' + 10);
+        else if((digit >= 'A') && (digit <= 'F'))
+            value = (value << 4) | (uint32_t)(digit - 'A' + 10);
+        else
+            break;
+    }
+    *aValid = (aData != start) && ((aData - start) <= 8);
+    return value;
+}
+
+/* Write the record for the current block
+ * - The backtrace is the PC, then LR when it holds a return address rather than EXC_RETURN
+*/
+static void finishBlock(parserType* aParser, int cutShort)
+{
+    uint8_t buffer[sizeof(crashRecordType) + sizeof(crashRecordTlvType) + (2 * sizeof(uint32_t))];
+    crashRecordType* record = (crashRecordType*)buffer;
+    crashRecordTlvType* tlv = (crashRecordTlvType*)(record + 1);
+    uint32_t* frames = (uint32_t*)(tlv + 1);
+    const uint32_t* values = aParser->m_Values;
+    uint32_t frameCount = 1;
+
+    aParser->m_InBlock = 0;
+    if((aParser->m_Type < 0) || !(aParser->m_Seen & (1u << Field_Pc)))
+    {
+        aParser->m_Dropped++;
+        return;
+    }
+
+    memset(buffer, 0, sizeof(buffer));
+    record->m_Magic = CRASH_RECORD_MAGIC;
+    record->m_Version = CRASH_RECORD_VERSION;
+    record->m_HeaderSize = sizeof(crashRecordType);
+    record->m_Producer = CRASH_RECORD_PRODUCER_APPLICATION;
+    record->m_Type = (uint8_t)aParser->m_Type;
+    record->m_Flags = CRASH_RECORD_FLAG_FROM_TEXT;
+    record->m_Sequence = aParser->m_Sequence++;
+    record->m_R[0] = values[Field_R0];
+    record->m_R[1] = values[Field_R1];
+    record->m_R[2] = values[Field_R2];
+    record->m_R[3] = values[Field_R3];
+    record->m_R[12] = values[Field_R12];
+    record->m_Lr = values[Field_Lr];
+    record->m_Pc = values[Field_Pc];
+    record->m_Psr = values[Field_Psr];
+    record->m_Cfsr = values[Field_Cfsr];
+    record->m_Hfsr = (values[Field_Hfsr] != EXCEPTION_HANDLER_FIELD_IS_INVALID) ? values[Field_Hfsr] : 0;
+    if(values[Field_Address] != EXCEPTION_HANDLER_FIELD_IS_INVALID)
+    {
+        if(aParser->m_Type == Bus_Fault)
+            record->m_Bfar = values[Field_Address];
+        else if(aParser->m_Type == MemMang_Fault)
+            record->m_Mmfar = values[Field_Address];
+    }
+    record->m_AssertToken = (aParser->m_Seen & (1u << Field_Token)) ? values[Field_Token] : EXCEPTION_HANDLER_FIELD_IS_INVALID;
+
+    if(cutShort || ((aParser->m_Seen & REQUIRED_FIELDS) != REQUIRED_FIELDS))
+    {
+        record->m_Flags |= CRASH_RECORD_FLAG_TRUNCATED;
+        aParser->m_Truncated++;
+    }
+
+    frames[0] = record->m_Pc;
+    if((aParser->m_Seen & (1u << Field_Lr)) && ((record->m_Lr & 0xFF000000u) != 0xFF000000u))
+        frames[frameCount++] = record->m_Lr;
+    tlv->m_Tag = CRASH_RECORD_TAG_BACKTRACE;
+    tlv->m_Length = (uint16_t)(frameCount * sizeof(uint32_t));
+
+    record->m_Size = sizeof(crashRecordType) + sizeof(crashRecordTlvType) + tlv->m_Length;
+    record->m_Crc = crashArchiveCrc(buffer + CRASH_RECORD_CRC_OFFSET, record->m_Size - CRASH_RECORD_CRC_OFFSET);
+    fwrite(buffer, 1, record->m_Size, aParser->m_Out);
+    aParser->m_Records++;
+}
+
+static void startBlock(parserType* aParser)
+{
+    // Once the fault address is in, only the optional assert token was still to come.
+    if(aParser->m_InBlock)
+        finishBlock(aParser, !(aParser->m_Seen & (1u << Field_Address)));
+    aParser->m_InBlock = 1;
+    aParser->m_Type = -1;
+    aParser->m_Seen = 0;
+    aParser->m_Gap = 0;
+    memset(aParser->m_Values, 0, sizeof(aParser->m_Values));
+    aParser->m_Blocks++;
+}
+
+/* One line inside a block
+ * - Keys are matched on the text just before each '=', so a prefix on the line is harmless
+ * - After an undefined instruction's fault address only the very next line is checked for the
+ *   assert token, firmware without FAULT_ASSERT never prints one and the block is complete
+ *   either way, nothing else on that line is taken
+*/
+static void parseLine(parserType* aParser, const char* aLine, const char* aEnd)
+{
+    const char* equals = aLine;
+    const char* colon = aLine;
+    int awaitingToken = (aParser->m_Seen & (1u << Field_Address)) != 0;
+    int used = 0;
+    uint32_t i;
+
+    while(!awaitingToken && (colon = findByte(colon, aEnd, ':')) < aEnd)
+    {
+        if((colon >= (aLine + 4)) && ((aEnd - colon) >= 2) && (memcmp(colon - 4, "Type: ", 6) == 0))
+        {
+            for(i = 0; i < (sizeof(typeNames) / sizeof(typeNames[0])); i++)
+            {
+                if(((size_t)(aEnd - (colon + 2)) >= typeNames[i].m_Length) && (memcmp(colon + 2, typeNames[i].m_Key, typeNames[i].m_Length) == 0))
+                {
+                    aParser->m_Type = (int)i;
+                    used = 1;
+                }
+            }
+        }
+        colon++;
+    }
+
+    while((equals = findByte(equals, aEnd, '=')) < aEnd)
+    {
+        for(i = awaitingToken ? Field_Token : 0; i < Field_Count; i++)
+        {
+            const char* key = equals - fieldKeys[i].m_Length;
+            uint32_t value;
+            int valid;
+
+            if((key < aLine) || (memcmp(key, fieldKeys[i].m_Key, fieldKeys[i].m_Length) != 0) ||
+               ((key > aLine) && isWordCharacter(key[-1])))
+                continue;
+            value = parseHex(equals + 1, aEnd, &valid);
+            if(valid)
+            {
+                aParser->m_Values[i] = value;
+                aParser->m_Seen |= 1u << i;
+                used = 1;
+            }
+            break;
+        }
+        equals++;
+    }
+
+    aParser->m_Gap = used ? 0 : (aParser->m_Gap + 1);
+
+    // The assert token can only follow an undefined instruction, and is the last line.
+    if(awaitingToken || ((aParser->m_Seen & (1u << Field_Address)) && !(aParser->m_Values[Field_Cfsr] & CFSR_UNDEFINSTR)))
+        finishBlock(aParser, 0);
+    else if(aParser->m_Gap > MAX_GAP)
+        finishBlock(aParser, !(aParser->m_Seen & (1u << Field_Address)));
+}
+
+/* Parse complete lines
+ * - Returns the bytes consumed, everything if final, otherwise up to the last newline
+*/
+static size_t parseBuffer(parserType* aParser, const char* aData, size_t length, int final)
+{
+    const char* end = aData + length;
+    const char* current = aData;
+
+    if(!final)
+    {
+        while((end > aData) && (end[-1] != '\n'))
+            end--;
+    }
+
+    while(current < end)
+    {
+        const char* lineEnd;
+
+        if(!aParser->m_InBlock)
+        {
+            current = findMarker(current, end);
+            if(current == end)
+                break;
+            startBlock(aParser);
+            current = findByte(current, end, '\n');
+            if(current < end)
+                current++;
+            continue;
+        }
+
+        lineEnd = findByte(current, end, '\n');
+        if(findMarker(current, lineEnd) < lineEnd)
+        {
+            startBlock(aParser);
+            current = (lineEnd < end) ? (lineEnd + 1) : end;
+            continue;
+        }
+        parseLine(aParser, current, lineEnd);
+        current = (lineEnd < end) ? (lineEnd + 1) : end;
+    }
+    if(final && aParser->m_InBlock)
+        finishBlock(aParser, !(aParser->m_Seen & (1u << Field_Address)));
+    return final ? length : (size_t)(end - aData);
+}
+
+static int parseFile(parserType* aParser, const char* aPath, uint64_t* aBytes)
+{
+    struct stat info;
+    const char* data;
+    int fd;
+
+    fd = open(aPath, O_RDONLY);
+    if((fd < 0) || (fstat(fd, &info) != 0))
+    {
+        perror(aPath);
+        if(fd >= 0)
+            close(fd);
+        return -1;
+    }
+    if(info.st_size == 0)
+    {
+        close(fd);
+        return 0;
+    }
+    data = mmap(NULL, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if(data == MAP_FAILED)
+    {
+        perror(aPath);
+        return -1;
+    }
+    madvise((void*)data, (size_t)info.st_size, MADV_SEQUENTIAL);
+    parseBuffer(aParser, data, (size_t)info.st_size, 1);
+    munmap((void*)data, (size_t)info.st_size);
+    *aBytes += (uint64_t)info.st_size;
+    return 0;
+}
+
+/* Standard input
+ * - Unconsumed bytes (a partial line) move to the front before the next read
+*/
+static int parseStream(parserType* aParser, int fd, uint64_t* aBytes)
+{
+    char* buffer = malloc(2 * READ_SIZE);
+    size_t held = 0;
+    ssize_t got;
+
+    if(buffer == NULL)
+        return -1;
+    while((got = read(fd, buffer + held, (2 * READ_SIZE) - held)) > 0)
+    {
+        size_t consumed;
+
+        held += (size_t)got;
+        *aBytes += (uint64_t)got;
+        consumed = parseBuffer(aParser, buffer, held, held == (2 * READ_SIZE));
+        if((consumed == 0) && (held == (2 * READ_SIZE)))
+            consumed = held;
+        memmove(buffer, buffer + consumed, held - consumed);
+        held -= consumed;
+    }
+    parseBuffer(aParser, buffer, held, 1);
+    free(buffer);
+    return (got < 0) ? -1 : 0;
+}
+
+int main(int argc, char** argv)
+{
+    parserType parser;
+    const char* output = NULL;
+    struct timespec start;
+    struct timespec finish;
+    uint64_t bytes = 0;
+    double seconds;
+    int failures = 0;
+    int option;
+
+    while((option = getopt(argc, argv, "o:")) != -1)
+    {
+        if(option != 'o')
+            break;
+        output = optarg;
+    }
+    if((output == NULL) || (optind >= argc))
+    {
+        fprintf(stderr, "usage: %s -o records.bin log.txt [log.txt ...]\n", argv[0]);
+        return 2;
+    }
+
+    memset(&parser, 0, sizeof(parser));
+    parser.m_Out = fopen(output, "wb");
+    if(parser.m_Out == NULL)
+    {
+        perror(output);
+        return 1;
+    }
+    setvbuf(parser.m_Out, NULL, _IOFBF, READ_SIZE);
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for(; optind < argc; optind++)
+    {
+        if(strcmp(argv[optind], "-") == 0)
+            failures += (parseStream(&parser, STDIN_FILENO, &bytes) != 0);
+        else
+            failures += (parseFile(&parser, argv[optind], &bytes) != 0);
+    }
+    if(fclose(parser.m_Out) != 0)
+    {
+        perror(output);
+        return 1;
+    }
+    clock_gettime(CLOCK_MONOTONIC, &finish);
+    seconds = (double)(finish.tv_sec - start.tv_sec) + ((double)(finish.tv_nsec - start.tv_nsec) / 1e9);
+
+    printf("%llu blocks, %llu records (%llu truncated), %llu dropped, %.1f MB in %.2f s, %.0f MB/s\n",
+           (unsigned long long)parser.m_Blocks, (unsigned long long)parser.m_Records, (unsigned long long)parser.m_Truncated,
+           (unsigned long long)parser.m_Dropped, (double)bytes / 1e6, seconds, (seconds > 0) ? ((double)bytes / 1e6 / seconds) : 0.0);
+    return (failures != 0) ? 1 : 0;
+}
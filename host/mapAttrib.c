@@ -0,0 +1,548 @@
+/*
+ * mapAttrib.c
+ *
+ *  Created on: 18 Oct 2026
+ *
+ *  Crash attribution by linker map
+ *  - Reads the input sections of a GNU ld map file (-Wl,-Map=app.map), each is an address
+ *    range with its section name, object file and archive member
+ *  - Every record's faulting PC and backtrace frames are looked up in those ranges, no
+ *    symbols needed, and counted per component and per object
+ *  - A component is the archive for archive members (libusb.a) and the object's directory
+ *    otherwise, or its first -d directories (Middlewares/Third_Party with -d 2)
+ *  - The backtrace column counts each record once per component or object it passes through
+ *  - Return addresses are looked up one byte back, at the call, so a call ending a section
+ *    isn't blamed on the next one
+ *  - Build: gcc -O2 -o mapAttrib mapAttrib.c crashArchive.c elf32.c
+ *  - Usage: mapAttrib -m app.map [-e app.elf] [-d depth] [-n objects] [-l] record.bin [record.bin ...]
+ */
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "crashArchive.h"
+#include "elf32.h"
+
+#define MAX_FRAMES          32u
+#define DEFAULT_OBJECTS     20u
+#define NAMES_SIZE          4096u       // Initial size of the name table, power of 2.
+#define FNV_OFFSET          0xCBF29CE484222325ull
+#define FNV_PRIME           0x100000001B3ull
+
+typedef struct
+{
+    uint32_t m_Address;
+    uint32_t m_Size;
+    const char* m_Section;
+    uint32_t m_Object;
+} rangeType;
+
+typedef struct
+{
+    const char* m_Name;         // Archive member as "libusb.a(usbd_core.o)".
+    uint32_t m_Component;
+    uint64_t m_Faulting;
+    uint64_t m_Frames;
+    uint64_t m_Stamp;           // Last record counted in m_Frames.
+} objectType;
+
+typedef struct
+{
+    const char* m_Name;
+    uint64_t m_Faulting;
+    uint64_t m_Frames;
+    uint64_t m_Stamp;           // Last record counted in m_Frames.
+} componentType;
+
+typedef struct
+{
+    const char* m_Name;         // NULL marks a free slot.
+    uint32_t m_Index;
+} nameSlotType;
+
+typedef struct
+{
+    nameSlotType* m_Slots;
+    uint32_t m_Size;
+    uint32_t m_Count;
+} nameTableType;
+
+static rangeType* ranges;
+static uint32_t rangeCount;
+static objectType* objects;
+static uint32_t objectCount;
+static componentType* components;
+static uint32_t componentCount;
+static nameTableType objectNames;
+static nameTableType componentNames;
+static uint32_t depth;
+
+static uint64_t fnvString(const char* aString)
+{
+    uint64_t hash = FNV_OFFSET;
+
+    while(*aString != '\0')
+        hash = (hash ^ (uint8_t)*aString++) * FNV_PRIME;
+    return hash;
+}
+
+/* Index of a name, aNew is called to add it if it's the first time
+ * - Names are kept by pointer, they must outlive the table
+*/
+static int internName(nameTableType* aTable, const char* aName, int (*aNew)(const char*, uint32_t*), uint32_t* aIndex)
+{
+    uint32_t slot;
+
+    if(((aTable->m_Count + 1u) * 2u) > aTable->m_Size)
+    {
+        nameSlotType* old = aTable->m_Slots;
+        uint32_t oldSize = aTable->m_Size;
+        uint32_t i;
+
+        aTable->m_Size = (oldSize != 0) ? (oldSize * 2u) : NAMES_SIZE;
+        aTable->m_Slots = calloc(aTable->m_Size, sizeof(nameSlotType));
+        if(aTable->m_Slots == NULL)
+            return -1;
+        for(i = 0; i < oldSize; i++)
+        {
+            if(old[i].m_Name == NULL)
+                continue;
+            for(slot = (uint32_t)fnvString(old[i].m_Name) & (aTable->m_Size - 1u); aTable->m_Slots[slot].m_Name != NULL;
+                slot = (slot + 1u) & (aTable->m_Size - 1u))
+                ;
+            aTable->m_Slots[slot] = old[i];
+        }
+        free(old);
+    }
+    for(slot = (uint32_t)fnvString(aName) & (aTable->m_Size - 1u); aTable->m_Slots[slot].m_Name != NULL;
+        slot = (slot + 1u) & (aTable->m_Size - 1u))
+    {
+        if(strcmp(aTable->m_Slots[slot].m_Name, aName) == 0)
+        {
+            *aIndex = aTable->m_Slots[slot].m_Index;
+            return 0;
+        }
+    }
+    if(aNew(aName, aIndex) != 0)
+        return -1;
+    aTable->m_Slots[slot].m_Name = aName;
+    aTable->m_Slots[slot].m_Index = *aIndex;
+    aTable->m_Count++;
+    return 0;
+}
+
+static int newComponent(const char* aName, uint32_t* aIndex)
+{
+    componentType* grown = realloc(components, ((size_t)componentCount + 1u) * sizeof(componentType));
+
+    if(grown == NULL)
+        return -1;
+    components = grown;
+    memset(&components[componentCount], 0, sizeof(componentType));
+    components[componentCount].m_Name = aName;
+    *aIndex = componentCount++;
+    return 0;
+}
+
+/* Component an object belongs to
+ * - libusb.a(usbd_core.o) gives libusb.a, path/to/file.o gives path/to, or its first depth
+ *   directories
+*/
+static char* componentName(const char* aObject)
+{
+    const char* open = strchr(aObject, '(');
+    const char* end;
+    const char* start = aObject;
+    char* name;
+
+    if((open != NULL) && (aObject[strlen(aObject) - 1u] == ')'))
+    {
+        const char* slash;
+
+        for(slash = aObject; slash < open; slash++)
+        {
+            if(*slash == '/')
+                start = slash + 1;
+        }
+        end = open;
+    }
+    else
+    {
+        end = strrchr(aObject, '/');
+        if(end == NULL)
+            return strdup(".");
+        if(depth != 0)
+        {
+            const char* cut = aObject;
+            uint32_t i;
+
+            for(i = 0; (i < depth) && (cut != NULL) && (cut < end); i++)
+                cut = strchr(cut + 1, '/');
+            if((cut != NULL) && (cut < end))
+                end = cut;
+        }
+    }
+    name = malloc((size_t)(end - start) + 1u);
+    if(name != NULL)
+    {
+        memcpy(name, start, (size_t)(end - start));
+        name[end - start] = '\0';
+    }
+    return name;
+}
+
+static int newObject(const char* aName, uint32_t* aIndex)
+{
+    objectType* grown = realloc(objects, ((size_t)objectCount + 1u) * sizeof(objectType));
+    char* component = componentName(aName);
+    uint32_t componentIndex;
+
+    if((grown == NULL) || (component == NULL))
+    {
+        free(component);
+        return -1;
+    }
+    objects = grown;
+    if(internName(&componentNames, component, newComponent, &componentIndex) != 0)
+        return -1;
+    if(components[componentIndex].m_Name != component)
+        free(component);
+    memset(&objects[objectCount], 0, sizeof(objectType));
+    objects[objectCount].m_Name = aName;
+    objects[objectCount].m_Component = componentIndex;
+    *aIndex = objectCount++;
+    return 0;
+}
+
+static int addRange(const char* aSection, uint64_t address, uint64_t size, const char* aObject)
+{
+    rangeType* range;
+    uint32_t object;
+
+    if((size == 0) || (address == 0) || ((address + size) > 0x100000000ull) || (*aObject == '\0'))
+        return 0;
+    if((rangeCount & 1023u) == 0)
+    {
+        rangeType* grown = realloc(ranges, ((size_t)rangeCount + 1024u) * sizeof(rangeType));
+
+        if(grown == NULL)
+            return -1;
+        ranges = grown;
+    }
+    if(internName(&objectNames, aObject, newObject, &object) != 0)
+        return -1;
+    range = &ranges[rangeCount++];
+    range->m_Address = (uint32_t)address;
+    range->m_Size = (uint32_t)size;
+    range->m_Section = aSection;
+    range->m_Object = object;
+    return 0;
+}
+
+static int compareRanges(const void* aLeft, const void* aRight)
+{
+    const rangeType* left = (const rangeType*)aLeft;
+    const rangeType* right = (const rangeType*)aRight;
+
+    return (left->m_Address > right->m_Address) - (left->m_Address < right->m_Address);
+}
+
+/* Parse the "Linker script and memory map" part of a map file
+ * - Input sections are " .text.name 0xaddress 0xsize file", a long name goes on a line of
+ *   its own with the rest on the next
+ * - Output sections start in the first column and symbols have no size, both are skipped
+ * - The text is kept, ranges point into it
+*/
+static char* loadMap(const char* aPath)
+{
+    FILE* file = fopen(aPath, "rb");
+    char* text;
+    char* line;
+    char* next;
+    char* pending = NULL;
+    long size;
+    int started = 0;
+
+    if(file == NULL)
+    {
+        perror(aPath);
+        return NULL;
+    }
+    fseek(file, 0, SEEK_END);
+    size = ftell(file);
+    rewind(file);
+    text = malloc((size_t)size + 1u);
+    if((text == NULL) || (fread(text, 1, (size_t)size, file) != (size_t)size))
+    {
+        perror(aPath);
+        fclose(file);
+        free(text);
+        return NULL;
+    }
+    fclose(file);
+    text[size] = '\0';
+
+    for(line = text; line != NULL; line = next)
+    {
+        char* section = pending;
+        char* cursor = line;
+        char* end;
+        uint64_t address;
+        uint64_t length;
+
+        next = strchr(line, '\n');
+        if(next != NULL)
+            *next++ = '\0';
+        line[strcspn(line, "\r")] = '\0';
+        pending = NULL;
+
+        if(!started)
+        {
+            started = (strncmp(line, "Linker script and memory map", 28) == 0);
+            continue;
+        }
+        if(line[0] != ' ')
+            continue;
+
+        // " .name" on its own, or starting the line, the address follows.
+        if((section == NULL) && (line[1] != ' '))
+        {
+            section = line + 1;
+            cursor = section + strcspn(section, " \t");
+            if(*cursor == '\0')
+            {
+                pending = section;
+                continue;
+            }
+            *cursor++ = '\0';
+        }
+        if((section == NULL) || (section[0] == '*'))
+            continue;
+
+        cursor += strspn(cursor, " \t");
+        address = strtoull(cursor, &end, 16);
+        if((end == cursor) || (strncmp(cursor, "0x", 2) != 0))
+            continue;
+        cursor = end + strspn(end, " \t");
+        length = strtoull(cursor, &end, 16);
+        if((end == cursor) || (strncmp(cursor, "0x", 2) != 0))
+            continue;
+        cursor = end + strspn(end, " \t");
+        if(addRange(section, address, length, cursor) != 0)
+        {
+            free(text);
+            return NULL;
+        }
+    }
+
+    if(!started)
+        fprintf(stderr, "%s: not a GNU ld map file\n", aPath);
+    qsort(ranges, rangeCount, sizeof(rangeType), compareRanges);
+    return text;
+}
+
+static const rangeType* findRange(uint32_t address)
+{
+    uint32_t low = 0;
+    uint32_t high = rangeCount;
+
+    while(low < high)
+    {
+        uint32_t middle = low + ((high - low) / 2u);
+
+        if(ranges[middle].m_Address <= address)
+            low = middle + 1u;
+        else
+            high = middle;
+    }
+    if((low == 0) || ((address - ranges[low - 1u].m_Address) >= ranges[low - 1u].m_Size))
+        return NULL;
+    return &ranges[low - 1u];
+}
+
+/* Count one record
+ * - Returns the faulting PC's range, NULL if it isn't in the map
+*/
+static const rangeType* attribute(const crashRecordType* aRecord, uint64_t stamp)
+{
+    uint32_t frames[MAX_FRAMES];
+    uint32_t count = crashArchiveBacktrace(aRecord, frames, MAX_FRAMES);
+    const rangeType* faulting = findRange(aRecord->m_Pc & ~1u);
+    uint32_t i;
+
+    if(faulting != NULL)
+    {
+        objects[faulting->m_Object].m_Faulting++;
+        components[objects[faulting->m_Object].m_Component].m_Faulting++;
+    }
+    for(i = 0; i < count; i++)
+    {
+        const rangeType* range = findRange((frames[i] & ~1u) - ((i != 0) ? 1u : 0u));
+        objectType* object;
+        componentType* component;
+
+        if(range == NULL)
+            continue;
+        object = &objects[range->m_Object];
+        if(object->m_Stamp != stamp)
+        {
+            object->m_Stamp = stamp;
+            object->m_Frames++;
+        }
+        component = &components[object->m_Component];
+        if(component->m_Stamp != stamp)
+        {
+            component->m_Stamp = stamp;
+            component->m_Frames++;
+        }
+    }
+    return faulting;
+}
+
+static int compareComponents(const void* aLeft, const void* aRight)
+{
+    const componentType* left = (const componentType*)aLeft;
+    const componentType* right = (const componentType*)aRight;
+
+    if(left->m_Faulting != right->m_Faulting)
+        return (left->m_Faulting < right->m_Faulting) ? 1 : -1;
+    return (left->m_Frames < right->m_Frames) - (left->m_Frames > right->m_Frames);
+}
+
+static int compareObjects(const void* aLeft, const void* aRight)
+{
+    const objectType* left = (const objectType*)aLeft;
+    const objectType* right = (const objectType*)aRight;
+
+    if(left->m_Faulting != right->m_Faulting)
+        return (left->m_Faulting < right->m_Faulting) ? 1 : -1;
+    return (left->m_Frames < right->m_Frames) - (left->m_Frames > right->m_Frames);
+}
+
+static double percent(uint64_t part, uint64_t total)
+{
+    return (total != 0) ? ((100.0 * (double)part) / (double)total) : 0.0;
+}
+
+static void usage(const char* aName)
+{
+    fprintf(stderr, "usage: %s -m app.map [-e app.elf] [-d depth] [-n objects] [-l] record.bin [record.bin ...]\n", aName);
+}
+
+int main(int argc, char** argv)
+{
+    const char* mapPath = NULL;
+    const uint8_t* buildId = NULL;
+    uint32_t buildIdLength = 0;
+    uint32_t shown = DEFAULT_OBJECTS;
+    uint64_t total = 0;
+    uint64_t skipped = 0;
+    uint64_t unmapped = 0;
+    elf32FileType elf;
+    int haveElf = 0;
+    int list = 0;
+    char* text;
+    uint32_t i;
+    int option;
+
+    while((option = getopt(argc, argv, "d:e:lm:n:")) != -1)
+    {
+        switch(option)
+        {
+            case 'd':   depth = (uint32_t)strtoul(optarg, NULL, 0); break;
+            case 'e':
+                if(elf32Open(&elf, optarg) != 0)
+                    return 1;
+                if(elf32BuildId(&elf, &buildId, &buildIdLength) != 0)
+                    fprintf(stderr, "%s: no build-id, every record is counted\n", optarg);
+                haveElf = 1;
+                break;
+            case 'l':   list = 1; break;
+            case 'm':   mapPath = optarg; break;
+            case 'n':   shown = (uint32_t)strtoul(optarg, NULL, 0); break;
+            default:
+                usage(argv[0]);
+                return 2;
+        }
+    }
+    if((mapPath == NULL) || (optind >= argc))
+    {
+        usage(argv[0]);
+        return 2;
+    }
+
+    text = loadMap(mapPath);
+    if(text == NULL)
+        return 1;
+    if(rangeCount == 0)
+    {
+        fprintf(stderr, "%s: no input sections\n", mapPath);
+        return 1;
+    }
+
+    for(; optind < argc; optind++)
+    {
+        crashArchiveType archive;
+        const crashRecordType* record;
+        size_t offset = 0;
+
+        if(crashArchiveOpen(&archive, argv[optind]) != 0)
+            continue;
+        while((record = crashArchiveNext(&archive, &offset)) != NULL)
+        {
+            const uint8_t* id;
+            uint32_t length = crashArchiveBuildId(record, &id);
+            const rangeType* faulting;
+
+            // The map only describes the build it came from.
+            if((buildIdLength != 0) && ((length != buildIdLength) || (memcmp(id, buildId, length) != 0)))
+            {
+                skipped++;
+                continue;
+            }
+            total++;
+            faulting = attribute(record, total);
+            unmapped += (faulting == NULL);
+            if(list)
+            {
+                printf("%-10u %08x  ", record->m_Sequence, record->m_Pc);
+                if(faulting != NULL)
+                    printf("%s+0x%x  %s\n", faulting->m_Section, (record->m_Pc & ~1u) - faulting->m_Address, objects[faulting->m_Object].m_Name);
+                else
+                    printf("(unmapped)\n");
+            }
+        }
+        crashArchiveClose(&archive);
+    }
+    if(list)
+        printf("\n");
+
+    printf("%llu records, %u input sections in %u objects\n", (unsigned long long)total, rangeCount, objectCount);
+    if(skipped != 0)
+        printf("%llu records from other builds skipped\n", (unsigned long long)skipped);
+    printf("\n%-40s%10s%8s%12s%8s\n", "component", "faulting", "", "backtrace", "");
+    qsort(components, componentCount, sizeof(componentType), compareComponents);
+    for(i = 0; i < componentCount; i++)
+    {
+        const componentType* component = &components[i];
+
+        if((component->m_Faulting == 0) && (component->m_Frames == 0))
+            continue;
+        printf("%-40s%10llu%7.1f%%%12llu%7.1f%%\n", component->m_Name, (unsigned long long)component->m_Faulting, percent(component->m_Faulting, total),
+               (unsigned long long)component->m_Frames, percent(component->m_Frames, total));
+    }
+    if(unmapped != 0)
+        printf("%-40s%10llu%7.1f%%\n", "(unmapped)", (unsigned long long)unmapped, percent(unmapped, total));
+
+    printf("\n%-56s%10s%12s\n", "object", "faulting", "backtrace");
+    qsort(objects, objectCount, sizeof(objectType), compareObjects);
+    for(i = 0; (i < objectCount) && (i < shown) && ((objects[i].m_Faulting != 0) || (objects[i].m_Frames != 0)); i++)
+        printf("%-56s%10llu%12llu\n", objects[i].m_Name, (unsigned long long)objects[i].m_Faulting, (unsigned long long)objects[i].m_Frames);
+
+    if(haveElf)
+        elf32Close(&elf);
+    free(text);
+    return 0;
+}
@@ -0,0 +1,50 @@
+/*
+ * testCheck.h
+ *
+ *  Created on: 18 Oct 2026
+ *
+ *  Checks for the host tool tests
+ *  - A failed check prints where it was and what it got, the test carries on
+ *  - testResult() prints the totals, return it from main() so make test stops on a failure
+ */
+
+#ifndef TEST_CHECK_H_
+#define TEST_CHECK_H_
+
+#include <inttypes.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#define CHECK(condition)                testCheck((condition) != 0, #condition, __FILE__, __LINE__)
+#define CHECK_EQUAL(actual, expected)   testCheckEqual((uint64_t)(actual), (uint64_t)(expected), #actual, __FILE__, __LINE__)
+
+static uint32_t testChecks;
+static uint32_t testFailures;
+
+static inline void testCheck(int passed, const char* aText, const char* aFile, int line)
+{
+    testChecks++;
+    if(!passed)
+    {
+        testFailures++;
+        printf("%s:%d: failed: %s\n", aFile, line, aText);
+    }
+}
+
+static inline void testCheckEqual(uint64_t actual, uint64_t expected, const char* aText, const char* aFile, int line)
+{
+    testChecks++;
+    if(actual != expected)
+    {
+        testFailures++;
+        printf("%s:%d: %s is %" PRIx64 ", expected %" PRIx64 "\n", aFile, line, aText, actual, expected);
+    }
+}
+
+static inline int testResult(const char* aName)
+{
+    printf("%s: %u checks, %u failed\n", aName, testChecks, testFailures);
+    return (testFailures != 0) ? 1 : 0;
+}
+
+#endif /* TEST_CHECK_H_ */
@@ -0,0 +1,170 @@
+/*
+ * testCrashCluster.c
+ *
+ *  Created on: 18 Oct 2026
+ *
+ *  Known-answer tests for crash clustering signatures
+ *  - Includes crashCluster.c so the signature functions are called directly, with two
+ *    builds' function tables filled in by hand instead of read from ELFs
+ *  - The expected hashes are FNV-1a 64 of the bytes signRecord() documents, worked out
+ *    separately, so a change to the signature shows up here before it splits a cache
+ */
+#define main crashClusterMain
+#include "../crashCluster.c"
+#undef main
+
+#include "testCheck.h"
+
+#define MAX_TEST_FRAMES     8u
+
+typedef struct
+{
+    crashRecordType m_Header;
+    crashRecordTlvType m_BuildIdTlv;
+    uint8_t m_BuildId[4];
+    crashRecordTlvType m_BacktraceTlv;
+    uint32_t m_Frames[MAX_TEST_FRAMES];
+} testRecordType;
+
+// The same functions, moved by a rebuild.
+static elf32FunctionType buildAFunctions[] =
+{
+    {0x08001000u, 0x100u, "motorStep"},
+    {0x08001100u, 0x100u, "motorTask"},
+    {0x08001200u, 0x100u, "uartSend"},
+    {0x08001300u, 0x100u, "uartTask"},
+    {0x08001400u, 0x100u, "main"}
+};
+static elf32FunctionType buildBFunctions[] =
+{
+    {0x08002000u, 0x100u, "motorStep"},
+    {0x08002100u, 0x100u, "motorTask"},
+    {0x08002200u, 0x100u, "uartSend"},
+    {0x08002300u, 0x100u, "uartTask"},
+    {0x08002400u, 0x100u, "main"}
+};
+static const uint8_t buildAId[4] = {0xA1, 0xA2, 0xA3, 0xA4};
+static const uint8_t buildBId[4] = {0xB1, 0xB2, 0xB3, 0xB4};
+
+/* Build a record with a build-id, or none if aBuildId is NULL
+*/
+static const crashRecordType* makeRecord(testRecordType* aRecord, uint8_t type, const uint8_t* aBuildId,
+                                         const uint32_t* aFrames, uint32_t count)
+{
+    memset(aRecord, 0, sizeof(*aRecord));
+    aRecord->m_Header.m_Magic = CRASH_RECORD_MAGIC;
+    aRecord->m_Header.m_Version = CRASH_RECORD_VERSION;
+    aRecord->m_Header.m_HeaderSize = sizeof(crashRecordType);
+    aRecord->m_Header.m_Type = type;
+    aRecord->m_Header.m_Pc = aFrames[0];
+    aRecord->m_BuildIdTlv.m_Tag = (aBuildId != NULL) ? CRASH_RECORD_TAG_BUILD_ID : 0xFFFFu;
+    aRecord->m_BuildIdTlv.m_Length = sizeof(aRecord->m_BuildId);
+    if(aBuildId != NULL)
+        memcpy(aRecord->m_BuildId, aBuildId, sizeof(aRecord->m_BuildId));
+    aRecord->m_BacktraceTlv.m_Tag = CRASH_RECORD_TAG_BACKTRACE;
+    aRecord->m_BacktraceTlv.m_Length = (uint16_t)(count * sizeof(uint32_t));
+    memcpy(aRecord->m_Frames, aFrames, count * sizeof(uint32_t));
+    aRecord->m_Header.m_Size = (uint32_t)(offsetof(testRecordType, m_Frames) + (count * sizeof(uint32_t)));
+    return &aRecord->m_Header;
+}
+
+static void setBuilds(uint32_t count)
+{
+    memset(elfs, 0, sizeof(elfs));
+    elfs[0].m_Functions = buildAFunctions;
+    elfs[0].m_FunctionCount = sizeof(buildAFunctions) / sizeof(buildAFunctions[0]);
+    elfs[1].m_Functions = buildBFunctions;
+    elfs[1].m_FunctionCount = sizeof(buildBFunctions) / sizeof(buildBFunctions[0]);
+    buildIds[0] = buildAId;
+    buildIds[1] = buildBId;
+    buildIdLengths[0] = sizeof(buildAId);
+    buildIdLengths[1] = sizeof(buildBId);
+    elfCount = count;
+}
+
+static void testUnnamed(void)
+{
+    static const uint32_t frames[] = {0x08004001u, 0x08001235u};
+    testRecordType record;
+    const crashRecordType* header = makeRecord(&record, Bus_Fault, NULL, frames, 2);
+
+    // No ELF: the type, then each address without the Thumb bit.
+    setBuilds(0);
+    CHECK_EQUAL(findElf(header), MAX_ELFS);
+    CHECK_EQUAL(signRecord(header, MAX_ELFS), 0xAB6F1A3698B389FBull);
+}
+
+static void testNamed(void)
+{
+    static const uint32_t framesA[] = {0x08001025u, 0x08001111u};
+    static const uint32_t framesB[] = {0x08002025u, 0x08002111u};
+    static const uint32_t framesMoved[] = {0x08001029u, 0x08001111u};
+    testRecordType recordA;
+    testRecordType recordB;
+    testRecordType recordMoved;
+    testRecordType recordType;
+    const crashRecordType* a = makeRecord(&recordA, Usage_Fault, buildAId, framesA, 2);
+    const crashRecordType* b = makeRecord(&recordB, Usage_Fault, buildBId, framesB, 2);
+    const crashRecordType* moved = makeRecord(&recordMoved, Usage_Fault, buildAId, framesMoved, 2);
+    const crashRecordType* type = makeRecord(&recordType, Bus_Fault, buildAId, framesA, 2);
+
+    setBuilds(2);
+    CHECK_EQUAL(findElf(a), 0);
+    CHECK_EQUAL(findElf(b), 1);
+
+    // motorStep+0x24 called from motorTask+0x10, in either build.
+    CHECK_EQUAL(signRecord(a, 0), 0x62AE18D6E8C72CA7ull);
+    CHECK_EQUAL(signRecord(b, 1), 0x62AE18D6E8C72CA7ull);
+    CHECK(signRecord(moved, 0) != signRecord(a, 0));
+    CHECK(signRecord(type, 0) != signRecord(a, 0));
+
+    // Against the wrong build the frames don't resolve and the signature differs.
+    CHECK(signRecord(b, 0) != signRecord(a, 0));
+
+    // A record without a build-id only takes the ELF when there is exactly one.
+    makeRecord(&recordA, Usage_Fault, NULL, framesA, 2);
+    CHECK_EQUAL(findElf(a), MAX_ELFS);
+    setBuilds(1);
+    CHECK_EQUAL(findElf(a), 0);
+    CHECK_EQUAL(signRecord(a, 0), 0x62AE18D6E8C72CA7ull);
+}
+
+static void testMinHash(void)
+{
+    static const uint32_t frames[] = {0x08001025u, 0x08001111u, 0x08001301u, 0x08001401u};
+    static const uint32_t framesOtherCaller[] = {0x08001025u, 0x08001111u, 0x08001301u, 0x08001201u};
+    static const uint32_t framesUnrelated[] = {0x08001221u, 0x08001225u};
+    testRecordType record;
+    testRecordType recordB;
+    testRecordType recordOther;
+    testRecordType recordUnrelated;
+    signatureType left;
+    signatureType right;
+    uint32_t rebuilt[] = {0x08002025u, 0x08002111u, 0x08002301u, 0x08002401u};
+
+    setBuilds(2);
+    memset(&left, 0, sizeof(left));
+    memset(&right, 0, sizeof(right));
+
+    // The same functions in another build have the same set, offsets don't matter.
+    minHashRecord(makeRecord(&record, Usage_Fault, buildAId, frames, 4), 0, left.m_MinHash);
+    rebuilt[0] += 8;
+    minHashRecord(makeRecord(&recordB, Usage_Fault, buildBId, rebuilt, 4), 1, right.m_MinHash);
+    CHECK(similarity(&left, &right) == 1.0);
+
+    // One caller differs: 6 of the 10 shingles are shared.
+    minHashRecord(makeRecord(&recordOther, Usage_Fault, buildAId, framesOtherCaller, 4), 0, right.m_MinHash);
+    CHECK((similarity(&left, &right) > 0.3) && (similarity(&left, &right) < 0.9));
+
+    // Nothing but the fault type in common.
+    minHashRecord(makeRecord(&recordUnrelated, Usage_Fault, buildAId, framesUnrelated, 2), 0, right.m_MinHash);
+    CHECK(similarity(&left, &right) < 0.3);
+}
+
+int main(void)
+{
+    testUnnamed();
+    testNamed();
+    testMinHash();
+    return testResult("crashCluster");
+}
@@ -0,0 +1,188 @@
+/*
+ * testDecodeCache.c
+ *
+ *  Created on: 18 Oct 2026
+ *
+ *  Known-answer tests for the decode cache
+ *  - The record and build-id hashes are keys in files already written, their values were
+ *    worked out separately and must not change without a new layout
+ *  - Values are round-tripped inline and on the heap, across close and reopen and across the
+ *    rebuilds that grow the slot table and the heap
+ *  - A new decoder version misses, and its next rebuild drops the old entries
+ *  - A file that isn't a cache is started over
+ */
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "../../exceptions.h"
+#include "../decodeCache.h"
+#include "testCheck.h"
+
+#define ENTRY_COUNT         5000u       // Enough to grow the 4096 slot table twice.
+#define LARGE_LENGTH        40u         // Values this long go on the heap.
+
+static char path[64];
+
+// Entry i's key and value, long values fill the heap past its first 64 KB.
+static uint64_t entryRecord(uint32_t i)
+{
+    return 0x1000u + i;
+}
+
+static uint64_t entryBuild(uint32_t i)
+{
+    return (i & 1u) ? 0 : 0xB0B0B0B0u;
+}
+
+static uint32_t entryValue(uint32_t i, uint8_t* aValue)
+{
+    uint32_t length = (i % 3u == 0) ? LARGE_LENGTH : (1u + (i % 8u));
+    uint32_t j;
+
+    for(j = 0; j < length; j++)
+        aValue[j] = (uint8_t)(i + (j * 7u));
+    return length;
+}
+
+static uint32_t checkEntries(decodeCacheType* aCache, uint32_t count)
+{
+    uint32_t found = 0;
+    uint32_t i;
+
+    for(i = 0; i < count; i++)
+    {
+        uint8_t expected[LARGE_LENGTH];
+        uint32_t expectedLength = entryValue(i, expected);
+        uint32_t length = 0;
+        const void* value = decodeCacheFind(aCache, entryRecord(i), entryBuild(i), &length);
+
+        if((value != NULL) && (length == expectedLength) && (memcmp(value, expected, length) == 0))
+            found++;
+    }
+    return found;
+}
+
+static off_t cacheFileSize(void)
+{
+    struct stat info;
+
+    return (stat(path, &info) == 0) ? info.st_size : -1;
+}
+
+static void testHashes(void)
+{
+    static const uint8_t id[4] = {0xA1, 0xA2, 0xA3, 0xA4};
+    crashRecordType record;
+
+    memset(&record, 0, sizeof(record));
+    record.m_Crc = 0x12345678u;
+    record.m_Size = 0x100u;
+    record.m_Pc = 0x08001234u;
+    record.m_Lr = 0x08000101u;
+    record.m_Sp = 0x2001FF00u;
+    record.m_Sequence = 7;
+    record.m_Cfsr = 0x8200u;
+    record.m_Type = Bus_Fault;
+
+    CHECK_EQUAL(decodeCacheRecordHash(&record), 0x3A2C5F541F014263ull);
+    CHECK_EQUAL(decodeCacheBuildHash(id, sizeof(id)), 0x4FC5D926827CCA2Dull);
+    CHECK_EQUAL(decodeCacheBuildHash(id, 0), 0);
+}
+
+static void testRoundTrip(void)
+{
+    decodeCacheType cache;
+    uint8_t value[LARGE_LENGTH];
+    uint32_t length;
+    off_t initialSize;
+    uint32_t i;
+
+    CHECK_EQUAL(decodeCacheOpen(&cache, path, 1), 0);
+    initialSize = cacheFileSize();
+    CHECK_EQUAL(checkEntries(&cache, ENTRY_COUNT), 0);
+    for(i = 0; i < ENTRY_COUNT; i++)
+    {
+        length = entryValue(i, value);
+        CHECK_EQUAL(decodeCacheStore(&cache, entryRecord(i), entryBuild(i), value, length), 0);
+    }
+    CHECK_EQUAL(checkEntries(&cache, ENTRY_COUNT), ENTRY_COUNT);
+    CHECK(cacheFileSize() > initialSize);
+
+    // Record hash 0 is the free slot marker.
+    CHECK_EQUAL(decodeCacheStore(&cache, 0, 0, value, 1), -1);
+
+    // The same record against another build is another entry, a second store replaces.
+    CHECK(decodeCacheFind(&cache, entryRecord(0), 0x1234u, &length) == NULL);
+    CHECK_EQUAL(decodeCacheStore(&cache, entryRecord(0), 0x1234u, "other", 5), 0);
+    CHECK_EQUAL(decodeCacheStore(&cache, entryRecord(0), 0x1234u, "replaced", 8), 0);
+    CHECK(decodeCacheFind(&cache, entryRecord(0), 0x1234u, &length) != NULL);
+    CHECK_EQUAL(length, 8);
+    CHECK_EQUAL(checkEntries(&cache, ENTRY_COUNT), ENTRY_COUNT);
+    decodeCacheClose(&cache);
+
+    CHECK_EQUAL(decodeCacheOpen(&cache, path, 1), 0);
+    CHECK_EQUAL(checkEntries(&cache, ENTRY_COUNT), ENTRY_COUNT);
+    CHECK(memcmp(decodeCacheFind(&cache, entryRecord(0), 0x1234u, &length), "replaced", 8) == 0);
+    decodeCacheClose(&cache);
+}
+
+static void testDecoderVersion(void)
+{
+    decodeCacheType cache;
+    uint8_t value[LARGE_LENGTH];
+    uint32_t i;
+
+    CHECK_EQUAL(decodeCacheOpen(&cache, path, 2), 0);
+    CHECK_EQUAL(checkEntries(&cache, ENTRY_COUNT), 0);
+    CHECK_EQUAL(cache.m_Misses, ENTRY_COUNT);
+
+    // Enough new entries to rebuild, which carries over only version 2.
+    for(i = 0; i < ENTRY_COUNT; i++)
+        CHECK_EQUAL(decodeCacheStore(&cache, entryRecord(i) + ENTRY_COUNT, 0, value, entryValue(i, value)), 0);
+    decodeCacheClose(&cache);
+
+    CHECK_EQUAL(decodeCacheOpen(&cache, path, 1), 0);
+    CHECK_EQUAL(checkEntries(&cache, ENTRY_COUNT), 0);
+    decodeCacheClose(&cache);
+}
+
+static void testNotACache(void)
+{
+    decodeCacheType cache;
+    FILE* file = fopen(path, "wb");
+    uint8_t value = 5;
+    uint32_t length = 0;
+
+    fputs("not a decode cache, just some text long enough for a header\n", file);
+    fclose(file);
+
+    CHECK_EQUAL(decodeCacheOpen(&cache, path, 1), 0);
+    CHECK(decodeCacheFind(&cache, entryRecord(0), entryBuild(0), &length) == NULL);
+    CHECK_EQUAL(decodeCacheStore(&cache, entryRecord(0), 0, &value, 1), 0);
+    CHECK(decodeCacheFind(&cache, entryRecord(0), 0, &length) != NULL);
+    decodeCacheClose(&cache);
+}
+
+int main(void)
+{
+    char directory[] = "/tmp/testDecodeCacheXXXXXX";
+
+    if(mkdtemp(directory) == NULL)
+    {
+        perror(directory);
+        return 1;
+    }
+    snprintf(path, sizeof(path), "%s/cache.bin", directory);
+
+    testHashes();
+    testRoundTrip();
+    testDecoderVersion();
+    testNotACache();
+
+    unlink(path);
+    rmdir(directory);
+    return testResult("decodeCache");
+}
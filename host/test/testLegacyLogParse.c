@@ -0,0 +1,280 @@
+/*
+ * testLegacyLogParse.c
+ *
+ *  Created on: 18 Oct 2026
+ *
+ *  Known-answer tests for the legacy log parser
+ *  - Includes legacyLogParse.c so the parser is driven directly, records are written to
+ *    memory and read back through crashArchive.c
+ *  - Covers complete blocks with prefixes and interleaved output, blocks cut short by a new
+ *    marker, by a gap or by the end of the log, the optional assert token, and input split
+ *    mid-line as parseStream() feeds it
+ */
+#define main legacyLogParseMain
+#include "../legacyLogParse.c"
+#undef main
+
+#include "testCheck.h"
+
+#define MAX_TEST_RECORDS    8u
+
+typedef struct
+{
+    char* m_Data;
+    size_t m_Size;
+    const crashRecordType* m_Records[MAX_TEST_RECORDS];
+    uint32_t m_Count;
+    parserType m_Parser;
+} parsedType;
+
+// Bus fault, timestamped, with unrelated output inside the block.
+static const char busFault[] =
+    "[  12.001] boot ok\r\n"
+    "[  12.345] **** EXCEPTION OCCURRED ****\r\n"
+    "[  12.345] Type: Bus Fault\r\n"
+    "[  12.345] Reason: Invalid data address\r\n"
+    "\n"
+    "[  12.346] net: link up\r\n"
+    "[  12.346] R0=1 R1=2\r\n"
+    "[  12.346] R2=3 R3=4\r\n"
+    "[  12.346] R12=c LR=8001235\r\n"
+    "[  12.346] PC=8004000 PSR=21000000\r\n"
+    "[  12.346] HFSR=0 CFSR=8200\r\n"
+    "[  12.346] Fault address=30000000\r\n"
+    "[  12.400] R0=ffffffff after the block\r\n";
+
+// Reset after the PC line, then the fault again in full from the next boot.
+static const char cutByMarker[] =
+    "**** EXCEPTION OCCURRED ****\r\n"
+    "Type: Hard Fault\r\n"
+    "R0=0 R1=0\r\n"
+    "R12=0 LR=fffffff9\r\n"
+    "PC=8000100 PSR=1000000\r\n"
+    "**** EXCEPTION OCCURRED ****\r\n"
+    "Type: Memory Fault\r\n"
+    "R0=0 R1=0\r\n"
+    "R2=0 R3=0\r\n"
+    "R12=0 LR=fffffffd\r\n"
+    "PC=8000200 PSR=1000000\r\n"
+    "HFSR=0 CFSR=82\r\n"
+    "Fault address=20030000\r\n";
+
+// Nothing past the type, then no marker at all: dropped.
+static const char cutBeforePc[] =
+    "**** EXCEPTION OCCURRED ****\r\n"
+    "Type: Usage Fault\r\n"
+    "R0=0 R1=0\r\n";
+
+// Undefined instruction with its assert token.
+static const char assertToken[] =
+    "**** EXCEPTION OCCURRED ****\r\n"
+    "Type: Usage Fault\r\n"
+    "Reason: Assertion failed\r\n"
+    "\n"
+    "R0=0 R1=0\r\n"
+    "R2=0 R3=0\r\n"
+    "R12=0 LR=8000301\r\n"
+    "PC=8000400 PSR=1000000\r\n"
+    "HFSR=0 CFSR=10000\r\n"
+    "Fault address=8000400\r\n"
+    "Assert token=2a0015\r\n";
+
+// Undefined instruction from firmware without FAULT_ASSERT, the next line is someone else's.
+static const char noAssertToken[] =
+    "**** EXCEPTION OCCURRED ****\r\n"
+    "Type: Usage Fault\r\n"
+    "R0=0 R1=0\r\n"
+    "R2=0 R3=0\r\n"
+    "R12=0 LR=8000301\r\n"
+    "PC=8000500 PSR=1000000\r\n"
+    "HFSR=0 CFSR=10000\r\n"
+    "Fault address=8000500\r\n"
+    "motor: PC=1234 LR=5678\r\n";
+
+// The log ends after the PSR.
+static const char cutByEnd[] =
+    "**** EXCEPTION OCCURRED ****\r\n"
+    "Type: Lockup\r\n"
+    "R0=0 R1=0\r\n"
+    "R2=0 R3=0\r\n"
+    "R12=0 LR=8000601\r\n"
+    "PC=8000600 PSR=1000000\r\n";
+
+/* Parse a log, in two pieces split at splitAt if it isn't 0
+*/
+static void parse(parsedType* aParsed, const char* aLog, size_t splitAt)
+{
+    size_t length = strlen(aLog);
+    size_t offset = 0;
+
+    memset(aParsed, 0, sizeof(*aParsed));
+    aParsed->m_Parser.m_Out = open_memstream(&aParsed->m_Data, &aParsed->m_Size);
+    if(splitAt != 0)
+    {
+        // As parseStream() does: what wasn't consumed is presented again with the rest.
+        size_t consumed = parseBuffer(&aParsed->m_Parser, aLog, splitAt, 0);
+
+        CHECK(consumed <= splitAt);
+        parseBuffer(&aParsed->m_Parser, aLog + consumed, length - consumed, 1);
+    }
+    else
+    {
+        parseBuffer(&aParsed->m_Parser, aLog, length, 1);
+    }
+    fclose(aParsed->m_Parser.m_Out);
+
+    while(offset < aParsed->m_Size)
+    {
+        uint32_t size = crashArchiveValidate((const uint8_t*)aParsed->m_Data + offset, aParsed->m_Size - offset);
+
+        CHECK(size != 0);
+        if((size == 0) || (aParsed->m_Count == MAX_TEST_RECORDS))
+            break;
+        aParsed->m_Records[aParsed->m_Count++] = (const crashRecordType*)(aParsed->m_Data + offset);
+        offset += size;
+    }
+    CHECK_EQUAL(aParsed->m_Count, aParsed->m_Parser.m_Records);
+}
+
+static void testBusFault(void)
+{
+    parsedType parsed;
+    const crashRecordType* record;
+    uint32_t frames[4];
+
+    parse(&parsed, busFault, 0);
+    CHECK_EQUAL(parsed.m_Count, 1);
+    CHECK_EQUAL(parsed.m_Parser.m_Truncated, 0);
+    if(parsed.m_Count == 1)
+    {
+        record = parsed.m_Records[0];
+        CHECK_EQUAL(record->m_Type, Bus_Fault);
+        CHECK_EQUAL(record->m_Flags, CRASH_RECORD_FLAG_FROM_TEXT);
+        CHECK_EQUAL(record->m_R[0], 1);
+        CHECK_EQUAL(record->m_R[3], 4);
+        CHECK_EQUAL(record->m_R[12], 0xC);
+        CHECK_EQUAL(record->m_Pc, 0x08004000u);
+        CHECK_EQUAL(record->m_Psr, 0x21000000u);
+        CHECK_EQUAL(record->m_Cfsr, 0x8200);
+        CHECK_EQUAL(record->m_Bfar, 0x30000000u);
+        CHECK_EQUAL(record->m_Mmfar, 0);
+        CHECK_EQUAL(record->m_AssertToken, EXCEPTION_HANDLER_FIELD_IS_INVALID);
+
+        // LR is a return address here, so it follows the PC.
+        CHECK_EQUAL(crashArchiveBacktrace(record, frames, 4), 2);
+        CHECK_EQUAL(frames[0], 0x08004000u);
+        CHECK_EQUAL(frames[1], 0x08001235u);
+    }
+    free(parsed.m_Data);
+}
+
+static void testCutByMarker(void)
+{
+    parsedType parsed;
+    uint32_t frames[4];
+
+    parse(&parsed, cutByMarker, 0);
+    CHECK_EQUAL(parsed.m_Parser.m_Blocks, 2);
+    CHECK_EQUAL(parsed.m_Count, 2);
+    CHECK_EQUAL(parsed.m_Parser.m_Truncated, 1);
+    if(parsed.m_Count == 2)
+    {
+        CHECK_EQUAL(parsed.m_Records[0]->m_Type, Hard_Fault);
+        CHECK_EQUAL(parsed.m_Records[0]->m_Flags, CRASH_RECORD_FLAG_FROM_TEXT | CRASH_RECORD_FLAG_TRUNCATED);
+        CHECK_EQUAL(parsed.m_Records[0]->m_Pc, 0x08000100u);
+        CHECK_EQUAL(parsed.m_Records[0]->m_Sequence, 0);
+
+        // EXC_RETURN in LR isn't a frame.
+        CHECK_EQUAL(crashArchiveBacktrace(parsed.m_Records[0], frames, 4), 1);
+
+        CHECK_EQUAL(parsed.m_Records[1]->m_Type, MemMang_Fault);
+        CHECK_EQUAL(parsed.m_Records[1]->m_Flags, CRASH_RECORD_FLAG_FROM_TEXT);
+        CHECK_EQUAL(parsed.m_Records[1]->m_Mmfar, 0x20030000u);
+        CHECK_EQUAL(parsed.m_Records[1]->m_Sequence, 1);
+    }
+    free(parsed.m_Data);
+}
+
+static void testCutBeforePc(void)
+{
+    parsedType parsed;
+
+    parse(&parsed, cutBeforePc, 0);
+    CHECK_EQUAL(parsed.m_Parser.m_Blocks, 1);
+    CHECK_EQUAL(parsed.m_Count, 0);
+    CHECK_EQUAL(parsed.m_Parser.m_Dropped, 1);
+    free(parsed.m_Data);
+}
+
+static void testAssertToken(void)
+{
+    parsedType parsed;
+
+    parse(&parsed, assertToken, 0);
+    CHECK_EQUAL(parsed.m_Count, 1);
+    if(parsed.m_Count == 1)
+    {
+        CHECK_EQUAL(parsed.m_Records[0]->m_Flags, CRASH_RECORD_FLAG_FROM_TEXT);
+        CHECK_EQUAL(parsed.m_Records[0]->m_AssertToken, 0x002A0015u);
+    }
+    free(parsed.m_Data);
+
+    // Only the token is looked for after the fault address, the block is complete without it.
+    parse(&parsed, noAssertToken, 0);
+    CHECK_EQUAL(parsed.m_Count, 1);
+    if(parsed.m_Count == 1)
+    {
+        CHECK_EQUAL(parsed.m_Records[0]->m_Flags, CRASH_RECORD_FLAG_FROM_TEXT);
+        CHECK_EQUAL(parsed.m_Records[0]->m_AssertToken, EXCEPTION_HANDLER_FIELD_IS_INVALID);
+        CHECK_EQUAL(parsed.m_Records[0]->m_Pc, 0x08000500u);
+        CHECK_EQUAL(parsed.m_Records[0]->m_Lr, 0x08000301u);
+    }
+    free(parsed.m_Data);
+}
+
+static void testCutByEnd(void)
+{
+    parsedType parsed;
+
+    parse(&parsed, cutByEnd, 0);
+    CHECK_EQUAL(parsed.m_Count, 1);
+    CHECK_EQUAL(parsed.m_Parser.m_Truncated, 1);
+    if(parsed.m_Count == 1)
+    {
+        CHECK_EQUAL(parsed.m_Records[0]->m_Type, Lockup);
+        CHECK_EQUAL(parsed.m_Records[0]->m_Flags, CRASH_RECORD_FLAG_FROM_TEXT | CRASH_RECORD_FLAG_TRUNCATED);
+        CHECK_EQUAL(parsed.m_Records[0]->m_Hfsr, 0);
+    }
+    free(parsed.m_Data);
+}
+
+/* Every split point gives the same records as the whole log at once
+*/
+static void testSplit(void)
+{
+    parsedType whole;
+    parsedType split;
+    size_t length = strlen(cutByMarker);
+    size_t i;
+
+    parse(&whole, cutByMarker, 0);
+    for(i = 1; i < length; i++)
+    {
+        parse(&split, cutByMarker, i);
+        CHECK_EQUAL(split.m_Size, whole.m_Size);
+        CHECK((split.m_Size == whole.m_Size) && (memcmp(split.m_Data, whole.m_Data, whole.m_Size) == 0));
+        free(split.m_Data);
+    }
+    free(whole.m_Data);
+}
+
+int main(void)
+{
+    testBusFault();
+    testCutByMarker();
+    testCutBeforePc();
+    testAssertToken();
+    testCutByEnd();
+    testSplit();
+    return testResult("legacyLogParse");
+}
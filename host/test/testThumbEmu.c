@@ -0,0 +1,359 @@
+/*
+ * testThumbEmu.c
+ *
+ *  Created on: 18 Oct 2026
+ *
+ *  Known-answer tests for the Thumb-2 emulator
+ *  - The programs were assembled with llvm-mc for thumbv7em, the listing is next to each
+ *    instruction; each result is stored to RAM and compared with the architecturally defined
+ *    value, flags included
+ *  - A divide by zero with CCR.DIV_0_TRP set checks exception entry: UsageFault, CFSR and the
+ *    stacked frame
+ */
+#include <string.h>
+
+#include "../thumbEmu.h"
+#include "testCheck.h"
+
+#define FLASH_SIZE          0x1000u
+#define RAM_BASE            0x20000000u
+#define RAM_SIZE            0x2000u
+#define CODE_ADDRESS        0x100u          // After the vector table.
+#define STACK_TOP           0x20001000u
+#define SCRATCH_ADDRESS     0x20000100u     // The program's own loads and stores.
+
+#define CCR_DIV_0_TRP       (1u<<4)
+#define SHCSR_USGFAULTENA   (1u<<18)
+#define CPACR_FPU_ENABLED   0x00F00000u
+#define CFSR_DIVBYZERO      (1u<<25)
+
+#define APSR_N              (1u<<31)
+#define APSR_Z              (1u<<30)
+#define APSR_C              (1u<<29)
+#define APSR_V              (1u<<28)
+#define APSR_Q              (1u<<27)
+#define APSR_GE(bits)       ((uint32_t)(bits) << 16)
+
+static const uint16_t resultsProgram[] =
+{
+    0xf240, 0x0700,         // movw r7, #0
+    0xf2c2, 0x0700,         // movt r7, #0x2000
+    0xf06f, 0x4000,         // mvn r0, #0x80000000
+    0x1c41,                 // adds r1, r0, #1
+    0xf3ef, 0x8200,         // mrs r2, apsr
+    0xf847, 0x1b04,         // str r1, [r7], #4
+    0xf847, 0x2b04,         // str r2, [r7], #4
+    0x1a01,                 // subs r1, r0, r0
+    0xf3ef, 0x8200,         // mrs r2, apsr
+    0xf847, 0x1b04,         // str r1, [r7], #4
+    0xf847, 0x2b04,         // str r2, [r7], #4
+    0x2000,                 // movs r0, #0
+    0x1e41,                 // subs r1, r0, #1
+    0xf3ef, 0x8200,         // mrs r2, apsr
+    0xf847, 0x1b04,         // str r1, [r7], #4
+    0xf847, 0x2b04,         // str r2, [r7], #4
+    0xf240, 0x0001,         // movw r0, #1
+    0xf2c8, 0x0000,         // movt r0, #0x8000
+    0x0041,                 // lsls r1, r0, #1
+    0xf3ef, 0x8200,         // mrs r2, apsr
+    0xf847, 0x1b04,         // str r1, [r7], #4
+    0xf847, 0x2b04,         // str r2, [r7], #4
+    0x1101,                 // asrs r1, r0, #4
+    0xf3ef, 0x8200,         // mrs r2, apsr
+    0xf847, 0x1b04,         // str r1, [r7], #4
+    0xf847, 0x2b04,         // str r2, [r7], #4
+    0x2003,                 // movs r0, #3
+    0xea4f, 0x0170,         // ror r1, r0, #1
+    0xf847, 0x1b04,         // str r1, [r7], #4
+    0xf240, 0x30e8,         // movw r0, #1000
+    0xf640, 0x31b8,         // movw r1, #3000
+    0xfb00, 0xf201,         // mul r2, r0, r1
+    0xf847, 0x2b04,         // str r2, [r7], #4
+    0xf06f, 0x0000,         // mvn r0, #0
+    0xfba0, 0x2300,         // umull r2, r3, r0, r0
+    0xf847, 0x2b04,         // str r2, [r7], #4
+    0xf847, 0x3b04,         // str r3, [r7], #4
+    0xfb80, 0x2300,         // smull r2, r3, r0, r0
+    0xf847, 0x2b04,         // str r2, [r7], #4
+    0xf847, 0x3b04,         // str r3, [r7], #4
+    0x2007,                 // movs r0, #7
+    0x2106,                 // movs r1, #6
+    0x2305,                 // movs r3, #5
+    0xfb00, 0x3201,         // mla r2, r0, r1, r3
+    0xf847, 0x2b04,         // str r2, [r7], #4
+    0x2064,                 // movs r0, #100
+    0x2107,                 // movs r1, #7
+    0xfbb0, 0xf2f1,         // udiv r2, r0, r1
+    0xf847, 0x2b04,         // str r2, [r7], #4
+    0xf06f, 0x0063,         // mvn r0, #99
+    0xfb90, 0xf2f1,         // sdiv r2, r0, r1
+    0xf847, 0x2b04,         // str r2, [r7], #4
+    0xf04f, 0x4000,         // mov r0, #0x80000000
+    0xf06f, 0x0100,         // mvn r1, #0
+    0xfb90, 0xf2f1,         // sdiv r2, r0, r1
+    0xf847, 0x2b04,         // str r2, [r7], #4
+    0x2100,                 // movs r1, #0
+    0xfbb0, 0xf2f1,         // udiv r2, r0, r1
+    0xf847, 0x2b04,         // str r2, [r7], #4
+    0x2001,                 // movs r0, #1
+    0xfab0, 0xf280,         // clz r2, r0
+    0xf847, 0x2b04,         // str r2, [r7], #4
+    0x2000,                 // movs r0, #0
+    0xfab0, 0xf280,         // clz r2, r0
+    0xf847, 0x2b04,         // str r2, [r7], #4
+    0x2001,                 // movs r0, #1
+    0xfa90, 0xf2a0,         // rbit r2, r0
+    0xf847, 0x2b04,         // str r2, [r7], #4
+    0xf243, 0x3044,         // movw r0, #0x3344
+    0xf2c1, 0x1022,         // movt r0, #0x1122
+    0xba02,                 // rev r2, r0
+    0xf847, 0x2b04,         // str r2, [r7], #4
+    0xba42,                 // rev16 r2, r0
+    0xf847, 0x2b04,         // str r2, [r7], #4
+    0xbac2,                 // revsh r2, r0
+    0xf847, 0x2b04,         // str r2, [r7], #4
+    0xf3c0, 0x2207,         // ubfx r2, r0, #8, #8
+    0xf847, 0x2b04,         // str r2, [r7], #4
+    0x21f0,                 // movs r1, #0xf0
+    0xf341, 0x1203,         // sbfx r2, r1, #4, #4
+    0xf847, 0x2b04,         // str r2, [r7], #4
+    0x2200,                 // movs r2, #0
+    0x21ff,                 // movs r1, #0xff
+    0xf361, 0x220b,         // bfi r2, r1, #8, #4
+    0xf847, 0x2b04,         // str r2, [r7], #4
+    0xf36f, 0x000f,         // bfc r0, #0, #16
+    0xf847, 0x0b04,         // str r0, [r7], #4
+    0x2005,                 // movs r0, #5
+    0x2805,                 // cmp r0, #5
+    0xbf0c,                 // ite eq
+    0x2201,                 // moveq r2, #1
+    0x2202,                 // movne r2, #2
+    0xf847, 0x2b04,         // str r2, [r7], #4
+    0x2804,                 // cmp r0, #4
+    0xbf0c,                 // ite eq
+    0x2201,                 // moveq r2, #1
+    0x2202,                 // movne r2, #2
+    0xf847, 0x2b04,         // str r2, [r7], #4
+    0x2000,                 // movs r0, #0
+    0xf380, 0x8800,         // msr apsr_nzcvq, r0
+    0xf240, 0x102c,         // movw r0, #300
+    0xf380, 0x0208,         // usat r2, #8, r0
+    0xf3ef, 0x8300,         // mrs r3, apsr
+    0xf847, 0x2b04,         // str r2, [r7], #4
+    0xf847, 0x3b04,         // str r3, [r7], #4
+    0x2000,                 // movs r0, #0
+    0xf380, 0x8800,         // msr apsr_nzcvq, r0
+    0xf240, 0x102c,         // movw r0, #300
+    0x4240,                 // negs r0, r0
+    0xf300, 0x0207,         // ssat r2, #8, r0
+    0xf847, 0x2b04,         // str r2, [r7], #4
+    0x2000,                 // movs r0, #0
+    0xf380, 0x8c00,         // msr apsr_nzcvqg, r0
+    0xf64f, 0x7001,         // movw r0, #0xff01
+    0xfa80, 0xf240,         // uadd8 r2, r0, r0
+    0xf3ef, 0x8300,         // mrs r3, apsr
+    0xf847, 0x2b04,         // str r2, [r7], #4
+    0xf847, 0x3b04,         // str r3, [r7], #4
+    0xf240, 0x1600,         // movw r6, #0x100
+    0xf2c2, 0x0600,         // movt r6, #0x2000
+    0xf248, 0x0081,         // movw r0, #0x8081
+    0xf2c8, 0x2083,         // movt r0, #0x8283
+    0x6030,                 // str r0, [r6]
+    0x7872,                 // ldrb r2, [r6, #1]
+    0xf847, 0x2b04,         // str r2, [r7], #4
+    0xf996, 0x2001,         // ldrsb r2, [r6, #1]
+    0xf847, 0x2b04,         // str r2, [r7], #4
+    0x8872,                 // ldrh r2, [r6, #2]
+    0xf847, 0x2b04,         // str r2, [r7], #4
+    0xf9b6, 0x2002,         // ldrsh r2, [r6, #2]
+    0xf847, 0x2b04,         // str r2, [r7], #4
+    0x2001,                 // movs r0, #1
+    0x2102,                 // movs r1, #2
+    0x2203,                 // movs r2, #3
+    0xc607,                 // stmia r6!, {r0-r2}
+    0xf847, 0x6b04,         // str r6, [r7], #4
+    0xe916, 0x0038,         // ldmdb r6, {r3-r5}
+    0x191b,                 // adds r3, r4
+    0x195b,                 // adds r3, r5
+    0xf847, 0x3b04,         // str r3, [r7], #4
+    0xf000, 0xf837,         // bl function
+    0xf847, 0x2b04,         // str r2, [r7], #4
+    0x4668,                 // mov r0, sp
+    0xf847, 0x0b04,         // str r0, [r7], #4
+    0x2000,                 // movs r0, #0
+    0x2201,                 // movs r2, #1
+    0xb100,                 // cbz r0, 1f
+    0x2202,                 // movs r2, #2
+    // 1:
+    0xf847, 0x2b04,         // str r2, [r7], #4
+    0x2003,                 // movs r0, #3
+    0xee00, 0x0a10,         // vmov s0, r0
+    0xeeb8, 0x0ac0,         // vcvt.f32.s32 s0, s0
+    0x2004,                 // movs r0, #4
+    0xee00, 0x0a90,         // vmov s1, r0
+    0xeef8, 0x0ae0,         // vcvt.f32.s32 s1, s1
+    0xee30, 0x1a20,         // vadd.f32 s2, s0, s1
+    0xed87, 0x1a00,         // vstr s2, [r7]
+    0x3704,                 // adds r7, #4
+    0xee20, 0x1a20,         // vmul.f32 s2, s0, s1
+    0xed87, 0x1a00,         // vstr s2, [r7]
+    0x3704,                 // adds r7, #4
+    0xee80, 0x1a20,         // vdiv.f32 s2, s0, s1
+    0xed87, 0x1a00,         // vstr s2, [r7]
+    0x3704,                 // adds r7, #4
+    0xeefd, 0x1ac1,         // vcvt.s32.f32 s3, s2
+    0xedc7, 0x1a00,         // vstr s3, [r7]
+    0x3704,                 // adds r7, #4
+    0xeeb1, 0x1ae0,         // vsqrt.f32 s2, s1
+    0xed87, 0x1a00,         // vstr s2, [r7]
+    0x3704,                 // adds r7, #4
+    0xeeb4, 0x0a60,         // vcmp.f32 s0, s1
+    0xeef1, 0xfa10,         // vmrs APSR_nzcv, fpscr
+    0xf3ef, 0x8200,         // mrs r2, apsr
+    0xf847, 0x2b04,         // str r2, [r7], #4
+    0xbe00,                 // bkpt #0
+    // function:
+    0xb510,                 // push {r4, lr}
+    0x242a,                 // movs r4, #42
+    0x4622,                 // mov r2, r4
+    0xbd10,                 // pop {r4, pc}
+};
+
+// Stored in order by resultsProgram.
+static const uint32_t expectedResults[] =
+{
+    0x80000000u, APSR_N | APSR_V,               // adds, signed overflow.
+    0x00000000u, APSR_Z | APSR_C,               // subs, equal.
+    0xFFFFFFFFu, APSR_N,                        // subs, borrow clears C.
+    0x00000002u, APSR_C,                        // lsls, bit 31 into C.
+    0xF8000000u, APSR_N,                        // asrs, C from bit 3.
+    0x80000001u,                                // ror.
+    3000000u,                                   // mul.
+    0x00000001u, 0xFFFFFFFEu,                   // umull 0xffffffff squared.
+    0x00000001u, 0x00000000u,                   // smull -1 squared.
+    47u,                                        // mla.
+    14u,                                        // udiv.
+    0xFFFFFFF2u,                                // sdiv rounds towards zero.
+    0x80000000u,                                // sdiv INT_MIN / -1.
+    0x00000000u,                                // udiv by zero without DIV_0_TRP.
+    31u, 32u,                                   // clz 1, clz 0.
+    0x80000000u,                                // rbit.
+    0x44332211u, 0x22114433u, 0x00004433u,      // rev, rev16, revsh.
+    0x00000033u,                                // ubfx.
+    0xFFFFFFFFu,                                // sbfx sign extends.
+    0x00000F00u,                                // bfi.
+    0x11220000u,                                // bfc.
+    1u, 2u,                                     // ite eq, taken then not.
+    255u, APSR_Q,                               // usat saturates and sets Q.
+    0xFFFFFF80u,                                // ssat.
+    0x0000FE02u, APSR_GE(0x2),                  // uadd8, carry out of byte 1 only.
+    0x00000080u, 0xFFFFFF80u,                   // ldrb, ldrsb.
+    0x00008283u, 0xFFFF8283u,                   // ldrh, ldrsh.
+    SCRATCH_ADDRESS + 12u,                      // stmia writeback.
+    6u,                                         // ldmdb.
+    42u,                                        // bl, push and pop {pc}.
+    STACK_TOP,                                  // sp balanced.
+    1u,                                         // cbz taken.
+    0x40E00000u, 0x41400000u, 0x3F400000u,      // 3 + 4, 3 * 4, 3 / 4.
+    0x00000000u,                                // vcvt.s32 0.75 truncates.
+    0x40000000u,                                // vsqrt 4.
+    APSR_N | APSR_GE(0x2)                       // vcmp 3 < 4, GE left from uadd8.
+};
+
+static const uint16_t divideByZeroProgram[] =
+{
+    0x2001,                 // movs r0, #1
+    0x2100,                 // movs r1, #0
+    0xfbb0, 0xf2f1,         // udiv r2, r0, r1
+    0xbe00,                 // bkpt #0
+    // usageFault:
+    0xbe01,                 // bkpt #1
+};
+
+static uint8_t flash[FLASH_SIZE];
+static uint8_t ram[RAM_SIZE];
+
+static void put32(uint8_t* aDest, uint32_t value)
+{
+    aDest[0] = (uint8_t)value;
+    aDest[1] = (uint8_t)(value >> 8);
+    aDest[2] = (uint8_t)(value >> 16);
+    aDest[3] = (uint8_t)(value >> 24);
+}
+
+/* Map a program at CODE_ADDRESS and reset into it
+ * - handler is the halfword index of the UsageFault handler, 0 for none
+*/
+static void loadProgram(thumbEmuType* aEmu, const uint16_t* aCode, uint32_t count, uint32_t handler)
+{
+    uint32_t i;
+
+    memset(flash, 0, sizeof(flash));
+    memset(ram, 0, sizeof(ram));
+    put32(&flash[0], STACK_TOP);
+    put32(&flash[4], CODE_ADDRESS | 1u);
+    if(handler != 0)
+        put32(&flash[4 * THUMB_EMU_USAGE_FAULT], (CODE_ADDRESS + (2u * handler)) | 1u);
+    for(i = 0; i < count; i++)
+    {
+        flash[CODE_ADDRESS + (2u * i)] = (uint8_t)aCode[i];
+        flash[CODE_ADDRESS + (2u * i) + 1u] = (uint8_t)(aCode[i] >> 8);
+    }
+
+    thumbEmuInit(aEmu);
+    thumbEmuMap(aEmu, 0, sizeof(flash), flash, THUMB_EMU_READ | THUMB_EMU_EXEC);
+    thumbEmuMap(aEmu, RAM_BASE, sizeof(ram), ram, THUMB_EMU_READ | THUMB_EMU_WRITE);
+    aEmu->m_Cpacr = CPACR_FPU_ENABLED;
+    CHECK_EQUAL(thumbEmuReset(aEmu), 0);
+}
+
+static void testResults(void)
+{
+    static thumbEmuType emu;
+    uint32_t count = sizeof(expectedResults) / sizeof(expectedResults[0]);
+    uint32_t i;
+
+    loadProgram(&emu, resultsProgram, sizeof(resultsProgram) / sizeof(resultsProgram[0]), 0);
+    CHECK_EQUAL(thumbEmuRun(&emu, 1000), ThumbEmu_Breakpoint);
+    for(i = 0; i < count; i++)
+    {
+        uint32_t value = 0;
+
+        CHECK_EQUAL(thumbEmuRead(&emu, RAM_BASE + (4u * i), 4, &value), 0);
+        if(value != expectedResults[i])
+            printf("result %u: ", i);
+        CHECK_EQUAL(value, expectedResults[i]);
+    }
+    CHECK_EQUAL(emu.m_R[7], RAM_BASE + (4u * count));
+}
+
+static void testDivideByZero(void)
+{
+    static thumbEmuType emu;
+    uint32_t pc = 0;
+    uint32_t xpsr = 0;
+
+    loadProgram(&emu, divideByZeroProgram, sizeof(divideByZeroProgram) / sizeof(divideByZeroProgram[0]), 5);
+    emu.m_Ccr |= CCR_DIV_0_TRP;
+    emu.m_Shcsr |= SHCSR_USGFAULTENA;
+    CHECK_EQUAL(thumbEmuRun(&emu, 100), ThumbEmu_Breakpoint);
+    CHECK_EQUAL(emu.m_R[15], CODE_ADDRESS + 10u);
+    CHECK_EQUAL(emu.m_Ipsr, THUMB_EMU_USAGE_FAULT);
+    CHECK_EQUAL(emu.m_Cfsr, CFSR_DIVBYZERO);
+    CHECK_EQUAL(emu.m_Hfsr, 0);
+
+    // Basic frame: r0-r3, r12, lr, pc, xPSR.
+    CHECK_EQUAL(emu.m_R[13], STACK_TOP - 32u);
+    CHECK_EQUAL(thumbEmuRead(&emu, emu.m_R[13] + 24u, 4, &pc), 0);
+    CHECK_EQUAL(thumbEmuRead(&emu, emu.m_R[13] + 28u, 4, &xpsr), 0);
+    CHECK_EQUAL(pc, CODE_ADDRESS + 4u);
+    CHECK_EQUAL(xpsr & 0x1FFu, 0);
+    CHECK_EQUAL(emu.m_R[14], 0xFFFFFFF9u);
+}
+
+int main(void)
+{
+    testResults();
+    testDivideByZero();
+    return testResult("thumbEmu");
+}
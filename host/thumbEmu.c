@@ -0,0 +1,2494 @@
+/*
+ * thumbEmu.c
+ *
+ *  Created on: 18 Oct 2026
+ *
+ *  Cortex-M4 Thumb-2 instruction emulator
+ *  - Straight interpreter, the speed comes from caching the last code and data region so
+ *    nearly every fetch and access is a bounds check and a memcpy
+ *  - r15 holds the current instruction + 4 while an instruction executes, so PC operands
+ *    need no special casing
+ *  - Faulting instructions commit nothing, loads are done before any register is written
+ *  - Stores that hit a bus error are imprecise, as they are through the M4 write buffer
+ *  - BKPT stops the emulator, as if a debugger were attached
+ */
+#include <math.h>
+#include <string.h>
+
+#include "thumbEmu.h"
+
+#define THUMB_EMU_RUNNING       0xFFFFFFFFu
+
+// SCB bits, same meaning as in exceptions.c.
+#define CFSR_IACCVIOL           (1u<<0)
+#define CFSR_MSTKERR            (1u<<4)
+#define CFSR_MUNSTKERR          (1u<<3)
+#define CFSR_MMARVALID          (1u<<7)
+#define CFSR_IBUSERR            (1u<<8)
+#define CFSR_PRECISERR          (1u<<9)
+#define CFSR_IMPRECISERR        (1u<<10)
+#define CFSR_UNSTKERR           (1u<<11)
+#define CFSR_STKERR             (1u<<12)
+#define CFSR_BFARVALID          (1u<<15)
+#define CFSR_UNDEFINSTR         (1u<<16)
+#define CFSR_INVSTATE           (1u<<17)
+#define CFSR_INVPC              (1u<<18)
+#define CFSR_NOCP               (1u<<19)
+#define CFSR_UNALIGNED          (1u<<24)
+#define CFSR_DIVBYZERO          (1u<<25)
+
+#define HFSR_VECTTBL            (1u<<1)
+#define HFSR_FORCED             (1u<<30)
+
+#define CCR_UNALIGN_TRP         (1u<<3)
+#define CCR_DIV_0_TRP           (1u<<4)
+#define CCR_STKALIGN            (1u<<9)
+
+#define SHCSR_MEMFAULTENA       (1u<<16)
+#define SHCSR_BUSFAULTENA       (1u<<17)
+#define SHCSR_USGFAULTENA       (1u<<18)
+
+#define CONTROL_SPSEL           (1u<<1)
+#define CONTROL_FPCA            (1u<<2)
+
+#define PSR_ALIGNED             (1u<<9)     // Stack was realigned on exception entry.
+#define PSR_THUMB               (1u<<24)
+
+#define EXC_RETURN_THREAD       (1u<<3)
+#define EXC_RETURN_PSP          (1u<<2)
+#define EXC_RETURN_BASIC_FRAME  (1u<<4)
+
+#define LOCKUP_ADDRESS          0xEFFFFFFEu
+#define CPUID_CORTEX_M4         0x410FC241u
+#define PRIORITY_BITS_MASK      0xF0u       // STM32F4 implements 4 priority bits.
+
+#define FPSCR_FLAGS_MASK        0xF0000000u
+
+static const thumbEmuRegionType emptyRegion;
+
+/* Region lookup
+ * - Linear, the list is short and the result is cached by the callers
+*/
+static const thumbEmuRegionType* findRegion(const thumbEmuType* aEmu, uint32_t address, uint32_t size)
+{
+    uint32_t i;
+
+    for(i = 0; i < aEmu->m_RegionCount; i++)
+    {
+        const thumbEmuRegionType* region = &aEmu->m_Regions[i];
+        uint32_t offset = address - region->m_Base;
+
+        if((offset < region->m_Size) && (size <= region->m_Size - offset))
+            return region;
+    }
+    return NULL;
+}
+
+static uint32_t groupedPriority(const thumbEmuType* aEmu, uint32_t exception)
+{
+    switch(exception)
+    {
+        case THUMB_EMU_NMI:         return (uint32_t)-2;
+        case THUMB_EMU_HARD_FAULT:  return (uint32_t)-1;
+        default:                    break;
+    }
+    return aEmu->m_Priority[exception] & (0xFFu << (((aEmu->m_Aircr >> 8) & 7u) + 1u));
+}
+
+int32_t thumbEmuExecutionPriority(const thumbEmuType* aEmu)
+{
+    int32_t priority = 256;
+    uint32_t i;
+
+    for(i = THUMB_EMU_NMI; i < THUMB_EMU_MAX_EXCEPTIONS; i++)
+    {
+        if(aEmu->m_Active[i] && ((int32_t)groupedPriority(aEmu, i) < priority))
+            priority = (int32_t)groupedPriority(aEmu, i);
+    }
+    if(aEmu->m_Basepri != 0)
+    {
+        int32_t basepri = (int32_t)(aEmu->m_Basepri & (0xFFu << (((aEmu->m_Aircr >> 8) & 7u) + 1u)));
+
+        if(basepri < priority)
+            priority = basepri;
+    }
+    if(aEmu->m_Primask && (priority > 0))
+        priority = 0;
+    if(aEmu->m_Faultmask && (priority > -1))
+        priority = -1;
+    return priority;
+}
+
+static void pend(thumbEmuType* aEmu, uint32_t exception)
+{
+    if(exception < THUMB_EMU_MAX_EXCEPTIONS)
+    {
+        aEmu->m_Pended[exception] = 1;
+        aEmu->m_AnyPended = 1;
+    }
+}
+
+/* Imprecise bus error
+ * - Raised after the store completes, escalates if BusFault is disabled
+*/
+static void impreciseBusFault(thumbEmuType* aEmu)
+{
+    aEmu->m_Cfsr |= CFSR_IMPRECISERR;
+    if(aEmu->m_Shcsr & SHCSR_BUSFAULTENA)
+        pend(aEmu, THUMB_EMU_BUS_FAULT);
+    else
+    {
+        aEmu->m_Hfsr |= HFSR_FORCED;
+        pend(aEmu, THUMB_EMU_HARD_FAULT);
+    }
+}
+
+/* Synchronous exception
+ * - Taken once the current instruction has been abandoned, the first one raised wins
+*/
+static void raise(thumbEmuType* aEmu, uint32_t exception, uint32_t returnAddress)
+{
+    if(aEmu->m_Fault == 0)
+    {
+        aEmu->m_Fault = exception;
+        aEmu->m_FaultReturn = returnAddress;
+    }
+}
+
+static void usageFault(thumbEmuType* aEmu, uint32_t cfsrBit)
+{
+    aEmu->m_Cfsr |= cfsrBit;
+    raise(aEmu, THUMB_EMU_USAGE_FAULT, aEmu->m_Current);
+}
+
+static void preciseBusFault(thumbEmuType* aEmu, uint32_t address)
+{
+    aEmu->m_Cfsr |= CFSR_PRECISERR|CFSR_BFARVALID;
+    aEmu->m_Bfar = address;
+    raise(aEmu, THUMB_EMU_BUS_FAULT, aEmu->m_Current);
+}
+
+/* System control space read
+ * - Word aligned, callers pick the bytes they asked for
+*/
+static uint32_t scsRead(const thumbEmuType* aEmu, uint32_t address)
+{
+    uint32_t value = 0;
+    uint32_t i;
+
+    if((address >= 0xE000E100u) && (address < 0xE000E110u))
+        return aEmu->m_NvicEnable[(address - 0xE000E100u) / 4];
+    if((address >= 0xE000E180u) && (address < 0xE000E190u))
+        return aEmu->m_NvicEnable[(address - 0xE000E180u) / 4];
+    if(((address >= 0xE000E200u) && (address < 0xE000E210u)) || ((address >= 0xE000E280u) && (address < 0xE000E290u)))
+    {
+        uint32_t first = 16 + ((address & 0xFu) * 8);
+
+        for(i = 0; (i < 32) && (first + i < THUMB_EMU_MAX_EXCEPTIONS); i++)
+            value |= (uint32_t)aEmu->m_Pended[first + i] << i;
+        return value;
+    }
+    if((address >= 0xE000E300u) && (address < 0xE000E310u))
+    {
+        uint32_t first = 16 + ((address & 0xFu) * 8);
+
+        for(i = 0; (i < 32) && (first + i < THUMB_EMU_MAX_EXCEPTIONS); i++)
+            value |= (uint32_t)aEmu->m_Active[first + i] << i;
+        return value;
+    }
+    if((address >= 0xE000E400u) && (address < 0xE000E400u + THUMB_EMU_MAX_EXCEPTIONS - 16))
+    {
+        memcpy(&value, &aEmu->m_Priority[16 + (address - 0xE000E400u)], 4);
+        return value;
+    }
+    if((address >= 0xE000ED18u) && (address < 0xE000ED24u))
+    {
+        memcpy(&value, &aEmu->m_Priority[4 + (address - 0xE000ED18u)], 4);
+        return value;
+    }
+
+    switch(address)
+    {
+        case 0xE0001000u:   return aEmu->m_DwtCtrl;
+        case 0xE0001004u:   return (uint32_t)(aEmu->m_Instructions - aEmu->m_CycleBase);
+        case 0xE000ED00u:   return CPUID_CORTEX_M4;
+        case 0xE000ED04u:
+            value = aEmu->m_Ipsr;
+            if(aEmu->m_Pended[THUMB_EMU_PENDSV])
+                value |= 1u << 28;
+            if(aEmu->m_Pended[THUMB_EMU_SYSTICK])
+                value |= 1u << 26;
+            return value;
+        case 0xE000ED08u:   return aEmu->m_Vtor;
+        case 0xE000ED0Cu:   return 0xFA050000u | (aEmu->m_Aircr & 0x700u);
+        case 0xE000ED14u:   return aEmu->m_Ccr;
+        case 0xE000ED24u:
+            value = aEmu->m_Shcsr;
+            if(aEmu->m_Active[THUMB_EMU_MEM_MANAGE])       value |= 1u << 0;
+            if(aEmu->m_Active[THUMB_EMU_BUS_FAULT])        value |= 1u << 1;
+            if(aEmu->m_Active[THUMB_EMU_USAGE_FAULT])      value |= 1u << 3;
+            if(aEmu->m_Active[THUMB_EMU_SVCALL])           value |= 1u << 7;
+            if(aEmu->m_Active[THUMB_EMU_DEBUG_MONITOR])    value |= 1u << 8;
+            if(aEmu->m_Active[THUMB_EMU_PENDSV])           value |= 1u << 10;
+            if(aEmu->m_Active[THUMB_EMU_SYSTICK])          value |= 1u << 11;
+            if(aEmu->m_Pended[THUMB_EMU_USAGE_FAULT])      value |= 1u << 12;
+            if(aEmu->m_Pended[THUMB_EMU_MEM_MANAGE])       value |= 1u << 13;
+            if(aEmu->m_Pended[THUMB_EMU_BUS_FAULT])        value |= 1u << 14;
+            if(aEmu->m_Pended[THUMB_EMU_SVCALL])           value |= 1u << 15;
+            return value;
+        case 0xE000ED28u:   return aEmu->m_Cfsr;
+        case 0xE000ED2Cu:   return aEmu->m_Hfsr;
+        case 0xE000ED30u:   return aEmu->m_Dfsr;
+        case 0xE000ED34u:   return aEmu->m_Mmfar;
+        case 0xE000ED38u:   return aEmu->m_Bfar;
+        case 0xE000ED88u:   return aEmu->m_Cpacr;
+        case 0xE000EDFCu:   return aEmu->m_Demcr;
+        default:            return 0;   // DHCSR reads as no debugger attached.
+    }
+}
+
+/* System control space write
+ * - aMask selects the bytes written, write-one-to-clear registers only see those bytes
+*/
+static void scsWrite(thumbEmuType* aEmu, uint32_t address, uint32_t value, uint32_t aMask)
+{
+    uint32_t i;
+
+    value &= aMask;
+    if((address >= 0xE000E100u) && (address < 0xE000E110u))
+    {
+        aEmu->m_NvicEnable[(address - 0xE000E100u) / 4] |= value;
+        return;
+    }
+    if((address >= 0xE000E180u) && (address < 0xE000E190u))
+    {
+        aEmu->m_NvicEnable[(address - 0xE000E180u) / 4] &= ~value;
+        return;
+    }
+    if(((address >= 0xE000E200u) && (address < 0xE000E210u)) || ((address >= 0xE000E280u) && (address < 0xE000E290u)))
+    {
+        uint32_t first = 16 + ((address & 0xFu) * 8);
+
+        for(i = 0; (i < 32) && (first + i < THUMB_EMU_MAX_EXCEPTIONS); i++)
+        {
+            if(value & (1u << i))
+            {
+                if(address < 0xE000E280u)
+                    pend(aEmu, first + i);
+                else
+                    aEmu->m_Pended[first + i] = 0;
+            }
+        }
+        return;
+    }
+    if(((address >= 0xE000E400u) && (address < 0xE000E400u + THUMB_EMU_MAX_EXCEPTIONS - 16)) ||
+       ((address >= 0xE000ED18u) && (address < 0xE000ED24u)))
+    {
+        uint8_t* priority = (address >= 0xE000ED18u) ? &aEmu->m_Priority[4 + (address - 0xE000ED18u)] : &aEmu->m_Priority[16 + (address - 0xE000E400u)];
+
+        for(i = 0; i < 4; i++)
+        {
+            if(aMask & (0xFFu << (i * 8)))
+                priority[i] = (uint8_t)((value >> (i * 8)) & PRIORITY_BITS_MASK);
+        }
+        return;
+    }
+
+    switch(address)
+    {
+        case 0xE0001000u:
+            aEmu->m_DwtCtrl = value;
+            break;
+        case 0xE0001004u:
+            aEmu->m_CycleBase = aEmu->m_Instructions - value;
+            break;
+        case 0xE000ED04u:
+            if(value & (1u << 31))
+                pend(aEmu, THUMB_EMU_NMI);
+            if(value & (1u << 28))
+                pend(aEmu, THUMB_EMU_PENDSV);
+            if(value & (1u << 27))
+                aEmu->m_Pended[THUMB_EMU_PENDSV] = 0;
+            if(value & (1u << 26))
+                pend(aEmu, THUMB_EMU_SYSTICK);
+            if(value & (1u << 25))
+                aEmu->m_Pended[THUMB_EMU_SYSTICK] = 0;
+            break;
+        case 0xE000ED08u:
+            aEmu->m_Vtor = value & 0xFFFFFF80u;
+            break;
+        case 0xE000ED0Cu:
+            if((value >> 16) != 0x05FAu)
+                break;
+            aEmu->m_Aircr = value & 0x700u;
+            if(value & (1u << 2))
+                aEmu->m_Stop = ThumbEmu_Reset;
+            break;
+        case 0xE000ED14u:
+            aEmu->m_Ccr = (value & 0x31Bu) | CCR_STKALIGN;
+            break;
+        case 0xE000ED24u:
+            aEmu->m_Shcsr = (aEmu->m_Shcsr & ~aMask) | (value & 0x70000u);
+            break;
+        case 0xE000ED28u:
+            aEmu->m_Cfsr &= ~value;
+            break;
+        case 0xE000ED2Cu:
+            aEmu->m_Hfsr &= ~value;
+            break;
+        case 0xE000ED30u:
+            aEmu->m_Dfsr &= ~value;
+            break;
+        case 0xE000ED34u:
+            aEmu->m_Mmfar = value;
+            break;
+        case 0xE000ED38u:
+            aEmu->m_Bfar = value;
+            break;
+        case 0xE000ED88u:
+            aEmu->m_Cpacr = value & (0xFu << 20);
+            break;
+        case 0xE000EDFCu:
+            aEmu->m_Demcr = value & 0x010F0000u;
+            break;
+        case 0xE000EF00u:
+            pend(aEmu, 16 + (value & 0x1FFu));
+            break;
+        default:
+            break;
+    }
+}
+
+/* Slow path memory access
+ * - Region misses, the private peripheral bus, bit-band aliases and the m_Io callback
+*/
+static int accessSlow(thumbEmuType* aEmu, uint32_t address, uint32_t size, uint32_t* aValue, int write)
+{
+    const thumbEmuRegionType* region = findRegion(aEmu, address, size);
+
+    if(region != NULL)
+    {
+        if(!(region->m_Flags & (write ? THUMB_EMU_WRITE : THUMB_EMU_READ)))
+            return -1;
+        aEmu->m_DataRegion = region;
+        if(write)
+            memcpy(region->m_Data + (address - region->m_Base), aValue, size);
+        else
+        {
+            *aValue = 0;
+            memcpy(aValue, region->m_Data + (address - region->m_Base), size);
+        }
+        return 0;
+    }
+
+    if((address >= 0xE0000000u) && (address < 0xE0100000u))
+    {
+        uint32_t shift = (address & 3u) * 8;
+        uint32_t mask = (size == 4) ? 0xFFFFFFFFu : (((1u << (size * 8)) - 1u) << shift);
+
+        if(write)
+            scsWrite(aEmu, address & ~3u, *aValue << shift, mask);
+        else
+            *aValue = (scsRead(aEmu, address & ~3u) & mask) >> shift;
+        return 0;
+    }
+
+    if(((address >= 0x22000000u) && (address < 0x24000000u)) || ((address >= 0x42000000u) && (address < 0x44000000u)))
+    {
+        uint32_t target = (address & 0xF0000000u) + ((address & 0x01FFFFFFu) >> 5);
+        uint32_t bit = (address >> 2) & 7u;
+        uint32_t byte;
+
+        if(accessSlow(aEmu, target, 1, &byte, 0) != 0)
+            return -1;
+        if(!write)
+        {
+            *aValue = (byte >> bit) & 1u;
+            return 0;
+        }
+        byte = (*aValue & 1u) ? (byte | (1u << bit)) : (byte & ~(1u << bit));
+        return accessSlow(aEmu, target, 1, &byte, 1);
+    }
+
+    // Straddling two regions, or one region and something else.
+    if((size > 1) && ((region = findRegion(aEmu, address, 1)) != NULL))
+    {
+        uint32_t i;
+        uint32_t value = write ? *aValue : 0;
+
+        for(i = 0; i < size; i++)
+        {
+            uint32_t byte = (value >> (i * 8)) & 0xFFu;
+
+            if(accessSlow(aEmu, address + i, 1, &byte, write) != 0)
+                return -1;
+            value |= write ? 0 : (byte << (i * 8));
+        }
+        if(!write)
+            *aValue = value;
+        return 0;
+    }
+
+    if(aEmu->m_Io == NULL)
+        return -1;
+    if(!write)
+        *aValue = 0;
+    return aEmu->m_Io(aEmu, address, size, aValue, write);
+}
+
+static inline int load(thumbEmuType* aEmu, uint32_t address, uint32_t size, uint32_t* aValue)
+{
+    const thumbEmuRegionType* region = aEmu->m_DataRegion;
+    uint32_t offset = address - region->m_Base;
+
+    if((offset < region->m_Size) && (size <= region->m_Size - offset) && (region->m_Flags & THUMB_EMU_READ))
+    {
+        *aValue = 0;
+        memcpy(aValue, region->m_Data + offset, size);
+        return 0;
+    }
+    if(accessSlow(aEmu, address, size, aValue, 0) == 0)
+        return 0;
+    preciseBusFault(aEmu, address);
+    return -1;
+}
+
+static inline void store(thumbEmuType* aEmu, uint32_t address, uint32_t size, uint32_t value)
+{
+    const thumbEmuRegionType* region = aEmu->m_DataRegion;
+    uint32_t offset = address - region->m_Base;
+
+    if((address - aEmu->m_WatchStart) < (aEmu->m_WatchEnd - aEmu->m_WatchStart))
+        aEmu->m_Stop = ThumbEmu_Watch;
+    if((offset < region->m_Size) && (size <= region->m_Size - offset) && (region->m_Flags & THUMB_EMU_WRITE))
+    {
+        memcpy(region->m_Data + offset, &value, size);
+        return;
+    }
+    if(accessSlow(aEmu, address, size, &value, 1) != 0)
+        impreciseBusFault(aEmu);
+}
+
+/* Single load or store alignment
+ * - Halfword and word accesses may be unaligned unless CCR.UNALIGN_TRP is set
+*/
+static inline int checkAlignment(thumbEmuType* aEmu, uint32_t address, uint32_t size, int trapAlways)
+{
+    if((address & (size - 1u)) == 0)
+        return 0;
+    if(trapAlways || (aEmu->m_Ccr & CCR_UNALIGN_TRP))
+    {
+        usageFault(aEmu, CFSR_UNALIGNED);
+        return -1;
+    }
+    return 0;
+}
+
+int thumbEmuRead(thumbEmuType* aEmu, uint32_t address, uint32_t size, uint32_t* aValue)
+{
+    return accessSlow(aEmu, address, size, aValue, 0);
+}
+
+int thumbEmuWrite(thumbEmuType* aEmu, uint32_t address, uint32_t size, uint32_t value)
+{
+    return accessSlow(aEmu, address, size, &value, 1);
+}
+
+uint32_t thumbEmuGetPsr(const thumbEmuType* aEmu)
+{
+    uint32_t psr = (aEmu->m_N << 31) | (aEmu->m_Z << 30) | (aEmu->m_C << 29) | (aEmu->m_V << 28) | (aEmu->m_Q << 27);
+
+    psr |= aEmu->m_Ge << 16;
+    psr |= (aEmu->m_ItState & 3u) << 25;
+    psr |= (aEmu->m_ItState >> 2) << 10;
+    psr |= aEmu->m_Thumb ? PSR_THUMB : 0;
+    psr |= aEmu->m_Ipsr;
+    return psr;
+}
+
+void thumbEmuSetPsr(thumbEmuType* aEmu, uint32_t psr)
+{
+    aEmu->m_N = (psr >> 31) & 1u;
+    aEmu->m_Z = (psr >> 30) & 1u;
+    aEmu->m_C = (psr >> 29) & 1u;
+    aEmu->m_V = (psr >> 28) & 1u;
+    aEmu->m_Q = (psr >> 27) & 1u;
+    aEmu->m_Ge = (psr >> 16) & 15u;
+    aEmu->m_ItState = ((psr >> 25) & 3u) | (((psr >> 10) & 0x3Fu) << 2);
+    aEmu->m_Thumb = (psr & PSR_THUMB) ? 1 : 0;
+    aEmu->m_Ipsr = psr & 0x1FFu;
+}
+
+static inline int usingPsp(const thumbEmuType* aEmu)
+{
+    return (aEmu->m_Ipsr == 0) && (aEmu->m_Control & CONTROL_SPSEL);
+}
+
+static void saveSp(thumbEmuType* aEmu)
+{
+    if(usingPsp(aEmu))
+        aEmu->m_Psp = aEmu->m_R[13];
+    else
+        aEmu->m_Msp = aEmu->m_R[13];
+}
+
+static void loadSp(thumbEmuType* aEmu)
+{
+    aEmu->m_R[13] = usingPsp(aEmu) ? aEmu->m_Psp : aEmu->m_Msp;
+}
+
+static void lockup(thumbEmuType* aEmu)
+{
+    aEmu->m_R[15] = LOCKUP_ADDRESS;
+    aEmu->m_Stop = ThumbEmu_Lockup;
+}
+
+/* Escalation
+ * - A configurable fault that is disabled, or not above the current priority, becomes a
+ *   forced HardFault, and a HardFault that cannot preempt is a lockup (returns 0)
+*/
+static uint32_t escalate(thumbEmuType* aEmu, uint32_t exception, int32_t current)
+{
+    uint32_t enabled = 1;
+
+    if((exception >= THUMB_EMU_MEM_MANAGE) && (exception <= THUMB_EMU_USAGE_FAULT))
+        enabled = aEmu->m_Shcsr & (SHCSR_MEMFAULTENA << (exception - THUMB_EMU_MEM_MANAGE));
+    if((exception >= THUMB_EMU_MEM_MANAGE) && (exception <= THUMB_EMU_DEBUG_MONITOR) &&
+       (!enabled || ((int32_t)groupedPriority(aEmu, exception) >= current)))
+    {
+        aEmu->m_Hfsr |= HFSR_FORCED;
+        exception = THUMB_EMU_HARD_FAULT;
+    }
+    if((exception == THUMB_EMU_HARD_FAULT) && (current <= -1))
+        return 0;
+    return exception;
+}
+
+/* Exception entry
+ * - Pushes a basic frame, or an extended one when CONTROL.FPCA says FP state is live
+ * - A bus error while stacking turns into a BusFault (or HardFault) entered instead, with
+ *   the frame contents lost, as on the real core
+*/
+static void enterException(thumbEmuType* aEmu, uint32_t exception, uint32_t returnAddress)
+{
+    uint32_t extended = aEmu->m_Control & CONTROL_FPCA;
+    uint32_t frameSize = extended ? 0x68u : 0x20u;
+    uint32_t psr = thumbEmuGetPsr(aEmu);
+    uint32_t excReturn = 0xFFFFFFE1u;
+    uint32_t sp = aEmu->m_R[13];
+    uint32_t frame[26];
+    uint32_t vector;
+    uint32_t i;
+    int failed = 0;
+
+    if(((sp - frameSize) & 4u) && (aEmu->m_Ccr & CCR_STKALIGN))
+    {
+        sp -= 4;
+        psr |= PSR_ALIGNED;
+    }
+    sp -= frameSize;
+
+    frame[0] = aEmu->m_R[0];
+    frame[1] = aEmu->m_R[1];
+    frame[2] = aEmu->m_R[2];
+    frame[3] = aEmu->m_R[3];
+    frame[4] = aEmu->m_R[12];
+    frame[5] = aEmu->m_R[14];
+    frame[6] = returnAddress & ~1u;
+    frame[7] = psr;
+    if(extended)
+    {
+        memcpy(&frame[8], aEmu->m_S, 16 * sizeof(uint32_t));
+        frame[24] = aEmu->m_Fpscr;
+        frame[25] = 0;
+    }
+    for(i = 0; i < frameSize / 4; i++)
+    {
+        if(accessSlow(aEmu, sp + (i * 4), 4, &frame[i], 1) != 0)
+            failed = 1;
+    }
+    if(failed)
+    {
+        uint32_t derived;
+
+        aEmu->m_Cfsr |= CFSR_STKERR;
+        derived = escalate(aEmu, THUMB_EMU_BUS_FAULT, (exception == THUMB_EMU_HARD_FAULT) ? -1 : (int32_t)groupedPriority(aEmu, exception));
+        if(derived == 0)
+        {
+            lockup(aEmu);
+            return;
+        }
+        exception = derived;
+    }
+
+    if(aEmu->m_Ipsr == 0)
+        excReturn |= EXC_RETURN_THREAD | ((aEmu->m_Control & CONTROL_SPSEL) ? EXC_RETURN_PSP : 0);
+    if(!extended)
+        excReturn |= EXC_RETURN_BASIC_FRAME;
+
+    aEmu->m_R[13] = sp;
+    saveSp(aEmu);
+    aEmu->m_Ipsr = exception;
+    aEmu->m_R[13] = aEmu->m_Msp;
+    aEmu->m_R[14] = excReturn;
+    aEmu->m_ItState = 0;
+    aEmu->m_Control &= ~CONTROL_FPCA;
+    aEmu->m_Active[exception] = 1;
+    aEmu->m_Pended[exception] = 0;
+    aEmu->m_ExclusiveValid = 0;
+
+    if(accessSlow(aEmu, aEmu->m_Vtor + (exception * 4), 4, &vector, 0) != 0)
+    {
+        aEmu->m_Hfsr |= HFSR_VECTTBL;
+        if(exception == THUMB_EMU_HARD_FAULT)
+        {
+            lockup(aEmu);
+            return;
+        }
+        aEmu->m_Active[exception] = 0;
+        aEmu->m_Active[THUMB_EMU_HARD_FAULT] = 1;
+        aEmu->m_Ipsr = THUMB_EMU_HARD_FAULT;
+        if(accessSlow(aEmu, aEmu->m_Vtor + (THUMB_EMU_HARD_FAULT * 4), 4, &vector, 0) != 0)
+        {
+            lockup(aEmu);
+            return;
+        }
+    }
+    aEmu->m_R[15] = vector & ~1u;
+    aEmu->m_Thumb = vector & 1u;
+}
+
+static void takeSynchronous(thumbEmuType* aEmu)
+{
+    uint32_t exception = escalate(aEmu, aEmu->m_Fault, thumbEmuExecutionPriority(aEmu));
+    uint32_t returnAddress = aEmu->m_FaultReturn;
+
+    aEmu->m_Fault = 0;
+    if(exception == 0)
+        lockup(aEmu);
+    else
+        enterException(aEmu, exception, returnAddress);
+}
+
+/* Pending asynchronous exceptions
+ * - The highest priority one that can preempt is taken, lowest number first on a tie
+*/
+static void takePending(thumbEmuType* aEmu)
+{
+    int32_t current = thumbEmuExecutionPriority(aEmu);
+    int32_t best = current;
+    uint32_t chosen = 0;
+    uint32_t any = 0;
+    uint32_t i;
+
+    for(i = THUMB_EMU_NMI; i < THUMB_EMU_MAX_EXCEPTIONS; i++)
+    {
+        if(!aEmu->m_Pended[i])
+            continue;
+        if((i >= 16) && !(aEmu->m_NvicEnable[(i - 16) / 32] & (1u << ((i - 16) % 32))))
+            continue;
+        any = 1;
+        if((int32_t)groupedPriority(aEmu, i) < best)
+        {
+            best = (int32_t)groupedPriority(aEmu, i);
+            chosen = i;
+        }
+    }
+    aEmu->m_AnyPended = any;
+    if(chosen != 0)
+        enterException(aEmu, chosen, aEmu->m_R[15]);
+}
+
+/* Exception return
+ * - Called after the instruction that loaded EXC_RETURN into the PC has completed
+*/
+static void exceptionReturn(thumbEmuType* aEmu, uint32_t excReturn)
+{
+    uint32_t exception = aEmu->m_Ipsr;
+    uint32_t mode = excReturn & 0xFu;
+    uint32_t frameSize = (excReturn & EXC_RETURN_BASIC_FRAME) ? 0x20u : 0x68u;
+    uint32_t frame[26];
+    uint32_t i;
+
+    if(((excReturn & 0xFFFFFFE0u) != 0xFFFFFFE0u) || ((mode != 1) && (mode != 9) && (mode != 0xD)) || !aEmu->m_Active[exception])
+    {
+        aEmu->m_Cfsr |= CFSR_INVPC;
+        raise(aEmu, THUMB_EMU_USAGE_FAULT, excReturn);
+        takeSynchronous(aEmu);
+        return;
+    }
+
+    aEmu->m_Active[exception] = 0;
+    aEmu->m_Msp = aEmu->m_R[13];
+    if(aEmu->m_Faultmask && (exception != THUMB_EMU_NMI))
+        aEmu->m_Faultmask = 0;
+    aEmu->m_Ipsr = (mode == 1) ? 1 : 0;     // Any handler mode value until the frame is read.
+    if(mode == 0xD)
+        aEmu->m_Control |= CONTROL_SPSEL;
+    else if(mode == 9)
+        aEmu->m_Control &= ~CONTROL_SPSEL;
+    loadSp(aEmu);
+
+    for(i = 0; i < frameSize / 4; i++)
+    {
+        if(accessSlow(aEmu, aEmu->m_R[13] + (i * 4), 4, &frame[i], 0) != 0)
+        {
+            aEmu->m_Cfsr |= CFSR_UNSTKERR;
+            raise(aEmu, THUMB_EMU_BUS_FAULT, aEmu->m_R[15]);
+            takeSynchronous(aEmu);
+            return;
+        }
+    }
+
+    aEmu->m_R[0] = frame[0];
+    aEmu->m_R[1] = frame[1];
+    aEmu->m_R[2] = frame[2];
+    aEmu->m_R[3] = frame[3];
+    aEmu->m_R[12] = frame[4];
+    aEmu->m_R[14] = frame[5];
+    aEmu->m_R[15] = frame[6] & ~1u;
+    if(frameSize != 0x20u)
+    {
+        memcpy(aEmu->m_S, &frame[8], 16 * sizeof(uint32_t));
+        aEmu->m_Fpscr = frame[24];
+        aEmu->m_Control |= CONTROL_FPCA;
+    }
+    else
+        aEmu->m_Control &= ~CONTROL_FPCA;
+    aEmu->m_R[13] += frameSize + ((frame[7] & PSR_ALIGNED) ? 4u : 0u);
+    thumbEmuSetPsr(aEmu, frame[7]);
+    if(mode == 1)
+    {
+        if(aEmu->m_Ipsr == 0)
+            aEmu->m_Ipsr = 1;
+    }
+    else
+        aEmu->m_Ipsr = 0;
+    saveSp(aEmu);
+    aEmu->m_ExclusiveValid = 0;
+    aEmu->m_AnyPended = 1;  // Something masked by the handler may be takeable now.
+}
+
+void thumbEmuRaise(thumbEmuType* aEmu, uint32_t exception)
+{
+    pend(aEmu, exception);
+}
+
+/* Synthetic fault
+ * - Sets the fault status the way the core would and enters the handler right away, for
+ *   running fault handlers against faults that never happened
+*/
+void thumbEmuFault(thumbEmuType* aEmu, uint32_t exception, uint32_t cfsrBits, uint32_t address)
+{
+    aEmu->m_Cfsr |= cfsrBits;
+    if(cfsrBits & CFSR_MMARVALID)
+        aEmu->m_Mmfar = address;
+    if(cfsrBits & CFSR_BFARVALID)
+        aEmu->m_Bfar = address;
+    aEmu->m_Stop = THUMB_EMU_RUNNING;
+    raise(aEmu, exception, aEmu->m_R[15]);
+    takeSynchronous(aEmu);
+}
+
+static inline uint32_t conditionPassed(const thumbEmuType* aEmu, uint32_t cond)
+{
+    uint32_t result;
+
+    switch(cond >> 1)
+    {
+        case 0:     result = aEmu->m_Z; break;
+        case 1:     result = aEmu->m_C; break;
+        case 2:     result = aEmu->m_N; break;
+        case 3:     result = aEmu->m_V; break;
+        case 4:     result = aEmu->m_C && !aEmu->m_Z; break;
+        case 5:     result = (aEmu->m_N == aEmu->m_V); break;
+        case 6:     result = !aEmu->m_Z && (aEmu->m_N == aEmu->m_V); break;
+        default:    return 1;
+    }
+    return (cond & 1u) ? !result : result;
+}
+
+static inline void setNZ(thumbEmuType* aEmu, uint32_t result)
+{
+    aEmu->m_N = result >> 31;
+    aEmu->m_Z = (result == 0);
+}
+
+static inline uint32_t addWithCarry(thumbEmuType* aEmu, uint32_t a, uint32_t b, uint32_t carry, uint32_t setFlags)
+{
+    uint64_t sum = (uint64_t)a + b + carry;
+    uint32_t result = (uint32_t)sum;
+
+    if(setFlags)
+    {
+        setNZ(aEmu, result);
+        aEmu->m_C = (uint32_t)(sum >> 32);
+        aEmu->m_V = ((a ^ result) & (b ^ result)) >> 31;
+    }
+    return result;
+}
+
+/* Shift with carry out
+ * - Types 0-3 are LSL, LSR, ASR and ROR by any amount, type 4 is RRX
+*/
+static uint32_t shiftC(uint32_t value, uint32_t type, uint32_t amount, uint32_t* aCarry)
+{
+    if(type == 4)
+    {
+        uint32_t result = (*aCarry << 31) | (value >> 1);
+
+        *aCarry = value & 1u;
+        return result;
+    }
+    if(amount == 0)
+        return value;
+
+    switch(type)
+    {
+        case 0:
+            if(amount > 32)
+            {
+                *aCarry = 0;
+                return 0;
+            }
+            *aCarry = (amount == 32) ? (value & 1u) : ((value >> (32 - amount)) & 1u);
+            return (amount == 32) ? 0 : (value << amount);
+        case 1:
+            if(amount > 32)
+            {
+                *aCarry = 0;
+                return 0;
+            }
+            *aCarry = (value >> (amount - 1)) & 1u;
+            return (amount == 32) ? 0 : (value >> amount);
+        case 2:
+            if(amount >= 32)
+            {
+                *aCarry = value >> 31;
+                return (value & 0x80000000u) ? 0xFFFFFFFFu : 0;
+            }
+            *aCarry = (value >> (amount - 1)) & 1u;
+            return (uint32_t)((int32_t)value >> amount);
+        default:
+            amount &= 31u;
+            if(amount != 0)
+                value = (value >> amount) | (value << (32 - amount));
+            *aCarry = value >> 31;
+            return value;
+    }
+}
+
+static inline uint32_t ror(uint32_t value, uint32_t amount)
+{
+    amount &= 31u;
+    return (amount == 0) ? value : ((value >> amount) | (value << (32 - amount)));
+}
+
+static inline void branchTo(thumbEmuType* aEmu, uint32_t address)
+{
+    aEmu->m_Next = address & ~1u;
+}
+
+/* Interworking branch
+ * - EXC_RETURN values in handler mode return from the exception once the instruction ends
+*/
+static inline void branchExchange(thumbEmuType* aEmu, uint32_t address)
+{
+    if((aEmu->m_Ipsr != 0) && (address >= 0xF0000000u))
+    {
+        aEmu->m_ExcReturn = address;
+        aEmu->m_Next = address;
+        return;
+    }
+    aEmu->m_Next = address & ~1u;
+    if(!(address & 1u))
+        aEmu->m_Thumb = 0;
+}
+
+static inline void writeRegister(thumbEmuType* aEmu, uint32_t rd, uint32_t value)
+{
+    if(rd == 15)
+        branchTo(aEmu, value);
+    else
+        aEmu->m_R[rd] = value;
+}
+
+static inline void undefined(thumbEmuType* aEmu)
+{
+    usageFault(aEmu, CFSR_UNDEFINSTR);
+}
+
+static int loadRegister(thumbEmuType* aEmu, uint32_t rt, uint32_t address, uint32_t size, uint32_t sign)
+{
+    uint32_t value;
+
+    if((checkAlignment(aEmu, address, size, 0) != 0) || (load(aEmu, address, size, &value) != 0))
+        return -1;
+    if(sign)
+        value = (size == 1) ? (uint32_t)(int32_t)(int8_t)value : (uint32_t)(int32_t)(int16_t)value;
+    if(rt == 15)
+        branchExchange(aEmu, value);
+    else
+        aEmu->m_R[rt] = value;
+    return 0;
+}
+
+static int storeRegister(thumbEmuType* aEmu, uint32_t value, uint32_t address, uint32_t size)
+{
+    if(checkAlignment(aEmu, address, size, 0) != 0)
+        return -1;
+    store(aEmu, address, size, value);
+    return 0;
+}
+
+/* LDM and POP
+ * - Every word is loaded before any register changes, so a bus error leaves nothing behind
+*/
+static inline uint32_t countBits(uint32_t value)
+{
+    value = value - ((value >> 1) & 0x55555555u);
+    value = (value & 0x33333333u) + ((value >> 2) & 0x33333333u);
+    return (((value + (value >> 4)) & 0x0F0F0F0Fu) * 0x01010101u) >> 24;
+}
+
+static void loadMultiple(thumbEmuType* aEmu, uint32_t rn, uint32_t list, uint32_t address, uint32_t writeback)
+{
+    uint32_t values[16];
+    uint32_t end = address;
+    uint32_t remaining;
+
+    if(checkAlignment(aEmu, address, 4, 1) != 0)
+        return;
+    for(remaining = list; remaining != 0; remaining &= remaining - 1u)
+    {
+        if(load(aEmu, end, 4, &values[__builtin_ctz(remaining)]) != 0)
+            return;
+        end += 4;
+    }
+    if(writeback && !(list & (1u << rn)))
+        aEmu->m_R[rn] = (aEmu->m_R[rn] == address) ? end : address;
+    for(remaining = list & 0x7FFFu; remaining != 0; remaining &= remaining - 1u)
+        aEmu->m_R[__builtin_ctz(remaining)] = values[__builtin_ctz(remaining)];
+    if(list & (1u << 15))
+        branchExchange(aEmu, values[15]);
+}
+
+static void storeMultiple(thumbEmuType* aEmu, uint32_t rn, uint32_t list, uint32_t address, uint32_t writeback)
+{
+    uint32_t end = address;
+    uint32_t remaining;
+
+    if(checkAlignment(aEmu, address, 4, 1) != 0)
+        return;
+    for(remaining = list; remaining != 0; remaining &= remaining - 1u)
+    {
+        store(aEmu, end, 4, aEmu->m_R[__builtin_ctz(remaining)]);
+        end += 4;
+    }
+    if(writeback)
+        aEmu->m_R[rn] = (aEmu->m_R[rn] == address) ? end : address;
+}
+
+static void hint(thumbEmuType* aEmu, uint32_t op)
+{
+    // NOP, YIELD, WFE and SEV do nothing here, WFI has nothing to wait for.
+    if(op == 3)
+        aEmu->m_Stop = ThumbEmu_Sleep;
+}
+
+static void changeProcessorState(thumbEmuType* aEmu, uint32_t disable, uint32_t affectI, uint32_t affectF)
+{
+    if(affectI)
+        aEmu->m_Primask = disable;
+    if(affectF && (!disable || (thumbEmuExecutionPriority(aEmu) > -1)))
+        aEmu->m_Faultmask = disable;
+    if(!disable)
+        aEmu->m_AnyPended = 1;
+}
+
+static void dataProcessing16(thumbEmuType* aEmu, uint32_t op)
+{
+    uint32_t* r = aEmu->m_R;
+    uint32_t setFlags = (aEmu->m_ItState == 0);
+    uint32_t rd = op & 7u;
+    uint32_t rm = (op >> 3) & 7u;
+    uint32_t carry = aEmu->m_C;
+    uint32_t result;
+
+    switch((op >> 6) & 15u)
+    {
+        case 0:     result = r[rd] & r[rm]; break;
+        case 1:     result = r[rd] ^ r[rm]; break;
+        case 2:     result = shiftC(r[rd], 0, r[rm] & 0xFFu, &carry); break;
+        case 3:     result = shiftC(r[rd], 1, r[rm] & 0xFFu, &carry); break;
+        case 4:     result = shiftC(r[rd], 2, r[rm] & 0xFFu, &carry); break;
+        case 5:     r[rd] = addWithCarry(aEmu, r[rd], r[rm], aEmu->m_C, setFlags); return;
+        case 6:     r[rd] = addWithCarry(aEmu, r[rd], ~r[rm], aEmu->m_C, setFlags); return;
+        case 7:     result = shiftC(r[rd], 3, r[rm] & 0xFFu, &carry); break;
+        case 8:
+            setNZ(aEmu, r[rd] & r[rm]);
+            return;
+        case 9:     r[rd] = addWithCarry(aEmu, ~r[rm], 0, 1, setFlags); return;
+        case 10:    addWithCarry(aEmu, r[rd], ~r[rm], 1, 1); return;
+        case 11:    addWithCarry(aEmu, r[rd], r[rm], 0, 1); return;
+        case 12:    result = r[rd] | r[rm]; break;
+        case 13:
+            r[rd] *= r[rm];
+            if(setFlags)
+                setNZ(aEmu, r[rd]);
+            return;
+        case 14:    result = r[rd] & ~r[rm]; break;
+        default:    result = ~r[rm]; break;
+    }
+    r[rd] = result;
+    if(setFlags)
+    {
+        setNZ(aEmu, result);
+        aEmu->m_C = carry;
+    }
+}
+
+static void miscellaneous16(thumbEmuType* aEmu, uint32_t op)
+{
+    uint32_t* r = aEmu->m_R;
+    uint32_t rd = op & 7u;
+    uint32_t rm = (op >> 3) & 7u;
+    uint32_t list;
+
+    switch((op >> 8) & 15u)
+    {
+        case 0x0:
+            r[13] = (op & 0x80u) ? (r[13] - ((op & 0x7Fu) << 2)) : (r[13] + ((op & 0x7Fu) << 2));
+            return;
+        case 0x1: case 0x3: case 0x9: case 0xB:
+            if((r[rd] == 0) != ((op & 0x800u) != 0))
+                branchTo(aEmu, r[15] + (((op >> 3) & 0x1Fu) << 1) + ((op & 0x200u) >> 3));
+            return;
+        case 0x2:
+            switch((op >> 6) & 3u)
+            {
+                case 0:     r[rd] = (uint32_t)(int32_t)(int16_t)r[rm]; break;
+                case 1:     r[rd] = (uint32_t)(int32_t)(int8_t)r[rm]; break;
+                case 2:     r[rd] = r[rm] & 0xFFFFu; break;
+                default:    r[rd] = r[rm] & 0xFFu; break;
+            }
+            return;
+        case 0x4: case 0x5:
+            list = (op & 0xFFu) | ((op & 0x100u) << 6);
+            storeMultiple(aEmu, 13, list, r[13] - (4 * countBits(list)), 1);
+            return;
+        case 0x6:
+            if((op & 0xFFE8u) == 0xB660u)
+            {
+                changeProcessorState(aEmu, (op >> 4) & 1u, op & 2u, op & 1u);
+                return;
+            }
+            break;
+        case 0xA:
+            switch((op >> 6) & 3u)
+            {
+                case 0:     r[rd] = __builtin_bswap32(r[rm]); return;
+                case 1:     r[rd] = ((r[rm] & 0x00FF00FFu) << 8) | ((r[rm] >> 8) & 0x00FF00FFu); return;
+                case 3:     r[rd] = (uint32_t)(int32_t)(int16_t)__builtin_bswap16((uint16_t)r[rm]); return;
+                default:    break;
+            }
+            break;
+        case 0xC: case 0xD:
+            list = (op & 0xFFu) | ((op & 0x100u) << 7);
+            loadMultiple(aEmu, 13, list, r[13], 1);
+            return;
+        case 0xE:
+            aEmu->m_Next = aEmu->m_Current;
+            aEmu->m_Stop = ThumbEmu_Breakpoint;
+            return;
+        case 0xF:
+            if(op & 0xFu)
+                aEmu->m_ItState = op & 0xFFu;
+            else
+                hint(aEmu, (op >> 4) & 15u);
+            return;
+        default:
+            break;
+    }
+    undefined(aEmu);
+}
+
+static void execute16(thumbEmuType* aEmu, uint32_t op)
+{
+    uint32_t* r = aEmu->m_R;
+    uint32_t setFlags = (aEmu->m_ItState == 0);
+    uint32_t rd = op & 7u;
+    uint32_t rn = (op >> 3) & 7u;
+    uint32_t rm = (op >> 6) & 7u;
+    uint32_t imm5 = (op >> 6) & 0x1Fu;
+    uint32_t imm8 = op & 0xFFu;
+    uint32_t rdHigh = (op >> 8) & 7u;
+    uint32_t carry = aEmu->m_C;
+    uint32_t result;
+
+    switch(op >> 11)
+    {
+        case 0x00:
+        case 0x01:
+        case 0x02:
+            if(imm5 == 0)
+                imm5 = (op >> 11) ? 32 : 0;
+            result = shiftC(r[rn], op >> 11, imm5, &carry);
+            r[rd] = result;
+            if(setFlags)
+            {
+                setNZ(aEmu, result);
+                aEmu->m_C = carry;
+            }
+            return;
+        case 0x03:
+            result = (op & 0x400u) ? rm : r[rm];
+            if(op & 0x200u)
+                r[rd] = addWithCarry(aEmu, r[rn], ~result, 1, setFlags);
+            else
+                r[rd] = addWithCarry(aEmu, r[rn], result, 0, setFlags);
+            return;
+        case 0x04:
+            r[rdHigh] = imm8;
+            if(setFlags)
+                setNZ(aEmu, imm8);
+            return;
+        case 0x05:
+            addWithCarry(aEmu, r[rdHigh], ~imm8, 1, 1);
+            return;
+        case 0x06:
+            r[rdHigh] = addWithCarry(aEmu, r[rdHigh], imm8, 0, setFlags);
+            return;
+        case 0x07:
+            r[rdHigh] = addWithCarry(aEmu, r[rdHigh], ~imm8, 1, setFlags);
+            return;
+        case 0x08:
+            if(!(op & 0x400u))
+            {
+                dataProcessing16(aEmu, op);
+                return;
+            }
+            rd = ((op >> 4) & 8u) | (op & 7u);
+            rm = (op >> 3) & 15u;
+            switch((op >> 8) & 3u)
+            {
+                case 0:
+                    writeRegister(aEmu, rd, r[rd] + r[rm]);
+                    return;
+                case 1:
+                    addWithCarry(aEmu, r[rd], ~r[rm], 1, 1);
+                    return;
+                case 2:
+                    writeRegister(aEmu, rd, r[rm]);
+                    return;
+                default:
+                    result = r[rm];
+                    if(op & 0x80u)
+                        r[14] = aEmu->m_Next | 1u;
+                    branchExchange(aEmu, result);
+                    return;
+            }
+        case 0x09:
+            loadRegister(aEmu, rdHigh, (r[15] & ~3u) + (imm8 << 2), 4, 0);
+            return;
+        case 0x0A:
+        case 0x0B:
+            result = r[rn] + r[rm];
+            switch((op >> 9) & 7u)
+            {
+                case 0:     storeRegister(aEmu, r[rd], result, 4); return;
+                case 1:     storeRegister(aEmu, r[rd], result, 2); return;
+                case 2:     storeRegister(aEmu, r[rd], result, 1); return;
+                case 3:     loadRegister(aEmu, rd, result, 1, 1); return;
+                case 4:     loadRegister(aEmu, rd, result, 4, 0); return;
+                case 5:     loadRegister(aEmu, rd, result, 2, 0); return;
+                case 6:     loadRegister(aEmu, rd, result, 1, 0); return;
+                default:    loadRegister(aEmu, rd, result, 2, 1); return;
+            }
+        case 0x0C:  storeRegister(aEmu, r[rd], r[rn] + (imm5 << 2), 4); return;
+        case 0x0D:  loadRegister(aEmu, rd, r[rn] + (imm5 << 2), 4, 0); return;
+        case 0x0E:  storeRegister(aEmu, r[rd], r[rn] + imm5, 1); return;
+        case 0x0F:  loadRegister(aEmu, rd, r[rn] + imm5, 1, 0); return;
+        case 0x10:  storeRegister(aEmu, r[rd], r[rn] + (imm5 << 1), 2); return;
+        case 0x11:  loadRegister(aEmu, rd, r[rn] + (imm5 << 1), 2, 0); return;
+        case 0x12:  storeRegister(aEmu, r[rdHigh], r[13] + (imm8 << 2), 4); return;
+        case 0x13:  loadRegister(aEmu, rdHigh, r[13] + (imm8 << 2), 4, 0); return;
+        case 0x14:  r[rdHigh] = (r[15] & ~3u) + (imm8 << 2); return;
+        case 0x15:  r[rdHigh] = r[13] + (imm8 << 2); return;
+        case 0x16:
+        case 0x17:
+            miscellaneous16(aEmu, op);
+            return;
+        case 0x18:
+            storeMultiple(aEmu, rdHigh, imm8, r[rdHigh], 1);
+            return;
+        case 0x19:
+            loadMultiple(aEmu, rdHigh, imm8, r[rdHigh], 1);
+            return;
+        case 0x1A:
+        case 0x1B:
+            switch((op >> 8) & 15u)
+            {
+                case 14:
+                    undefined(aEmu);
+                    return;
+                case 15:
+                    raise(aEmu, THUMB_EMU_SVCALL, aEmu->m_Next);
+                    return;
+                default:
+                    if(conditionPassed(aEmu, (op >> 8) & 15u))
+                        branchTo(aEmu, r[15] + (uint32_t)((int32_t)(int8_t)imm8 << 1));
+                    return;
+            }
+        default:
+            branchTo(aEmu, r[15] + (uint32_t)(((int32_t)(op << 21)) >> 20));
+            return;
+    }
+}
+
+static uint32_t expandImmediate(uint32_t imm12, uint32_t* aCarry)
+{
+    uint32_t imm8 = imm12 & 0xFFu;
+    uint32_t value;
+
+    if((imm12 & 0xC00u) == 0)
+    {
+        switch((imm12 >> 8) & 3u)
+        {
+            case 0:     return imm8;
+            case 1:     return imm8 * 0x00010001u;
+            case 2:     return imm8 * 0x01000100u;
+            default:    return imm8 * 0x01010101u;
+        }
+    }
+    value = ror(0x80u | (imm12 & 0x7Fu), imm12 >> 7);
+    *aCarry = value >> 31;
+    return value;
+}
+
+/* Shared data processing for the immediate and shifted register forms
+ * - TST, TEQ, CMN and CMP are the flag setting encodings with Rd = PC
+*/
+static void dataProcessing32(thumbEmuType* aEmu, uint32_t op, uint32_t setFlags, uint32_t rn, uint32_t rd, uint32_t operand, uint32_t carry)
+{
+    uint32_t a = aEmu->m_R[rn];
+    uint32_t compare = (rd == 15) && setFlags;
+    uint32_t result;
+
+    switch(op)
+    {
+        case 0:     result = a & operand; break;
+        case 1:     result = a & ~operand; compare = 0; break;
+        case 2:     result = (rn == 15) ? operand : (a | operand); compare = 0; break;
+        case 3:     result = (rn == 15) ? ~operand : (a | ~operand); compare = 0; break;
+        case 4:     result = a ^ operand; break;
+        case 8:
+            result = addWithCarry(aEmu, a, operand, 0, setFlags);
+            if(!compare)
+                writeRegister(aEmu, rd, result);
+            return;
+        case 10:
+            writeRegister(aEmu, rd, addWithCarry(aEmu, a, operand, aEmu->m_C, setFlags));
+            return;
+        case 11:
+            writeRegister(aEmu, rd, addWithCarry(aEmu, a, ~operand, aEmu->m_C, setFlags));
+            return;
+        case 13:
+            result = addWithCarry(aEmu, a, ~operand, 1, setFlags);
+            if(!compare)
+                writeRegister(aEmu, rd, result);
+            return;
+        case 14:
+            writeRegister(aEmu, rd, addWithCarry(aEmu, ~a, operand, 1, setFlags));
+            return;
+        default:
+            undefined(aEmu);
+            return;
+    }
+    if(setFlags)
+    {
+        setNZ(aEmu, result);
+        aEmu->m_C = carry;
+    }
+    if(!compare)
+        writeRegister(aEmu, rd, result);
+}
+
+static void modifiedImmediate(thumbEmuType* aEmu, uint32_t hw1, uint32_t hw2)
+{
+    uint32_t imm12 = ((hw1 & 0x400u) << 1) | ((hw2 >> 4) & 0x700u) | (hw2 & 0xFFu);
+    uint32_t carry = aEmu->m_C;
+    uint32_t operand = expandImmediate(imm12, &carry);
+
+    dataProcessing32(aEmu, (hw1 >> 5) & 15u, hw1 & 0x10u, hw1 & 15u, (hw2 >> 8) & 15u, operand, carry);
+}
+
+static uint32_t signedSaturate(thumbEmuType* aEmu, int64_t value, uint32_t bits)
+{
+    int64_t high = ((int64_t)1 << (bits - 1)) - 1;
+    int64_t low = -((int64_t)1 << (bits - 1));
+
+    if(value > high)
+    {
+        aEmu->m_Q = 1;
+        return (uint32_t)high;
+    }
+    if(value < low)
+    {
+        aEmu->m_Q = 1;
+        return (uint32_t)low;
+    }
+    return (uint32_t)value;
+}
+
+static uint32_t unsignedSaturate(thumbEmuType* aEmu, int64_t value, uint32_t bits)
+{
+    int64_t high = ((int64_t)1 << bits) - 1;
+
+    if(value > high)
+    {
+        aEmu->m_Q = 1;
+        return (uint32_t)high;
+    }
+    if(value < 0)
+    {
+        aEmu->m_Q = 1;
+        return 0;
+    }
+    return (uint32_t)value;
+}
+
+static void plainImmediate(thumbEmuType* aEmu, uint32_t hw1, uint32_t hw2)
+{
+    uint32_t* r = aEmu->m_R;
+    uint32_t rn = hw1 & 15u;
+    uint32_t rd = (hw2 >> 8) & 15u;
+    uint32_t imm12 = ((hw1 & 0x400u) << 1) | ((hw2 >> 4) & 0x700u) | (hw2 & 0xFFu);
+    uint32_t imm16 = (rn << 12) | imm12;
+    uint32_t lsb = ((hw2 >> 10) & 0x1Cu) | ((hw2 >> 6) & 3u);
+    uint32_t field = hw2 & 0x1Fu;
+    uint32_t value;
+    uint32_t carry;
+
+    switch((hw1 >> 4) & 0x1Fu)
+    {
+        case 0x00:
+            r[rd] = ((rn == 15) ? (r[15] & ~3u) : r[rn]) + imm12;
+            return;
+        case 0x04:
+            r[rd] = imm16;
+            return;
+        case 0x0A:
+            r[rd] = ((rn == 15) ? (r[15] & ~3u) : r[rn]) - imm12;
+            return;
+        case 0x0C:
+            r[rd] = (r[rd] & 0xFFFFu) | (imm16 << 16);
+            return;
+        case 0x10:
+        case 0x12:
+            if((hw1 & 0x20u) && (lsb == 0))
+                break;      // SSAT16.
+            carry = 0;
+            value = shiftC(r[rn], (hw1 & 0x20u) ? 2 : 0, lsb, &carry);
+            r[rd] = signedSaturate(aEmu, (int32_t)value, field + 1);
+            return;
+        case 0x18:
+        case 0x1A:
+            if((hw1 & 0x20u) && (lsb == 0))
+                break;      // USAT16.
+            carry = 0;
+            value = shiftC(r[rn], (hw1 & 0x20u) ? 2 : 0, lsb, &carry);
+            r[rd] = unsignedSaturate(aEmu, (int32_t)value, field);
+            return;
+        case 0x14:
+            if(lsb + field > 31)
+                break;
+            r[rd] = (uint32_t)(((int32_t)(r[rn] << (31 - lsb - field))) >> (31 - field));
+            return;
+        case 0x1C:
+            if(lsb + field > 31)
+                break;
+            r[rd] = (r[rn] >> lsb) & (0xFFFFFFFFu >> (31 - field));
+            return;
+        case 0x16:
+            if(field < lsb)
+                break;
+            value = (0xFFFFFFFFu >> (31 - (field - lsb))) << lsb;
+            r[rd] = (r[rd] & ~value) | (((rn == 15) ? 0 : (r[rn] << lsb)) & value);
+            return;
+        default:
+            break;
+    }
+    undefined(aEmu);
+}
+
+static void shiftedRegister(thumbEmuType* aEmu, uint32_t hw1, uint32_t hw2)
+{
+    uint32_t* r = aEmu->m_R;
+    uint32_t op = (hw1 >> 5) & 15u;
+    uint32_t rn = hw1 & 15u;
+    uint32_t type = (hw2 >> 4) & 3u;
+    uint32_t amount = ((hw2 >> 10) & 0x1Cu) | ((hw2 >> 6) & 3u);
+    uint32_t carry = aEmu->m_C;
+    uint32_t operand;
+
+    if(amount == 0)
+    {
+        if(type == 3)
+            type = 4;
+        else if(type != 0)
+            amount = 32;
+    }
+    operand = shiftC(r[hw2 & 15u], type, amount, &carry);
+    if(op == 6)
+    {
+        // PKHBT and PKHTB.
+        r[(hw2 >> 8) & 15u] = (hw2 & 0x20u) ? ((r[rn] & 0xFFFF0000u) | (operand & 0xFFFFu)) : ((operand & 0xFFFF0000u) | (r[rn] & 0xFFFFu));
+        return;
+    }
+    dataProcessing32(aEmu, op, hw1 & 0x10u, rn, (hw2 >> 8) & 15u, operand, carry);
+}
+
+static void loadStoreMultiple(thumbEmuType* aEmu, uint32_t hw1, uint32_t hw2)
+{
+    uint32_t rn = hw1 & 15u;
+    uint32_t count = countBits(hw2);
+    uint32_t address;
+
+    switch((hw1 >> 7) & 3u)
+    {
+        case 1:     address = aEmu->m_R[rn]; break;
+        case 2:     address = aEmu->m_R[rn] - (4 * count); break;
+        default:    undefined(aEmu); return;
+    }
+    if(hw1 & 0x10u)
+        loadMultiple(aEmu, rn, hw2, address, hw1 & 0x20u);
+    else
+        storeMultiple(aEmu, rn, hw2, address, hw1 & 0x20u);
+}
+
+static void storeExclusive(thumbEmuType* aEmu, uint32_t rd, uint32_t rt, uint32_t address, uint32_t size)
+{
+    if(checkAlignment(aEmu, address, size, 1) != 0)
+        return;
+    if(aEmu->m_ExclusiveValid && (aEmu->m_ExclusiveAddress == address))
+    {
+        store(aEmu, address, size, aEmu->m_R[rt]);
+        aEmu->m_R[rd] = 0;
+    }
+    else
+        aEmu->m_R[rd] = 1;
+    aEmu->m_ExclusiveValid = 0;
+}
+
+static void loadExclusive(thumbEmuType* aEmu, uint32_t rt, uint32_t address, uint32_t size)
+{
+    if((checkAlignment(aEmu, address, size, 1) == 0) && (loadRegister(aEmu, rt, address, size, 0) == 0))
+    {
+        aEmu->m_ExclusiveAddress = address;
+        aEmu->m_ExclusiveValid = 1;
+    }
+}
+
+/* LDRD, STRD, exclusives and table branches
+*/
+static void loadStoreDual(thumbEmuType* aEmu, uint32_t hw1, uint32_t hw2)
+{
+    uint32_t* r = aEmu->m_R;
+    uint32_t op1 = (hw1 >> 7) & 3u;
+    uint32_t op2 = (hw1 >> 4) & 3u;
+    uint32_t rn = hw1 & 15u;
+    uint32_t rt = hw2 >> 12;
+    uint32_t rt2 = (hw2 >> 8) & 15u;
+    uint32_t imm8 = hw2 & 0xFFu;
+    uint32_t value;
+    uint32_t value2;
+
+    if((op1 == 0) && (op2 == 0))
+    {
+        storeExclusive(aEmu, rt2, rt, r[rn] + (imm8 << 2), 4);
+        return;
+    }
+    if((op1 == 0) && (op2 == 1))
+    {
+        loadExclusive(aEmu, rt, r[rn] + (imm8 << 2), 4);
+        return;
+    }
+    if((op1 & 2u) || (op2 & 2u))
+    {
+        uint32_t base = (rn == 15) ? (r[15] & ~3u) : r[rn];
+        uint32_t offset = (hw1 & 0x80u) ? (base + (imm8 << 2)) : (base - (imm8 << 2));
+        uint32_t address = (hw1 & 0x100u) ? offset : base;
+
+        if(checkAlignment(aEmu, address, 4, 1) != 0)
+            return;
+        if(hw1 & 0x10u)
+        {
+            if((load(aEmu, address, 4, &value) != 0) || (load(aEmu, address + 4, 4, &value2) != 0))
+                return;
+            r[rt] = value;
+            r[rt2] = value2;
+        }
+        else
+        {
+            store(aEmu, address, 4, r[rt]);
+            store(aEmu, address + 4, 4, r[rt2]);
+        }
+        if(hw1 & 0x20u)
+            r[rn] = offset;
+        return;
+    }
+
+    switch(((op2 & 1u) << 4) | ((hw2 >> 4) & 15u))
+    {
+        case 0x04:  storeExclusive(aEmu, hw2 & 15u, rt, r[rn], 1); return;
+        case 0x05:  storeExclusive(aEmu, hw2 & 15u, rt, r[rn], 2); return;
+        case 0x10:
+            if(load(aEmu, r[rn] + r[hw2 & 15u], 1, &value) == 0)
+                branchTo(aEmu, r[15] + (value << 1));
+            return;
+        case 0x11:
+            if(load(aEmu, r[rn] + (r[hw2 & 15u] << 1), 2, &value) == 0)
+                branchTo(aEmu, r[15] + (value << 1));
+            return;
+        case 0x14:  loadExclusive(aEmu, rt, r[rn], 1); return;
+        case 0x15:  loadExclusive(aEmu, rt, r[rn], 2); return;
+        default:    break;
+    }
+    undefined(aEmu);
+}
+
+static void loadStoreSingle(thumbEmuType* aEmu, uint32_t hw1, uint32_t hw2)
+{
+    uint32_t* r = aEmu->m_R;
+    uint32_t rn = hw1 & 15u;
+    uint32_t rt = hw2 >> 12;
+    uint32_t size = 1u << ((hw1 >> 5) & 3u);
+    uint32_t isLoad = hw1 & 0x10u;
+    uint32_t sign = hw1 & 0x100u;
+    uint32_t address;
+    uint32_t writeback = 0;
+    uint32_t offset = 0;
+
+    if((size == 8) || (sign && !isLoad))
+    {
+        undefined(aEmu);
+        return;
+    }
+    if(rn == 15)
+    {
+        if(!isLoad)
+        {
+            undefined(aEmu);
+            return;
+        }
+        address = (hw1 & 0x80u) ? ((r[15] & ~3u) + (hw2 & 0xFFFu)) : ((r[15] & ~3u) - (hw2 & 0xFFFu));
+    }
+    else if(hw1 & 0x80u)
+        address = r[rn] + (hw2 & 0xFFFu);
+    else if(hw2 & 0x800u)
+    {
+        offset = (hw2 & 0x200u) ? (r[rn] + (hw2 & 0xFFu)) : (r[rn] - (hw2 & 0xFFu));
+        address = (hw2 & 0x400u) ? offset : r[rn];
+        writeback = hw2 & 0x100u;
+        if(!(hw2 & 0x400u) && !writeback)
+        {
+            undefined(aEmu);
+            return;
+        }
+    }
+    else if((hw2 & 0xFC0u) == 0)
+        address = r[rn] + (r[hw2 & 15u] << ((hw2 >> 4) & 3u));
+    else
+    {
+        undefined(aEmu);
+        return;
+    }
+
+    if(isLoad)
+    {
+        if((rt == 15) && (size != 4))
+            return;     // PLD and PLI.
+        if(loadRegister(aEmu, rt, address, size, sign) != 0)
+            return;
+    }
+    else if(storeRegister(aEmu, r[rt], address, size) != 0)
+        return;
+    if(writeback && (!isLoad || (rt != rn)))
+        r[rn] = offset;
+}
+
+static void moveToSpecial(thumbEmuType* aEmu, uint32_t hw1, uint32_t hw2)
+{
+    uint32_t value = aEmu->m_R[hw1 & 15u];
+
+    switch(hw2 & 0xFFu)
+    {
+        case 0: case 1: case 2: case 3:
+            if(hw2 & 0x800u)
+            {
+                aEmu->m_N = (value >> 31) & 1u;
+                aEmu->m_Z = (value >> 30) & 1u;
+                aEmu->m_C = (value >> 29) & 1u;
+                aEmu->m_V = (value >> 28) & 1u;
+                aEmu->m_Q = (value >> 27) & 1u;
+            }
+            if(hw2 & 0x400u)
+                aEmu->m_Ge = (value >> 16) & 15u;
+            return;
+        case 8:
+            aEmu->m_Msp = value & ~3u;
+            if(!usingPsp(aEmu))
+                aEmu->m_R[13] = aEmu->m_Msp;
+            return;
+        case 9:
+            aEmu->m_Psp = value & ~3u;
+            if(usingPsp(aEmu))
+                aEmu->m_R[13] = aEmu->m_Psp;
+            return;
+        case 16:
+            aEmu->m_Primask = value & 1u;
+            break;
+        case 17:
+            aEmu->m_Basepri = value & PRIORITY_BITS_MASK;
+            break;
+        case 18:
+            value &= PRIORITY_BITS_MASK;
+            if((value != 0) && ((value < aEmu->m_Basepri) || (aEmu->m_Basepri == 0)))
+                aEmu->m_Basepri = value;
+            break;
+        case 19:
+            if(!(value & 1u) || (thumbEmuExecutionPriority(aEmu) > -1))
+                aEmu->m_Faultmask = value & 1u;
+            break;
+        case 20:
+            saveSp(aEmu);
+            if(aEmu->m_Ipsr == 0)
+                aEmu->m_Control = (aEmu->m_Control & ~CONTROL_SPSEL) | (value & CONTROL_SPSEL);
+            aEmu->m_Control = (aEmu->m_Control & ~(CONTROL_FPCA|1u)) | (value & (CONTROL_FPCA|1u));
+            loadSp(aEmu);
+            return;
+        default:
+            return;
+    }
+    aEmu->m_AnyPended = 1;
+}
+
+static uint32_t moveFromSpecial(const thumbEmuType* aEmu, uint32_t sysm)
+{
+    uint32_t flags = thumbEmuGetPsr(aEmu) & 0xF80F0000u;
+
+    switch(sysm)
+    {
+        case 0: case 2: return flags;
+        case 1: case 3: return flags | aEmu->m_Ipsr;
+        case 5: case 7: return aEmu->m_Ipsr;
+        case 8:         return usingPsp(aEmu) ? aEmu->m_Msp : aEmu->m_R[13];
+        case 9:         return usingPsp(aEmu) ? aEmu->m_R[13] : aEmu->m_Psp;
+        case 16:        return aEmu->m_Primask;
+        case 17:
+        case 18:        return aEmu->m_Basepri;
+        case 19:        return aEmu->m_Faultmask;
+        case 20:        return aEmu->m_Control;
+        default:        return 0;
+    }
+}
+
+static void branchesAndControl(thumbEmuType* aEmu, uint32_t hw1, uint32_t hw2)
+{
+    uint32_t s = (hw1 >> 10) & 1u;
+    uint32_t j1 = (hw2 >> 13) & 1u;
+    uint32_t j2 = (hw2 >> 11) & 1u;
+    uint32_t offset;
+
+    if((hw2 & 0x5000u) == 0)
+    {
+        if((hw1 & 0x380u) != 0x380u)
+        {
+            if(conditionPassed(aEmu, (hw1 >> 6) & 15u))
+            {
+                offset = (s << 20) | (j2 << 19) | (j1 << 18) | ((hw1 & 0x3Fu) << 12) | ((hw2 & 0x7FFu) << 1);
+                branchTo(aEmu, aEmu->m_R[15] + (uint32_t)(((int32_t)(offset << 11)) >> 11));
+            }
+            return;
+        }
+        switch((hw1 >> 4) & 0x7Fu)
+        {
+            case 0x38: case 0x39:
+                moveToSpecial(aEmu, hw1, hw2);
+                return;
+            case 0x3A:
+                hint(aEmu, hw2 & 0xFFu);
+                return;
+            case 0x3B:
+                if(((hw2 >> 4) & 15u) == 2)
+                    aEmu->m_ExclusiveValid = 0;
+                return;     // DSB, DMB and ISB have nothing to order.
+            case 0x3E: case 0x3F:
+                aEmu->m_R[(hw2 >> 8) & 15u] = moveFromSpecial(aEmu, hw2 & 0xFFu);
+                return;
+            default:
+                undefined(aEmu);
+                return;
+        }
+    }
+    if((hw2 & 0x5000u) == 0x4000u)
+    {
+        undefined(aEmu);    // BLX immediate, no ARM state to go to.
+        return;
+    }
+
+    offset = (s << 24) | ((!(j1 ^ s)) << 23) | ((!(j2 ^ s)) << 22) | ((hw1 & 0x3FFu) << 12) | ((hw2 & 0x7FFu) << 1);
+    if(hw2 & 0x4000u)
+        aEmu->m_R[14] = aEmu->m_Next | 1u;
+    branchTo(aEmu, aEmu->m_R[15] + (uint32_t)(((int32_t)(offset << 7)) >> 7));
+}
+
+/* Parallel add and subtract
+ * - Only the GE setting forms, which is what newlib's memchr and strlen use
+*/
+static void parallelAddSubtract(thumbEmuType* aEmu, uint32_t hw1, uint32_t hw2)
+{
+    uint32_t a = aEmu->m_R[hw1 & 15u];
+    uint32_t b = aEmu->m_R[hw2 & 15u];
+    uint32_t isUnsigned = hw2 & 0x40u;
+    uint32_t result = 0;
+    uint32_t ge = 0;
+    uint32_t lanes;
+    uint32_t width;
+    uint32_t i;
+
+    if((hw2 & 0x30u) != 0)
+    {
+        undefined(aEmu);
+        return;
+    }
+    switch((hw1 >> 4) & 7u)
+    {
+        case 0: case 4: lanes = 4; width = 8; break;
+        case 1: case 5: lanes = 2; width = 16; break;
+        default:
+            undefined(aEmu);
+            return;
+    }
+    for(i = 0; i < lanes; i++)
+    {
+        uint32_t mask = (1u << width) - 1u;
+        uint32_t x = (a >> (i * width)) & mask;
+        uint32_t y = (b >> (i * width)) & mask;
+        int32_t sum;
+
+        if(!isUnsigned)
+        {
+            x = (uint32_t)(((int32_t)(x << (32 - width))) >> (32 - width));
+            y = (uint32_t)(((int32_t)(y << (32 - width))) >> (32 - width));
+        }
+        sum = (hw1 & 0x40u) ? ((int32_t)x - (int32_t)y) : ((int32_t)x + (int32_t)y);
+        if(isUnsigned ? ((hw1 & 0x40u) ? (sum >= 0) : (sum > (int32_t)mask)) : (sum >= 0))
+            ge |= ((lanes == 4) ? 1u : 3u) << (i * (4 / lanes));
+        result |= ((uint32_t)sum & mask) << (i * width);
+    }
+    aEmu->m_R[(hw2 >> 8) & 15u] = result;
+    aEmu->m_Ge = ge;
+}
+
+static void dataProcessingRegister(thumbEmuType* aEmu, uint32_t hw1, uint32_t hw2)
+{
+    uint32_t* r = aEmu->m_R;
+    uint32_t op1 = (hw1 >> 4) & 15u;
+    uint32_t op2 = (hw2 >> 4) & 15u;
+    uint32_t rn = hw1 & 15u;
+    uint32_t rd = (hw2 >> 8) & 15u;
+    uint32_t rm = hw2 & 15u;
+    uint32_t carry = aEmu->m_C;
+    uint32_t value;
+    uint32_t i;
+
+    if((hw2 & 0xF000u) != 0xF000u)
+    {
+        undefined(aEmu);
+        return;
+    }
+    if((op1 < 8) && (op2 == 0))
+    {
+        value = shiftC(r[rn], (op1 >> 1) & 3u, r[rm] & 0xFFu, &carry);
+        r[rd] = value;
+        if(op1 & 1u)
+        {
+            setNZ(aEmu, value);
+            aEmu->m_C = carry;
+        }
+        return;
+    }
+    if((op1 < 6) && (op2 & 8u))
+    {
+        value = ror(r[rm], ((hw2 >> 4) & 3u) * 8);
+        switch(op1)
+        {
+            case 0:     value = (uint32_t)(int32_t)(int16_t)value; break;
+            case 1:     value &= 0xFFFFu; break;
+            case 4:     value = (uint32_t)(int32_t)(int8_t)value; break;
+            case 5:     value &= 0xFFu; break;
+            default:    undefined(aEmu); return;
+        }
+        r[rd] = (rn == 15) ? value : (r[rn] + value);
+        return;
+    }
+    if((op1 & 8u) && !(op2 & 8u))
+    {
+        parallelAddSubtract(aEmu, hw1, hw2);
+        return;
+    }
+    if(((op1 & 0xCu) == 0x8u) && ((op2 & 0xCu) == 0x8u))
+    {
+        switch(((op1 & 3u) << 2) | (op2 & 3u))
+        {
+            case 0x0:   r[rd] = signedSaturate(aEmu, (int64_t)(int32_t)r[rm] + (int32_t)r[rn], 32); return;
+            case 0x1:   r[rd] = signedSaturate(aEmu, (int64_t)(int32_t)r[rm] + (int32_t)signedSaturate(aEmu, 2 * (int64_t)(int32_t)r[rn], 32), 32); return;
+            case 0x2:   r[rd] = signedSaturate(aEmu, (int64_t)(int32_t)r[rm] - (int32_t)r[rn], 32); return;
+            case 0x3:   r[rd] = signedSaturate(aEmu, (int64_t)(int32_t)r[rm] - (int32_t)signedSaturate(aEmu, 2 * (int64_t)(int32_t)r[rn], 32), 32); return;
+            case 0x4:   r[rd] = __builtin_bswap32(r[rm]); return;
+            case 0x5:   r[rd] = ((r[rm] & 0x00FF00FFu) << 8) | ((r[rm] >> 8) & 0x00FF00FFu); return;
+            case 0x6:
+                value = 0;
+                for(i = 0; i < 32; i++)
+                    value |= ((r[rm] >> i) & 1u) << (31 - i);
+                r[rd] = value;
+                return;
+            case 0x7:   r[rd] = (uint32_t)(int32_t)(int16_t)__builtin_bswap16((uint16_t)r[rm]); return;
+            case 0x8:
+                value = 0;
+                for(i = 0; i < 4; i++)
+                    value |= ((aEmu->m_Ge & (1u << i)) ? r[rn] : r[rm]) & (0xFFu << (i * 8));
+                r[rd] = value;
+                return;
+            case 0xC:   r[rd] = r[rm] ? (uint32_t)__builtin_clz(r[rm]) : 32; return;
+            default:    break;
+        }
+    }
+    undefined(aEmu);
+}
+
+static inline int32_t halfword(uint32_t value, uint32_t top)
+{
+    return top ? (int32_t)(int16_t)(value >> 16) : (int32_t)(int16_t)value;
+}
+
+static void multiply(thumbEmuType* aEmu, uint32_t hw1, uint32_t hw2)
+{
+    uint32_t* r = aEmu->m_R;
+    uint32_t ra = hw2 >> 12;
+    uint32_t rd = (hw2 >> 8) & 15u;
+    uint32_t a = r[hw1 & 15u];
+    uint32_t b = r[hw2 & 15u];
+    uint32_t accumulate = (ra != 15) ? r[ra] : 0;
+    int64_t product;
+
+    switch((hw1 >> 4) & 7u)
+    {
+        case 0:
+            if((hw2 & 0x30u) == 0)
+                r[rd] = (a * b) + accumulate;
+            else if((hw2 & 0x30u) == 0x10u)
+                r[rd] = r[ra] - (a * b);
+            else
+                break;
+            return;
+        case 1:
+            product = (int64_t)halfword(a, hw2 & 0x20u) * halfword(b, hw2 & 0x10u);
+            if(ra != 15)
+            {
+                product += (int32_t)accumulate;
+                if((product > INT32_MAX) || (product < INT32_MIN))
+                    aEmu->m_Q = 1;
+            }
+            r[rd] = (uint32_t)product;
+            return;
+        case 2:
+        case 4:
+            if(hw2 & 0x10u)
+                b = ror(b, 16);
+            product = (int64_t)halfword(a, 0) * halfword(b, 0);
+            if(hw1 & 0x40u)
+                product -= (int64_t)halfword(a, 1) * halfword(b, 1);
+            else
+                product += (int64_t)halfword(a, 1) * halfword(b, 1);
+            if(ra != 15)
+                product += (int32_t)accumulate;
+            if((product > INT32_MAX) || (product < INT32_MIN))
+                aEmu->m_Q = 1;
+            r[rd] = (uint32_t)product;
+            return;
+        case 3:
+            product = ((int64_t)(int32_t)a * halfword(b, hw2 & 0x10u)) >> 16;
+            if(ra != 15)
+            {
+                product += (int32_t)accumulate;
+                if((product > INT32_MAX) || (product < INT32_MIN))
+                    aEmu->m_Q = 1;
+            }
+            r[rd] = (uint32_t)product;
+            return;
+        case 5:
+        case 6:
+            product = (int64_t)(int32_t)a * (int32_t)b;
+            if(hw1 & 0x20u)
+                product = ((int64_t)accumulate << 32) - product;
+            else
+                product += (int64_t)((uint64_t)accumulate << 32);
+            if(hw2 & 0x10u)
+                product += 0x80000000;
+            r[rd] = (uint32_t)((uint64_t)product >> 32);
+            return;
+        default:
+            break;
+    }
+    undefined(aEmu);
+}
+
+static void longMultiply(thumbEmuType* aEmu, uint32_t hw1, uint32_t hw2)
+{
+    uint32_t* r = aEmu->m_R;
+    uint32_t lo = hw2 >> 12;
+    uint32_t hi = (hw2 >> 8) & 15u;
+    uint32_t a = r[hw1 & 15u];
+    uint32_t b = r[hw2 & 15u];
+    uint64_t accumulate = ((uint64_t)r[hi] << 32) | r[lo];
+    uint64_t result;
+
+    switch(((hw1 >> 4) & 7u) << 4 | ((hw2 >> 4) & 15u))
+    {
+        case 0x00:  result = (uint64_t)((int64_t)(int32_t)a * (int32_t)b); break;
+        case 0x20:  result = (uint64_t)a * b; break;
+        case 0x40:  result = (uint64_t)((int64_t)(int32_t)a * (int32_t)b) + accumulate; break;
+        case 0x60:  result = ((uint64_t)a * b) + accumulate; break;
+        case 0x66:  result = ((uint64_t)a * b) + r[hi] + r[lo]; break;
+        case 0x1F:
+        case 0x3F:
+            if(b == 0)
+            {
+                if(aEmu->m_Ccr & CCR_DIV_0_TRP)
+                {
+                    usageFault(aEmu, CFSR_DIVBYZERO);
+                    return;
+                }
+                r[hi] = 0;
+            }
+            else if(hw1 & 0x20u)
+                r[hi] = a / b;
+            else if((a == 0x80000000u) && (b == 0xFFFFFFFFu))
+                r[hi] = a;
+            else
+                r[hi] = (uint32_t)((int32_t)a / (int32_t)b);
+            return;
+        default:
+            if(((hw1 & 0x70u) == 0x40u) && ((hw2 & 0xF0u) >= 0x80u) && ((hw2 & 0xF0u) <= 0xB0u))
+            {
+                result = (uint64_t)((int64_t)halfword(a, hw2 & 0x20u) * halfword(b, hw2 & 0x10u)) + accumulate;
+                break;
+            }
+            undefined(aEmu);
+            return;
+    }
+    r[lo] = (uint32_t)result;
+    r[hi] = (uint32_t)(result >> 32);
+}
+
+static inline float getFloat(const thumbEmuType* aEmu, uint32_t index)
+{
+    float value;
+
+    memcpy(&value, &aEmu->m_S[index], sizeof(value));
+    return value;
+}
+
+static inline void setFloat(thumbEmuType* aEmu, uint32_t index, float value)
+{
+    memcpy(&aEmu->m_S[index], &value, sizeof(value));
+}
+
+static uint32_t floatToInteger(float value, uint32_t isSigned, uint32_t towardZero)
+{
+    if(!towardZero)
+        value = nearbyintf(value);
+    if(isnan(value))
+        return 0;
+    if(isSigned)
+    {
+        if(value >= 2147483648.0f)
+            return 0x7FFFFFFFu;
+        if(value <= -2147483648.0f)
+            return 0x80000000u;
+        return (uint32_t)(int32_t)value;
+    }
+    if(value >= 4294967296.0f)
+        return 0xFFFFFFFFu;
+    if(value <= 0.0f)
+        return 0;
+    return (uint32_t)value;
+}
+
+/* VLDR, VSTR, VLDM, VSTM, VPUSH, VPOP and the two register VMOVs
+ * - Double registers are pairs of singles, FPv4-SP can move them but not compute with them
+*/
+static void floatLoadStore(thumbEmuType* aEmu, uint32_t hw1, uint32_t hw2)
+{
+    uint32_t* r = aEmu->m_R;
+    uint32_t rn = hw1 & 15u;
+    uint32_t isDouble = (hw2 >> 8) & 1u;
+    uint32_t vd = isDouble ? ((((hw1 >> 2) & 0x10u) | ((hw2 >> 12) & 15u)) * 2) : ((((hw2 >> 12) & 15u) << 1) | ((hw1 >> 6) & 1u));
+    uint32_t imm = (hw2 & 0xFFu) << 2;
+    uint32_t words;
+    uint32_t address;
+    uint32_t values[32];
+    uint32_t i;
+
+    if((hw1 & 0x1E0u) == 0x040u)
+    {
+        uint32_t rt = hw2 >> 12;
+        uint32_t rt2 = rn;
+        uint32_t vm = isDouble ? ((((hw2 >> 1) & 0x10u) | (hw2 & 15u)) * 2) : (((hw2 & 15u) << 1) | ((hw2 >> 5) & 1u));
+
+        if(vm > 30)
+        {
+            undefined(aEmu);
+            return;
+        }
+        if(hw1 & 0x10u)
+        {
+            r[rt] = aEmu->m_S[vm];
+            r[rt2] = aEmu->m_S[vm + 1];
+        }
+        else
+        {
+            aEmu->m_S[vm] = r[rt];
+            aEmu->m_S[vm + 1] = r[rt2];
+        }
+        return;
+    }
+
+    if((hw1 & 0x120u) == 0x100u)
+    {
+        uint32_t base = (rn == 15) ? (r[15] & ~3u) : r[rn];
+
+        address = (hw1 & 0x80u) ? (base + imm) : (base - imm);
+        words = isDouble ? 2 : 1;
+        if((vd + words) > 32)
+        {
+            undefined(aEmu);
+            return;
+        }
+        if(checkAlignment(aEmu, address, 4, 1) != 0)
+            return;
+        if(hw1 & 0x10u)
+        {
+            for(i = 0; i < words; i++)
+            {
+                if(load(aEmu, address + (i * 4), 4, &values[i]) != 0)
+                    return;
+            }
+            memcpy(&aEmu->m_S[vd], values, words * 4);
+        }
+        else
+        {
+            for(i = 0; i < words; i++)
+                store(aEmu, address + (i * 4), 4, aEmu->m_S[vd + i]);
+        }
+        return;
+    }
+
+    words = hw2 & 0xFFu;
+    if(isDouble)
+        words &= ~1u;
+    if(((hw1 & 0x180u) != 0x080u) && ((hw1 & 0x1A0u) != 0x120u))
+    {
+        undefined(aEmu);
+        return;
+    }
+    if((words == 0) || ((vd + words) > 32))
+    {
+        undefined(aEmu);
+        return;
+    }
+    address = (hw1 & 0x100u) ? (r[rn] - (words * 4)) : r[rn];
+    if(checkAlignment(aEmu, address, 4, 1) != 0)
+        return;
+    if(hw1 & 0x10u)
+    {
+        for(i = 0; i < words; i++)
+        {
+            if(load(aEmu, address + (i * 4), 4, &values[i]) != 0)
+                return;
+        }
+        memcpy(&aEmu->m_S[vd], values, words * 4);
+    }
+    else
+    {
+        for(i = 0; i < words; i++)
+            store(aEmu, address + (i * 4), 4, aEmu->m_S[vd + i]);
+    }
+    if(hw1 & 0x20u)
+        r[rn] = (hw1 & 0x100u) ? address : (address + (words * 4));
+}
+
+static void floatCompare(thumbEmuType* aEmu, float a, float b)
+{
+    uint32_t flags;
+
+    if(isnan(a) || isnan(b))
+        flags = 0x3u;
+    else if(a == b)
+        flags = 0x6u;
+    else if(a < b)
+        flags = 0x8u;
+    else
+        flags = 0x2u;
+    aEmu->m_Fpscr = (aEmu->m_Fpscr & ~FPSCR_FLAGS_MASK) | (flags << 28);
+}
+
+static void floatDataProcessing(thumbEmuType* aEmu, uint32_t hw1, uint32_t hw2)
+{
+    uint32_t d = (((hw2 >> 12) & 15u) << 1) | ((hw1 >> 6) & 1u);
+    uint32_t n = ((hw1 & 15u) << 1) | ((hw2 >> 7) & 1u);
+    uint32_t m = ((hw2 & 15u) << 1) | ((hw2 >> 5) & 1u);
+    uint32_t opc2 = hw1 & 15u;
+    uint32_t negate = (hw2 >> 6) & 1u;
+    float a = getFloat(aEmu, n);
+    float b = getFloat(aEmu, m);
+    float accumulate = getFloat(aEmu, d);
+    uint32_t imm8;
+
+    if(hw2 & 0x100u)
+    {
+        undefined(aEmu);    // No double precision arithmetic on FPv4-SP.
+        return;
+    }
+    switch(((hw1 >> 4) & 0x8u) | ((hw1 >> 4) & 0x3u))
+    {
+        case 0x0:   setFloat(aEmu, d, negate ? (accumulate - (a * b)) : (accumulate + (a * b))); return;
+        case 0x1:   setFloat(aEmu, d, negate ? (-accumulate - (a * b)) : (-accumulate + (a * b))); return;
+        case 0x2:   setFloat(aEmu, d, negate ? -(a * b) : (a * b)); return;
+        case 0x3:   setFloat(aEmu, d, negate ? (a - b) : (a + b)); return;
+        case 0x8:
+            if(negate)
+                break;
+            setFloat(aEmu, d, a / b);
+            return;
+        case 0x9:   setFloat(aEmu, d, negate ? fmaf(-a, b, -accumulate) : fmaf(a, b, -accumulate)); return;
+        case 0xA:   setFloat(aEmu, d, negate ? fmaf(-a, b, accumulate) : fmaf(a, b, accumulate)); return;
+        case 0xB:
+            if(!negate)
+            {
+                imm8 = (opc2 << 4) | (hw2 & 15u);
+                aEmu->m_S[d] = ((imm8 & 0x80u) << 24) | ((imm8 & 0x40u) ? 0x3E000000u : 0x40000000u) | ((imm8 & 0x3Fu) << 19);
+                return;
+            }
+            switch((opc2 << 1) | ((hw2 >> 7) & 1u))
+            {
+                case 0x00:  aEmu->m_S[d] = aEmu->m_S[m]; return;
+                case 0x01:  aEmu->m_S[d] = aEmu->m_S[m] & 0x7FFFFFFFu; return;
+                case 0x02:  aEmu->m_S[d] = aEmu->m_S[m] ^ 0x80000000u; return;
+                case 0x03:  setFloat(aEmu, d, sqrtf(b)); return;
+                case 0x08:
+                case 0x09:  floatCompare(aEmu, accumulate, b); return;
+                case 0x0A:
+                case 0x0B:  floatCompare(aEmu, accumulate, 0.0f); return;
+                case 0x10:  setFloat(aEmu, d, (float)aEmu->m_S[m]); return;
+                case 0x11:  setFloat(aEmu, d, (float)(int32_t)aEmu->m_S[m]); return;
+                case 0x18:
+                case 0x19:  aEmu->m_S[d] = floatToInteger(b, 0, hw2 & 0x80u); return;
+                case 0x1A:
+                case 0x1B:  aEmu->m_S[d] = floatToInteger(b, 1, hw2 & 0x80u); return;
+                default:    break;
+            }
+            break;
+        default:
+            break;
+    }
+    undefined(aEmu);
+}
+
+static void floatingPoint(thumbEmuType* aEmu, uint32_t hw1, uint32_t hw2)
+{
+    uint32_t rt = hw2 >> 12;
+
+    if(((hw2 >> 9) & 7u) != 5u)
+    {
+        undefined(aEmu);    // Only coprocessors 10 and 11 exist.
+        return;
+    }
+    if((aEmu->m_Cpacr & (0xFu << 20)) != (0xFu << 20))
+    {
+        usageFault(aEmu, CFSR_NOCP);
+        return;
+    }
+    aEmu->m_Control |= CONTROL_FPCA;
+
+    if((hw1 & 0xFE00u) == 0xEC00u)
+    {
+        floatLoadStore(aEmu, hw1, hw2);
+        return;
+    }
+    if((hw1 & 0xFF00u) != 0xEE00u)
+    {
+        undefined(aEmu);
+        return;
+    }
+    if(!(hw2 & 0x10u))
+    {
+        floatDataProcessing(aEmu, hw1, hw2);
+        return;
+    }
+    if(((hw1 & 0xFFE0u) == 0xEE00u) && ((hw2 & 0x0F7Fu) == 0x0A10u))
+    {
+        uint32_t n = ((hw1 & 15u) << 1) | ((hw2 >> 7) & 1u);
+
+        if(hw1 & 0x10u)
+            aEmu->m_R[rt] = aEmu->m_S[n];
+        else
+            aEmu->m_S[n] = aEmu->m_R[rt];
+        return;
+    }
+    if((hw1 == 0xEEF1u) && ((hw2 & 0x0FFFu) == 0x0A10u))
+    {
+        if(rt == 15)
+        {
+            aEmu->m_N = (aEmu->m_Fpscr >> 31) & 1u;
+            aEmu->m_Z = (aEmu->m_Fpscr >> 30) & 1u;
+            aEmu->m_C = (aEmu->m_Fpscr >> 29) & 1u;
+            aEmu->m_V = (aEmu->m_Fpscr >> 28) & 1u;
+        }
+        else
+            aEmu->m_R[rt] = aEmu->m_Fpscr;
+        return;
+    }
+    if((hw1 == 0xEEE1u) && ((hw2 & 0x0FFFu) == 0x0A10u))
+    {
+        aEmu->m_Fpscr = aEmu->m_R[rt];
+        return;
+    }
+    undefined(aEmu);
+}
+
+static void execute32(thumbEmuType* aEmu, uint32_t hw1, uint32_t hw2)
+{
+    switch((hw1 >> 11) & 3u)
+    {
+        case 1:
+            if((hw1 & 0x0600u) == 0)
+            {
+                if(hw1 & 0x40u)
+                    loadStoreDual(aEmu, hw1, hw2);
+                else
+                    loadStoreMultiple(aEmu, hw1, hw2);
+            }
+            else if((hw1 & 0x0600u) == 0x0200u)
+                shiftedRegister(aEmu, hw1, hw2);
+            else
+                floatingPoint(aEmu, hw1, hw2);
+            return;
+        case 2:
+            if(hw2 & 0x8000u)
+                branchesAndControl(aEmu, hw1, hw2);
+            else if(hw1 & 0x0200u)
+                plainImmediate(aEmu, hw1, hw2);
+            else
+                modifiedImmediate(aEmu, hw1, hw2);
+            return;
+        default:
+            if((hw1 & 0x0600u) == 0)
+                loadStoreSingle(aEmu, hw1, hw2);
+            else if((hw1 & 0x0700u) == 0x0200u)
+                dataProcessingRegister(aEmu, hw1, hw2);
+            else if((hw1 & 0x0780u) == 0x0300u)
+                multiply(aEmu, hw1, hw2);
+            else if((hw1 & 0x0780u) == 0x0380u)
+                longMultiply(aEmu, hw1, hw2);
+            else
+                undefined(aEmu);
+            return;
+    }
+}
+
+/* Instruction fetch slow path
+ * - Execute-never addresses are a MemManage fault, anything else unmapped a BusFault
+*/
+static int fetchSlow(thumbEmuType* aEmu, uint32_t pc, uint32_t* aHw1, uint32_t* aHw2)
+{
+    const thumbEmuRegionType* region;
+    uint32_t i;
+
+    for(i = 0; i < 2; i++)
+    {
+        uint32_t address = pc + (i * 2);
+        uint16_t half;
+
+        if(((address >= 0x40000000u) && (address < 0x60000000u)) || (address >= 0xA0000000u))
+        {
+            aEmu->m_Cfsr |= CFSR_IACCVIOL;
+            raise(aEmu, THUMB_EMU_MEM_MANAGE, pc);
+            return -1;
+        }
+        region = findRegion(aEmu, address, 2);
+        if((region == NULL) || !(region->m_Flags & THUMB_EMU_EXEC))
+        {
+            aEmu->m_Cfsr |= CFSR_IBUSERR;
+            raise(aEmu, THUMB_EMU_BUS_FAULT, pc);
+            return -1;
+        }
+        if(region->m_Size >= 4)
+            aEmu->m_CodeRegion = region;
+        memcpy(&half, region->m_Data + (address - region->m_Base), 2);
+        if(i == 0)
+        {
+            *aHw1 = half;
+            if(half < 0xE800u)
+                return 2;
+        }
+        else
+            *aHw2 = half;
+    }
+    return 4;
+}
+
+thumbEmuStopType thumbEmuRun(thumbEmuType* aEmu, uint64_t maxInstructions)
+{
+    uint64_t end = aEmu->m_Instructions + maxInstructions;
+
+    aEmu->m_Stop = THUMB_EMU_RUNNING;
+    while(aEmu->m_Instructions < end)
+    {
+        const thumbEmuRegionType* code;
+        uint32_t pc;
+        uint32_t offset;
+        uint32_t itState;
+        uint32_t hw1;
+        uint32_t hw2 = 0;
+        uint32_t length;
+
+        if(aEmu->m_AnyPended)
+        {
+            takePending(aEmu);
+            if(aEmu->m_Stop != THUMB_EMU_RUNNING)
+                break;
+        }
+        pc = aEmu->m_R[15];
+        if(!aEmu->m_Thumb)
+        {
+            aEmu->m_Cfsr |= CFSR_INVSTATE;
+            raise(aEmu, THUMB_EMU_USAGE_FAULT, pc);
+            takeSynchronous(aEmu);
+            if(aEmu->m_Stop != THUMB_EMU_RUNNING)
+                break;
+            continue;
+        }
+
+        code = aEmu->m_CodeRegion;
+        offset = pc - code->m_Base;
+        if((offset < code->m_Size) && ((code->m_Size - offset) >= 4))
+        {
+            uint16_t half[2];
+
+            memcpy(half, code->m_Data + offset, 4);
+            hw1 = half[0];
+            length = 2;
+            if(hw1 >= 0xE800u)
+            {
+                hw2 = half[1];
+                length = 4;
+            }
+        }
+        else
+        {
+            length = (uint32_t)fetchSlow(aEmu, pc, &hw1, &hw2);
+            if(aEmu->m_Fault != 0)
+            {
+                takeSynchronous(aEmu);
+                if(aEmu->m_Stop != THUMB_EMU_RUNNING)
+                    break;
+                continue;
+            }
+        }
+
+        itState = aEmu->m_ItState;
+        aEmu->m_Current = pc;
+        aEmu->m_Next = pc + length;
+        aEmu->m_R[15] = pc + 4;
+        if((itState == 0) || conditionPassed(aEmu, itState >> 4))
+        {
+            if(length == 2)
+                execute16(aEmu, hw1);
+            else
+                execute32(aEmu, hw1, hw2);
+        }
+
+        if(aEmu->m_Fault != 0)
+        {
+            aEmu->m_R[15] = pc;
+            aEmu->m_ExcReturn = 0;
+            takeSynchronous(aEmu);
+        }
+        else
+        {
+            aEmu->m_Instructions++;
+            if(itState != 0)
+                aEmu->m_ItState = ((itState & 7u) == 0) ? 0 : ((itState & 0xE0u) | ((itState << 1) & 0x1Fu));
+            aEmu->m_R[15] = aEmu->m_Next;
+            if(aEmu->m_ExcReturn != 0)
+            {
+                uint32_t excReturn = aEmu->m_ExcReturn;
+
+                aEmu->m_ExcReturn = 0;
+                exceptionReturn(aEmu, excReturn);
+            }
+        }
+        if(aEmu->m_Stop != THUMB_EMU_RUNNING)
+            break;
+    }
+    return (aEmu->m_Stop == THUMB_EMU_RUNNING) ? ThumbEmu_Limit : (thumbEmuStopType)aEmu->m_Stop;
+}
+
+void thumbEmuInit(thumbEmuType* aEmu)
+{
+    memset(aEmu, 0, sizeof(*aEmu));
+    aEmu->m_Ccr = CCR_STKALIGN;
+    aEmu->m_Thumb = 1;
+    aEmu->m_CodeRegion = &emptyRegion;
+    aEmu->m_DataRegion = &emptyRegion;
+    aEmu->m_Stop = THUMB_EMU_RUNNING;
+}
+
+int thumbEmuMap(thumbEmuType* aEmu, uint32_t base, uint32_t size, uint8_t* aData, uint32_t flags)
+{
+    thumbEmuRegionType* region;
+
+    if(aEmu->m_RegionCount >= THUMB_EMU_MAX_REGIONS)
+        return -1;
+    region = &aEmu->m_Regions[aEmu->m_RegionCount++];
+    region->m_Base = base;
+    region->m_Size = size;
+    region->m_Data = aData;
+    region->m_Flags = flags;
+    return 0;
+}
+
+/* Reset
+ * - Initial MSP and PC from the vector table at VTOR, which starts at 0 as on the core
+*/
+int thumbEmuReset(thumbEmuType* aEmu)
+{
+    uint32_t sp;
+    uint32_t pc;
+
+    if((accessSlow(aEmu, aEmu->m_Vtor, 4, &sp, 0) != 0) || (accessSlow(aEmu, aEmu->m_Vtor + 4, 4, &pc, 0) != 0))
+        return -1;
+    aEmu->m_Msp = sp & ~3u;
+    aEmu->m_R[13] = aEmu->m_Msp;
+    aEmu->m_R[14] = 0xFFFFFFFFu;
+    aEmu->m_R[15] = pc & ~1u;
+    aEmu->m_Thumb = pc & 1u;
+    aEmu->m_Ipsr = 0;
+    aEmu->m_Control = 0;
+    aEmu->m_ItState = 0;
+    return 0;
+}
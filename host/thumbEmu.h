@@ -0,0 +1,137 @@
+/*
+ * thumbEmu.h
+ *
+ *  Created on: 18 Oct 2026
+ *
+ *  Cortex-M4 Thumb-2 instruction emulator for the host tools
+ *  - Integer, load/store, branch, multiply/divide and single precision VFP instructions
+ *  - Exception model: entry, return, fault escalation and lockup, with the SCB fault
+ *    registers emulated, so the real handlers in exceptions.c can run on it
+ *  - FP context is stacked eagerly (no lazy stacking) whenever CONTROL.FPCA is set
+ *  - Memory is a list of host buffers, anything else goes to the m_Io callback
+ */
+
+#ifndef THUMB_EMU_H_
+#define THUMB_EMU_H_
+
+#include <stdint.h>
+
+#define THUMB_EMU_MAX_REGIONS       16
+#define THUMB_EMU_MAX_EXCEPTIONS    128     // 16 system exceptions and 112 IRQs.
+
+// Region flags.
+#define THUMB_EMU_READ              (1u<<0)
+#define THUMB_EMU_WRITE             (1u<<1)
+#define THUMB_EMU_EXEC              (1u<<2)
+
+// Why thumbEmuRun() returned.
+typedef enum
+{
+    ThumbEmu_Limit,         // Instruction budget used up.
+    ThumbEmu_Breakpoint,    // BKPT executed, PC is at the BKPT.
+    ThumbEmu_Lockup,        // Fault while unable to take one, PC is the lockup address.
+    ThumbEmu_Reset,         // AIRCR.SYSRESETREQ written.
+    ThumbEmu_Sleep,         // WFI or WFE with nothing to wake it.
+    ThumbEmu_Watch          // Write inside the watch range.
+} thumbEmuStopType;
+
+// Exception numbers.
+#define THUMB_EMU_NMI               2u
+#define THUMB_EMU_HARD_FAULT        3u
+#define THUMB_EMU_MEM_MANAGE        4u
+#define THUMB_EMU_BUS_FAULT         5u
+#define THUMB_EMU_USAGE_FAULT       6u
+#define THUMB_EMU_SVCALL            11u
+#define THUMB_EMU_DEBUG_MONITOR     12u
+#define THUMB_EMU_PENDSV            14u
+#define THUMB_EMU_SYSTICK           15u
+
+typedef struct
+{
+    uint32_t m_Base;
+    uint32_t m_Size;
+    uint8_t* m_Data;
+    uint32_t m_Flags;
+} thumbEmuRegionType;
+
+typedef struct thumbEmu
+{
+    uint32_t m_R[16];               // r15 is the address of the next instruction to run.
+    uint32_t m_N, m_Z, m_C, m_V, m_Q;
+    uint32_t m_Ge;
+    uint32_t m_ItState;
+    uint32_t m_Thumb;               // EPSR.T, clear after interworking to an even address.
+    uint32_t m_Ipsr;
+    uint32_t m_Msp;                 // Banked copies, r13 holds the active one.
+    uint32_t m_Psp;
+    uint32_t m_Control;
+    uint32_t m_Primask;
+    uint32_t m_Faultmask;
+    uint32_t m_Basepri;
+    uint32_t m_S[32];               // FP registers.
+    uint32_t m_Fpscr;
+
+    // System control space.
+    uint32_t m_Vtor;
+    uint32_t m_Aircr;
+    uint32_t m_Ccr;
+    uint32_t m_Shcsr;
+    uint32_t m_Cfsr;
+    uint32_t m_Hfsr;
+    uint32_t m_Dfsr;
+    uint32_t m_Mmfar;
+    uint32_t m_Bfar;
+    uint32_t m_Cpacr;
+    uint32_t m_Demcr;
+    uint32_t m_DwtCtrl;
+    uint8_t  m_Priority[THUMB_EMU_MAX_EXCEPTIONS];
+    uint8_t  m_Active[THUMB_EMU_MAX_EXCEPTIONS];
+    uint8_t  m_Pended[THUMB_EMU_MAX_EXCEPTIONS];
+    uint32_t m_NvicEnable[4];
+
+    // Exclusive monitor.
+    uint32_t m_ExclusiveAddress;
+    uint32_t m_ExclusiveValid;
+
+    thumbEmuRegionType m_Regions[THUMB_EMU_MAX_REGIONS];
+    uint32_t m_RegionCount;
+
+    // Memory outside the regions, return 0 on success or -1 for a bus error.
+    int (*m_Io)(struct thumbEmu* aEmu, uint32_t address, uint32_t size, uint32_t* aValue, int write);
+    void* m_User;
+
+    // Stop with ThumbEmu_Watch after a write in [m_WatchStart, m_WatchEnd).
+    uint32_t m_WatchStart;
+    uint32_t m_WatchEnd;
+
+    uint64_t m_Instructions;        // Executed so far, also the DWT cycle counter.
+    uint64_t m_CycleBase;
+
+    // Internal.
+    uint32_t m_Current;
+    uint32_t m_Next;
+    uint32_t m_Fault;               // Synchronous exception raised by the current instruction.
+    uint32_t m_FaultReturn;
+    uint32_t m_ExcReturn;           // EXC_RETURN branched to by the current instruction.
+    uint32_t m_AnyPended;
+    uint32_t m_Stop;
+    const thumbEmuRegionType* m_CodeRegion;
+    const thumbEmuRegionType* m_DataRegion;
+} thumbEmuType;
+
+void thumbEmuInit(thumbEmuType* aEmu);
+int thumbEmuMap(thumbEmuType* aEmu, uint32_t base, uint32_t size, uint8_t* aData, uint32_t flags);
+int thumbEmuReset(thumbEmuType* aEmu);
+thumbEmuStopType thumbEmuRun(thumbEmuType* aEmu, uint64_t maxInstructions);
+
+int thumbEmuRead(thumbEmuType* aEmu, uint32_t address, uint32_t size, uint32_t* aValue);
+int thumbEmuWrite(thumbEmuType* aEmu, uint32_t address, uint32_t size, uint32_t value);
+
+uint32_t thumbEmuGetPsr(const thumbEmuType* aEmu);
+void thumbEmuSetPsr(thumbEmuType* aEmu, uint32_t psr);
+int32_t thumbEmuExecutionPriority(const thumbEmuType* aEmu);
+
+void thumbEmuRaise(thumbEmuType* aEmu, uint32_t exception);
+void thumbEmuFault(thumbEmuType* aEmu, uint32_t exception, uint32_t cfsrBits, uint32_t address);
+
+#endif /* THUMB_EMU_H_ */
@@ -0,0 +1,170 @@
+/*
+ * thumbEmuTarget.c
+ *
+ *  Created on: 18 Oct 2026
+ *
+ *  STM32F413 machine for the Thumb-2 emulator
+ */
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../exceptions.h"
+#include "thumbEmuTarget.h"
+
+#define EXC_RETURN_PSP          (1u<<2)
+#define CONTROL_SPSEL           (1u<<1)
+#define SHCSR_FAULTS_ENABLED    0x00070000u     // As exceptionsInit() leaves it.
+#define CCR_DEFAULT             0x00000210u     // STKALIGN and DIV_0_TRP.
+#define CPACR_FPU_ENABLED       0x00F00000u
+
+static int peripheralAccess(thumbEmuType* aEmu, uint32_t address, uint32_t size, uint32_t* aValue, int write)
+{
+    thumbEmuTargetType* target = (thumbEmuTargetType*)aEmu->m_User;
+
+    // Peripheral space only, anything else unmapped is a bus error.
+    if((address < 0x40000000u) || (address >= 0x60000000u))
+        return -1;
+    if(write)
+        target->m_IoWrites++;
+    else
+    {
+        target->m_IoReads++;
+        *aValue = 0;
+    }
+    if(target->m_Verbose)
+        printf("  io %s%u %08x = %08x at %08x\n", write ? "write" : "read", size * 8, address, *aValue, aEmu->m_Current);
+    return 0;
+}
+
+int thumbEmuTargetOpen(thumbEmuTargetType* aTarget, const elf32FileType* aElf)
+{
+    const Elf32_Shdr* vectors = elf32FindSection(aElf, ".isr_vector");
+    const Elf32_Sym* stackTop = elf32FindSymbol(aElf, "_estack");
+    uint32_t offset;
+
+    memset(aTarget, 0, sizeof(*aTarget));
+    aTarget->m_Elf = aElf;
+    aTarget->m_Flash = calloc(1, THUMB_EMU_TARGET_FLASH_SIZE);
+    aTarget->m_Ram = calloc(1, THUMB_EMU_TARGET_RAM_SIZE);
+    aTarget->m_RamImage = calloc(1, THUMB_EMU_TARGET_RAM_SIZE);
+    if((aTarget->m_Flash == NULL) || (aTarget->m_Ram == NULL) || (aTarget->m_RamImage == NULL))
+    {
+        thumbEmuTargetClose(aTarget);
+        return -1;
+    }
+    memset(aTarget->m_Flash, 0xFF, THUMB_EMU_TARGET_FLASH_SIZE);
+
+    // Section by section, elf32ReadMemory() stops at the first gap.
+    for(offset = 0; offset < THUMB_EMU_TARGET_FLASH_SIZE; )
+    {
+        uint32_t length = elf32ReadMemory(aElf, THUMB_EMU_TARGET_FLASH_BASE + offset, aTarget->m_Flash + offset,
+                                          THUMB_EMU_TARGET_FLASH_SIZE - offset, 1);
+
+        offset += (length != 0) ? length : 4;
+    }
+    for(offset = 0; offset < THUMB_EMU_TARGET_RAM_SIZE; )
+    {
+        uint32_t length = elf32ReadMemory(aElf, THUMB_EMU_TARGET_RAM_BASE + offset, aTarget->m_RamImage + offset,
+                                          THUMB_EMU_TARGET_RAM_SIZE - offset, 0);
+
+        offset += (length != 0) ? length : 4;
+    }
+
+    aTarget->m_VectorTable = (vectors != NULL) ? vectors->sh_addr : THUMB_EMU_TARGET_FLASH_BASE;
+    if(stackTop != NULL)
+        aTarget->m_MainStackTop = stackTop->st_value;
+    else
+        memcpy(&aTarget->m_MainStackTop, aTarget->m_Flash + (aTarget->m_VectorTable - THUMB_EMU_TARGET_FLASH_BASE), 4);
+    thumbEmuTargetReset(aTarget);
+    return 0;
+}
+
+void thumbEmuTargetClose(thumbEmuTargetType* aTarget)
+{
+    free(aTarget->m_Flash);
+    free(aTarget->m_Ram);
+    free(aTarget->m_RamImage);
+    memset(aTarget, 0, sizeof(*aTarget));
+}
+
+/* Reset
+ * - RAM back to the ELF image and the core in the state the firmware leaves it after
+ *   exceptionsInit(), with MSP and PC from the vector table
+*/
+void thumbEmuTargetReset(thumbEmuTargetType* aTarget)
+{
+    thumbEmuType* emu = &aTarget->m_Emu;
+
+    memcpy(aTarget->m_Ram, aTarget->m_RamImage, THUMB_EMU_TARGET_RAM_SIZE);
+    aTarget->m_IoReads = 0;
+    aTarget->m_IoWrites = 0;
+
+    thumbEmuInit(emu);
+    thumbEmuMap(emu, THUMB_EMU_TARGET_FLASH_BASE, THUMB_EMU_TARGET_FLASH_SIZE, aTarget->m_Flash, THUMB_EMU_READ|THUMB_EMU_EXEC);
+    thumbEmuMap(emu, THUMB_EMU_TARGET_RAM_BASE, THUMB_EMU_TARGET_RAM_SIZE, aTarget->m_Ram, THUMB_EMU_READ|THUMB_EMU_WRITE|THUMB_EMU_EXEC);
+    thumbEmuMap(emu, 0, THUMB_EMU_TARGET_FLASH_SIZE, aTarget->m_Flash, THUMB_EMU_READ|THUMB_EMU_EXEC);
+    emu->m_Io = peripheralAccess;
+    emu->m_User = aTarget;
+    emu->m_Vtor = aTarget->m_VectorTable;
+    emu->m_Shcsr = SHCSR_FAULTS_ENABLED;
+    emu->m_Ccr = CCR_DEFAULT;
+    emu->m_Cpacr = CPACR_FPU_ENABLED;
+    thumbEmuReset(emu);
+}
+
+/* Seed from a crash record
+ * - Registers as they were when the fault hit, captured memory over the ELF's RAM image
+ * - MSP is unknown when the fault came from a task, the top of the main stack is used
+*/
+void thumbEmuTargetSeed(thumbEmuTargetType* aTarget, const crashRecordType* aRecord)
+{
+    thumbEmuType* emu = &aTarget->m_Emu;
+    const crashRecordTlvType* tlv = NULL;
+    uint32_t exception;
+
+    thumbEmuTargetReset(aTarget);
+
+    while((tlv = crashArchiveNextTlv(aRecord, tlv)) != NULL)
+    {
+        const uint8_t* payload = (const uint8_t*)(tlv + 1);
+        uint32_t address;
+        uint32_t i;
+
+        if((tlv->m_Tag != CRASH_RECORD_TAG_MEMORY) || (tlv->m_Length < 4))
+            continue;
+        memcpy(&address, payload, 4);
+        for(i = 0; i < (uint32_t)tlv->m_Length - 4; i++)
+            thumbEmuWrite(emu, address + i, 1, payload[4 + i]);
+    }
+
+    memcpy(emu->m_R, aRecord->m_R, sizeof(aRecord->m_R));
+    emu->m_R[14] = aRecord->m_Lr;
+    emu->m_R[15] = aRecord->m_Pc & ~1u;
+    thumbEmuSetPsr(emu, aRecord->m_Psr);
+    if(aRecord->m_ExcReturn & EXC_RETURN_PSP)
+    {
+        emu->m_Control = CONTROL_SPSEL;
+        emu->m_Psp = aRecord->m_Sp;
+        emu->m_Msp = aTarget->m_MainStackTop;
+    }
+    else
+        emu->m_Msp = aRecord->m_Sp;
+    emu->m_R[13] = aRecord->m_Sp;
+
+    exception = emu->m_Ipsr;
+    if((exception != 0) && (exception < THUMB_EMU_MAX_EXCEPTIONS))
+        emu->m_Active[exception] = 1;
+}
+
+uint32_t thumbEmuTargetException(uint8_t type)
+{
+    switch(type)
+    {
+        case MemMang_Fault: return THUMB_EMU_MEM_MANAGE;
+        case Bus_Fault:     return THUMB_EMU_BUS_FAULT;
+        case Usage_Fault:   return THUMB_EMU_USAGE_FAULT;
+        default:            return THUMB_EMU_HARD_FAULT;
+    }
+}
@@ -0,0 +1,49 @@
+/*
+ * thumbEmuTarget.h
+ *
+ *  Created on: 18 Oct 2026
+ *
+ *  STM32F413 machine for the Thumb-2 emulator
+ *  - Flash (also aliased at 0) holds the ELF's image, RAM starts as the ELF initialises it
+ *  - Peripherals read as zero and ignore writes, they are counted so a replay can tell
+ *    when it went somewhere the snapshot cannot follow
+ *  - A crash record seeds the registers and overlays its captured memory
+ */
+
+#ifndef THUMB_EMU_TARGET_H_
+#define THUMB_EMU_TARGET_H_
+
+#include <stdint.h>
+
+#include "crashArchive.h"
+#include "elf32.h"
+#include "thumbEmu.h"
+
+#define THUMB_EMU_TARGET_FLASH_BASE     0x08000000u
+#define THUMB_EMU_TARGET_FLASH_SIZE     0x00180000u     // 1.5 MB.
+#define THUMB_EMU_TARGET_RAM_BASE       0x20000000u
+#define THUMB_EMU_TARGET_RAM_SIZE       0x00050000u     // 320 KB.
+
+typedef struct
+{
+    thumbEmuType m_Emu;
+    const elf32FileType* m_Elf;
+    uint8_t* m_Flash;
+    uint8_t* m_Ram;
+    uint8_t* m_RamImage;        // RAM as the ELF initialises it.
+    uint32_t m_VectorTable;
+    uint32_t m_MainStackTop;
+    uint64_t m_IoReads;
+    uint64_t m_IoWrites;
+    int m_Verbose;              // Print every peripheral access.
+} thumbEmuTargetType;
+
+int thumbEmuTargetOpen(thumbEmuTargetType* aTarget, const elf32FileType* aElf);
+void thumbEmuTargetClose(thumbEmuTargetType* aTarget);
+
+void thumbEmuTargetReset(thumbEmuTargetType* aTarget);
+void thumbEmuTargetSeed(thumbEmuTargetType* aTarget, const crashRecordType* aRecord);
+
+uint32_t thumbEmuTargetException(uint8_t type);
+
+#endif /* THUMB_EMU_TARGET_H_ */